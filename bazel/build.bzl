@@ -15,7 +15,8 @@ def bes_cc_library(name, deps = [], copts = [], linkops = []):
             "lib/bes/" + name + "/**/*.h",
             "lib/bes/" + name + "/**/*.tcc",
         ]),
-        copts = COPTS + copts,
+        # Tag log statements with the library name for per-module thresholds
+        copts = COPTS + copts + ["-DBES_LOG_MODULE=\\\"" + name + "\\\""],
         linkopts = LINKOPTS + linkops,
         includes = ["lib"],
         deps = deps,
@@ -0,0 +1,231 @@
+#include "bench/bench.h"
+
+#include <unistd.h>
+
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace bes::bench;
+
+namespace {
+
+enum class OutputFormat
+{
+    TEXT,
+    JSON,
+};
+
+struct Options
+{
+    std::string filter;
+    std::string out_file;
+    std::chrono::milliseconds min_time{250};
+    OutputFormat format = OutputFormat::TEXT;
+};
+
+struct Result
+{
+    std::string suite;
+    std::string name;
+    std::uint64_t iterations;
+    double ns_per_op;
+    double items_per_second;
+    std::string label;
+};
+
+void usage(char const* bin)
+{
+    std::cerr << "Usage: " << bin << " [options]\n\n"
+              << "Options:\n"
+              << "  --filter=<substring>    Only run benchmarks whose 'Suite/Name' contains the substring\n"
+              << "  --min-time=<ms>         Minimum time for a single timed run (default: 250)\n"
+              << "  --format=<text|json>    Output format (default: text)\n"
+              << "  --out=<file>            Write results to a file instead of stdout\n";
+    std::exit(2);
+}
+
+Options parseOptions(int argc, char** argv)
+{
+    Options opts;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            opts.filter = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--min-time=", 11) == 0) {
+            opts.min_time = std::chrono::milliseconds(std::stoul(argv[i] + 11));
+        } else if (std::strcmp(argv[i], "--format=json") == 0) {
+            opts.format = OutputFormat::JSON;
+        } else if (std::strcmp(argv[i], "--format=text") == 0) {
+            opts.format = OutputFormat::TEXT;
+        } else if (std::strncmp(argv[i], "--out=", 6) == 0) {
+            opts.out_file = argv[i] + 6;
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    return opts;
+}
+
+/**
+ * Run a benchmark with a growing iteration count until a single run takes at least `min_time`.
+ */
+State runBenchmark(Registration const& bm, std::chrono::milliseconds min_time)
+{
+    std::uint64_t iterations = 1;
+
+    for (;;) {
+        State state(iterations);
+        bm.fn(state);
+
+        auto elapsed = state.elapsed();
+        if (elapsed >= min_time || iterations >= 1000000000) {
+            return state;
+        }
+
+        // Aim a little past the minimum, but never grow by more than 10x in a single step
+        double multiplier = elapsed.count() > 0 ? 1.4 * double(std::chrono::nanoseconds(min_time).count()) /
+                                                      double(elapsed.count())
+                                                : 10.0;
+        multiplier = std::min(10.0, std::max(2.0, multiplier));
+        iterations = static_cast<std::uint64_t>(double(iterations) * multiplier);
+    }
+}
+
+std::string jsonEscape(std::string const& str)
+{
+    std::string out;
+    out.reserve(str.size());
+
+    for (char c : str) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                out += c;
+        }
+    }
+
+    return out;
+}
+
+void writeText(std::ostream& out, Result const& r)
+{
+    std::string name = r.suite + "/" + r.name;
+    out << std::left << std::setw(48) << name << std::right << std::setw(14) << r.iterations << std::setw(14)
+        << std::fixed << std::setprecision(1) << r.ns_per_op << std::setw(16) << std::setprecision(0)
+        << r.items_per_second;
+
+    if (!r.label.empty()) {
+        out << "  " << r.label;
+    }
+
+    out << std::endl;
+}
+
+/**
+ * JSON layout is stable so results from two commits can be diffed or loaded side by side.
+ */
+void writeJson(std::ostream& out, std::vector<Result> const& results)
+{
+    char host[256] = {};
+    ::gethostname(host, sizeof(host) - 1);
+
+    std::time_t now = std::time(nullptr);
+    std::tm now_tm{};
+    ::gmtime_r(&now, &now_tm);
+    char date[32];
+    std::strftime(date, sizeof(date), "%FT%TZ", &now_tm);
+
+    out << "{\n  \"context\": {\n"
+        << "    \"date\": \"" << date << "\",\n"
+        << "    \"host\": \"" << jsonEscape(host) << "\",\n"
+        << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+#ifdef NDEBUG
+        << "    \"optimised\": true\n"
+#else
+        << "    \"optimised\": false\n"
+#endif
+        << "  },\n  \"benchmarks\": [";
+
+    bool first = true;
+    for (auto const& r : results) {
+        out << (first ? "\n" : ",\n") << "    {\"suite\": \"" << jsonEscape(r.suite) << "\", \"name\": \""
+            << jsonEscape(r.name) << "\", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << std::fixed
+            << std::setprecision(3) << r.ns_per_op << ", \"items_per_second\": " << std::setprecision(1)
+            << r.items_per_second;
+
+        if (!r.label.empty()) {
+            out << ", \"label\": \"" << jsonEscape(r.label) << "\"";
+        }
+
+        out << "}";
+        first = false;
+    }
+
+    out << "\n  ]\n}\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    auto opts = parseOptions(argc, argv);
+
+    std::ofstream out_file;
+    if (!opts.out_file.empty()) {
+        out_file.open(opts.out_file);
+        if (!out_file.is_open()) {
+            std::cerr << "Unable to open output file: " << opts.out_file << std::endl;
+            return 1;
+        }
+    }
+
+    std::ostream& out = out_file.is_open() ? out_file : std::cout;
+
+    if (opts.format == OutputFormat::TEXT) {
+        out << std::left << std::setw(48) << "Benchmark" << std::right << std::setw(14) << "Iterations"
+            << std::setw(14) << "ns/op" << std::setw(16) << "items/s" << "\n";
+    }
+
+    std::vector<Result> results;
+
+    for (auto const& bm : registry()) {
+        std::string name = bm.suite + "/" + bm.name;
+        if (!opts.filter.empty() && name.find(opts.filter) == std::string::npos) {
+            continue;
+        }
+
+        auto state = runBenchmark(bm, opts.min_time);
+        double ns = double(state.elapsed().count());
+
+        Result r{bm.suite, bm.name, state.iterations(), ns / double(state.iterations()),
+                 double(state.itemsProcessed()) * 1e9 / ns, state.label()};
+
+        if (opts.format == OutputFormat::TEXT) {
+            writeText(out, r);
+        } else {
+            // Keep some sign of life on the console while a JSON run is in progress
+            std::cerr << name << std::endl;
+        }
+
+        results.push_back(std::move(r));
+    }
+
+    if (opts.format == OutputFormat::JSON) {
+        writeJson(out, results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bes::bench {
+
+/**
+ * Iteration control for a single benchmark run.
+ *
+ * The clock starts on the first call to keepRunning() and stops when it returns false, so any setup before the loop
+ * and teardown after it is excluded from the result:
+ *
+ *      BES_BENCH(Suite, Name)
+ *      {
+ *          setup();
+ *          while (state.keepRunning()) {
+ *              codeUnderTest();
+ *          }
+ *      }
+ */
+class State
+{
+   public:
+    using clock = std::chrono::steady_clock;
+
+    explicit State(std::uint64_t iterations) : max_iterations(iterations) {}
+
+    inline bool keepRunning()
+    {
+        if (count == 0) {
+            startTiming();
+        }
+
+        if (count++ < max_iterations) {
+            return true;
+        }
+
+        stopTiming();
+        return false;
+    }
+
+    /**
+     * Manual timing, for benchmarks that process all iterations as a single batch (eg, spread over several threads)
+     * rather than with a keepRunning() loop.
+     */
+    inline void startTiming()
+    {
+        start = clock::now();
+    }
+
+    inline void stopTiming()
+    {
+        end = clock::now();
+    }
+
+    /**
+     * Exclude a section of the loop from timing, such as resetting state between batches.
+     */
+    inline void pauseTiming()
+    {
+        pause_start = clock::now();
+    }
+
+    inline void resumeTiming()
+    {
+        paused += clock::now() - pause_start;
+    }
+
+    /**
+     * Number of iterations this run will perform.
+     */
+    [[nodiscard]] inline std::uint64_t iterations() const
+    {
+        return max_iterations;
+    }
+
+    /**
+     * Override the number of items processed if an iteration handles more (or less) than a single item.
+     */
+    inline void setItemsProcessed(std::uint64_t items)
+    {
+        items_processed = items;
+    }
+
+    [[nodiscard]] inline std::uint64_t itemsProcessed() const
+    {
+        return items_processed ? items_processed : max_iterations;
+    }
+
+    /**
+     * Free-form note printed alongside the result, for measurements that aren't a rate (eg, an output size).
+     */
+    inline void setLabel(std::string text)
+    {
+        label_text = std::move(text);
+    }
+
+    [[nodiscard]] inline std::string const& label() const
+    {
+        return label_text;
+    }
+
+    [[nodiscard]] inline std::chrono::nanoseconds elapsed() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start - paused);
+    }
+
+   private:
+    std::uint64_t max_iterations;
+    std::uint64_t count = 0;
+    std::uint64_t items_processed = 0;
+    std::string label_text;
+    clock::time_point start;
+    clock::time_point end;
+    clock::time_point pause_start;
+    clock::duration paused{0};
+};
+
+using Benchmark = std::function<void(State&)>;
+
+struct Registration
+{
+    std::string suite;
+    std::string name;
+    Benchmark fn;
+};
+
+inline std::vector<Registration>& registry()
+{
+    static std::vector<Registration> benchmarks;
+    return benchmarks;
+}
+
+struct Registrar
+{
+    Registrar(char const* suite, char const* name, Benchmark fn)
+    {
+        registry().push_back({suite, name, std::move(fn)});
+    }
+};
+
+/**
+ * Prevent the compiler from optimising away a value that is otherwise unused.
+ */
+template <class T>
+inline void doNotOptimise(T const& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace bes::bench
+
+/**
+ * Declare a benchmark; the body receives a `bes::bench::State& state`.
+ */
+#define BES_BENCH(suite, name)                                                                                   \
+    static void bes_bench_##suite##_##name(::bes::bench::State& state);                                          \
+    static ::bes::bench::Registrar bes_bench_reg_##suite##_##name(#suite, #name, bes_bench_##suite##_##name);    \
+    static void bes_bench_##suite##_##name(::bes::bench::State& state)
@@ -0,0 +1,53 @@
+#include <bes/core.h>
+
+#include "bench/bench.h"
+
+namespace {
+
+constexpr auto config_yaml = R"--EOF--(---
+server:
+  bind: 0.0.0.0
+  listen: 9000
+web:
+  build: static
+  sessions:
+    ttl: 3600
+    redis:
+      host: 127.0.0.1
+      port: 6379
+)--EOF--";
+
+}  // namespace
+
+BES_BENCH(Config, GetTopLevel)
+{
+    bes::Config cfg;
+    cfg.loadString(config_yaml);
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(cfg.get<std::uint16_t>("server", "listen"));
+    }
+}
+
+BES_BENCH(Config, GetNested)
+{
+    bes::Config cfg;
+    cfg.loadString(config_yaml);
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(cfg.get<std::string>("web", "sessions", "redis", "host"));
+    }
+}
+
+/**
+ * getOr() on a missing key falls back to the default via an IndexErrorException.
+ */
+BES_BENCH(Config, GetOrMissing)
+{
+    bes::Config cfg;
+    cfg.loadString(config_yaml);
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(cfg.getOr<std::uint32_t>(250, "web", "sessions", "timeout"));
+    }
+}
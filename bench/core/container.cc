@@ -0,0 +1,55 @@
+#include <bes/core.h>
+
+#include <string>
+
+#include "bench/bench.h"
+
+namespace {
+
+void fillContainer(bes::Container& c, int n)
+{
+    for (int i = 0; i < n; ++i) {
+        c.emplace<std::string>("service.key." + std::to_string(i), "value");
+    }
+}
+
+}  // namespace
+
+BES_BENCH(Container, GetHit)
+{
+    bes::Container c;
+    fillContainer(c, 32);
+    std::string const key = "service.key.16";
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(c.get<std::string>(key));
+    }
+}
+
+BES_BENCH(Container, ExistsMiss)
+{
+    bes::Container c;
+    fillContainer(c, 32);
+    std::string const key = "service.key.missing";
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(c.exists(key));
+    }
+}
+
+/**
+ * A miss on get() throws a KeyNotFoundException, measures the cost of that path.
+ */
+BES_BENCH(Container, GetMissThrows)
+{
+    bes::Container c;
+    fillContainer(c, 32);
+    std::string const key = "service.key.missing";
+
+    while (state.keepRunning()) {
+        try {
+            bes::bench::doNotOptimise(c.get<std::string>(key));
+        } catch (bes::KeyNotFoundException const&) {
+        }
+    }
+}
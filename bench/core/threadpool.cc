@@ -0,0 +1,82 @@
+#include <bes/core.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+
+namespace {
+
+/**
+ * Enqueue `state.iterations()` empty tasks from `producers` threads at once, timing until the pool has run them all.
+ */
+void contendedEnqueue(bes::bench::State& state, unsigned producers, bes::threadsize_t workers)
+{
+    bes::ThreadPool pool(workers);
+    std::atomic<std::uint64_t> done{0};
+    std::atomic<bool> go{false};
+    std::uint64_t per_producer = state.iterations() / producers + 1;
+    std::uint64_t total = per_producer * producers;
+
+    std::vector<std::thread> threads;
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+
+            for (std::uint64_t i = 0; i < per_producer; ++i) {
+                pool.enqueue([&done] {
+                    done.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        });
+    }
+
+    state.startTiming();
+    go.store(true);
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    while (done.load() < total) {
+        std::this_thread::yield();
+    }
+
+    state.stopTiming();
+    state.setItemsProcessed(total);
+}
+
+}  // namespace
+
+/**
+ * Round-trip latency: enqueue a task and block until its result is available.
+ */
+BES_BENCH(ThreadPool, DispatchLatency)
+{
+    bes::ThreadPool pool(4);
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(pool.enqueue([] {
+                                          return 1;
+                                      })
+                                      .get());
+    }
+}
+
+BES_BENCH(ThreadPool, EnqueueThroughput1Producer)
+{
+    contendedEnqueue(state, 1, 4);
+}
+
+BES_BENCH(ThreadPool, EnqueueThroughput4Producers)
+{
+    contendedEnqueue(state, 4, 4);
+}
+
+BES_BENCH(ThreadPool, EnqueueThroughput16Producers)
+{
+    contendedEnqueue(state, 16, 4);
+}
@@ -0,0 +1,72 @@
+#include <bes/core.h>
+
+#include <chrono>
+
+#include "bench/bench.h"
+
+namespace {
+
+/**
+ * Cheap xorshift generator, keeps the RNG out of the measurement.
+ */
+inline std::uint64_t nextRand(std::uint64_t& s)
+{
+    s ^= s << 13;
+    s ^= s >> 7;
+    s ^= s << 17;
+    return s;
+}
+
+/// Delays between 1 second and ~4.6 hours, so nothing fires during the run and every wheel level is exercised
+inline std::chrono::milliseconds randomDelay(std::uint64_t& s)
+{
+    return std::chrono::milliseconds(1000 + nextRand(s) % (1u << 24));
+}
+
+}  // namespace
+
+BES_BENCH(TimerWheel, Schedule)
+{
+    bes::TimerWheel wheel;
+    std::uint64_t seed = 0x9e3779b97f4a7c15;
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(wheel.schedule(randomDelay(seed), [] {}));
+    }
+}
+
+BES_BENCH(TimerWheel, Cancel)
+{
+    bes::TimerWheel wheel;
+    std::uint64_t seed = 0x9e3779b97f4a7c15;
+    std::vector<bes::timer_id_t> ids;
+    ids.reserve(state.iterations());
+
+    for (std::uint64_t i = 0; i < state.iterations(); ++i) {
+        ids.push_back(wheel.schedule(randomDelay(seed), [] {}));
+    }
+
+    auto it = ids.begin();
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(wheel.cancel(*it++));
+    }
+}
+
+/**
+ * Schedule + cancel pairs against a wheel already holding a million outstanding timers.
+ */
+BES_BENCH(TimerWheel, ChurnWithMillionOutstanding)
+{
+    bes::TimerWheel wheel;
+    std::uint64_t seed = 0x9e3779b97f4a7c15;
+
+    for (int i = 0; i < 1000000; ++i) {
+        wheel.schedule(randomDelay(seed), [] {});
+    }
+
+    while (state.keepRunning()) {
+        wheel.cancel(wheel.schedule(randomDelay(seed), [] {}));
+    }
+
+    state.setItemsProcessed(state.iterations() * 2);
+}
@@ -0,0 +1,79 @@
+#include <bes/log.h>
+
+#include <fstream>
+
+#include "bench/bench.h"
+
+using namespace bes::log;
+using namespace bes::log::backend;
+
+namespace {
+
+/**
+ * Points std::cout at /dev/null for the lifetime of the object, so console backends do real formatting and writes
+ * without flooding the benchmark output.
+ */
+class DiscardConsole
+{
+   public:
+    DiscardConsole() : null("/dev/null"), original(std::cout.rdbuf(null.rdbuf())) {}
+
+    ~DiscardConsole()
+    {
+        std::cout.flush();
+        std::cout.rdbuf(original);
+    }
+
+   private:
+    std::ofstream null;
+    std::streambuf* original;
+};
+
+}  // namespace
+
+/**
+ * Cost on the calling thread of a BES_LOG statement writing straight to the console.
+ */
+BES_BENCH(Log, SyncConsole)
+{
+    DiscardConsole discard;
+    LogSink sink(Severity::INFO);
+    sink.addBackend<ConsoleLogBackend>(LogFormat::FULL, ColourMode::DISABLE);
+
+    int i = 0;
+    while (state.keepRunning()) {
+        BES_LOG(INFO) << "Request " << ++i << " completed in " << 12.5 << "ms";
+    }
+}
+
+/**
+ * Same statement with the console behind an AsyncLogBackend; the timed section excludes the final drain.
+ */
+BES_BENCH(Log, AsyncConsole)
+{
+    DiscardConsole discard;
+    LogSink sink(Severity::INFO);
+    sink.addBackend<AsyncLogBackend>(std::make_shared<ConsoleLogBackend>(LogFormat::FULL, ColourMode::DISABLE),
+                                     OverflowPolicy::BLOCK);
+
+    int i = 0;
+    while (state.keepRunning()) {
+        BES_LOG(INFO) << "Request " << ++i << " completed in " << 12.5 << "ms";
+    }
+
+    sink.flush();
+}
+
+/**
+ * A statement below the sink's severity, the floor cost of leaving logging in the request path.
+ */
+BES_BENCH(Log, Disabled)
+{
+    LogSink sink(Severity::INFO);
+    sink.addBackend<ConsoleLogBackend>(LogFormat::FULL, ColourMode::DISABLE);
+
+    int i = 0;
+    while (state.keepRunning()) {
+        BES_LOG(DEBUG) << "Request " << ++i << " completed in " << 12.5 << "ms";
+    }
+}
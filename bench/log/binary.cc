@@ -0,0 +1,23 @@
+#include <bes/log.h>
+
+#include "bench/bench.h"
+
+using namespace bes::log;
+using namespace bes::log::backend;
+
+/**
+ * Cost on the calling thread of a structured statement with a binary backend attached. Writes go to /dev/null, a tight
+ * loop can outpace the writer so some records may be dropped; the drop path is cheaper still.
+ */
+BES_BENCH(Log, BinaryStructured)
+{
+    LogSink sink(Severity::INFO);
+    sink.addBackend<BinaryLogBackend>("/dev/null", 4 * 1024 * 1024);
+
+    int i = 0;
+    while (state.keepRunning()) {
+        BES_LOGF(INFO, "Request {} completed in {}ms", ++i, 12.5);
+    }
+
+    sink.flush();
+}
@@ -0,0 +1,95 @@
+#include <bes/log.h>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "bench/bench.h"
+
+using namespace bes::log;
+using namespace bes::log::backend;
+
+namespace {
+
+char const* const log_path = "/tmp/bes_bench_file.log";
+
+/**
+ * Log `state.iterations()` records spread over `producers` threads, timing until they are all written.
+ */
+void logFrom(bes::bench::State& state, LogSink& sink, unsigned producers)
+{
+    std::uint64_t per_producer = state.iterations() / producers + 1;
+
+    std::vector<std::thread> threads;
+    state.startTiming();
+
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([per_producer] {
+            for (std::uint64_t i = 0; i < per_producer; ++i) {
+                BES_LOG(INFO) << "Request " << i << " completed in " << 12.5 << "ms";
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    sink.flush();
+    state.stopTiming();
+    state.setItemsProcessed(per_producer * producers);
+}
+
+/**
+ * Console backend with std::cout pointed at a file, so both backends pay for real writes.
+ */
+void console(bes::bench::State& state, unsigned producers)
+{
+    std::ofstream file(log_path, std::ios::trunc);
+    auto* original = std::cout.rdbuf(file.rdbuf());
+
+    {
+        LogSink sink(Severity::INFO);
+        sink.addBackend<ConsoleLogBackend>(LogFormat::FULL, ColourMode::DISABLE);
+        logFrom(state, sink, producers);
+    }
+
+    std::cout.rdbuf(original);
+    std::remove(log_path);
+}
+
+void file(bes::bench::State& state, unsigned producers)
+{
+    std::remove(log_path);
+
+    {
+        LogSink sink(Severity::INFO);
+        sink.addBackend<FileLogBackend>(log_path, LogFormat::FULL);
+        logFrom(state, sink, producers);
+    }
+
+    std::remove(log_path);
+}
+
+}  // namespace
+
+BES_BENCH(Log, ConsoleToFile1Thread)
+{
+    console(state, 1);
+}
+
+BES_BENCH(Log, ConsoleToFile4Threads)
+{
+    console(state, 4);
+}
+
+BES_BENCH(Log, FileBackend1Thread)
+{
+    file(state, 1);
+}
+
+BES_BENCH(Log, FileBackend4Threads)
+{
+    file(state, 4);
+}
@@ -0,0 +1,63 @@
+#include <bes/templating.h>
+
+#include "bench/bench.h"
+
+using namespace bes::templating;
+
+namespace {
+
+/**
+ * A listing page's worth of conditionals, most of which compare a string to a number or another string and so fall
+ * back to comparing the rendered values.
+ */
+std::string const listing = R"(
+{% for item in items %}
+{% if item == "featured" %}<b>{% elif item == 3 %}<i>{% elif item != "hidden" %}<span>{% endif %}
+{% if count > 10 %}more{% endif %}{% if ratio == 0.5 %}half{% endif %}
+{% endfor %})";
+
+}  // namespace
+
+BES_BENCH(Conditionals, Render)
+{
+    Engine engine;
+    engine.loadString("listing", listing);
+
+    data::ContextBuilder ctx;
+    ctx.set("items", std::vector<std::string>{"featured", "normal", "hidden", "normal", "3", "normal", "normal", "x"});
+    ctx.set("count", 12);
+    ctx.set("ratio", 0.5);
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(engine.render("listing", ctx.getContext()));
+    }
+
+    state.setItemsProcessed(state.iterations() * 8);
+}
+
+BES_BENCH(Conditionals, MixedEquals)
+{
+    data::StandardShell<std::string> left("fox");
+    data::StandardShell<int> right(3);
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(left.equals(right));
+    }
+}
+
+/**
+ * The mixed-type comparison as IfNode used to do it, catching the ValueErrorException to fall back to strings.
+ */
+BES_BENCH(Conditionals, MixedEqualsThrow)
+{
+    data::StandardShell<std::string> left("fox");
+    data::StandardShell<int> right(3);
+
+    while (state.keepRunning()) {
+        try {
+            bes::bench::doNotOptimise(left == right);
+        } catch (ValueErrorException const&) {
+            // Fall back to a string comparison
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include <bes/templating.h>
+
+#include "bench/bench.h"
+
+using bes::templating::Text;
+
+namespace {
+
+std::string const sentence = "the quick brown fox jumps over the lazy dog and keeps on running into the distance";
+std::string const padded = "   \t  some value with surrounding whitespace  \n\t  ";
+
+}  // namespace
+
+BES_BENCH(Text, Split)
+{
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(Text::split(sentence));
+    }
+}
+
+BES_BENCH(Text, SplitArgs)
+{
+    std::string const expr = R"(item.title | upper | default("no title") [1, 2, 3])";
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(Text::splitArgs(expr));
+    }
+}
+
+BES_BENCH(Text, Trim)
+{
+    while (state.keepRunning()) {
+        std::string s = padded;
+        Text::trim(s);
+        bes::bench::doNotOptimise(s);
+    }
+}
+
+BES_BENCH(Text, Nl2br)
+{
+    std::string const text = "line one\nline two\r\nline three\n\nline five";
+
+    while (state.keepRunning()) {
+        std::string s = text;
+        Text::nl2br(s);
+        bes::bench::doNotOptimise(s);
+    }
+}
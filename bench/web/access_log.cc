@@ -0,0 +1,128 @@
+#include <bes/log.h>
+#include <bes/web.h>
+
+#include <cstdio>
+
+#include "bench/bench.h"
+
+using namespace bes::log;
+using namespace bes::log::backend;
+
+namespace {
+
+char const* const log_path = "/tmp/bes_bench_access.log";
+
+/**
+ * Producer cost of logging a 200 response at the given 2xx sample rate. The buffer is flushed outside of the timing
+ * before it can fill, so the writer's share (see Web/AccessLogFormat) isn't included.
+ */
+void accessLog(bes::bench::State& state, unsigned success_rate)
+{
+    std::remove(log_path);
+
+    {
+        bes::web::AccessLogSampling sampling;
+        sampling.success_rate = success_rate;
+        bes::web::AccessLog log(log_path, sampling, 4096);
+
+        std::string const method = "GET";
+        std::string const route = "article";
+        std::string const uri = "/articles/1234?page=2";
+        std::uint64_t pending = 0;
+
+        while (state.keepRunning()) {
+            auto duration = std::chrono::microseconds(120);
+            auto rate = log.sample(200, duration);
+            if (rate == 0) {
+                continue;
+            }
+
+            bes::web::AccessRecord rec;
+            rec.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+            rec.bytes = 5120;
+            rec.handle_us = 100;
+            rec.render_us = 20;
+            rec.total_us = static_cast<std::uint32_t>(duration.count());
+            rec.status = 200;
+            rec.sample_rate = static_cast<std::uint16_t>(rate);
+            rec.setMethod(method);
+            rec.setRoute(route);
+            rec.setUri(uri);
+
+            log.record(rec);
+
+            if (++pending == 4000) {
+                state.pauseTiming();
+                log.flush();
+                pending = 0;
+                state.resumeTiming();
+            }
+        }
+
+        log.flush();
+    }
+
+    std::remove(log_path);
+}
+
+}  // namespace
+
+/**
+ * The previous behaviour: one formatted BES_LOG line per request, written by a FileLogBackend.
+ */
+BES_BENCH(Web, LogSinkRequestLine)
+{
+    std::remove(log_path);
+
+    {
+        LogSink sink(Severity::INFO);
+        sink.addBackend<FileLogBackend>(log_path, LogFormat::FULL);
+
+        std::string const method = "GET";
+        std::string const uri = "/articles/1234?page=2";
+        std::string const status = "200";
+
+        state.startTiming();
+
+        for (std::uint64_t i = 0; i < state.iterations(); ++i) {
+            BES_LOG(INFO) << "[HTTP] " << method << " " << uri << " -> " << status << " in " << 120 << " μs";
+        }
+
+        sink.flush();
+        state.stopTiming();
+    }
+
+    std::remove(log_path);
+}
+
+BES_BENCH(Web, AccessLogAll)
+{
+    accessLog(state, 1);
+}
+
+BES_BENCH(Web, AccessLogSampled10)
+{
+    accessLog(state, 10);
+}
+
+/**
+ * Writer cost of serialising a record to NDJSON.
+ */
+BES_BENCH(Web, AccessLogFormat)
+{
+    bes::web::AccessRecord rec;
+    rec.timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    rec.bytes = 5120;
+    rec.total_us = 120;
+    rec.status = 200;
+    rec.setMethod("GET");
+    rec.setRoute("article");
+    rec.setUri("/articles/1234?page=2");
+
+    std::string out;
+    while (state.keepRunning()) {
+        out.clear();
+        bes::web::AccessLog::format(out, rec);
+        bes::bench::doNotOptimise(out);
+    }
+}
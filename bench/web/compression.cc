@@ -0,0 +1,116 @@
+#include <bes/web.h>
+
+#include <string>
+
+#include "bench/bench.h"
+
+using bes::web::ContentEncoding;
+
+namespace {
+
+/**
+ * Template output of roughly `size` bytes: repeated markup with varying text, as a listing page would render.
+ */
+std::string page(std::size_t size)
+{
+    static char const* const words[] = {"market", "review",  "update", "season", "local",  "report", "annual",
+                                        "record", "opening", "team",   "launch", "change", "weekend", "guide"};
+
+    std::string s = "<!DOCTYPE html><html><head><title>Articles</title></head><body><ul class=\"articles\">\n";
+    std::uint32_t seed = 12345;
+
+    while (s.size() < size) {
+        seed = seed * 1103515245 + 12345;
+        auto id = std::to_string(seed % 100000);
+
+        s += "<li class=\"article\"><a href=\"/articles/" + id + "\">";
+        for (int i = 0; i < 5; ++i) {
+            seed = seed * 1103515245 + 12345;
+            s += words[(seed >> 16) % 14];
+            s += ' ';
+        }
+        s += "</a><span class=\"date\">2021-0" + std::to_string(seed % 9 + 1) + "-1" + std::to_string(seed % 7) +
+             "</span></li>\n";
+    }
+
+    return s + "</ul></body></html>\n";
+}
+
+/**
+ * Each iteration is one response; the label records the bytes sent against the uncompressed body.
+ */
+void run(bes::bench::State& state, std::size_t size, ContentEncoding encoding, int level)
+{
+    auto const body = page(size);
+    auto const wire = bes::web::compress(body, encoding, level).size();
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(bes::web::compress(body, encoding, level));
+    }
+
+    state.setLabel("wire=" + std::to_string(wire) + "B of " + std::to_string(body.size()) + "B (" +
+                   std::to_string(wire * 100 / body.size()) + "%)");
+}
+
+}  // namespace
+
+BES_BENCH(Compression, Gzip8K_L1)
+{
+    run(state, 8 * 1024, ContentEncoding::GZIP, 1);
+}
+
+BES_BENCH(Compression, Gzip8K_L6)
+{
+    run(state, 8 * 1024, ContentEncoding::GZIP, 6);
+}
+
+BES_BENCH(Compression, Gzip8K_L9)
+{
+    run(state, 8 * 1024, ContentEncoding::GZIP, 9);
+}
+
+BES_BENCH(Compression, Deflate8K_L6)
+{
+    run(state, 8 * 1024, ContentEncoding::DEFLATE, 6);
+}
+
+BES_BENCH(Compression, Gzip64K_L1)
+{
+    run(state, 64 * 1024, ContentEncoding::GZIP, 1);
+}
+
+BES_BENCH(Compression, Gzip64K_L6)
+{
+    run(state, 64 * 1024, ContentEncoding::GZIP, 6);
+}
+
+/**
+ * A response cache hit for a gzip client: the stored variant is written as it is, compression costs nothing.
+ */
+BES_BENCH(Compression, CachedVariant8K)
+{
+    bes::web::CachedResponse entry;
+    entry.body = page(8 * 1024);
+    entry.gzip_body = bes::web::compress(entry.body, ContentEncoding::GZIP, 6);
+
+    std::string out;
+    out.reserve(entry.body.size());
+
+    while (state.keepRunning()) {
+        out.clear();
+        out += entry.gzip_body;
+        bes::bench::doNotOptimise(out);
+    }
+
+    state.setLabel("wire=" + std::to_string(entry.gzip_body.size()) + "B of " + std::to_string(entry.body.size()) +
+                   "B");
+}
+
+BES_BENCH(Compression, Negotiate)
+{
+    std::string const header = "gzip, deflate, br";
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(bes::web::negotiateEncoding(header));
+    }
+}
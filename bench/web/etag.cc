@@ -0,0 +1,41 @@
+#include <bes/web.h>
+
+#include <string>
+
+#include "bench/bench.h"
+
+namespace {
+
+/**
+ * Typical template output, 8KB of markup.
+ */
+std::string page()
+{
+    std::string s;
+    while (s.size() < 8 * 1024) {
+        s += "<div class=\"item\"><a href=\"/articles/1234\">A headline for the article</a><p>Summary text</p></div>\n";
+    }
+
+    return s;
+}
+
+}  // namespace
+
+BES_BENCH(ETag, Page8K)
+{
+    auto const body = page();
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(bes::web::strongETag(body));
+    }
+}
+
+BES_BENCH(ETag, Match)
+{
+    auto const etag = bes::web::strongETag(page());
+    auto const header = "\"0123456789abcdef\", W/" + etag;
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(bes::web::etagMatches(header, etag));
+    }
+}
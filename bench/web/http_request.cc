@@ -0,0 +1,156 @@
+#include <bes/web.h>
+
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include "bench/bench.h"
+
+namespace {
+
+struct FakeTransport
+{
+    bes::net::socket::Stream socket;
+    bes::fastcgi::Transceiver transceiver{socket};
+};
+
+/**
+ * A FastCGI request with the params of a typical page view: a listing with a few query params and a handful of
+ * analytics cookies alongside the session.
+ */
+class FakeRequest : private FakeTransport, public bes::fastcgi::Request
+{
+   public:
+    explicit FakeRequest(bes::Container const& container)
+        : bes::fastcgi::Request(FakeTransport::transceiver, container)
+    {
+        params[bes::web::Http::Parameter::REQUEST_METHOD] = "GET";
+        params[bes::web::Http::Parameter::DOCUMENT_URI] = "/catalogue/shoes";
+        params[bes::web::Http::Parameter::QUERY_STRING] =
+            "page=2&sort=price-asc&colour=black&size=10&utm_source=newsletter&utm_medium=email&q=running+shoes";
+        params[bes::web::Http::Parameter::COOKIE] =
+            "bsn=S7f3a9c2e4b1d8f6a0c5e; currency=AUD; _ga=GA1.2.1234567890.1612345678; "
+            "_gid=GA1.2.987654321.1612345678; consent=analytics%3Dtrue";
+    }
+};
+
+bes::Container const& requestContainer()
+{
+    static bes::Container container;
+    static bool initialised = [] {
+        container.add<bes::web::SessionInterface>(bes::web::SVC_SESSION_MGR, nullptr);
+        return true;
+    }();
+
+    (void)initialised;
+    return container;
+}
+
+/**
+ * The previous parser, for comparison: both maps are built up front, a character at a time through stringstreams.
+ */
+void eagerParse(std::string const& qs, std::string const& cookie_header,
+                std::unordered_map<std::string, std::string>& query, std::unordered_map<std::string, std::string>& cookies)
+{
+    int mode = 0;
+    std::stringstream key;
+    std::stringstream value;
+
+    for (std::size_t i = 0; i <= qs.length(); ++i) {
+        char c = i == qs.length() ? '&' : qs[i];
+
+        if (c == '=' && mode == 0) {
+            mode = 1;
+        } else if (c == '&') {
+            if (key.rdbuf()->in_avail()) {
+                query[key.str()] = value.str();
+            }
+            key.str(std::string());
+            value.str(std::string());
+            mode = 0;
+        } else {
+            if (c == '+') {
+                c = ' ';
+            }
+            (mode == 0 ? key : value) << c;
+        }
+    }
+
+    mode = 0;
+    key.str(std::string());
+    value.str(std::string());
+
+    for (char c : cookie_header + ";") {
+        if (c == ';') {
+            if (key.rdbuf()->in_avail() && value.rdbuf()->in_avail()) {
+                cookies.insert_or_assign(key.str(), value.str());
+            }
+            key.str(std::string());
+            value.str(std::string());
+            mode = 0;
+        } else if (mode == 0 && c == '=') {
+            mode = 1;
+        } else if (c != ' ') {
+            (mode == 0 ? key : value) << c;
+        }
+    }
+}
+
+}  // namespace
+
+/**
+ * A request whose controller never reads a query param or cookie: nothing is parsed.
+ */
+BES_BENCH(HttpRequest, Untouched)
+{
+    FakeRequest base(requestContainer());
+
+    while (state.keepRunning()) {
+        bes::web::HttpRequest request(base);
+        bes::bench::doNotOptimise(request.method());
+    }
+}
+
+/**
+ * A controller reading two query params and a cookie.
+ */
+BES_BENCH(HttpRequest, LazyRead)
+{
+    FakeRequest base(requestContainer());
+
+    while (state.keepRunning()) {
+        bes::web::HttpRequest request(base);
+        bes::bench::doNotOptimise(request.queryParam("page"));
+        bes::bench::doNotOptimise(request.findQueryParam("q"));
+        bes::bench::doNotOptimise(request.findCookie("currency"));
+    }
+}
+
+BES_BENCH(HttpRequest, EagerParse)
+{
+    FakeRequest base(requestContainer());
+    auto const& qs = base.getParam(bes::web::Http::Parameter::QUERY_STRING);
+    auto const& cookie_header = base.getParam(bes::web::Http::Parameter::COOKIE);
+
+    while (state.keepRunning()) {
+        std::unordered_map<std::string, std::string> query;
+        std::unordered_map<std::string, std::string> cookies;
+        eagerParse(qs, cookie_header, query, cookies);
+        bes::bench::doNotOptimise(query.at("page"));
+        bes::bench::doNotOptimise(cookies.at("currency"));
+    }
+}
+
+BES_BENCH(HttpRequest, ScanQuery)
+{
+    FakeRequest base(requestContainer());
+    std::string_view const qs = base.getParam(bes::web::Http::Parameter::QUERY_STRING);
+
+    while (state.keepRunning()) {
+        bes::web::ParamList params;
+        params.parseQuery(qs);
+        bes::bench::doNotOptimise(params.size());
+    }
+
+    state.setItemsProcessed(state.iterations() * qs.size());
+}
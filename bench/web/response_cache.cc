@@ -0,0 +1,70 @@
+#include <bes/web.h>
+
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+
+using bes::web::CachedResponse;
+using bes::web::ResponseCache;
+
+namespace {
+
+std::string const headers = "Status: 200\nContent-Type: text/html; charset=utf-8\n";
+std::string const body(8 * 1024, 'x');
+
+std::vector<std::string> keys(std::size_t count)
+{
+    std::vector<std::string> out;
+    out.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        out.push_back("article\x1f" + std::to_string(i) + "\x1f\x1e\x1e\x1e");
+    }
+
+    return out;
+}
+
+}  // namespace
+
+BES_BENCH(ResponseCache, Hit)
+{
+    ResponseCache cache(256 * 1024 * 1024);
+    auto const k = keys(10000);
+    for (auto const& key : k) {
+        cache.put(key, CachedResponse{headers, body}, std::chrono::seconds(60));
+    }
+
+    std::size_t i = 0;
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(cache.get(k[i++ % k.size()]));
+    }
+}
+
+BES_BENCH(ResponseCache, Miss)
+{
+    ResponseCache cache(256 * 1024 * 1024);
+    auto const k = keys(10000);
+
+    std::size_t i = 0;
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(cache.get(k[i++ % k.size()]));
+    }
+}
+
+/**
+ * Storing into a full cache, so every put evicts.
+ */
+BES_BENCH(ResponseCache, PutEvict)
+{
+    ResponseCache cache(1024 * 1024);
+    auto const k = keys(10000);
+
+    std::size_t i = 0;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        CachedResponse resp{headers, body};
+        state.resumeTiming();
+
+        cache.put(k[i++ % k.size()], std::move(resp), std::chrono::seconds(60));
+    }
+}
@@ -0,0 +1,232 @@
+#include <bes/web.h>
+
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "bench/bench.h"
+
+namespace {
+
+/**
+ * A few hundred routes in the shape of a typical site: sections with a listing, an item by ID and an item by slug.
+ */
+bes::web::MappedRouter& router()
+{
+    static bes::web::MappedRouter r = [] {
+        bes::web::MappedRouter router;
+        router.addRoute(bes::web::Route("home", "/"));
+
+        for (int i = 0; i < 100; ++i) {
+            auto section = "/section-" + std::to_string(i);
+            router.addRoute(bes::web::Route("list_" + std::to_string(i), section));
+            router.addRoute(bes::web::Route("item_" + std::to_string(i), section + "/{ id: [0-9]+ }"));
+            router.addRoute(bes::web::Route("slug_" + std::to_string(i), section + "/{ id: [0-9]+ }/{ slug: .+ }"));
+        }
+
+        return router;
+    }();
+
+    return r;
+}
+
+/**
+ * The previous matcher, for comparison: a prefix compare and regex match against every route in turn.
+ */
+bes::web::PrecachedRoute const* linearMatch(std::string const& uri, bes::web::ActionArgs& args)
+{
+    for (auto const& it : router().routeMap()) {
+        auto const& route = it.second;
+        if (uri.compare(0, route.prefix.size(), route.prefix) != 0) {
+            continue;
+        }
+
+        if (route.arg_map.empty()) {
+            if (route.prefix.size() == uri.size()) {
+                return &route;
+            }
+            continue;
+        }
+
+        std::smatch match;
+        std::string rest = uri.substr(route.prefix.size());
+        if (std::regex_match(rest, match, route.regex) && match.size() == route.arg_map.size() + 1) {
+            for (std::size_t i = 0; i < route.arg_map.size(); ++i) {
+                args[route.arg_map[i]] = match[i + 1].str();
+            }
+            return &route;
+        }
+    }
+
+    return nullptr;
+}
+
+struct FakeTransport
+{
+    bes::net::socket::Stream socket;
+    bes::fastcgi::Transceiver transceiver{socket};
+};
+
+/**
+ * A FastCGI request with its params set directly, rather than read from a socket.
+ */
+class FakeRequest : private FakeTransport, public bes::fastcgi::Request
+{
+   public:
+    FakeRequest(bes::Container const& container, std::string const& uri)
+        : bes::fastcgi::Request(FakeTransport::transceiver, container)
+    {
+        params[bes::web::Http::Parameter::REQUEST_METHOD] = "GET";
+        params[bes::web::Http::Parameter::DOCUMENT_URI] = uri;
+        params[bes::web::Http::Parameter::QUERY_STRING] = "";
+    }
+};
+
+bes::Container const& requestContainer()
+{
+    static bes::Container container;
+    static bool initialised = [] {
+        container.add<bes::web::SessionInterface>(bes::web::SVC_SESSION_MGR, nullptr);
+        return true;
+    }();
+
+    (void)initialised;
+    return container;
+}
+
+std::vector<std::string> const uris = {
+    "/",
+    "/section-7",
+    "/section-42/1234",
+    "/section-99/5678/some-article-title",
+};
+
+}  // namespace
+
+BES_BENCH(Router, TreeMatch)
+{
+    auto& r = router();
+    std::size_t i = 0;
+
+    while (state.keepRunning()) {
+        bes::web::ActionArgs args;
+        bes::bench::doNotOptimise(r.matchRoute(uris[i++ % uris.size()], "", args));
+    }
+}
+
+BES_BENCH(Router, TreeMiss)
+{
+    auto& r = router();
+
+    while (state.keepRunning()) {
+        bes::web::ActionArgs args;
+        bes::bench::doNotOptimise(r.matchRoute("/no/such/page", "", args));
+    }
+}
+
+BES_BENCH(Router, LinearRegexMatch)
+{
+    std::size_t i = 0;
+
+    while (state.keepRunning()) {
+        bes::web::ActionArgs args;
+        bes::bench::doNotOptimise(linearMatch(uris[i++ % uris.size()], args));
+    }
+}
+
+/**
+ * A request no router handles, as bot traffic probing for paths would: the router passes without an exception.
+ */
+BES_BENCH(Router, YieldMiss)
+{
+    auto& r = router();
+    FakeRequest base(requestContainer(), "/wp-admin/setup-config.php");
+    bes::web::HttpRequest request(base);
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(r.tryYieldResponse(request));
+    }
+}
+
+/**
+ * The same miss signalled with a CannotYieldException, as a router that doesn't override tryYieldResponse() would.
+ */
+BES_BENCH(Router, YieldMissThrow)
+{
+    auto& r = router();
+    FakeRequest base(requestContainer(), "/wp-admin/setup-config.php");
+    bes::web::HttpRequest request(base);
+
+    while (state.keepRunning()) {
+        try {
+            bes::bench::doNotOptimise(r.yieldResponse(request));
+        } catch (bes::web::CannotYieldException const&) {
+            // Next router
+        }
+    }
+}
+
+namespace {
+
+/**
+ * A router with a single cacheable page, whose controller builds an 8KB body.
+ */
+bes::web::MappedRouter& pageRouter(bool cached)
+{
+    auto build = [](bool with_cache) {
+        auto r = std::make_unique<bes::web::MappedRouter>();
+        r->loadRoutesFromString("page:\n  uri: /page\n  cache: 3600\n");
+        r->registerController("page", [](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+            auto resp = bes::web::HttpResponse::ok();
+            for (int i = 0; i < 128; ++i) {
+                resp.write("<p>A paragraph of rendered template output, roughly sixty-four bytes</p>");
+            }
+            return resp;
+        });
+
+        if (with_cache) {
+            r->setResponseCache(std::make_shared<bes::web::ResponseCache>(64 * 1024 * 1024));
+        }
+
+        return r;
+    };
+
+    static auto with_cache = build(true);
+    static auto without_cache = build(false);
+
+    return cached ? *with_cache : *without_cache;
+}
+
+void yieldPage(bes::bench::State& state, bool cached)
+{
+    auto& r = pageRouter(cached);
+    FakeRequest base(requestContainer(), "/page");
+    bes::web::HttpRequest request(base);
+
+    // Prime the cache, as the responder would after the first render
+    if (auto resp = r.tryYieldResponse(request); resp && resp->cacheStore()) {
+        auto const& store = *resp->cacheStore();
+        store.cache->put(store.key, bes::web::CachedResponse{"Status: 200\n", resp->content()}, store.ttl);
+    }
+
+    while (state.keepRunning()) {
+        auto resp = r.tryYieldResponse(request);
+        if (resp->cached()) {
+            bes::bench::doNotOptimise(resp->cached()->body.size());
+        } else {
+            bes::bench::doNotOptimise(resp->content().size());
+        }
+    }
+}
+
+}  // namespace
+
+BES_BENCH(Router, YieldRendered)
+{
+    yieldPage(state, false);
+}
+
+BES_BENCH(Router, YieldCached)
+{
+    yieldPage(state, true);
+}
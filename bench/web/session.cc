@@ -0,0 +1,74 @@
+#include <bes/web.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "bench/bench.h"
+
+namespace {
+
+/**
+ * The previous generator, for comparison: a freshly seeded Mersenne Twister and a stringstream per key.
+ */
+std::string seededKey(std::string const& ns)
+{
+    std::stringstream out;
+    std::mt19937 rng(std::random_device{}());
+    std::uniform_int_distribution<std::mt19937::result_type> dist64(1e17, 1e18);
+
+    out << ns;
+    out << std::hex << dist64(rng) << dist64(rng);
+
+    return out.str();
+}
+
+}  // namespace
+
+BES_BENCH(SessionKey, Seeded)
+{
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(seededKey("S"));
+    }
+}
+
+BES_BENCH(SessionKey, Generate)
+{
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(bes::web::SessionInterface::generateSessionKey("S"));
+    }
+}
+
+/**
+ * Into a caller's buffer, without allocating.
+ */
+BES_BENCH(SessionKey, Write)
+{
+    char key[bes::web::SessionInterface::SESSION_KEY_LENGTH];
+
+    while (state.keepRunning()) {
+        bes::web::SessionInterface::writeSessionKey(key);
+        bes::bench::doNotOptimise(key[0]);
+    }
+}
+
+/**
+ * A loaded session read back and written with one value changed: the floor for any networked session manager.
+ */
+BES_BENCH(MemorySession, ReadWrite)
+{
+    bes::web::MemorySessionMgr mgr;
+    mgr.setSessionTtl(3600);
+
+    auto session = mgr.createSession("S");
+    session.setValue("user_id", int64_t(48213377));
+    session.setValue("username", "jordon.example");
+    mgr.persistSession(session);
+
+    int64_t hits = 0;
+    while (state.keepRunning()) {
+        auto loaded = mgr.getSession(session.sessionId());
+        loaded.setValue("hits", ++hits);
+        mgr.persistSession(loaded);
+    }
+}
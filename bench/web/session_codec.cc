@@ -0,0 +1,141 @@
+#include <bes/web.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench/bench.h"
+
+namespace {
+
+/**
+ * A signed-in shopper: identity, preferences, a few flags and counters, and a CSRF token.
+ */
+bes::web::Session session()
+{
+    bes::web::Session s("S0123456789abcdef0123456789abcdef");
+    s.setValue("user_id", int64_t(48213377));
+    s.setValue("username", "jordon.example");
+    s.setValue("email", "jordon@example.com");
+    s.setValue("currency", "AUD");
+    s.setValue("locale", "en_AU");
+    s.setValue("csrf", "9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08");
+    s.setValue("cart_items", int64_t(3));
+    s.setValue("cart_total", 249.95);
+    s.setValue("admin", false);
+    s.setValue("newsletter", true);
+    s.setValue("last_seen", int64_t(1612345678));
+    s.setValue("return_to", "/catalogue/shoes?page=2&sort=price-asc");
+    return s;
+}
+
+/**
+ * The hash format, for comparison: a type-prefixed string per value.
+ */
+std::string encodeValue(bes::web::SessionObject const& value)
+{
+    switch (value.data_type) {
+        case bes::web::SessionObject::ObjectType::DOUBLE:
+            return "D" + std::to_string(std::any_cast<double>(value.data));
+        case bes::web::SessionObject::ObjectType::STRING:
+            return "S" + std::any_cast<std::string>(value.data);
+        case bes::web::SessionObject::ObjectType::INT64:
+            return "I" + std::to_string(std::any_cast<int64_t>(value.data));
+        default:
+            return "B" + std::to_string(std::any_cast<bool>(value.data));
+    }
+}
+
+std::vector<std::pair<std::string, std::string>> encodeHash(bes::web::Session const& s)
+{
+    std::vector<std::pair<std::string, std::string>> hash;
+    for (auto const& it : s.getMap()) {
+        hash.emplace_back(it.first, encodeValue(it.second));
+    }
+    return hash;
+}
+
+bes::web::Session decodeHash(std::string const& id, std::vector<std::pair<std::string, std::string>> const& hash)
+{
+    bes::web::Session s(id);
+    for (auto const& [key, value] : hash) {
+        switch (value[0]) {
+            case 'B':
+                s.setValue(key, bes::web::SessionObject(value[1] == '1'));
+                break;
+            case 'S':
+                s.setValue(key, bes::web::SessionObject(value.substr(1)));
+                break;
+            case 'I':
+                s.setValue(key, bes::web::SessionObject(atol(value.substr(1).c_str())));
+                break;
+            case 'D':
+                s.setValue(key, bes::web::SessionObject(atof(value.substr(1).c_str())));
+                break;
+        }
+    }
+    s.markClean();
+    return s;
+}
+
+/**
+ * Bytes of a RESP bulk string.
+ */
+std::size_t bulk(std::string const& s)
+{
+    return std::to_string(s.size()).size() + s.size() + 5;
+}
+
+}  // namespace
+
+BES_BENCH(SessionCodec, HashEncode)
+{
+    auto const s = session();
+    auto hash = encodeHash(s);
+
+    // The HMSET on the wire, and the field and value bytes Redis stores
+    std::size_t wire = bulk("HMSET") + bulk("session:" + s.sessionId());
+    std::size_t stored = 0;
+    for (auto const& [key, value] : hash) {
+        wire += bulk(key) + bulk(value);
+        stored += key.size() + value.size();
+    }
+    state.setLabel("wire " + std::to_string(wire) + " B, stored " + std::to_string(stored) + " B");
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(encodeHash(s));
+    }
+}
+
+BES_BENCH(SessionCodec, BinaryEncode)
+{
+    auto const s = session();
+    auto blob = bes::web::BinarySessionCodec::encode(s, 1612345678);
+
+    std::size_t wire = bulk("SET") + bulk("session:" + s.sessionId()) + bulk(blob);
+    state.setLabel("wire " + std::to_string(wire) + " B, stored " + std::to_string(blob.size()) + " B");
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(bes::web::BinarySessionCodec::encode(s, 1612345678));
+    }
+}
+
+BES_BENCH(SessionCodec, HashDecode)
+{
+    auto const s = session();
+    auto const hash = encodeHash(s);
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(decodeHash(s.sessionId(), hash));
+    }
+}
+
+BES_BENCH(SessionCodec, BinaryDecode)
+{
+    auto const s = session();
+    auto const blob = bes::web::BinarySessionCodec::encode(s, 1612345678);
+
+    while (state.keepRunning()) {
+        bes::bench::doNotOptimise(bes::web::BinarySessionCodec::decode(s.sessionId(), blob));
+    }
+}
@@ -191,6 +191,12 @@ class Kernel : public KernelInterface
     /// Runs the config parser, if a valid file exists
     void initConfig();
 
+    /// Apply per-module log severities from the `log.modules` config section
+    void initLogModules();
+
+    /// Apply per-source log throttles from the `log.sources` config section
+    void initLogSources();
+
     /// Load the DI container with some core data and services
     void loadContainer();
 };
@@ -228,6 +234,8 @@ int Kernel<AppT>::init()
 
         // Load the configuration file, will consider the --config option from the CLI if present
         initConfig();
+        initLogModules();
+        initLogSources();
 
         // Bootstrap the service container with some base values & services
         loadContainer();
@@ -281,6 +289,7 @@ int Kernel<AppT>::run()
         // Control the order things shutdown
         app.get()->shutdown();
         di_t::getDiscoveryInterface()->shutdown();
+        log_sink->flush();
 
         return signalToExitCode(exitRequestStatus());
     });
@@ -302,13 +311,24 @@ void Kernel<AppT>::initSignalInterception()
     sigaddset(&signal_intercept, SIGTERM);
     sigaddset(&signal_intercept, SIGUSR1);
 
+    // SIGHUP asks us to reopen log files (eg, after logrotate), it does not shut down
+    sigaddset(&signal_intercept, SIGHUP);
+
     // Block the signals, we'll do a quick graceful shutdown when either are received
     pthread_sigmask(SIG_BLOCK, &signal_intercept, nullptr);
 
     signal_thread = std::thread([&, this]() {
         // The thread will sit and wait here until a signal is delivered
         int signum = 0;
-        sigwait(&signal_intercept, &signum);
+        for (;;) {
+            sigwait(&signal_intercept, &signum);
+            if (signum != SIGHUP) {
+                break;
+            }
+
+            BES_LOG(INFO) << "Hangup received, reopening log files";
+            log_sink->reopen();
+        }
 
         // Send log item
         if (signum == SIGINT) {
@@ -387,6 +407,62 @@ void Kernel<AppT>::initConfig()
     }
 }
 
+/**
+ * Modules listed under `log.modules` override the CLI verbosity, eg:
+ *
+ *      log:
+ *        modules:
+ *          fastcgi: WARNING
+ *          web: DEBUG
+ */
+template <class AppT>
+void Kernel<AppT>::initLogModules()
+{
+    auto modules = config.getOr<YAML::Node>(YAML::Node(), "log", "modules");
+    if (!modules.IsMap()) {
+        return;
+    }
+
+    for (auto const& it : modules) {
+        auto module = it.first.as<std::string>();
+        try {
+            log_sink->setModuleSeverity(module, bes::log::parseSeverity(it.second.as<std::string>()));
+            BES_LOG(DEBUG) << "Log severity for module <" << module << "> set to " << it.second.as<std::string>();
+        } catch (std::invalid_argument const& e) {
+            throw ManagedExitException(std::string("Invalid log config: ") + e.what(), ExitCode::CONFIG_ERR);
+        }
+    }
+}
+
+template <class AppT>
+void Kernel<AppT>::initLogSources()
+{
+    auto sources = config.getOr<YAML::Node>(YAML::Node(), "log", "sources");
+    if (!sources.IsMap()) {
+        return;
+    }
+
+    for (auto const& it : sources) {
+        auto source = it.first.as<std::string>();
+        bes::log::ThrottleConfig throttle;
+
+        try {
+            throttle.rate = it.second["rate"].as<double>(throttle.rate);
+            throttle.burst = it.second["burst"].as<unsigned>(throttle.burst);
+            throttle.dedup = it.second["dedup"].as<bool>(throttle.dedup);
+            throttle.repeat_report =
+                std::chrono::seconds(it.second["repeat_report"].as<long>(throttle.repeat_report.count()));
+        } catch (YAML::Exception const& e) {
+            throw ManagedExitException("Invalid log config for source <" + source + ">: " + e.what(),
+                                       ExitCode::CONFIG_ERR);
+        }
+
+        log_sink->setSourceThrottle(source, throttle);
+        BES_LOG(DEBUG) << "Log throttle for source <" << source << "> set to " << throttle.rate << "/s, burst "
+                       << throttle.burst;
+    }
+}
+
 template <class AppT>
 int Kernel<AppT>::executeKernelCli()
 {
@@ -1,5 +1,6 @@
 #include "parser.h"
 
+#include <cstring>
 #include <iostream>
 #include <utility>
 #include <vector>
@@ -5,5 +5,7 @@
 #include "core/exception.h"
 #include "core/file_finder.h"
 #include "core/model.h"
+#include "core/output_buffer.h"
 #include "core/threadpool.h"
+#include "core/timer_wheel.h"
 #include "core/util.h"
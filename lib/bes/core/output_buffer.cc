@@ -0,0 +1,152 @@
+#include "output_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace bes;
+
+void OutputBuffer::append(char const* data, std::size_t len)
+{
+    total += len;
+
+    while (len) {
+        if (slabs.empty() || slabs.back().used == slabs.back().capacity) {
+            // A large write gets a slab of its own size, rather than being cut into many
+            auto capacity = std::max(slab_size, len);
+            slabs.push_back(Slab{std::make_unique<char[]>(capacity), capacity, 0});
+        }
+
+        auto& slab = slabs.back();
+        auto n = std::min(len, slab.capacity - slab.used);
+        std::memcpy(slab.data.get() + slab.used, data, n);
+        slab.used += n;
+        data += n;
+        len -= n;
+    }
+}
+
+void OutputBuffer::append(std::string_view data)
+{
+    append(data.data(), data.size());
+}
+
+void OutputBuffer::append(char c)
+{
+    auto& slab = writable();
+    slab.data[slab.used++] = c;
+    ++total;
+}
+
+void OutputBuffer::append(std::shared_ptr<char const> data, std::size_t len)
+{
+    if (len == 0) {
+        return;
+    }
+
+    slabs.push_back(Slab{nullptr, len, len, std::move(data)});
+    total += len;
+}
+
+void OutputBuffer::append(OutputBuffer&& other)
+{
+    if (&other == this || other.total == 0) {
+        return;
+    }
+
+    // Small enough to fit in the space we have left - not worth a partly filled slab in the middle of the chain
+    if (!slabs.empty() && other.total <= slabs.back().capacity - slabs.back().used) {
+        other.forEach([this](char const* data, std::size_t len) {
+            append(data, len);
+        });
+    } else {
+        for (auto& slab : other.slabs) {
+            if (slab.used) {
+                slabs.push_back(std::move(slab));
+            }
+        }
+        total += other.total;
+    }
+
+    other.slabs.clear();
+    other.total = 0;
+}
+
+std::size_t OutputBuffer::size() const
+{
+    return total;
+}
+
+bool OutputBuffer::empty() const
+{
+    return total == 0;
+}
+
+void OutputBuffer::clear()
+{
+    if (slabs.size() > 1) {
+        slabs.erase(slabs.begin() + 1, slabs.end());
+    }
+
+    if (!slabs.empty()) {
+        if (slabs.front().shared) {
+            slabs.clear();
+        } else {
+            slabs.front().used = 0;
+        }
+    }
+
+    total = 0;
+}
+
+std::string OutputBuffer::str() const
+{
+    std::string out;
+    out.reserve(total);
+    forEach([&out](char const* data, std::size_t len) {
+        out.append(data, len);
+    });
+
+    return out;
+}
+
+OutputBuffer::Slab& OutputBuffer::writable()
+{
+    if (slabs.empty() || slabs.back().used == slabs.back().capacity) {
+        slabs.push_back(Slab{std::make_unique<char[]>(slab_size), slab_size, 0});
+    }
+
+    return slabs.back();
+}
+
+OutputStream::OutputStream(OutputBuffer& buffer) : std::ostream(nullptr), buf(buffer)
+{
+    rdbuf(&buf);
+}
+
+OutputBuffer& OutputStream::buffer()
+{
+    return buf.target;
+}
+
+OutputBuffer const& OutputStream::buffer() const
+{
+    return buf.target;
+}
+
+/**
+ * There is no put area: every write goes straight to the buffer, so it never holds bytes the buffer hasn't seen.
+ */
+OutputStream::Buf::int_type OutputStream::Buf::overflow(int_type c)
+{
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        target.append(traits_type::to_char_type(c));
+    }
+
+    return traits_type::not_eof(c);
+}
+
+std::streamsize OutputStream::Buf::xsputn(char const* s, std::streamsize n)
+{
+    target.append(s, static_cast<std::size_t>(n));
+    return n;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bes {
+
+/**
+ * An append-only byte buffer held as a chain of fixed-size slabs.
+ *
+ * Appending never moves what has already been written, so a response can be rendered into a buffer and handed on (to
+ * an HTTP response, then to the FastCGI writer) without its bytes being copied at each step: appending one buffer to
+ * another moves its slabs across rather than copying them. Readers walk the slabs in order with forEach(); str()
+ * gathers them into a single string for the few callers that need contiguous data. A slab may also refer to bytes
+ * owned by someone else, so a cached file can be sent from where it lies.
+ */
+class OutputBuffer
+{
+   public:
+    static constexpr std::size_t slab_size = 16 * 1024;
+
+    OutputBuffer() = default;
+    OutputBuffer(OutputBuffer&&) noexcept = default;
+    OutputBuffer& operator=(OutputBuffer&&) noexcept = default;
+    OutputBuffer(OutputBuffer const&) = delete;
+    OutputBuffer& operator=(OutputBuffer const&) = delete;
+
+    void append(char const* data, std::size_t len);
+    void append(std::string_view data);
+    void append(char c);
+
+    /**
+     * Append bytes held elsewhere, such as a memory-mapped file, without copying them. The buffer keeps `data` alive
+     * until it is cleared or destroyed.
+     */
+    void append(std::shared_ptr<char const> data, std::size_t len);
+
+    /**
+     * Move the contents of `other` onto the end of this buffer, leaving `other` empty. Its slabs are taken as they
+     * are, so the only bytes copied are those that fit in the space left in this buffer's last slab.
+     */
+    void append(OutputBuffer&& other);
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] bool empty() const;
+
+    /**
+     * Drop the contents, keeping one slab for reuse.
+     */
+    void clear();
+
+    /**
+     * Copy the contents into a single string.
+     */
+    [[nodiscard]] std::string str() const;
+
+    /**
+     * Call `fn(char const*, std::size_t)` for each non-empty run of bytes, in order.
+     */
+    template <class Fn>
+    void forEach(Fn&& fn) const;
+
+   private:
+    struct Slab
+    {
+        std::unique_ptr<char[]> data;
+        std::size_t capacity;
+        std::size_t used;
+
+        /// Set for a slab that refers to bytes it doesn't own; it is always full, so is never written to
+        std::shared_ptr<char const> shared = nullptr;
+
+        [[nodiscard]] char const* bytes() const
+        {
+            return shared ? shared.get() : data.get();
+        }
+    };
+
+    std::vector<Slab> slabs;
+    std::size_t total = 0;
+
+    Slab& writable();
+};
+
+/**
+ * A std::ostream that writes into an OutputBuffer, so anything that renders to a stream can render straight into one.
+ */
+class OutputStream : public std::ostream
+{
+   public:
+    explicit OutputStream(OutputBuffer& buffer);
+
+    OutputBuffer& buffer();
+    OutputBuffer const& buffer() const;
+
+   private:
+    class Buf : public std::streambuf
+    {
+       public:
+        explicit Buf(OutputBuffer& target) : target(target) {}
+        OutputBuffer& target;
+
+       protected:
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(char const* s, std::streamsize n) override;
+    };
+
+    Buf buf;
+};
+
+template <class Fn>
+inline void OutputBuffer::forEach(Fn&& fn) const
+{
+    for (auto const& slab : slabs) {
+        if (slab.used) {
+            fn(slab.bytes(), slab.used);
+        }
+    }
+}
+
+}  // namespace bes
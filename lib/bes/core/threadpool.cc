@@ -30,9 +30,12 @@ void ThreadPool::addThreads(threadsize_t n)
                 std::function<void()> task;
 
                 {
-                    // Wait for work to be added to the queue
+                    // Wait for work to be added to the queue, the predicate guards against both spurious wake-ups and
+                    // tasks that were queued while every worker was busy
                     std::unique_lock<std::mutex> lock(queue_mutex);
-                    condition.wait(lock);
+                    condition.wait(lock, [this] {
+                        return stop.load() || !tasks.empty();
+                    });
 
                     // Exit if we've no work to do
                     if (stop.load()) {
@@ -60,16 +60,16 @@ auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::inv
 {
     using return_type = typename std::invoke_result<F, Args...>::type;
 
+    // don't allow enqueueing after stopping the pool, checked before we take ownership of the callable
+    if (stop.load()) {
+        throw std::runtime_error("Enqueue on stopped ThreadPool");
+    }
+
     auto task =
         std::make_shared<std::packaged_task<return_type()>>(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
 
     std::future<return_type> res = task->get_future();
     {
-        // don't allow enqueueing after stopping the pool
-        if (stop.load()) {
-            throw std::runtime_error("Enqueue on stopped ThreadPool");
-        }
-
         std::unique_lock<std::mutex> lock(queue_mutex);
         ++backlog_size;
         tasks.emplace([task]() {
@@ -0,0 +1,369 @@
+#include "timer_wheel.h"
+
+#include <bes/log.h>
+
+#include <algorithm>
+
+using namespace bes;
+
+TimerWheel::TimerWheel(std::shared_ptr<ThreadPool> pool, Clock now)
+    : pool(std::move(pool)), clock_fn(std::move(now)), epoch(this->now())
+{
+    for (auto& level : wheel) {
+        level.fill(nil);
+    }
+
+    // A wheel with its own clock is advanced by poll()
+    if (clock_fn == nullptr) {
+        driver = std::thread([this] {
+            driverLoop();
+        });
+    }
+}
+
+TimerWheel::~TimerWheel()
+{
+    shutdown();
+}
+
+void TimerWheel::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop.store(true);
+    }
+
+    condition.notify_all();
+
+    if (driver.joinable()) {
+        driver.join();
+    }
+}
+
+timer_id_t TimerWheel::schedule(std::chrono::milliseconds delay, Callback cb)
+{
+    return scheduleAt(now() + delay, std::move(cb));
+}
+
+timer_id_t TimerWheel::scheduleAt(clock::time_point when, Callback cb)
+{
+    if (stop.load()) {
+        return invalid_timer;
+    }
+
+    auto tick = toTick(when);
+    bool notify;
+    timer_id_t id;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // The driver doesn't tick an empty wheel, bring it up to date before placing the timer against it
+        if (count == 0) {
+            current = std::max(current, elapsed());
+        }
+
+        auto idx = allocateNode();
+        Node& node = nodes[idx];
+        node.expiry = tick < current ? current : tick;
+        node.callback = std::move(cb);
+        link(idx);
+        ++count;
+
+        id = (static_cast<timer_id_t>(node.generation) << 32) | idx;
+
+        // Only wake the driver if this timer expires before it was planning to wake
+        notify = node.expiry < planned_wake;
+    }
+
+    if (notify) {
+        condition.notify_one();
+    }
+
+    return id;
+}
+
+bool TimerWheel::cancel(timer_id_t id)
+{
+    auto idx = static_cast<std::uint32_t>(id & UINT32_MAX);
+    auto generation = static_cast<std::uint32_t>(id >> 32);
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (idx >= nodes.size() || !nodes[idx].active || nodes[idx].generation != generation) {
+        return false;
+    }
+
+    unlink(idx);
+    releaseNode(idx);
+    --count;
+
+    return true;
+}
+
+size_t TimerWheel::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return count;
+}
+
+void TimerWheel::poll()
+{
+    std::vector<Callback> due;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stop.load()) {
+            return;
+        }
+
+        collect(due);
+    }
+
+    dispatch(due);
+}
+
+TimerWheel::clock::time_point TimerWheel::now() const
+{
+    return clock_fn == nullptr ? clock::now() : clock_fn();
+}
+
+std::uint64_t TimerWheel::elapsed() const
+{
+    auto tp = now();
+    if (tp <= epoch) {
+        return 0;
+    }
+
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(tp - epoch).count());
+}
+
+std::uint64_t TimerWheel::toTick(clock::time_point tp) const
+{
+    if (tp <= epoch) {
+        return 0;
+    }
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(tp - epoch).count();
+    return static_cast<std::uint64_t>((us + 999) / 1000);
+}
+
+std::uint32_t TimerWheel::allocateNode()
+{
+    if (free_head == nil) {
+        if (nodes.size() >= nil) {
+            throw std::runtime_error("Timer wheel capacity exceeded");
+        }
+
+        nodes.emplace_back();
+        free_head = static_cast<std::uint32_t>(nodes.size() - 1);
+    }
+
+    auto idx = free_head;
+    free_head = nodes[idx].next;
+    nodes[idx].next = nil;
+    nodes[idx].active = true;
+
+    return idx;
+}
+
+void TimerWheel::releaseNode(std::uint32_t idx)
+{
+    Node& node = nodes[idx];
+    node.callback = nullptr;
+    node.active = false;
+    node.prev = nil;
+    node.next = free_head;
+
+    // Bumping the generation invalidates any outstanding timer IDs for this node
+    if (++node.generation == 0) {
+        node.generation = 1;
+    }
+
+    free_head = idx;
+}
+
+/**
+ * Place a node in the correct wheel according to its distance from the current tick.
+ */
+void TimerWheel::link(std::uint32_t idx)
+{
+    Node& node = nodes[idx];
+    std::uint64_t delta = node.expiry - current;
+
+    // Timers beyond the range of the top wheel are parked at its furthest slot and re-cascaded when reached
+    std::uint64_t expiry = delta > max_delta ? current + max_delta : node.expiry;
+
+    unsigned level = 0;
+    while (level < levels - 1 && delta >= (std::uint64_t(1) << (level_bits * (level + 1)))) {
+        ++level;
+    }
+
+    auto slot = static_cast<std::uint32_t>((expiry >> (level_bits * level)) & slot_mask);
+    auto& head = wheel[level][slot];
+
+    node.slot = static_cast<std::uint16_t>(level * slots + slot);
+    node.prev = nil;
+    node.next = head;
+    if (head != nil) {
+        nodes[head].prev = idx;
+    }
+    head = idx;
+
+    if (level == 0) {
+        occupied[slot / 64] |= std::uint64_t(1) << (slot % 64);
+    }
+}
+
+void TimerWheel::unlink(std::uint32_t idx)
+{
+    Node& node = nodes[idx];
+    unsigned level = node.slot / slots;
+    std::uint32_t slot = node.slot % slots;
+
+    if (node.prev != nil) {
+        nodes[node.prev].next = node.next;
+    } else {
+        wheel[level][slot] = node.next;
+    }
+
+    if (node.next != nil) {
+        nodes[node.next].prev = node.prev;
+    }
+
+    if (level == 0 && wheel[0][slot] == nil) {
+        occupied[slot / 64] &= ~(std::uint64_t(1) << (slot % 64));
+    }
+
+    node.prev = nil;
+    node.next = nil;
+}
+
+std::uint32_t TimerWheel::cascade(unsigned level)
+{
+    auto slot = static_cast<std::uint32_t>((current >> (level_bits * level)) & slot_mask);
+    auto idx = wheel[level][slot];
+    wheel[level][slot] = nil;
+
+    while (idx != nil) {
+        auto next = nodes[idx].next;
+        link(idx);
+        idx = next;
+    }
+
+    return slot;
+}
+
+void TimerWheel::advance(std::vector<Callback>& due)
+{
+    auto slot = static_cast<std::uint32_t>(current & slot_mask);
+
+    // Each time a wheel completes a rotation, pull the next slot of the wheel above it down
+    if (slot == 0) {
+        for (unsigned level = 1; level < levels; ++level) {
+            if (cascade(level) != 0) {
+                break;
+            }
+        }
+    }
+
+    auto idx = wheel[0][slot];
+    wheel[0][slot] = nil;
+    occupied[slot / 64] &= ~(std::uint64_t(1) << (slot % 64));
+
+    while (idx != nil) {
+        auto next = nodes[idx].next;
+        due.push_back(std::move(nodes[idx].callback));
+        releaseNode(idx);
+        --count;
+        idx = next;
+    }
+
+    ++current;
+}
+
+void TimerWheel::collect(std::vector<Callback>& due)
+{
+    auto until = elapsed();
+
+    while (current <= until) {
+        // Nothing left to fire, so there's nothing to tick through either
+        if (count == 0) {
+            current = until + 1;
+            break;
+        }
+
+        advance(due);
+    }
+}
+
+std::uint64_t TimerWheel::nextWakeTick() const
+{
+    if (count == 0) {
+        return UINT64_MAX;
+    }
+
+    // Search the remainder of the innermost wheel's rotation for an occupied slot
+    auto slot = static_cast<std::uint32_t>(current & slot_mask);
+    for (auto word = slot / 64; word < occupied.size(); ++word) {
+        std::uint64_t bits = occupied[word];
+        if (word == slot / 64) {
+            bits &= ~std::uint64_t(0) << (slot % 64);
+        }
+
+        if (bits) {
+            return current + (word * 64 + __builtin_ctzll(bits)) - slot;
+        }
+    }
+
+    // Nothing left this rotation, wake at the next cascade
+    return current + (slots - slot);
+}
+
+void TimerWheel::dispatch(std::vector<Callback>& due)
+{
+    for (auto& cb : due) {
+        if (pool != nullptr) {
+            try {
+                pool->enqueue(std::move(cb));
+                continue;
+            } catch (std::exception const& e) {
+                // Pool is shutting down, run the callback here rather than silently lose it
+                BES_LOG(WARNING) << "Timer dispatch failed, running on driver thread: " << e.what();
+            }
+        }
+
+        try {
+            cb();
+        } catch (std::exception const& e) {
+            BES_LOG(ERROR) << "Uncaught exception in timer callback: " << e.what();
+        }
+    }
+
+    due.clear();
+}
+
+void TimerWheel::driverLoop()
+{
+    std::vector<Callback> due;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stop.load()) {
+        collect(due);
+
+        if (!due.empty()) {
+            planned_wake = current;
+            lock.unlock();
+            dispatch(due);
+            lock.lock();
+            continue;
+        }
+
+        planned_wake = nextWakeTick();
+        if (planned_wake == UINT64_MAX) {
+            condition.wait(lock);
+        } else {
+            condition.wait_until(lock, epoch + std::chrono::milliseconds(planned_wake));
+        }
+    }
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "threadpool.h"
+
+namespace bes {
+
+using timer_id_t = std::uint64_t;
+
+/**
+ * Hierarchical timer wheel with millisecond resolution.
+ *
+ * Timers are held in four cascading wheels of 256 slots each, giving O(1) schedule and cancel operations and a range of
+ * ~49 days before a timer needs to be re-cascaded. Timer nodes are pooled and linked by index, so millions of
+ * outstanding timers cost a single allocation per pool growth rather than one per timer.
+ *
+ * A single driver thread advances the wheel. Expired callbacks are dispatched onto the supplied ThreadPool, or run on
+ * the driver thread if no pool was provided (keep those callbacks trivial).
+ *
+ * A wheel may instead be given its own clock, in which case it has no driver thread and time only moves when poll() is
+ * called. This lets tests step through time rather than sleep through it.
+ *
+ * All public functions are thread-safe, and may be called from within a timer callback.
+ */
+class TimerWheel
+{
+   public:
+    using Callback = std::function<void()>;
+    using clock = std::chrono::steady_clock;
+    using Clock = std::function<clock::time_point()>;
+
+    /// Returned when a timer could not be scheduled; never a valid timer ID
+    static constexpr timer_id_t invalid_timer = 0;
+
+    explicit TimerWheel(std::shared_ptr<ThreadPool> pool = nullptr, Clock now = nullptr);
+    TimerWheel(TimerWheel const&) = delete;
+    TimerWheel& operator=(TimerWheel const&) = delete;
+    virtual ~TimerWheel();
+
+    /**
+     * Run `cb` once `delay` has elapsed. Returns an ID that may be used to cancel the timer.
+     */
+    timer_id_t schedule(std::chrono::milliseconds delay, Callback cb);
+
+    /**
+     * Run `cb` at (or as soon as possible after) `when`.
+     */
+    timer_id_t scheduleAt(clock::time_point when, Callback cb);
+
+    /**
+     * Cancel a pending timer.
+     *
+     * Returns false if the timer has already fired, was already cancelled or never existed.
+     */
+    bool cancel(timer_id_t id);
+
+    /**
+     * Number of timers waiting to expire.
+     */
+    [[nodiscard]] size_t size() const;
+
+    /**
+     * Run every timer that is due by the wheel's clock. Only needed for a wheel given its own clock.
+     */
+    void poll();
+
+    /**
+     * Stop the driver thread. Pending timers are discarded without being run.
+     */
+    void shutdown();
+
+   protected:
+    static constexpr unsigned level_bits = 8;
+    static constexpr unsigned levels = 4;
+    static constexpr std::uint32_t slots = 1u << level_bits;
+    static constexpr std::uint32_t slot_mask = slots - 1;
+    static constexpr std::uint32_t nil = UINT32_MAX;
+    static constexpr std::uint64_t max_delta = (std::uint64_t(1) << (level_bits * levels)) - 1;
+
+    struct Node
+    {
+        std::uint64_t expiry = 0;
+        std::uint32_t prev = nil;
+        std::uint32_t next = nil;
+        std::uint32_t generation = 1;
+        std::uint16_t slot = 0;
+        bool active = false;
+        Callback callback;
+    };
+
+    [[nodiscard]] clock::time_point now() const;
+
+    /// Ticks elapsed since the wheel was created, rounded down so that nothing fires ahead of its deadline
+    [[nodiscard]] std::uint64_t elapsed() const;
+
+    /// Convert a time-point to a tick (milliseconds since the wheel was created), rounding up
+    [[nodiscard]] std::uint64_t toTick(clock::time_point tp) const;
+
+    std::uint32_t allocateNode();
+    void releaseNode(std::uint32_t idx);
+
+    void link(std::uint32_t idx);
+    void unlink(std::uint32_t idx);
+
+    /// Re-insert all nodes held in a slot of a higher wheel, returning the slot index
+    std::uint32_t cascade(unsigned level);
+
+    /// Process a single tick, moving expired callbacks into `due`
+    void advance(std::vector<Callback>& due);
+
+    /// Process every tick up to the present, skipping straight over any stretch in which the wheel is empty
+    void collect(std::vector<Callback>& due);
+
+    /// Tick the driver should next wake on, or UINT64_MAX if there is nothing to do
+    [[nodiscard]] std::uint64_t nextWakeTick() const;
+
+    void dispatch(std::vector<Callback>& due);
+    void driverLoop();
+
+    std::shared_ptr<ThreadPool> pool;
+    Clock clock_fn;
+    clock::time_point epoch;
+
+    std::vector<Node> nodes;
+    std::uint32_t free_head = nil;
+    std::array<std::array<std::uint32_t, slots>, levels> wheel;
+    std::array<std::uint64_t, slots / 64> occupied{};
+
+    // Next tick to be processed by the driver
+    std::uint64_t current = 0;
+    std::uint64_t planned_wake = UINT64_MAX;
+    size_t count = 0;
+
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<bool> stop{false};
+    std::thread driver;
+};
+
+}  // namespace bes
@@ -1,5 +1,8 @@
 #include "connection.h"
 
+#include <algorithm>
+#include <mutex>
+
 #include "bes/dbal/exception.h"
 
 using namespace bes::dbal::wide::cassandra;
@@ -7,9 +10,21 @@ using namespace bes::dbal::wide::cassandra;
 Connection::Connection(Context const& ctx, bool own_logging)
 {
     if (own_logging) {
-        // Pipe the Cassandra driver logging into the Bes logger
-        cass_log_set_level(CASS_LOG_TRACE);
+        // Pipe the Cassandra driver logging into the Bes logger, following our levels as they change
+        static std::once_flag listening;
+        std::call_once(listening, [] {
+            bes::log::LogSink::onThresholdChange(&Connection::syncDriverLogLevel);
+        });
+
+        syncDriverLogLevel();
         cass_log_set_callback(Connection::driverLog, this->log_data);
+
+        if (bes::log::LogSink::hasInstance() && !bes::log::LogSink::instance().hasSourceThrottle(LOG_SOURCE)) {
+            bes::log::ThrottleConfig throttle;
+            throttle.rate = 20;
+            throttle.burst = 50;
+            bes::log::LogSink::instance().setSourceThrottle(LOG_SOURCE, throttle);
+        }
     }
 
     try {
@@ -67,7 +82,45 @@ bool Connection::isConnected() const
 
 void Connection::driverLog(CassLogMessage const* message, void* data)
 {
-    BES_LOG_LVL(Connection::cassToBesSeverity(message->severity)) << "CASS: " << message->message;
+    BES_LOG_SOURCE_LVL(Connection::cassToBesSeverity(message->severity), LOG_SOURCE) << "CASS: " << message->message;
+}
+
+void Connection::syncDriverLogLevel()
+{
+    // Until there's a sink the driver's messages go nowhere either way, so leave the driver at its own default rather
+    // than silence it for good if nothing syncs it later
+    if (!bes::log::LogSink::hasInstance()) {
+        cass_log_set_level(CASS_LOG_WARN);
+        return;
+    }
+
+    // Statements below the compile-time floor don't exist, regardless of the runtime threshold
+    auto threshold = std::max(bes::log::LogSink::moduleThreshold(BES_LOG_MODULE).load(), BES_LOG_MIN_SEVERITY);
+    cass_log_set_level(besToCassSeverity(threshold));
+}
+
+/**
+ * Most verbose driver level that still passes the given Bes threshold.
+ */
+CassLogLevel Connection::besToCassSeverity(int threshold)
+{
+    using bes::log::Severity;
+
+    if (threshold <= static_cast<int>(Severity::TRACE)) {
+        return CASS_LOG_TRACE;
+    } else if (threshold <= static_cast<int>(Severity::DEBUG)) {
+        return CASS_LOG_DEBUG;
+    } else if (threshold <= static_cast<int>(Severity::INFO)) {
+        return CASS_LOG_INFO;
+    } else if (threshold <= static_cast<int>(Severity::WARNING)) {
+        return CASS_LOG_WARN;
+    } else if (threshold <= static_cast<int>(Severity::ERROR)) {
+        return CASS_LOG_ERROR;
+    } else if (threshold <= static_cast<int>(Severity::CRITICAL)) {
+        return CASS_LOG_CRITICAL;
+    } else {
+        return CASS_LOG_DISABLED;
+    }
 }
 
 bes::log::Severity Connection::cassToBesSeverity(CassLogLevel s)
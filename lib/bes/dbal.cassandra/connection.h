@@ -17,7 +17,8 @@ class Connection
      * Create a new DB connection.
      *
      * By default, the Cassandra driver dumps to the console indiscriminately. If you opt to `own_logging`, we'll pipe
-     * this into the Bes log system instead.
+     * this into the Bes log system instead, under the "cassandra" log source. Unless the log sink already has a
+     * throttle for that source, a default one is applied so that a flapping cluster can't flood the log.
      */
     explicit Connection(Context const& ctx, bool own_logging = true);
 
@@ -28,6 +29,17 @@ class Connection
     static void driverLog(CassLogMessage const* message, void* data);
     void* log_data = nullptr;
 
+    /**
+     * Set the driver's log level from the effective severity of the "dbal.cassandra" log module, so the driver doesn't
+     * build messages we'd discard. Without a log sink the driver is left at its default level (warnings).
+     *
+     * Called when a connection that owns logging is created, and from then on whenever log severities change.
+     */
+    static void syncDriverLogLevel();
+
+    /// Log source used for driver messages
+    static constexpr auto LOG_SOURCE = "cassandra";
+
    protected:
     std::string hosts;
     std::shared_ptr<CassFuture> connect_future;
@@ -37,6 +49,7 @@ class Connection
 
    private:
     static bes::log::Severity cassToBesSeverity(CassLogLevel);
+    static CassLogLevel besToCassSeverity(int threshold);
 };
 
 }  // namespace bes::dbal::wide::cassandra
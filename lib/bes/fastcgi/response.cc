@@ -16,15 +16,14 @@ bool Response::hasParam(std::string const& key) const
 
 void Response::flush(bool force)
 {
-    flushStream(model::RecordType::OUT, out, force && !out_sent);
-    flushStream(model::RecordType::ERR, err, force && !err_sent);
+    flushStream(model::RecordType::OUT, out_buffer, force && !out_sent);
+    flushStream(model::RecordType::ERR, err_buffer, force && !err_sent);
 }
 
-void Response::flushStream(model::RecordType rt, std::stringstream& str, bool force)
+void Response::flushStream(model::RecordType rt, bes::OutputBuffer& buffer, bool force)
 {
-    str.seekg(0, std::ios::end);
-    if (str.tellg() || force) {
-        transceiver.writeStream(rt, str.str(), request.getRequestId());
+    if (!buffer.empty() || force) {
+        transceiver.writeStream(rt, buffer, request.getRequestId());
 
         if (rt == model::RecordType::OUT) {
             out_sent = true;
@@ -33,5 +32,5 @@ void Response::flushStream(model::RecordType rt, std::stringstream& str, bool fo
         }
     }
 
-    str.str(std::string());
-}
\ No newline at end of file
+    buffer.clear();
+}
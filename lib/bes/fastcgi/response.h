@@ -1,5 +1,6 @@
 #pragma once
 
+#include <bes/core.h>
 #include <bes/log.h>
 #include <bes/net.h>
 
@@ -32,14 +33,17 @@ class Response
     Request const& request;
     Transceiver& transceiver;
 
-    std::stringstream out;
-    std::stringstream err;
+    /// Output is written straight into these buffers, which are sent to the server without being copied again
+    bes::OutputBuffer out_buffer;
+    bes::OutputBuffer err_buffer;
+    bes::OutputStream out{out_buffer};
+    bes::OutputStream err{err_buffer};
 
     bool out_sent = false;
     bool err_sent = false;
 
    private:
-    void flushStream(model::RecordType rt, std::stringstream& str, bool force = false);
+    void flushStream(model::RecordType rt, bes::OutputBuffer& buffer, bool force = false);
 };
 
 }  // namespace bes::fastcgi
@@ -1,5 +1,7 @@
 #include "transceiver.h"
 
+#include <algorithm>
+
 using namespace bes::fastcgi;
 
 Transceiver::Transceiver(bes::net::socket::Stream& socket) : socket(socket) {}
@@ -20,42 +22,85 @@ std::string Transceiver::readStream(model::Header const& header)
 void Transceiver::writeStream(model::RecordType rt, std::string const& data, int16_t request_id)
 {
     size_t written = 0;
-    size_t payload_size = data.length();
-    char const* buffer = data.c_str();
 
     do {
-        size_t seg_size = data.length() - written;
-        if (seg_size > 64000) {
-            seg_size = 64000;
-        }
+        size_t seg_size = std::min(data.length() - written, max_record_size);
+        writeRecord(rt, data.c_str() + written, seg_size, request_id);
+        written += seg_size;
+    } while (written != data.length());
+}
 
-        // Create stream header
-        model::Header header{};
-        header.content_length = seg_size;
-        header.padding_length = seg_size % model::chunk_size ? model::chunk_size - (seg_size % model::chunk_size) : 0;
-        header.request_id = request_id;
-        header.version = model::fcgi_version;
-        header.type = rt;
-        header.reserved = '\0';
-
-        // Endian transform & send
-        writeModel(header);
-
-        // Send stream data
-        if (seg_size) {
-            socket.writeBytes(buffer + written, seg_size);
-        }
+/**
+ * Each run of the buffer is sent from where it lies, so the body isn't gathered into one string first. Runs are
+ * gathered into records as large as a record may be, each sent with its header and padding in a single write.
+ */
+void Transceiver::writeStream(model::RecordType rt, bes::OutputBuffer const& data, int16_t request_id)
+{
+    if (data.empty()) {
+        writeRecord(rt, nullptr, 0, request_id);
+        return;
+    }
 
-        // Send padding data (NB: we can only still use padding_length because it's 8-bit)
-        if (header.padding_length) {
-            char pad[header.padding_length];
-            std::memset(pad, '\0', header.padding_length);
-            socket.writeBytes(pad, header.padding_length);
+    record.resize(1);
+    size_t len = 0;
+
+    data.forEach([&](char const* run, size_t run_len) {
+        while (run_len) {
+            size_t seg_size = std::min(run_len, max_record_size - len);
+            record.push_back(iovec{const_cast<char*>(run), seg_size});
+            len += seg_size;
+            run += seg_size;
+            run_len -= seg_size;
+
+            if (len == max_record_size) {
+                sendRecord(rt, len, request_id);
+                record.resize(1);
+                len = 0;
+            }
         }
+    });
 
-        written += seg_size;
+    if (len) {
+        sendRecord(rt, len, request_id);
+    }
+}
+
+void Transceiver::writeRecord(model::RecordType rt, char const* data, size_t len, int16_t request_id)
+{
+    record.resize(1);
+    if (len) {
+        record.push_back(iovec{const_cast<char*>(data), len});
+    }
+
+    sendRecord(rt, len, request_id);
+}
+
+/**
+ * Send the record gathered in `record`, `len` bytes of payload, filling in its header slot and adding its padding.
+ */
+void Transceiver::sendRecord(model::RecordType rt, size_t len, int16_t request_id)
+{
+    static constexpr char padding[model::chunk_size] = {};
+
+    // Create stream header
+    model::Header header{};
+    header.content_length = len;
+    header.padding_length = len % model::chunk_size ? model::chunk_size - (len % model::chunk_size) : 0;
+    header.request_id = request_id;
+    header.version = model::fcgi_version;
+    header.type = rt;
+    header.reserved = '\0';
+
+    // Endian transform
+    endian<model::Header>(header, true);
+    record.front() = iovec{&header, sizeof(header)};
+
+    // Padding (NB: we can only still use padding_length because it's 8-bit)
+    if (header.padding_length) {
+        record.push_back(iovec{const_cast<char*>(padding), header.padding_length});
+    }
 
-    } while (written != payload_size);
+    socket.writeVector(record.data(), record.size());
 }
 
 /**
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <bes/core.h>
 #include <bes/log.h>
 #include <bes/net.h>
 
 #include <cstring>
+#include <vector>
 
 #include "memory.tcc"
 #include "model.h"
@@ -24,6 +26,7 @@ class Transceiver
     std::string readStream(model::Header const& header);
 
     void writeStream(model::RecordType, std::string const& data, int16_t request_id);
+    void writeStream(model::RecordType, bes::OutputBuffer const& data, int16_t request_id);
 
     /**
      * Send an EndRequest to the server.
@@ -51,6 +54,16 @@ class Transceiver
 
    protected:
     bes::net::socket::Stream& socket;
+
+   private:
+    /// Largest payload sent in a single stream record
+    static constexpr size_t max_record_size = 64000;
+
+    /// The record being gathered: a slot for its header, then runs of its payload
+    std::vector<iovec> record;
+
+    void writeRecord(model::RecordType rt, char const* data, size_t len, int16_t request_id);
+    void sendRecord(model::RecordType rt, size_t len, int16_t request_id);
 };
 
 template <class T>
@@ -1,7 +1,13 @@
 #pragma once
 
+#include "log/backend/asynclogbackend.h"
+#include "log/backend/binarylogbackend.h"
 #include "log/backend/consolelogbackend.h"
+#include "log/backend/filelogbackend.h"
+#include "log/binary/logf.h"
+#include "log/binary/reader.h"
 #include "log/logger.h"
 #include "log/logsink.h"
 #include "log/model.h"
+#include "log/throttle.h"
 #include "log/colour.h"
@@ -0,0 +1,217 @@
+#include "asynclogbackend.h"
+
+#include <iostream>
+#include <stdexcept>
+
+using namespace bes::log::backend;
+
+AsyncLogBackend::AsyncLogBackend(std::shared_ptr<LogBackend> target, OverflowPolicy policy, std::size_t capacity)
+    : target(std::move(target)), policy(policy), ring(capacity)
+{
+    if (this->target == nullptr) {
+        throw std::invalid_argument("AsyncLogBackend requires a target backend");
+    }
+
+    writer = std::thread([this] {
+        writerLoop();
+    });
+}
+
+AsyncLogBackend::~AsyncLogBackend()
+{
+    shutdown();
+}
+
+void AsyncLogBackend::process(LogRecord const& log_record)
+{
+    if (stop.load()) {
+        target->process(log_record);
+        return;
+    }
+
+    LogRecord record(log_record);
+
+    if (ring.tryPush(std::move(record))) {
+        ++accepted;
+        wakeWriter();
+        return;
+    }
+
+    switch (policy) {
+        case OverflowPolicy::BLOCK: {
+            unsigned attempts = 0;
+            do {
+                wakeWriter();
+
+                if (stop.load()) {
+                    target->process(record);
+                    return;
+                }
+
+                // Give the writer a moment before resorting to sleeping
+                if (++attempts < 64) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            } while (!ring.tryPush(std::move(record)));
+
+            ++accepted;
+            return;
+        }
+        case OverflowPolicy::DROP_WITH_COUNT:
+            ++dropped_unreported;
+            [[fallthrough]];
+        case OverflowPolicy::DROP:
+            ++dropped_total;
+            return;
+    }
+}
+
+void AsyncLogBackend::flush()
+{
+    if (stop.load()) {
+        target->flush();
+        return;
+    }
+
+    auto goal = accepted.load();
+
+    ++flush_waiters;
+    wakeWriter();
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        flushed_cv.wait(lock, [this, goal] {
+            return flushed.load() >= goal || writer_done;
+        });
+    }
+
+    --flush_waiters;
+}
+
+void AsyncLogBackend::reopen()
+{
+    target->reopen();
+}
+
+void AsyncLogBackend::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop.store(true);
+    }
+
+    wake_cv.notify_one();
+
+    if (writer.joinable()) {
+        writer.join();
+    }
+
+    // Catch anything pushed by a producer that raced with the writer exiting
+    LogRecord record;
+    while (ring.tryPop(record)) {
+        target->process(record);
+    }
+
+    target->flush();
+}
+
+std::uint64_t AsyncLogBackend::dropped() const
+{
+    return dropped_total.load();
+}
+
+void AsyncLogBackend::wakeWriter()
+{
+    // Pairs with the fence in writerLoop(), either we see the writer sleeping or it sees our record
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (sleeping.load(std::memory_order_relaxed) && sleeping.exchange(false)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wake_cv.notify_one();
+    }
+}
+
+void AsyncLogBackend::writerLoop()
+{
+    std::vector<LogRecord> batch;
+    batch.reserve(max_batch + 1);
+    LogRecord record;
+
+    for (;;) {
+        while (batch.size() < max_batch && ring.tryPop(record)) {
+            batch.push_back(std::move(record));
+        }
+
+        if (!batch.empty()) {
+            writeBatch(batch);
+            continue;
+        }
+
+        if (stop.load()) {
+            break;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // The timeout is only a safety net, producers wake us when they push a record
+        if (ring.empty() && !stop.load()) {
+            wake_cv.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                return !sleeping.load() || stop.load();
+            });
+        }
+
+        sleeping.store(false);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        writer_done = true;
+    }
+
+    flushed_cv.notify_all();
+}
+
+void AsyncLogBackend::writeBatch(std::vector<LogRecord>& batch)
+{
+    auto count = batch.size();
+
+    auto lost = dropped_unreported.exchange(0);
+    if (lost > 0) {
+        LogRecord warning;
+        warning.severity = Severity::WARNING;
+        warning.function = __func__;
+        warning.filename = __FILE__;
+        warning.lineno = __LINE__;
+        warning.timestamp = std::chrono::system_clock::now();
+        warning.message = "Log buffer overflow, " + std::to_string(lost) + " log records dropped";
+        batch.push_back(std::move(warning));
+    }
+
+    written += count;
+
+    // Backend failures can't be logged, fall back to stderr so they aren't silent
+    try {
+        target->processBatch(batch);
+
+        if (ring.empty() || flush_waiters.load() > 0) {
+            target->flush();
+            flushed.store(written.load());
+        }
+    } catch (std::exception const& e) {
+        std::cerr << "Async log backend failed to write " << batch.size() << " records: " << e.what() << std::endl;
+        flushed.store(written.load());
+    }
+
+    batch.clear();
+
+    if (flush_waiters.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        flushed_cv.notify_all();
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../model.h"
+#include "../ring_buffer.h"
+
+namespace bes::log::backend {
+
+/**
+ * Action taken when a record is logged while the ring buffer is full.
+ */
+enum class OverflowPolicy
+{
+    // Caller waits until the writer frees space; nothing is lost, but logging can stall the request path
+    BLOCK,
+
+    // Record is discarded
+    DROP,
+
+    // Record is discarded, and the writer logs a warning with the number of records lost
+    DROP_WITH_COUNT,
+};
+
+/**
+ * Moves the cost of formatting and writing log records off the calling thread.
+ *
+ * Records are copied into a bounded lock-free ring, a dedicated writer thread drains the ring in batches and hands each
+ * batch to the wrapped backend via `processBatch()`. Use it as a decorator around any other backend:
+ *
+ *      log_sink.addBackend<AsyncLogBackend>(std::make_shared<ConsoleLogBackend>(LogFormat::STANDARD));
+ *
+ * Destroying the backend (such as when the LogSink is destroyed) will write all pending records before returning.
+ */
+class AsyncLogBackend : public LogBackend
+{
+   public:
+    explicit AsyncLogBackend(std::shared_ptr<LogBackend> target,
+                             OverflowPolicy policy = OverflowPolicy::DROP_WITH_COUNT, std::size_t capacity = 8192);
+    ~AsyncLogBackend() override;
+
+    AsyncLogBackend(AsyncLogBackend const&) = delete;
+    AsyncLogBackend& operator=(AsyncLogBackend const&) = delete;
+
+    void process(LogRecord const& log_record) override;
+
+    /**
+     * Block until every record accepted before this call has been written by the target backend.
+     */
+    void flush() override;
+
+    void reopen() override;
+
+    /**
+     * Drain the ring and stop the writer thread. Records logged afterwards are written synchronously.
+     */
+    void shutdown();
+
+    /**
+     * Total number of records discarded due to a full ring.
+     */
+    [[nodiscard]] std::uint64_t dropped() const;
+
+    /**
+     * Maximum number of records handed to the target backend in a single batch.
+     */
+    static constexpr std::size_t max_batch = 512;
+
+   private:
+    std::shared_ptr<LogBackend> target;
+    OverflowPolicy policy;
+    RingBuffer<LogRecord> ring;
+
+    std::atomic<std::uint64_t> accepted{0};
+    std::atomic<std::uint64_t> written{0};
+    std::atomic<std::uint64_t> flushed{0};
+    std::atomic<std::uint64_t> dropped_total{0};
+    std::atomic<std::uint64_t> dropped_unreported{0};
+
+    std::mutex mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable flushed_cv;
+    std::atomic<int> flush_waiters{0};
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> stop{false};
+    bool writer_done = false;
+
+    std::thread writer;
+
+    void wakeWriter();
+    void writerLoop();
+    void writeBatch(std::vector<LogRecord>& batch);
+};
+
+}  // namespace bes::log::backend
@@ -0,0 +1,408 @@
+#include "binarylogbackend.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+using namespace bes::log::backend;
+using bes::log::binary::EntryType;
+using bes::log::binary::ThreadBuffer;
+
+std::atomic<BinaryLogBackend*> BinaryLogBackend::current{nullptr};
+std::atomic<int> BinaryLogBackend::holds{0};
+std::atomic<std::uint64_t> BinaryLogBackend::generations{0};
+
+namespace {
+
+template <class T>
+void append(std::string& out, T value)
+{
+    out.append(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+void appendString(std::string& out, char const* str)
+{
+    auto len = static_cast<std::uint32_t>(std::strlen(str));
+    append(out, len);
+    out.append(str, len);
+}
+
+/**
+ * Format ID for a standard record. Each thread keeps the IDs of the call sites it has logged from, keyed on the address
+ * of the statement's file name and its line, so only a site's first record on a thread goes to the format registry.
+ */
+std::uint32_t recordFormatId(bes::log::LogRecord const& log_record)
+{
+    if (log_record.site == nullptr) {
+        return bes::log::binary::recordFormat(log_record).id;
+    }
+
+    struct Site
+    {
+        char const* file;
+        int lineno;
+        bes::log::Severity severity;
+
+        bool operator==(Site const& other) const
+        {
+            return file == other.file && lineno == other.lineno && severity == other.severity;
+        }
+    };
+
+    struct SiteHash
+    {
+        std::size_t operator()(Site const& site) const
+        {
+            return std::hash<void const*>()(site.file) ^ (static_cast<std::size_t>(site.lineno) << 4) ^
+                   static_cast<std::size_t>(site.severity);
+        }
+    };
+
+    thread_local std::unordered_map<Site, std::uint32_t, SiteHash> sites;
+
+    Site site{log_record.site, log_record.lineno, log_record.severity};
+    auto it = sites.find(site);
+    if (it == sites.end()) {
+        it = sites.emplace(site, bes::log::binary::recordFormat(log_record).id).first;
+    }
+
+    return it->second;
+}
+
+}  // namespace
+
+BinaryLogBackend::BinaryLogBackend(std::string path, std::size_t thread_buffer_size)
+    : path(std::move(path)), thread_buffer_size(thread_buffer_size)
+{
+    BinaryLogBackend* expected = nullptr;
+    if (!current.compare_exchange_strong(expected, this)) {
+        throw std::runtime_error("Only one BinaryLogBackend may exist at a time");
+    }
+
+    openFile();
+    if (fd < 0) {
+        current.store(nullptr);
+        throw std::runtime_error("Unable to open binary log " + this->path + ": " + std::strerror(errno));
+    }
+
+    // Every thread re-registers its buffer with a new backend
+    generation = ++generations;
+
+    writer = std::thread([this] {
+        writerLoop();
+    });
+}
+
+BinaryLogBackend::~BinaryLogBackend()
+{
+    current.store(nullptr);
+
+    // New holds now find no backend, wait out any taken before it was cleared
+    while (holds.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    wake_cv.notify_one();
+
+    if (writer.joinable()) {
+        writer.join();
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+BinaryLogBackend::Active BinaryLogBackend::active()
+{
+    return Active();
+}
+
+/**
+ * The hold is announced before the backend is read, so either the destructor sees the hold and waits for it, or the
+ * hold sees the backend already cleared.
+ */
+BinaryLogBackend::Active::Active()
+{
+    holds.fetch_add(1);
+    backend = current.load();
+
+    if (backend == nullptr) {
+        holds.fetch_sub(1);
+    }
+}
+
+BinaryLogBackend::Active::~Active()
+{
+    if (backend != nullptr) {
+        holds.fetch_sub(1);
+    }
+}
+
+void BinaryLogBackend::process(LogRecord const& log_record)
+{
+    if (log_record.binary_logged) {
+        return;
+    }
+
+    auto id = recordFormatId(log_record);
+    auto ts = std::chrono::duration_cast<std::chrono::nanoseconds>(log_record.timestamp.time_since_epoch()).count();
+
+    // Oversized messages would never fit in the thread buffer, keep what we can
+    std::string_view message(log_record.message);
+    if (message.size() > thread_buffer_size / 4) {
+        message = message.substr(0, thread_buffer_size / 4);
+    }
+
+    threadBuffer().push(id, static_cast<std::int64_t>(ts), message);
+}
+
+void BinaryLogBackend::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (stop) {
+        return;
+    }
+
+    // A pass may already be under way and have missed our records, so wait for the one after it
+    auto target = passes + 2;
+
+    ++flush_waiters;
+    wake_cv.notify_one();
+    pass_cv.wait(lock, [this, target] {
+        return passes >= target || stop;
+    });
+    --flush_waiters;
+}
+
+void BinaryLogBackend::reopen()
+{
+    reopen_requested.store(true);
+}
+
+std::uint64_t BinaryLogBackend::dropped() const
+{
+    return dropped_total.load();
+}
+
+ThreadBuffer& BinaryLogBackend::threadBuffer()
+{
+    struct Handle
+    {
+        std::shared_ptr<ThreadBuffer> buffer;
+        std::uint64_t generation = 0;
+
+        ~Handle()
+        {
+            if (buffer) {
+                buffer->retired.store(true);
+            }
+        }
+    };
+
+    thread_local Handle handle;
+
+    if (handle.generation != generation) {
+        if (handle.buffer) {
+            handle.buffer->retired.store(true);
+        }
+
+        handle.buffer = std::make_shared<ThreadBuffer>(thread_buffer_size);
+        handle.generation = generation;
+
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.push_back(handle.buffer);
+    }
+
+    return *handle.buffer;
+}
+
+/**
+ * Open the log file and start a new segment; formats are defined again as they are next used.
+ */
+void BinaryLogBackend::openFile()
+{
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return;
+    }
+
+    defined_formats.clear();
+
+    out.append(binary::segment_magic, sizeof(binary::segment_magic));
+    append(out, binary::format_version);
+    append(out, std::uint8_t(0));
+    writeOut();
+}
+
+void BinaryLogBackend::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        bool stopping = stop;
+
+        lock.unlock();
+        writePass();
+        lock.lock();
+
+        ++passes;
+        pass_cv.notify_all();
+
+        if (stopping) {
+            break;
+        }
+
+        wake_cv.wait_for(lock, poll_interval, [this] {
+            return stop || flush_waiters > 0;
+        });
+    }
+}
+
+/**
+ * Drain every thread buffer, then write the records in timestamp order.
+ */
+void BinaryLogBackend::writePass()
+{
+    if (reopen_requested.exchange(false)) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+
+        openFile();
+        if (fd < 0) {
+            std::cerr << "Unable to reopen binary log " << path << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+
+    std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        snapshot = buffers;
+    }
+
+    staging.clear();
+    pending.clear();
+    std::uint64_t lost = 0;
+    std::vector<ThreadBuffer*> released;
+
+    for (auto const& buffer : snapshot) {
+        // Check before draining; once retired, the owning thread can't add anything further
+        bool retired = buffer->retired.load();
+
+        buffer->drain([this](char const* record, std::size_t size) {
+            std::int64_t ts;
+            std::memcpy(&ts, record + 4, 8);
+            pending.push_back({ts, staging.size(), size});
+            staging.insert(staging.end(), record, record + size);
+        });
+
+        lost += buffer->dropped.exchange(0);
+
+        if (retired) {
+            released.push_back(buffer.get());
+        }
+    }
+
+    if (!released.empty()) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                     [&released](auto const& b) {
+                                         return std::find(released.begin(), released.end(), b.get()) !=
+                                                released.end();
+                                     }),
+                      buffers.end());
+    }
+
+    std::stable_sort(pending.begin(), pending.end(), [](PendingRecord const& a, PendingRecord const& b) {
+        return a.timestamp < b.timestamp;
+    });
+
+    if (lost > 0) {
+        dropped_total += lost;
+        out += static_cast<char>(EntryType::DROPPED);
+        append(out, lost);
+    }
+
+    for (auto const& record : pending) {
+        char const* data = &staging[record.offset];
+        std::uint32_t id;
+        std::memcpy(&id, data, 4);
+
+        defineFormat(id);
+
+        out += static_cast<char>(EntryType::RECORD);
+        out.append(data, ThreadBuffer::header_size);
+        append(out, static_cast<std::uint32_t>(record.size - ThreadBuffer::header_size));
+        out.append(data + ThreadBuffer::header_size, record.size - ThreadBuffer::header_size);
+    }
+
+    writeOut();
+}
+
+/**
+ * Write the format descriptor for `id` ahead of its first record.
+ */
+void BinaryLogBackend::defineFormat(std::uint32_t id)
+{
+    if (id < defined_formats.size() && defined_formats[id]) {
+        return;
+    }
+
+    auto const* descriptor = binary::findFormat(id);
+    if (descriptor == nullptr) {
+        return;
+    }
+
+    if (id >= defined_formats.size()) {
+        defined_formats.resize(id + 1, false);
+    }
+    defined_formats[id] = true;
+
+    out += static_cast<char>(EntryType::FORMAT);
+    append(out, id);
+    append(out, static_cast<std::uint8_t>(descriptor->severity));
+    append(out, static_cast<std::int32_t>(descriptor->lineno));
+    appendString(out, descriptor->format);
+    appendString(out, descriptor->function);
+    appendString(out, descriptor->filename);
+}
+
+void BinaryLogBackend::writeOut()
+{
+    if (fd < 0) {
+        out.clear();
+        return;
+    }
+
+    std::size_t written = 0;
+
+    while (written < out.size()) {
+        auto r = ::write(fd, out.data() + written, out.size() - written);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // Logging can't log its own failure
+            std::cerr << "Binary log write to " << path << " failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        written += static_cast<std::size_t>(r);
+    }
+
+    out.clear();
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../binary/model.h"
+#include "../binary/thread_buffer.h"
+#include "../model.h"
+
+namespace bes::log::backend {
+
+/**
+ * Writes a compact binary log, deferring all formatting to the offline decoder (`//tools:log_decode`).
+ *
+ * Structured statements (BES_LOGF) push only their format ID and raw argument bytes into a buffer owned by the calling
+ * thread; nothing is formatted or locked on the hot path. They still reach any other backends on the sink, formatted
+ * for them. Standard BES_LOG records are also accepted, stored as their already formatted message.
+ *
+ * A writer thread periodically drains every thread's buffer, orders the records by timestamp and appends them to the
+ * file with a single write. If a thread's buffer is full, the record is dropped and the count is recorded in the log.
+ *
+ * Only one BinaryLogBackend may exist at a time.
+ */
+class BinaryLogBackend : public LogBackend
+{
+   public:
+    explicit BinaryLogBackend(std::string path, std::size_t thread_buffer_size = 256 * 1024);
+    ~BinaryLogBackend() override;
+
+    BinaryLogBackend(BinaryLogBackend const&) = delete;
+    BinaryLogBackend& operator=(BinaryLogBackend const&) = delete;
+
+    void process(LogRecord const& log_record) override;
+
+    /**
+     * Block until everything logged before this call is written to the file.
+     */
+    void flush() override;
+
+    /**
+     * Close and reopen the file, starting a new segment. Performed by the writer thread.
+     */
+    void reopen() override;
+
+    /**
+     * Push a structured record to the calling thread's buffer.
+     */
+    template <class... Args>
+    void push(binary::Descriptor const& descriptor, Args const&... args);
+
+    /**
+     * Total number of records dropped due to full thread buffers.
+     */
+    [[nodiscard]] std::uint64_t dropped() const;
+
+    /**
+     * A hold on the live backend; while one is held, the backend's destructor waits rather than tear it down under a
+     * push. Hold it only for as long as the push takes.
+     */
+    class Active
+    {
+       public:
+        Active();
+        ~Active();
+
+        Active(Active const&) = delete;
+        Active& operator=(Active const&) = delete;
+
+        explicit operator bool() const
+        {
+            return backend != nullptr;
+        }
+
+        BinaryLogBackend* operator->() const
+        {
+            return backend;
+        }
+
+       private:
+        BinaryLogBackend* backend;
+    };
+
+    /**
+     * The live backend, empty if there isn't one.
+     */
+    static Active active();
+
+    /// Interval at which the writer drains thread buffers
+    static constexpr std::chrono::milliseconds poll_interval{10};
+
+   private:
+    struct PendingRecord
+    {
+        std::int64_t timestamp;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    std::string path;
+    int fd;
+    std::size_t thread_buffer_size;
+    std::uint64_t generation;
+
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<binary::ThreadBuffer>> buffers;
+
+    // Writer thread state
+    std::vector<bool> defined_formats;
+    std::vector<char> staging;
+    std::vector<PendingRecord> pending;
+    std::string out;
+    std::atomic<std::uint64_t> dropped_total{0};
+    std::atomic<bool> reopen_requested{false};
+
+    std::mutex mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable pass_cv;
+    std::uint64_t passes = 0;
+    int flush_waiters = 0;
+    bool stop = false;
+
+    std::thread writer;
+
+    static std::atomic<BinaryLogBackend*> current;
+    static std::atomic<int> holds;
+    static std::atomic<std::uint64_t> generations;
+
+    binary::ThreadBuffer& threadBuffer();
+    void openFile();
+    void writerLoop();
+    void writePass();
+    void defineFormat(std::uint32_t id);
+    void writeOut();
+};
+
+template <class... Args>
+void BinaryLogBackend::push(binary::Descriptor const& descriptor, Args const&... args)
+{
+    auto ts = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::system_clock::now().time_since_epoch())
+                  .count();
+
+    threadBuffer().push(descriptor.id, static_cast<std::int64_t>(ts), args...);
+}
+
+}  // namespace bes::log::backend
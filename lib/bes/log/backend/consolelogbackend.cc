@@ -16,24 +16,49 @@ ConsoleLogBackend::ConsoleLogBackend(LogFormat f, ColourMode use_clr) : fmt(f)
 }
 
 void ConsoleLogBackend::process(LogRecord const& log_record)
+{
+    format(std::cout, log_record) << std::endl;
+}
+
+/**
+ * Formats the entire batch into a single buffer so it reaches the console in one write.
+ */
+void ConsoleLogBackend::processBatch(std::vector<LogRecord> const& batch)
+{
+    batch_buffer.str("");
+
+    for (auto const& record : batch) {
+        format(batch_buffer, record) << '\n';
+    }
+
+    auto const& out = batch_buffer.str();
+    std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+}
+
+void ConsoleLogBackend::flush()
+{
+    std::cout.flush();
+}
+
+std::ostream& ConsoleLogBackend::format(std::ostream& stream, LogRecord const& log_record) const
 {
     if (isColour()) {
         bool c = true;
         switch (log_record.severity) {
             case bes::log::Severity::TRACE:
             case bes::log::Severity::DEBUG:
-                std::cout << BES_CLR_DEBUG;
+                stream << BES_CLR_DEBUG;
                 break;
             case bes::log::Severity::WARNING:
-                std::cout << BES_CLR_WARNING;
+                stream << BES_CLR_WARNING;
                 break;
             case bes::log::Severity::ERROR:
-                std::cout << BES_CLR_ERROR;
+                stream << BES_CLR_ERROR;
                 break;
             case bes::log::Severity::CRITICAL:
             case bes::log::Severity::ALERT:
             case bes::log::Severity::FATAL:
-                std::cout << BES_CLR_CRITICAL;
+                stream << BES_CLR_CRITICAL;
                 break;
             default:
                 c = false;
@@ -41,14 +66,11 @@ void ConsoleLogBackend::process(LogRecord const& log_record)
         }
 
         if (c) {
-            log_record.str(std::cout, fmt) << BES_CLR_RESET << std::endl;
-        } else {
-            log_record.str(std::cout, fmt) << std::endl;
+            return log_record.str(stream, fmt) << BES_CLR_RESET;
         }
-
-    } else {
-        log_record.str(std::cout, fmt) << std::endl;
     }
+
+    return log_record.str(stream, fmt);
 }
 
 bool ConsoleLogBackend::isColour() const
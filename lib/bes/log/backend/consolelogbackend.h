@@ -1,5 +1,8 @@
 #pragma once
 
+#include <sstream>
+#include <vector>
+
 #include "../colour.h"
 #include "../model.h"
 
@@ -17,8 +20,14 @@ class ConsoleLogBackend : public LogBackend
     LogFormat fmt;
     bool use_colour;
 
+    std::ostream& format(std::ostream& stream, LogRecord const& log_record) const;
+
    private:
-    void process(LogRecord  const& log_record) override;
+    std::ostringstream batch_buffer;
+
+    void process(LogRecord const& log_record) override;
+    void processBatch(std::vector<LogRecord> const& batch) override;
+    void flush() override;
 };
 
 }  // namespace bes::log::backend
@@ -0,0 +1,279 @@
+#include "filelogbackend.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace bes::log::backend;
+
+FileLogBackend::FileLogBackend(std::string path, LogFormat f, FileLogRotation rotation)
+    : path(std::move(path)), fmt(f), rotation(rotation)
+{
+    openFile();
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open log file " + this->path + ": " + std::strerror(errno));
+    }
+
+    current.reserve(chunk_size);
+
+    flusher = std::thread([this] {
+        flusherLoop();
+    });
+}
+
+FileLogBackend::~FileLogBackend()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    wake_cv.notify_one();
+
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void FileLogBackend::process(LogRecord const& log_record)
+{
+    // Format outside of the lock
+    thread_local std::ostringstream line;
+    line.str("");
+    log_record.str(line, fmt) << '\n';
+    auto const& str = line.str();
+
+    bool wake = false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (!current.empty() && current.size() + str.size() > chunk_size) {
+            if (full.size() >= max_pending_chunks) {
+                ++dropped_total;
+                return;
+            }
+
+            full.push_back(std::move(current));
+            current = takeChunk();
+            wake = true;
+        }
+
+        current.append(str);
+    }
+
+    if (wake) {
+        wake_cv.notify_one();
+    }
+}
+
+void FileLogBackend::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (stop) {
+        return;
+    }
+
+    // A pass may already be under way and have missed our records, so wait for the one after it
+    auto target = passes + 2;
+
+    ++flush_waiters;
+    wake_cv.notify_one();
+    pass_cv.wait(lock, [this, target] {
+        return passes >= target || stop;
+    });
+    --flush_waiters;
+}
+
+void FileLogBackend::reopen()
+{
+    reopen_requested.store(true);
+    wake_cv.notify_one();
+}
+
+std::uint64_t FileLogBackend::dropped() const
+{
+    return dropped_total.load();
+}
+
+/**
+ * Recycle a written chunk if one is available, else allocate. Must be called with the mutex held.
+ */
+std::string FileLogBackend::takeChunk()
+{
+    if (spare.empty()) {
+        std::string chunk;
+        chunk.reserve(chunk_size);
+        return chunk;
+    }
+
+    auto chunk = std::move(spare.back());
+    spare.pop_back();
+    return chunk;
+}
+
+void FileLogBackend::openFile()
+{
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    opened = std::chrono::steady_clock::now();
+    file_size = 0;
+
+    struct stat st = {};
+    if (fd >= 0 && ::fstat(fd, &st) == 0) {
+        file_size = static_cast<std::size_t>(st.st_size);
+    }
+}
+
+/**
+ * Shift path.1 .. path.N along by one, move the live file to path.1 and open a fresh one.
+ */
+void FileLogBackend::rotate()
+{
+    if (fd >= 0) {
+        ::close(fd);
+    }
+
+    if (rotation.keep == 0) {
+        ::unlink(path.c_str());
+    } else {
+        ::unlink((path + "." + std::to_string(rotation.keep)).c_str());
+
+        for (unsigned i = rotation.keep - 1; i > 0; --i) {
+            ::rename((path + "." + std::to_string(i)).c_str(), (path + "." + std::to_string(i + 1)).c_str());
+        }
+
+        ::rename(path.c_str(), (path + ".1").c_str());
+    }
+
+    openFile();
+    if (fd < 0) {
+        std::cerr << "Unable to open log file " << path << " after rotation: " << std::strerror(errno) << std::endl;
+    }
+}
+
+void FileLogBackend::flusherLoop()
+{
+    std::vector<std::string> writing;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        bool stopping = stop;
+
+        writing.swap(full);
+        if (!current.empty()) {
+            writing.push_back(std::move(current));
+            current = takeChunk();
+        }
+
+        lock.unlock();
+
+        if (reopen_requested.exchange(false)) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+
+            openFile();
+            if (fd < 0) {
+                std::cerr << "Unable to reopen log file " << path << ": " << std::strerror(errno) << std::endl;
+            }
+        }
+
+        write(writing);
+
+        lock.lock();
+
+        // Recycle the written chunks, keeping enough spares to absorb a burst
+        for (auto& chunk : writing) {
+            if (spare.size() < 4) {
+                chunk.clear();
+                spare.push_back(std::move(chunk));
+            }
+        }
+        writing.clear();
+
+        ++passes;
+        pass_cv.notify_all();
+
+        if (stopping) {
+            break;
+        }
+
+        wake_cv.wait_for(lock, flush_interval, [this] {
+            return stop || flush_waiters > 0 || !full.empty() || reopen_requested.load();
+        });
+    }
+}
+
+void FileLogBackend::write(std::vector<std::string>& chunks)
+{
+    std::size_t total = 0;
+    for (auto const& chunk : chunks) {
+        total += chunk.size();
+    }
+
+    if (total == 0) {
+        return;
+    }
+
+    bool expired = rotation.max_age.count() > 0 && std::chrono::steady_clock::now() - opened >= rotation.max_age;
+    bool oversize = rotation.max_bytes > 0 && file_size > 0 && file_size + total > rotation.max_bytes;
+
+    if (expired || oversize) {
+        rotate();
+    }
+
+    if (fd < 0) {
+        return;
+    }
+
+    std::vector<iovec> iov;
+    iov.reserve(chunks.size());
+    for (auto& chunk : chunks) {
+        if (!chunk.empty()) {
+            iov.push_back({chunk.data(), chunk.size()});
+        }
+    }
+
+    std::size_t idx = 0;
+    while (idx < iov.size()) {
+        auto count = static_cast<int>(std::min<std::size_t>(iov.size() - idx, IOV_MAX));
+        auto written = ::writev(fd, &iov[idx], count);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // Logging can't log its own failure
+            std::cerr << "Log write to " << path << " failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+
+        file_size += static_cast<std::size_t>(written);
+
+        // Step over fully written buffers, then trim a partially written one
+        auto remaining = static_cast<std::size_t>(written);
+        while (idx < iov.size() && remaining >= iov[idx].iov_len) {
+            remaining -= iov[idx].iov_len;
+            ++idx;
+        }
+
+        if (remaining > 0) {
+            iov[idx].iov_base = static_cast<char*>(iov[idx].iov_base) + remaining;
+            iov[idx].iov_len -= remaining;
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../model.h"
+
+namespace bes::log::backend {
+
+/**
+ * Rotation policy for a FileLogBackend.
+ */
+struct FileLogRotation
+{
+    // Rotate once the file reaches this size, zero to disable
+    std::size_t max_bytes = 0;
+
+    // Rotate once the file has been open this long, zero to disable
+    std::chrono::seconds max_age{0};
+
+    // Number of rotated files to keep (path.1 being the newest), older files are deleted
+    unsigned keep = 5;
+};
+
+/**
+ * Appends formatted records to a file, with size and time based rotation.
+ *
+ * Producers format on their own thread and copy the line into a large in-memory chunk under a short lock. A flusher
+ * thread swaps out the filled chunks and writes them with a single writev(), and is the only thread that touches the
+ * file, so rotation and reopening never block a producer. If the flusher falls too far behind, records are dropped and
+ * counted rather than stalling the caller.
+ *
+ * Call reopen() (the kernel does so on SIGHUP) after an external tool such as logrotate has moved the file.
+ */
+class FileLogBackend : public LogBackend
+{
+   public:
+    explicit FileLogBackend(std::string path, LogFormat f = LogFormat::FULL, FileLogRotation rotation = {});
+    ~FileLogBackend() override;
+
+    FileLogBackend(FileLogBackend const&) = delete;
+    FileLogBackend& operator=(FileLogBackend const&) = delete;
+
+    void process(LogRecord const& log_record) override;
+
+    /**
+     * Block until all records received so far are written to the file.
+     */
+    void flush() override;
+
+    /**
+     * Close and reopen the file at the configured path, performed asynchronously by the flusher.
+     */
+    void reopen() override;
+
+    /**
+     * Number of records discarded because the flusher could not keep up.
+     */
+    [[nodiscard]] std::uint64_t dropped() const;
+
+    /// Size of each in-memory chunk
+    static constexpr std::size_t chunk_size = 256 * 1024;
+
+    /// Chunks allowed to queue for the flusher before records are dropped
+    static constexpr std::size_t max_pending_chunks = 64;
+
+    /// Maximum time a record waits in memory before it is written
+    static constexpr std::chrono::milliseconds flush_interval{250};
+
+   private:
+    std::string path;
+    LogFormat fmt;
+    FileLogRotation rotation;
+
+    // Flusher thread state
+    int fd = -1;
+    std::size_t file_size = 0;
+    std::chrono::steady_clock::time_point opened;
+
+    std::mutex mutex;
+    std::string current;
+    std::vector<std::string> full;
+    std::vector<std::string> spare;
+    std::uint64_t passes = 0;
+    int flush_waiters = 0;
+    bool stop = false;
+
+    std::condition_variable wake_cv;
+    std::condition_variable pass_cv;
+    std::atomic<bool> reopen_requested{false};
+    std::atomic<std::uint64_t> dropped_total{0};
+
+    std::thread flusher;
+
+    std::string takeChunk();
+    void openFile();
+    void rotate();
+    void flusherLoop();
+    void write(std::vector<std::string>& chunks);
+};
+
+}  // namespace bes::log::backend
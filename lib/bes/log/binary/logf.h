@@ -0,0 +1,67 @@
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include "../backend/binarylogbackend.h"
+#include "../logger.h"
+#include "model.h"
+
+namespace bes::log::binary {
+
+/**
+ * Dispatch a structured statement, see BES_LOGF.
+ *
+ * With a BinaryLogBackend attached the raw arguments are recorded there. The statement is only formatted if other
+ * backends are attached, and is then sent through the LogSink as a normal record, which the binary backend skips.
+ */
+template <class... Args>
+void emit(Descriptor const& descriptor, Args const&... args)
+{
+    bool binary_logged = false;
+    if (auto binary_backend = backend::BinaryLogBackend::active()) {
+        binary_backend->push(descriptor, args...);
+        binary_logged = true;
+    }
+
+    if (!LogSink::hasInstance() || LogSink::instance().backendCount() <= (binary_logged ? 1 : 0)) {
+        return;
+    }
+
+    std::string payload(payloadSize(args...), '\0');
+    encodePayload(payload.data(), args...);
+
+    std::ostringstream message;
+    formatPayload(message, descriptor.format, payload.data(), payload.size());
+
+    LogRecord record;
+    record.severity = descriptor.severity;
+    record.function = descriptor.function;
+    record.filename = descriptor.filename;
+    record.lineno = descriptor.lineno;
+    record.timestamp = std::chrono::system_clock::now();
+    record.message = message.str();
+    record.binary_logged = binary_logged;
+
+    LogSink::instance().log(record);
+}
+
+}  // namespace bes::log::binary
+
+/**
+ * Structured log statement with a static format; `{}` placeholders are replaced by the arguments in order:
+ *
+ *      BES_LOGF(DEBUG, "FCGI: request {} received {} bytes", request_id, len);
+ *
+ * The format is registered once per call site. Arguments must be arithmetic types or strings; they are only evaluated
+ * if the statement passes the same severity checks as BES_LOG.
+ */
+#define BES_LOGF(level, format, ...)                                                                           \
+    for (bool BES_LOG_ON = BES_LOG_ACTIVE(::bes::log::Severity::level); BES_LOG_ON; BES_LOG_ON = false)        \
+    ::bes::log::binary::emit(                                                                                  \
+        [](char const* bes_log_function) -> ::bes::log::binary::Descriptor const& {                           \
+            static ::bes::log::binary::Descriptor const descriptor = ::bes::log::binary::registerFormat(       \
+                ::bes::log::Severity::level, format, bes_log_function, __FILE__, __LINE__);                    \
+            return descriptor;                                                                                 \
+        }(__func__),                                                                                           \
+        ##__VA_ARGS__)
@@ -0,0 +1,145 @@
+#include "model.h"
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+
+using namespace bes::log::binary;
+
+namespace {
+
+struct FormatRegistry
+{
+    std::mutex mutex;
+
+    // Deque so that pointers handed out by findFormat() remain valid as the registry grows
+    std::deque<Descriptor> descriptors;
+
+    // Owned strings for descriptors built from LogRecords, keyed by call site
+    std::deque<std::string> strings;
+    std::map<std::tuple<int, std::string, std::string, int>, Descriptor> records;
+
+    Descriptor add(bes::log::Severity severity, char const* format, char const* function, char const* filename,
+                   int lineno)
+    {
+        Descriptor d{static_cast<std::uint32_t>(descriptors.size()), severity, format, function, filename, lineno};
+        descriptors.push_back(d);
+        return d;
+    }
+};
+
+FormatRegistry& registry()
+{
+    static FormatRegistry r;
+    return r;
+}
+
+template <class T>
+T readValue(char const*& pos, char const* end)
+{
+    if (static_cast<std::size_t>(end - pos) < sizeof(T)) {
+        throw std::runtime_error("Truncated structured log payload");
+    }
+
+    T v;
+    std::memcpy(&v, pos, sizeof(T));
+    pos += sizeof(T);
+    return v;
+}
+
+/**
+ * Decode and print the next argument, returns false if there are no more arguments.
+ */
+bool writeArg(std::ostream& stream, char const*& pos, char const* end)
+{
+    if (pos >= end) {
+        return false;
+    }
+
+    switch (static_cast<ArgType>(readValue<std::uint8_t>(pos, end))) {
+        case ArgType::BOOL:
+            stream << (readValue<std::uint8_t>(pos, end) ? "true" : "false");
+            break;
+        case ArgType::CHAR:
+            stream << readValue<char>(pos, end);
+            break;
+        case ArgType::INT:
+            stream << readValue<std::int64_t>(pos, end);
+            break;
+        case ArgType::UINT:
+            stream << readValue<std::uint64_t>(pos, end);
+            break;
+        case ArgType::DOUBLE:
+            stream << readValue<double>(pos, end);
+            break;
+        case ArgType::STRING: {
+            auto len = readValue<std::uint32_t>(pos, end);
+            if (static_cast<std::size_t>(end - pos) < len) {
+                throw std::runtime_error("Truncated structured log payload");
+            }
+            stream.write(pos, len);
+            pos += len;
+            break;
+        }
+        default:
+            throw std::runtime_error("Unknown structured log argument type");
+    }
+
+    return true;
+}
+
+}  // namespace
+
+Descriptor bes::log::binary::registerFormat(Severity severity, char const* format, char const* function,
+                                            char const* filename, int lineno)
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.add(severity, format, function, filename, lineno);
+}
+
+Descriptor bes::log::binary::recordFormat(LogRecord const& record)
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    auto key = std::make_tuple(static_cast<int>(record.severity), record.filename, record.function, record.lineno);
+    auto it = reg.records.find(key);
+    if (it != reg.records.end()) {
+        return it->second;
+    }
+
+    auto const& function = reg.strings.emplace_back(record.function);
+    auto const& filename = reg.strings.emplace_back(record.filename);
+    auto d = reg.add(record.severity, "{}", function.c_str(), filename.c_str(), record.lineno);
+    reg.records.emplace(std::move(key), d);
+
+    return d;
+}
+
+Descriptor const* bes::log::binary::findFormat(std::uint32_t id)
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return id < reg.descriptors.size() ? &reg.descriptors[id] : nullptr;
+}
+
+void bes::log::binary::formatPayload(std::ostream& stream, char const* format, char const* payload, std::size_t size)
+{
+    char const* pos = payload;
+    char const* end = payload + size;
+
+    for (char const* f = format; *f; ++f) {
+        if (f[0] == '{' && f[1] == '}') {
+            // Placeholders without a matching argument are left as-is
+            if (!writeArg(stream, pos, end)) {
+                stream << "{}";
+            }
+            ++f;
+        } else {
+            stream << *f;
+        }
+    }
+}
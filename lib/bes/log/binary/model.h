@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "../model.h"
+
+namespace bes::log::binary {
+
+/**
+ * Binary log layout
+ *
+ * A file is a sequence of entries, each starting with a single tag byte. All integers are little-endian (host order,
+ * the decoder is expected to run on the same architecture) and strings are a u32 length followed by the bytes.
+ *
+ *      SEGMENT     "BESLOG" <u8 version> <u8 0>      written each time a file is opened, resets the format table
+ *      FORMAT      'F' <u32 id> <u8 severity> <i32 lineno> <str format> <str function> <str filename>
+ *      RECORD      'R' <u32 id> <i64 timestamp ns> <u32 payload size> <payload>
+ *      DROPPED     'D' <u64 count>
+ *
+ * A record payload is the raw arguments of the log statement, each an ArgType byte followed by its value.
+ */
+constexpr char segment_magic[] = {'B', 'E', 'S', 'L', 'O', 'G'};
+constexpr std::uint8_t format_version = 1;
+
+enum class EntryType : char
+{
+    SEGMENT = 'B',
+    FORMAT = 'F',
+    RECORD = 'R',
+    DROPPED = 'D',
+};
+
+enum class ArgType : std::uint8_t
+{
+    BOOL = 1,
+    CHAR,
+    INT,
+    UINT,
+    DOUBLE,
+    STRING,
+};
+
+/**
+ * Static description of a single log statement, registered once per call site.
+ *
+ * Placeholders in `format` are `{}` and are substituted by the statement's arguments in order.
+ */
+struct Descriptor
+{
+    std::uint32_t id;
+    Severity severity;
+    char const* format;
+    char const* function;
+    char const* filename;
+    int lineno;
+};
+
+/**
+ * Register a call site, returning a descriptor that must outlive the process' logging (call sites hold it in a
+ * function-local static). The strings are not copied.
+ */
+Descriptor registerFormat(Severity severity, char const* format, char const* function, char const* filename,
+                          int lineno);
+
+/**
+ * Descriptor for a pre-formatted LogRecord from the standard BES_LOG macros: format is a single `{}` for the message.
+ *
+ * Strings are interned, repeated calls for the same call site return the same descriptor.
+ */
+Descriptor recordFormat(LogRecord const& record);
+
+/**
+ * Look up a registered descriptor by ID, returns nullptr for an unknown ID.
+ */
+Descriptor const* findFormat(std::uint32_t id);
+
+/**
+ * Render `format` to `stream`, substituting each `{}` with the next argument decoded from `payload`.
+ *
+ * Throws std::runtime_error if the payload is malformed.
+ */
+void formatPayload(std::ostream& stream, char const* format, char const* payload, std::size_t size);
+
+namespace detail {
+
+template <class T>
+struct IsString : std::bool_constant<std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> ||
+                                     std::is_same_v<T, char const*> || std::is_same_v<T, char*>>
+{
+};
+
+template <class T>
+using Decayed = std::decay_t<T>;
+
+inline std::string_view asView(std::string const& v)
+{
+    return v;
+}
+
+inline std::string_view asView(std::string_view v)
+{
+    return v;
+}
+
+inline std::string_view asView(char const* v)
+{
+    return v ? std::string_view(v) : std::string_view();
+}
+
+}  // namespace detail
+
+/**
+ * Number of payload bytes needed to encode a single argument.
+ */
+template <class T>
+inline std::size_t encodedSize(T const& value)
+{
+    using D = detail::Decayed<T>;
+
+    if constexpr (std::is_same_v<D, bool> || std::is_same_v<D, char>) {
+        return 2;
+    } else if constexpr (std::is_integral_v<D> || std::is_floating_point_v<D>) {
+        return 1 + 8;
+    } else {
+        static_assert(detail::IsString<D>::value, "Structured log arguments must be arithmetic or strings");
+        return 1 + 4 + detail::asView(value).size();
+    }
+}
+
+/**
+ * Encode a single argument at `out`, returning the position after it. `out` must have encodedSize() bytes available.
+ */
+template <class T>
+inline char* encodeArg(char* out, T const& value)
+{
+    using D = detail::Decayed<T>;
+
+    if constexpr (std::is_same_v<D, bool>) {
+        *out++ = static_cast<char>(ArgType::BOOL);
+        *out++ = value ? 1 : 0;
+    } else if constexpr (std::is_same_v<D, char>) {
+        *out++ = static_cast<char>(ArgType::CHAR);
+        *out++ = value;
+    } else if constexpr (std::is_floating_point_v<D>) {
+        auto v = static_cast<double>(value);
+        *out++ = static_cast<char>(ArgType::DOUBLE);
+        std::memcpy(out, &v, 8);
+        out += 8;
+    } else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+        auto v = static_cast<std::int64_t>(value);
+        *out++ = static_cast<char>(ArgType::INT);
+        std::memcpy(out, &v, 8);
+        out += 8;
+    } else if constexpr (std::is_integral_v<D>) {
+        auto v = static_cast<std::uint64_t>(value);
+        *out++ = static_cast<char>(ArgType::UINT);
+        std::memcpy(out, &v, 8);
+        out += 8;
+    } else {
+        auto view = detail::asView(value);
+        auto len = static_cast<std::uint32_t>(view.size());
+        *out++ = static_cast<char>(ArgType::STRING);
+        std::memcpy(out, &len, 4);
+        std::memcpy(out + 4, view.data(), len);
+        out += 4 + len;
+    }
+
+    return out;
+}
+
+template <class... Args>
+inline std::size_t payloadSize(Args const&... args)
+{
+    return (std::size_t(0) + ... + encodedSize(args));
+}
+
+template <class... Args>
+inline char* encodePayload(char* out, Args const&... args)
+{
+    ((out = encodeArg(out, args)), ...);
+    return out;
+}
+
+}  // namespace bes::log::binary
@@ -0,0 +1,130 @@
+#include "reader.h"
+
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+using namespace bes::log::binary;
+
+Reader::Reader(std::istream& in) : in(in)
+{
+    if (in.peek() != static_cast<char>(EntryType::SEGMENT)) {
+        throw std::runtime_error("Input is not a binary log");
+    }
+}
+
+bool Reader::next(LogRecord& record)
+{
+    for (;;) {
+        int tag = in.get();
+        if (tag == std::char_traits<char>::eof()) {
+            return false;
+        }
+
+        switch (static_cast<EntryType>(tag)) {
+            case EntryType::SEGMENT:
+                readSegmentHeader();
+                break;
+
+            case EntryType::FORMAT:
+                readFormat();
+                break;
+
+            case EntryType::DROPPED:
+                record.severity = Severity::WARNING;
+                record.function = "";
+                record.filename = "";
+                record.lineno = 0;
+                record.timestamp = std::chrono::system_clock::time_point(std::chrono::nanoseconds(last_timestamp));
+                record.message = std::to_string(read<std::uint64_t>()) + " log records dropped";
+                return true;
+
+            case EntryType::RECORD: {
+                auto id = read<std::uint32_t>();
+                last_timestamp = read<std::int64_t>();
+                auto size = read<std::uint32_t>();
+
+                payload.resize(size);
+                if (!in.read(payload.data(), size)) {
+                    throw std::runtime_error("Truncated binary log record");
+                }
+
+                auto it = formats.find(id);
+                if (it == formats.end()) {
+                    throw std::runtime_error("Binary log record references undefined format " + std::to_string(id));
+                }
+
+                auto const& format = it->second;
+                std::ostringstream message;
+                formatPayload(message, format.format.c_str(), payload.data(), payload.size());
+
+                record.severity = format.severity;
+                record.function = format.function;
+                record.filename = format.filename;
+                record.lineno = format.lineno;
+                record.timestamp = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::nanoseconds(last_timestamp)));
+                record.message = message.str();
+                return true;
+            }
+
+            default:
+                throw std::runtime_error("Corrupt binary log, unknown entry type " + std::to_string(tag));
+        }
+    }
+}
+
+void Reader::readSegmentHeader()
+{
+    char magic[sizeof(segment_magic) - 1];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, segment_magic + 1, sizeof(magic)) != 0) {
+        throw std::runtime_error("Input is not a binary log");
+    }
+
+    auto version = read<std::uint8_t>();
+    read<std::uint8_t>();
+
+    if (version != format_version) {
+        throw std::runtime_error("Unsupported binary log version " + std::to_string(version));
+    }
+
+    // Format IDs are only unique within the process that wrote the segment
+    formats.clear();
+}
+
+void Reader::readFormat()
+{
+    auto id = read<std::uint32_t>();
+
+    Format format;
+    format.severity = static_cast<Severity>(read<std::uint8_t>());
+    format.lineno = read<std::int32_t>();
+    format.format = readString();
+    format.function = readString();
+    format.filename = readString();
+
+    formats[id] = std::move(format);
+}
+
+template <class T>
+T Reader::read()
+{
+    T value;
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+        throw std::runtime_error("Truncated binary log");
+    }
+
+    return value;
+}
+
+std::string Reader::readString()
+{
+    auto len = read<std::uint32_t>();
+    std::string str(len, '\0');
+    if (!in.read(str.data(), len)) {
+        throw std::runtime_error("Truncated binary log");
+    }
+
+    return str;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <unordered_map>
+
+#include "../model.h"
+#include "model.h"
+
+namespace bes::log::binary {
+
+/**
+ * Decodes a binary log written by the BinaryLogBackend back into LogRecords, which can then be rendered with any
+ * LogFormat.
+ *
+ * Dropped-record markers are returned as a WARNING record stating how many records were lost.
+ */
+class Reader
+{
+   public:
+    explicit Reader(std::istream& in);
+
+    /**
+     * Decode the next record; returns false at the end of the input.
+     *
+     * Throws std::runtime_error if the input is not a binary log or is corrupt.
+     */
+    bool next(LogRecord& record);
+
+   private:
+    struct Format
+    {
+        Severity severity;
+        int lineno;
+        std::string format;
+        std::string function;
+        std::string filename;
+    };
+
+    std::istream& in;
+    std::unordered_map<std::uint32_t, Format> formats;
+    std::int64_t last_timestamp = 0;
+    std::string payload;
+
+    void readSegmentHeader();
+    void readFormat();
+
+    template <class T>
+    T read();
+
+    std::string readString();
+};
+
+}  // namespace bes::log::binary
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include "model.h"
+
+namespace bes::log::binary {
+
+/**
+ * Single-producer, single-consumer byte ring owned by one logging thread and drained by the binary log writer.
+ *
+ * Each record is stored contiguously as `<u32 size> <u32 format id> <i64 timestamp> <payload>`. A record that won't fit
+ * before the end of the ring is written from the start instead, with a 0xFFFFFFFF size marking the skipped space.
+ */
+class ThreadBuffer
+{
+   public:
+    /// Offset of the payload within a record, after the format ID and timestamp
+    static constexpr std::size_t header_size = 4 + 8;
+
+    explicit ThreadBuffer(std::size_t capacity);
+
+    ThreadBuffer(ThreadBuffer const&) = delete;
+    ThreadBuffer& operator=(ThreadBuffer const&) = delete;
+
+    /**
+     * Encode a record into the ring; returns false and counts a drop if there is not enough space. Never blocks.
+     */
+    template <class... Args>
+    bool push(std::uint32_t id, std::int64_t timestamp, Args const&... args);
+
+    /**
+     * Pass every available record to `fn(char const* record, std::size_t size)`, where `record` points at the format
+     * ID. The record memory is released once `fn` returns. Consumer thread only.
+     */
+    template <class F>
+    std::size_t drain(F&& fn);
+
+    [[nodiscard]] bool empty() const;
+
+    /// Set when the owning thread exits, the writer releases the buffer once it is drained
+    std::atomic<bool> retired{false};
+
+    /// Records discarded because the ring was full, reset by the writer when it reports them
+    std::atomic<std::uint64_t> dropped{0};
+
+   private:
+    static constexpr std::uint32_t wrap_marker = UINT32_MAX;
+
+    std::size_t const mask;
+    std::unique_ptr<char[]> data;
+
+    alignas(64) std::atomic<std::uint64_t> head{0};
+    alignas(64) std::atomic<std::uint64_t> tail{0};
+};
+
+inline ThreadBuffer::ThreadBuffer(std::size_t capacity)
+    : mask([capacity] {
+          std::size_t size = 1024;
+          while (size < capacity) {
+              size <<= 1;
+          }
+          return size - 1;
+      }()),
+      data(new char[mask + 1])
+{
+}
+
+template <class... Args>
+bool ThreadBuffer::push(std::uint32_t id, std::int64_t timestamp, Args const&... args)
+{
+    std::size_t const capacity = mask + 1;
+    std::size_t const size = header_size + payloadSize(args...);
+    std::size_t const need = 4 + size;
+
+    if (need > capacity / 2) {
+        ++dropped;
+        return false;
+    }
+
+    std::uint64_t pos = head.load(std::memory_order_relaxed);
+    std::size_t const contiguous = capacity - (pos & mask);
+    std::size_t const skip = need > contiguous ? contiguous : 0;
+
+    if (pos + skip + need - tail.load(std::memory_order_acquire) > capacity) {
+        ++dropped;
+        return false;
+    }
+
+    if (skip >= 4) {
+        std::memcpy(&data[pos & mask], &wrap_marker, 4);
+    }
+
+    char* out = &data[(pos + skip) & mask];
+    auto size32 = static_cast<std::uint32_t>(size);
+    std::memcpy(out, &size32, 4);
+    std::memcpy(out + 4, &id, 4);
+    std::memcpy(out + 8, &timestamp, 8);
+    encodePayload(out + 4 + header_size, args...);
+
+    head.store(pos + skip + need, std::memory_order_release);
+    return true;
+}
+
+template <class F>
+std::size_t ThreadBuffer::drain(F&& fn)
+{
+    std::size_t const capacity = mask + 1;
+    std::uint64_t pos = tail.load(std::memory_order_relaxed);
+    std::uint64_t const end = head.load(std::memory_order_acquire);
+    std::size_t count = 0;
+
+    while (pos < end) {
+        std::size_t const contiguous = capacity - (pos & mask);
+        if (contiguous < 4) {
+            pos += contiguous;
+            continue;
+        }
+
+        std::uint32_t size;
+        std::memcpy(&size, &data[pos & mask], 4);
+        if (size == wrap_marker) {
+            pos += contiguous;
+            continue;
+        }
+
+        fn(&data[(pos & mask) + 4], static_cast<std::size_t>(size));
+        pos += 4 + size;
+        ++count;
+    }
+
+    tail.store(pos, std::memory_order_release);
+    return count;
+}
+
+inline bool ThreadBuffer::empty() const
+{
+    return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+}
+
+}  // namespace bes::log::binary
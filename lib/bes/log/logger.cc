@@ -2,8 +2,8 @@
 
 using namespace bes::log;
 
-Logger::Logger(Severity severity, char const* function, char const* filename, int lineno)
-    : severity(severity), function(function), filename(filename), lineno(lineno)
+Logger::Logger(Severity severity, char const* function, char const* filename, int lineno, char const* source)
+    : severity(severity), function(function), filename(filename), lineno(lineno), source(source)
 {
     if (LogSink::hasInstance()) {
         LogSink& s = LogSink::instance();
@@ -31,10 +31,15 @@ void Logger::dispatch()
     record.function = function;
     record.filename = filename;
     record.lineno = lineno;
+    record.site = filename;
     record.timestamp = std::chrono::system_clock::now();
     record.message = ostream->str();
 
-    LogSink::instance().log(record);
+    if (source == nullptr) {
+        LogSink::instance().log(record);
+    } else {
+        LogSink::instance().log(source, record);
+    }
 }
 
 std::ostream& Logger::stream()
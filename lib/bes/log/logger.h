@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <iostream>
@@ -12,6 +13,25 @@
 #include "logsink.h"
 #include "model.h"
 
+/**
+ * Module a translation unit belongs to, for per-module log thresholds. Each library sets this to its own name in the
+ * build; code outside of the libraries falls under the global severity.
+ */
+#ifndef BES_LOG_MODULE
+#define BES_LOG_MODULE ""
+#endif
+
+/**
+ * Statements below this severity are compiled out. Defaults to INFO for release (NDEBUG) builds, and TRACE otherwise.
+ */
+#ifndef BES_LOG_MIN_SEVERITY
+#ifdef NDEBUG
+#define BES_LOG_MIN_SEVERITY 2
+#else
+#define BES_LOG_MIN_SEVERITY 0
+#endif
+#endif
+
 namespace bes::log {
 
 /**
@@ -25,7 +45,11 @@ namespace bes::log {
 class Logger
 {
    public:
-    Logger(Severity severity, char const* function, char const* filename, int lineno);
+    /**
+     * Severity filtering is done by the BES_LOG macros before a Logger is constructed, against the module's threshold.
+     * The Logger confirms there is a sink to dispatch to, and that the sink would accept the severity from some module.
+     */
+    Logger(Severity severity, char const* function, char const* filename, int lineno, char const* source = nullptr);
 
     [[nodiscard]] bool enabled() const;
 
@@ -41,7 +65,57 @@ class Logger
     char const* function;
     char const* filename;
     int lineno;
+    char const* source;
     std::unique_ptr<std::ostringstream> ostream;
 };
 
+namespace {
+
+/**
+ * Threshold for the module this translation unit is compiled into, looked up on first use so the BES_LOG macros never
+ * perform a lookup after that. A function-local static rather than a namespace-scope reference, so that statements
+ * run during another translation unit's static initialisation don't read it before it is bound.
+ */
+inline std::atomic<int>& localThreshold()
+{
+    static std::atomic<int>& threshold = LogSink::moduleThreshold(BES_LOG_MODULE);
+    return threshold;
+}
+
+}  // namespace
+
 }  // namespace bes::log
+
+/**
+ * True if a statement at `level` should be logged by this translation unit.
+ */
+#define BES_LOG_ACTIVE(level)                                          \
+    (static_cast<int>(level) >= BES_LOG_MIN_SEVERITY &&                \
+     static_cast<int>(level) >= ::bes::log::localThreshold().load(::std::memory_order_relaxed))
+
+/**
+ * Create a log entry with a fully-qualified log level.
+ *
+ * The outer loop runs zero times unless the severity passes both the compile-time floor and the module's runtime
+ * threshold, so a disabled statement costs a single relaxed load and its `<<` arguments are never evaluated. When
+ * `level` is a constant below BES_LOG_MIN_SEVERITY the statement is removed entirely.
+ */
+#define BES_LOG_LVL(level) BES_LOG_SOURCE_LVL(level, nullptr)
+
+/**
+ * Primary entry-point for logging, allows short-hand severity:
+ *      BES_LOG(INFO) << "Test Log";
+ */
+#define BES_LOG(level) BES_LOG_LVL(::bes::log::Severity::level)
+
+/**
+ * Log on behalf of a named source, subject to any throttle set with LogSink::setSourceThrottle():
+ *      BES_LOG_SOURCE(ERROR, "cassandra") << message;
+ */
+#define BES_LOG_SOURCE_LVL(level, source)                                                                         \
+    for (bool BES_LOG_ON = BES_LOG_ACTIVE(level); BES_LOG_ON; BES_LOG_ON = false)                                  \
+        for (auto BES_LOG_INST = ::bes::log::Logger(level, __func__, __FILE__, __LINE__, source);                   \
+             BES_LOG_INST.enabled(); BES_LOG_INST.dispatch())                                                     \
+    BES_LOG_INST.stream()
+
+#define BES_LOG_SOURCE(level, source) BES_LOG_SOURCE_LVL(::bes::log::Severity::level, source)
@@ -1,9 +1,61 @@
 #include "logsink.h"
 
+#include <algorithm>
+
 using namespace bes::log;
 
 LogSink* LogSink::singleton = nullptr;
 
+namespace {
+
+/**
+ * Module thresholds outlive any LogSink, as translation units hold references to them from their first log statement.
+ */
+struct ThresholdRegistry
+{
+    std::mutex mutex;
+    bool active = false;
+    int global = severity_off;
+    std::map<std::string, int> overrides;
+    std::map<std::string, std::atomic<int>> modules;
+    std::vector<std::function<void()>> listeners;
+
+    int thresholdFor(std::string const& module) const
+    {
+        if (!active) {
+            return severity_off;
+        }
+
+        auto it = overrides.find(module);
+        return it == overrides.end() ? global : it->second;
+    }
+};
+
+ThresholdRegistry& registry()
+{
+    static ThresholdRegistry r;
+    return r;
+}
+
+/**
+ * Tell the listeners that thresholds have changed. Called without the registry lock held, listeners are free to read
+ * their thresholds.
+ */
+void notifyListeners()
+{
+    std::vector<std::function<void()>> listeners;
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        listeners = registry().listeners;
+    }
+
+    for (auto const& fn : listeners) {
+        fn();
+    }
+}
+
+}  // namespace
+
 LogSink::LogSink(Severity s)
 {
     if (LogSink::singleton != nullptr) {
@@ -13,11 +65,25 @@ LogSink::LogSink(Severity s)
     severity = static_cast<int>(s);
 
     LogSink::singleton = this;
+    applyThresholds();
 }
 
 LogSink::~LogSink()
 {
     LogSink::singleton = nullptr;
+
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.active = false;
+        reg.overrides.clear();
+
+        for (auto& module : reg.modules) {
+            module.second.store(severity_off);
+        }
+    }
+
+    notifyListeners();
 }
 
 LogSink& LogSink::instance()
@@ -34,24 +100,102 @@ void LogSink::log(LogRecord const& log_record)
     }
 }
 
+void LogSink::log(char const* source, LogRecord const& log_record)
+{
+    std::shared_lock<std::shared_mutex> lock(throttle_mutex);
+
+    auto it = throttles.find(source);
+    if (it == throttles.end()) {
+        lock.unlock();
+        log(log_record);
+        return;
+    }
+
+    it->second->admit(log_record.severity, log_record.message, [this, &log_record](Severity s, std::string_view msg) {
+        if (msg.data() == log_record.message.data()) {
+            log(log_record);
+            return;
+        }
+
+        LogRecord summary = log_record;
+        summary.severity = s;
+        summary.message = msg;
+        log(summary);
+    });
+}
+
+void LogSink::setSourceThrottle(std::string const& source, ThrottleConfig config)
+{
+    std::lock_guard<std::shared_mutex> lock(throttle_mutex);
+    throttles.insert_or_assign(source, std::make_unique<Throttle>(config));
+}
+
+void LogSink::clearSourceThrottle(std::string const& source)
+{
+    std::lock_guard<std::shared_mutex> lock(throttle_mutex);
+    throttles.erase(source);
+}
+
+bool LogSink::hasSourceThrottle(std::string const& source) const
+{
+    std::shared_lock<std::shared_mutex> lock(throttle_mutex);
+    return throttles.find(source) != throttles.end();
+}
+
+void LogSink::flush()
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(throttle_mutex);
+
+        for (auto const& throttle : throttles) {
+            throttle.second->drain([this, &throttle](Severity s, std::string_view msg) {
+                LogRecord summary;
+                summary.severity = s;
+                summary.function = "";
+                summary.filename = "";
+                summary.lineno = 0;
+                summary.timestamp = std::chrono::system_clock::now();
+                summary.message = throttle.first + ": " + std::string(msg);
+                log(summary);
+            });
+        }
+    }
+
+    std::shared_lock<std::shared_mutex> lock(backend_mutex);
+
+    for (auto const& backend : backends) {
+        backend.second->flush();
+    }
+}
+
+void LogSink::reopen()
+{
+    std::shared_lock<std::shared_mutex> lock(backend_mutex);
+
+    for (auto const& backend : backends) {
+        backend.second->reopen();
+    }
+}
+
 void LogSink::removeBackend(long const& id)
 {
     std::lock_guard<std::shared_mutex> lock(backend_mutex);
     backends.erase(id);
-    has_backends.store(!backends.empty());
+    backend_count.store(backends.size());
+    applyThresholds();
 }
 
 void LogSink::clearBackends()
 {
     std::lock_guard<std::shared_mutex> lock(backend_mutex);
     backends.clear();
-    has_backends.store(false);
+    backend_count.store(0);
+    applyThresholds();
 }
 
-std::size_t LogSink::backendCount()
+std::size_t LogSink::backendCount() const
 {
-    std::shared_lock<std::shared_mutex> lock(backend_mutex);
-    return backends.size();
+    return backend_count.load(std::memory_order_relaxed);
 }
 
 /**
@@ -59,17 +203,80 @@ std::size_t LogSink::backendCount()
  */
 bool LogSink::empty() const
 {
-    return !has_backends.load(std::memory_order_relaxed);
+    return backend_count.load(std::memory_order_relaxed) == 0;
 }
 
 bool LogSink::enabled(Severity s) const
 {
-    return severity.load(std::memory_order_relaxed) <= static_cast<int>(s);
+    return lowest_severity.load(std::memory_order_relaxed) <= static_cast<int>(s);
 }
 
 void LogSink::setSeverity(Severity s)
 {
     severity.store(static_cast<int>(s));
+    applyThresholds();
+}
+
+void LogSink::setModuleSeverity(std::string const& module, Severity s)
+{
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        registry().overrides[module] = static_cast<int>(s);
+    }
+
+    applyThresholds();
+}
+
+void LogSink::clearModuleSeverity(std::string const& module)
+{
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        registry().overrides.erase(module);
+    }
+
+    applyThresholds();
+}
+
+std::atomic<int>& LogSink::moduleThreshold(char const* module)
+{
+    auto& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    auto [it, inserted] = reg.modules.try_emplace(module, severity_off);
+    if (inserted) {
+        it->second.store(reg.thresholdFor(it->first));
+    }
+
+    return it->second;
+}
+
+void LogSink::onThresholdChange(std::function<void()> fn)
+{
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().listeners.push_back(std::move(fn));
+}
+
+void LogSink::applyThresholds()
+{
+    {
+        auto& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+
+        reg.active = LogSink::singleton == this && backend_count.load() > 0;
+        reg.global = severity.load();
+
+        int lowest = reg.global;
+        for (auto const& module : reg.overrides) {
+            lowest = std::min(lowest, module.second);
+        }
+        lowest_severity.store(lowest);
+
+        for (auto& module : reg.modules) {
+            module.second.store(reg.thresholdFor(module.first));
+        }
+    }
+
+    notifyListeners();
 }
 
 bool LogSink::hasInstance() noexcept
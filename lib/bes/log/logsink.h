@@ -9,8 +9,10 @@
 #include <shared_mutex>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 
 #include "model.h"
+#include "throttle.h"
 
 namespace bes::log {
 
@@ -38,41 +40,100 @@ class LogSink
 
     void log(LogRecord const& log_record);
 
+    /**
+     * Log a record on behalf of a named source, applying the source's throttle if it has one.
+     */
+    void log(char const* source, LogRecord const& log_record);
+
     template <class T, class... Args>
     long addBackend(Args&&... args);
 
     void removeBackend(long const& id);
     void clearBackends();
-    std::size_t backendCount();
+    [[nodiscard]] std::size_t backendCount() const;
 
     void setSeverity(bes::log::Severity s);
 
+    /**
+     * Override the global severity for a single module; module names match the library names (eg "fastcgi",
+     * "web.redis"), see BES_LOG_MODULE.
+     *
+     * May be changed at any time, statements in the module pick up the new threshold immediately.
+     */
+    void setModuleSeverity(std::string const& module, bes::log::Severity s);
+    void clearModuleSeverity(std::string const& module);
+
+    /**
+     * Rate limit and de-duplicate records logged under `source` (see BES_LOG_SOURCE), such as a third-party driver's
+     * log callback. Replaces any existing throttle for the source.
+     */
+    void setSourceThrottle(std::string const& source, ThrottleConfig config);
+    void clearSourceThrottle(std::string const& source);
+    [[nodiscard]] bool hasSourceThrottle(std::string const& source) const;
+
+    /**
+     * Report any counts held by source throttles, then block until every backend has written the records it has
+     * received.
+     */
+    void flush();
+
+    /**
+     * Ask every backend to reopen its output files, called by the kernel on SIGHUP.
+     */
+    void reopen();
+
     /**
      * Return true if this object has no backends.
      */
     [[nodiscard]] bool empty() const;
 
     /**
-     * Return false if we're not logging at this severity
+     * Return false if we're not logging at this severity in any module: the global severity, lowered by any module
+     * that has been set below it.
      */
     [[nodiscard]] bool enabled(Severity s) const;
 
+    /**
+     * Lowest severity that will be logged by statements compiled into `module`, consulted by the BES_LOG macros before
+     * anything else is constructed.
+     *
+     * The returned reference is valid for the life of the process, regardless of LogSink instances coming and going.
+     */
+    static std::atomic<int>& moduleThreshold(char const* module);
+
+    /**
+     * Call `fn` whenever module thresholds may have changed: as a sink comes and goes, its backends change, or a
+     * severity is set. For passing our levels on to a third-party library that filters its own logging.
+     *
+     * Listeners are process-wide and live for the rest of the process. They may be called with the sink's locks held,
+     * so must not log.
+     */
+    static void onThresholdChange(std::function<void()> fn);
+
    private:
     std::shared_mutex backend_mutex;
-    std::atomic<bool> has_backends{false};
+    std::atomic<std::size_t> backend_count{0};
+    long next_backend_id = 0;
     std::map<long, std::shared_ptr<bes::log::backend::LogBackend>> backends;
     std::atomic<int> severity{0};
+    std::atomic<int> lowest_severity{0};
+    mutable std::shared_mutex throttle_mutex;
+    std::map<std::string, std::unique_ptr<Throttle>, std::less<>> throttles;
     static LogSink* singleton;
+
+    /// Push the current severity and backend state to every module threshold
+    void applyThresholds();
 };
 
 template <class T, class... Args>
 long LogSink::addBackend(Args&&... args)
 {
     std::lock_guard<std::shared_mutex> lock(backend_mutex);
-    static long id = 0;
+    auto id = next_backend_id++;
     backends[id] = std::make_shared<T>(std::forward<Args>(args)...);
-    has_backends.store(true);
-    return id++;
+    backend_count.store(backends.size());
+    applyThresholds();
+    return id;
 }
 
 }  // namespace bes::log
@@ -1,5 +1,9 @@
 #include "model.h"
 
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+
 std::ostream &operator<<(std::ostream &stream, bes::log::Severity const &s)
 {
     switch (s) {
@@ -37,6 +41,24 @@ std::ostream &operator<<(std::ostream &stream, bes::log::Severity const &s)
     return stream;
 }
 
+bes::log::Severity bes::log::parseSeverity(std::string const &name)
+{
+    std::string upper(name);
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) {
+        return std::toupper(c);
+    });
+
+    for (int i = static_cast<int>(Severity::TRACE); i <= static_cast<int>(Severity::FATAL); ++i) {
+        std::ostringstream ss;
+        ss << static_cast<Severity>(i);
+        if (ss.str() == upper) {
+            return static_cast<Severity>(i);
+        }
+    }
+
+    throw std::invalid_argument("Unknown log severity: " + name);
+}
+
 std::ostream &bes::log::LogRecord::str(std::ostream &stream, bes::log::LogFormat f) const
 {
     switch (f) {
@@ -65,19 +87,24 @@ std::ostream &bes::log::LogRecord::str(std::ostream &stream, bes::log::LogFormat
 /**
  * Formatter for our time-point.
  *
- * NB: We have thread safety issues due to the std::localtime invocation, this function should be rebuilt with the
- *     availability of C++20 and it's improved chrono libraries.
- *
- * https://en.cppreference.com/w/cpp/io/manip/put_time
+ * Uses the thread-safe localtime_r(), and caches the rendered string per thread as consecutive records almost always
+ * fall within the same second; converting to local time is far more expensive than the rest of the record.
  */
 std::ostream &bes::log::LogRecord::fmt_tp(std::ostream &stream) const
 {
+    thread_local std::time_t cached_time = -1;
+    thread_local char cached_str[32] = {};
+
     std::time_t time = std::chrono::system_clock::to_time_t(timestamp);
 
-    // FIXME: std::localtime is not thread safe
-    std::tm time_tm = *std::localtime(&time);
+    if (time != cached_time) {
+        std::tm time_tm = {};
+        ::localtime_r(&time, &time_tm);
+        std::strftime(cached_str, sizeof(cached_str), "%F %T", &time_tm);
+        cached_time = time;
+    }
 
-    stream << std::put_time(&time_tm, "%F %T");
+    stream << cached_str;
 
     return stream;
 }
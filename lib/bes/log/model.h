@@ -9,6 +9,7 @@
 #include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <vector>
 
 namespace bes::log {
 
@@ -49,6 +50,16 @@ enum class Severity : int
     //    MAX = Severity::FATAL,
 };
 
+/**
+ * Threshold value that disables logging entirely.
+ */
+constexpr int severity_off = static_cast<int>(Severity::FATAL) + 1;
+
+/**
+ * Parse a severity name (case-insensitive, eg "debug" or "WARNING"); throws std::invalid_argument for unknown names.
+ */
+Severity parseSeverity(std::string const &name);
+
 /**
  * Quick format selection for text backends.
  */
@@ -83,6 +94,13 @@ class LogRecord
     std::chrono::system_clock::time_point timestamp;
     std::string message;
 
+    /// The statement's __FILE__ literal, which with the line number identifies its call site without comparing strings;
+    /// null for records not built by a log statement
+    char const *site = nullptr;
+
+    /// Set on a structured statement that has already been written to the binary log in its raw form
+    bool binary_logged = false;
+
     ::std::ostream &str(::std::ostream &stream, LogFormat f) const;
 
    private:
@@ -99,6 +117,29 @@ class LogBackend
     virtual ~LogBackend() = default;
 
     virtual void process(LogRecord const &log_record) = 0;
+
+    /**
+     * Process a batch of records, called by the AsyncLogBackend writer thread.
+     *
+     * Backends that can write a batch more efficiently than a record at a time (eg, with a single buffered write)
+     * should override this.
+     */
+    virtual void processBatch(std::vector<LogRecord> const &batch)
+    {
+        for (auto const &record : batch) {
+            process(record);
+        }
+    }
+
+    /**
+     * Block until all records received so far have been written.
+     */
+    virtual void flush() {}
+
+    /**
+     * Reopen any files held by the backend, such as after they have been moved by logrotate.
+     */
+    virtual void reopen() {}
 };
 }  // namespace backend
 
@@ -116,17 +157,3 @@ struct NullStream : ::std::ostringstream
 
 // Output Severity as a human-readable string
 std::ostream &operator<<(std::ostream &stream, bes::log::Severity const &s);
-
-/**
- * Create a log entry with a fully-qualified log level.
- */
-#define BES_LOG_LVL(level)                                                                                    \
-    for (auto BES_LOG_INST = ::bes::log::Logger(level, __func__, __FILE__, __LINE__); BES_LOG_INST.enabled(); \
-         BES_LOG_INST.dispatch())                                                                             \
-    BES_LOG_INST.stream()
-
-/**
- * Primary entry-point for logging, allows short-hand severity:
- *      BES_LOG(INFO) << "Test Log";
- */
-#define BES_LOG(level) BES_LOG_LVL(::bes::log::Severity::level)
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace bes::log {
+
+/**
+ * Bounded, lock-free multi-producer ring buffer.
+ *
+ * Each cell carries a sequence number which tells a producer or consumer whether the cell is ready for it, so claiming
+ * a slot is a single CAS on the head or tail counter and nothing ever blocks. Any number of threads may push, the log
+ * writer is the only consumer.
+ *
+ * Capacity is rounded up to a power of two.
+ */
+template <class T>
+class RingBuffer
+{
+   public:
+    explicit RingBuffer(std::size_t capacity);
+
+    RingBuffer(RingBuffer const&) = delete;
+    RingBuffer& operator=(RingBuffer const&) = delete;
+
+    /**
+     * Move an item into the buffer, returns false without modifying `item` if the buffer is full.
+     */
+    bool tryPush(T&& item);
+
+    /**
+     * Move the oldest item out of the buffer, returns false if the buffer is empty.
+     */
+    bool tryPop(T& item);
+
+    [[nodiscard]] bool empty() const;
+
+    [[nodiscard]] std::size_t capacity() const;
+
+   private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    // Keep the producer and consumer counters on separate cache lines
+    static constexpr std::size_t cache_line = 64;
+
+    std::size_t const mask;
+    std::unique_ptr<Cell[]> cells;
+
+    alignas(cache_line) std::atomic<std::size_t> head{0};
+    alignas(cache_line) std::atomic<std::size_t> tail{0};
+};
+
+template <class T>
+RingBuffer<T>::RingBuffer(std::size_t capacity)
+    : mask([capacity] {
+          if (capacity < 2) {
+              throw std::invalid_argument("Ring buffer capacity must be at least 2");
+          }
+
+          std::size_t size = 2;
+          while (size < capacity) {
+              size <<= 1;
+          }
+
+          return size - 1;
+      }()),
+      cells(new Cell[mask + 1])
+{
+    for (std::size_t i = 0; i <= mask; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <class T>
+bool RingBuffer<T>::tryPush(T&& item)
+{
+    std::size_t pos = head.load(std::memory_order_relaxed);
+
+    for (;;) {
+        Cell& cell = cells[pos & mask];
+        std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.data = std::move(item);
+                cell.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // The consumer has not yet released this cell from the previous lap
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <class T>
+bool RingBuffer<T>::tryPop(T& item)
+{
+    std::size_t pos = tail.load(std::memory_order_relaxed);
+
+    for (;;) {
+        Cell& cell = cells[pos & mask];
+        std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+        if (diff == 0) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                item = std::move(cell.data);
+                cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = tail.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <class T>
+bool RingBuffer<T>::empty() const
+{
+    std::size_t pos = tail.load(std::memory_order_acquire);
+    return cells[pos & mask].sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+template <class T>
+std::size_t RingBuffer<T>::capacity() const
+{
+    return mask + 1;
+}
+
+}  // namespace bes::log
@@ -0,0 +1,10 @@
+#include "throttle.h"
+
+using namespace bes::log;
+
+Throttle::Throttle(ThrottleConfig config) : cfg(config), tokens(config.burst), last_refill(clock::now()) {}
+
+ThrottleConfig const& Throttle::config() const
+{
+    return cfg;
+}
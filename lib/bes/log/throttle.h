@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "model.h"
+
+namespace bes::log {
+
+/**
+ * Limits applied to a single log source, see LogSink::setSourceThrottle().
+ */
+struct ThrottleConfig
+{
+    // Sustained records per second, zero for no rate limit
+    double rate = 0;
+
+    // Records that may be logged in a burst before the rate applies
+    unsigned burst = 10;
+
+    // Collapse consecutive identical messages into a "last message repeated" count
+    bool dedup = true;
+
+    // While a message keeps repeating, report the count at this interval
+    std::chrono::seconds repeat_report{30};
+};
+
+/**
+ * Token-bucket rate limiter with duplicate suppression for one log source.
+ *
+ * Records that pass are handed to an `emit(Severity, std::string_view message)` callback, preceded by any summary of
+ * what was suppressed before them. Thread-safe; emit is called with the throttle's lock held so summaries and records
+ * stay in order.
+ */
+class Throttle
+{
+   public:
+    using clock = std::chrono::steady_clock;
+
+    explicit Throttle(ThrottleConfig config);
+
+    template <class F>
+    void admit(Severity severity, std::string_view message, F&& emit, clock::time_point now = clock::now());
+
+    /**
+     * Emit any pending repeat or suppression counts, so that they aren't lost when a flood stops.
+     */
+    template <class F>
+    void drain(F&& emit);
+
+    [[nodiscard]] ThrottleConfig const& config() const;
+
+   private:
+    ThrottleConfig cfg;
+
+    std::mutex mutex;
+    double tokens;
+    clock::time_point last_refill;
+
+    std::string last_message;
+    Severity last_severity = Severity::INFO;
+    std::uint64_t repeats = 0;
+    clock::time_point repeat_since;
+
+    std::uint64_t rate_dropped = 0;
+
+    template <class F>
+    void reportRepeats(F& emit);
+
+    template <class F>
+    void reportDropped(F& emit);
+};
+
+template <class F>
+void Throttle::admit(Severity severity, std::string_view message, F&& emit, clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (cfg.rate > 0) {
+        tokens = std::min<double>(cfg.burst, tokens + cfg.rate * std::chrono::duration<double>(now - last_refill).count());
+        last_refill = now;
+    }
+
+    if (cfg.dedup && !last_message.empty() && severity == last_severity && message == last_message) {
+        ++repeats;
+        if (now - repeat_since >= cfg.repeat_report) {
+            reportRepeats(emit);
+            repeat_since = now;
+        }
+        return;
+    }
+
+    reportRepeats(emit);
+
+    if (cfg.dedup) {
+        last_message.assign(message);
+        last_severity = severity;
+        repeat_since = now;
+    }
+
+    if (cfg.rate > 0) {
+        if (tokens < 1) {
+            ++rate_dropped;
+            return;
+        }
+        tokens -= 1;
+    }
+
+    reportDropped(emit);
+    emit(severity, message);
+}
+
+template <class F>
+void Throttle::drain(F&& emit)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    reportRepeats(emit);
+    reportDropped(emit);
+}
+
+template <class F>
+void Throttle::reportRepeats(F& emit)
+{
+    if (repeats == 0) {
+        return;
+    }
+
+    emit(last_severity, "Last message repeated " + std::to_string(repeats) + " times");
+    repeats = 0;
+}
+
+template <class F>
+void Throttle::reportDropped(F& emit)
+{
+    if (rate_dropped == 0) {
+        return;
+    }
+
+    emit(Severity::WARNING, std::to_string(rate_dropped) + " messages suppressed by rate limit");
+    rate_dropped = 0;
+}
+
+}  // namespace bes::log
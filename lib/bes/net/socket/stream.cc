@@ -1,5 +1,8 @@
 #include "stream.h"
 
+#include <algorithm>
+#include <climits>
+
 using namespace bes::net::socket;
 
 Stream::Stream(int s)
@@ -136,6 +139,30 @@ void Stream::writeBytes(const void* buf, size_t len)
     } while (write_count != len);
 }
 
+void Stream::writeVector(iovec* iov, size_t count)
+{
+    while (count) {
+        errno = 0;
+        auto r = ::writev(sock, iov, static_cast<int>(std::min<size_t>(count, IOV_MAX)));
+        if (r == -1) {
+            throw SocketException("Socket write failed");
+        }
+
+        // Skip what was written, which may end part way through a buffer
+        auto written = static_cast<size_t>(r);
+        while (count && written >= iov->iov_len) {
+            written -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+
+        if (count) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
+    }
+}
+
 Stream::~Stream()
 {
     stop();
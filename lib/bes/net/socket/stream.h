@@ -1,5 +1,7 @@
 #pragma once
 
+#include <sys/uio.h>
+
 #include <atomic>
 #include <functional>
 #include <thread>
@@ -46,6 +48,12 @@ class Stream : public Socket
      */
     void writeBytes(void const* buf, size_t len);
 
+    /**
+     * Write `count` buffers to the stream in order, in as few syscalls as the kernel allows. The buffers in `iov` are
+     * advanced past what has been written as the write progresses.
+     */
+    void writeVector(iovec* iov, size_t count);
+
    protected:
     socket_opt_t getSocketOptions() override;
 
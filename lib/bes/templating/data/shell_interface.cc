@@ -7,9 +7,42 @@ using namespace bes::templating::data;
  *
  * Not all objects have a renderable 'main value', it's OK not to implement this.
  */
+namespace {
+
+// The shell whose default render(std::ostream&) is trying the std::ostringstream form, on this thread
+thread_local ShellInterface const* legacy_render = nullptr;
+
+}  // namespace
+
+void ShellInterface::render(std::ostream& str) const
+{
+    // In case this shell only overrides the deprecated std::ostringstream form
+    std::ostringstream buffer;
+    auto outer = legacy_render;
+    legacy_render = this;
+
+    try {
+        render(buffer);
+    } catch (...) {
+        legacy_render = outer;
+        throw;
+    }
+
+    legacy_render = outer;
+    str << buffer.str();
+}
+
+/**
+ * Deprecated, forwards to render(std::ostream&) - unless that's the default trying this form, in which case this shell
+ * overrides neither.
+ */
 void ShellInterface::render(std::ostringstream& str) const
 {
-    throw UnknownTypeException(BES_TEMPLATING_NO_SHELL);
+    if (legacy_render == this) {
+        throw UnknownTypeException(BES_TEMPLATING_NO_SHELL);
+    }
+
+    render(static_cast<std::ostream&>(str));
 }
 
 /**
@@ -20,30 +53,58 @@ std::shared_ptr<ShellInterface> ShellInterface::childNode(std::string const& key
     throw UnknownTypeException(std::string(BES_TEMPLATING_NO_SHELL) + " (" + key + ")");
 }
 
+namespace {
+
 /**
  * We'll first attempt this as an int comparison, then try the floating-point comparison if that fails. We'll also
  * give priority to matching types before transforming an int to a float.
- *
- * If either objects cannot output either an int or a float, this function will throw a ValueErrorException.
  */
-bool ShellInterface::operator<(ShellInterface const& rhs) const
+template <class Op>
+std::optional<bool> numericCompare(ShellInterface const& lhs, ShellInterface const& rhs, Op op)
 {
-    try {
-        long left = asInt();
-
-        try {
-            return left < rhs.asInt();
-        } catch (ValueErrorException const&) {
-            return (double)left < rhs.asFloat();
+    if (auto left = lhs.tryInt()) {
+        if (auto right = rhs.tryInt()) {
+            return op(*left, *right);
+        } else if (auto right_float = rhs.tryFloat()) {
+            return op(static_cast<double>(*left), *right_float);
         }
-    } catch (ValueErrorException const&) {
-        double left = asFloat();
-        try {
-            return left < rhs.asFloat();
-        } catch (ValueErrorException const&) {
-            return left < (double)(rhs.asInt());
+    } else if (auto left_float = lhs.tryFloat()) {
+        if (auto right_float = rhs.tryFloat()) {
+            return op(*left_float, *right_float);
+        } else if (auto right = rhs.tryInt()) {
+            return op(*left_float, static_cast<double>(*right));
         }
     }
+
+    return std::nullopt;
+}
+
+}  // namespace
+
+std::optional<bool> ShellInterface::lessThan(ShellInterface const& rhs) const
+{
+    return numericCompare(*this, rhs, [](auto a, auto b) {
+        return a < b;
+    });
+}
+
+std::optional<bool> ShellInterface::equals(ShellInterface const& rhs) const
+{
+    return numericCompare(*this, rhs, [](auto a, auto b) {
+        return a == b;
+    });
+}
+
+/**
+ * If either objects cannot output either an int or a float, this function will throw a ValueErrorException.
+ */
+bool ShellInterface::operator<(ShellInterface const& rhs) const
+{
+    if (auto result = lessThan(rhs)) {
+        return *result;
+    }
+
+    throw ValueErrorException(BES_TEMPLATING_NOT_COMPATIBLE);
 }
 
 bool ShellInterface::operator>(ShellInterface const& rhs) const
@@ -63,26 +124,16 @@ bool ShellInterface::operator>=(ShellInterface const& rhs) const
 
 /**
  * The equality operators will use the comparison operator logic to calculate a numeric match only. If this fails
- * with a ValueErrorException, you could try rendering the objects to do a string comparison.
+ * with a ValueErrorException, you could try rendering the objects to do a string comparison - or use equals() and
+ * skip the exception.
  */
 bool ShellInterface::operator==(ShellInterface const& rhs) const
 {
-    try {
-        long left = asInt();
-
-        try {
-            return left == rhs.asInt();
-        } catch (ValueErrorException const&) {
-            return (double)left == rhs.asFloat();
-        }
-    } catch (ValueErrorException const&) {
-        double left = asFloat();
-        try {
-            return left == rhs.asFloat();
-        } catch (ValueErrorException const&) {
-            return left == (double)(rhs.asInt());
-        }
+    if (auto result = equals(rhs)) {
+        return *result;
     }
+
+    throw ValueErrorException(BES_TEMPLATING_NOT_COMPATIBLE);
 }
 
 bool ShellInterface::operator!=(ShellInterface const& rhs) const
@@ -119,6 +170,24 @@ double ShellInterface::asFloat() const
     throw ValueErrorException(BES_TEMPLATING_NOT_COMPATIBLE);
 }
 
+std::optional<long> ShellInterface::tryInt() const
+{
+    try {
+        return asInt();
+    } catch (ValueErrorException const&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<double> ShellInterface::tryFloat() const
+{
+    try {
+        return asFloat();
+    } catch (ValueErrorException const&) {
+        return std::nullopt;
+    }
+}
+
 /**
  * Retrieve the size of the data contained within an iterable object.
  */
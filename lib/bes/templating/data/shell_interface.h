@@ -7,6 +7,7 @@
 #define BES_TEMPLATING_NOT_COMPATIBLE "Not a compatible conversion"
 
 #include <memory>
+#include <optional>
 #include <sstream>
 
 #include "../exception.h"
@@ -21,6 +22,14 @@ class ShellInterface
      *
      * Not all objects have a renderable 'main value', it's OK not to implement this.
      */
+    virtual void render(std::ostream& str) const;
+
+    /**
+     * Deprecated: shells used to render into a std::ostringstream, override render(std::ostream&) instead.
+     *
+     * A shell that still overrides only this form keeps working, with its output buffered and then copied into the
+     * template's stream; a call with a std::ostringstream on a shell that doesn't is forwarded to the stream form.
+     */
     virtual void render(std::ostringstream& str) const;
 
     /**
@@ -48,6 +57,23 @@ class ShellInterface
      */
     [[nodiscard]] virtual double asFloat() const;
 
+    /**
+     * Non-throwing forms of asInt() and asFloat(), returning nullopt where there is no such representation.
+     *
+     * The defaults call asInt()/asFloat() and catch the ValueErrorException, so existing shells keep working. If you
+     * implement either of those, override these as well so that comparisons against your type don't need to unwind.
+     */
+    [[nodiscard]] virtual std::optional<long> tryInt() const;
+    [[nodiscard]] virtual std::optional<double> tryFloat() const;
+
+    /**
+     * Numeric comparisons, returning nullopt if either side has no numeric representation.
+     *
+     * The comparison operators use these and throw a ValueErrorException on nullopt.
+     */
+    [[nodiscard]] std::optional<bool> lessThan(ShellInterface const& rhs) const;
+    [[nodiscard]] std::optional<bool> equals(ShellInterface const& rhs) const;
+
     /**
      * Retrieve the size of the data contained within an iterable object.
      */
@@ -70,13 +96,13 @@ class ShellInterface
     virtual bool operator==(ShellInterface const& rhs) const;
     virtual bool operator!=(ShellInterface const& rhs) const;
 
-    friend inline std::ostringstream& operator<<(std::ostringstream& css, ShellInterface const& shell)
+    friend inline std::ostream& operator<<(std::ostream& css, ShellInterface const& shell)
     {
         shell.render(css);
         return css;
     }
 
-    friend inline std::ostringstream& operator<<(std::ostringstream& css, ShellInterface const* shell)
+    friend inline std::ostream& operator<<(std::ostream& css, ShellInterface const* shell)
     {
         shell->render(css);
         return css;
@@ -2,6 +2,7 @@
 
 #include <any>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -28,7 +29,7 @@ class SimpleShell : public ShellInterface
    public:
     SimpleShell(T item) : item(item) {}
 
-    inline void render(std::ostringstream& str) const override
+    inline void render(std::ostream& str) const override
     {
         str << item;
     }
@@ -46,7 +47,7 @@ class IntegerShell : public ShellInterface
    public:
     IntegerShell(T item) : item(item) {}
 
-    inline void render(std::ostringstream& str) const override
+    inline void render(std::ostream& str) const override
     {
         str << item;
     }
@@ -61,6 +62,16 @@ class IntegerShell : public ShellInterface
         return static_cast<long>(item);
     }
 
+    std::optional<long> tryInt() const override
+    {
+        return static_cast<long>(item);
+    }
+
+    std::optional<double> tryFloat() const override
+    {
+        return std::nullopt;
+    }
+
    protected:
     T item;
 };
@@ -74,7 +85,7 @@ class FloatShell : public ShellInterface
    public:
     FloatShell(T item) : item(item) {}
 
-    inline void render(std::ostringstream& str) const override
+    inline void render(std::ostream& str) const override
     {
         str << item;
     }
@@ -89,6 +100,16 @@ class FloatShell : public ShellInterface
         return static_cast<double>(item);
     }
 
+    std::optional<long> tryInt() const override
+    {
+        return std::nullopt;
+    }
+
+    std::optional<double> tryFloat() const override
+    {
+        return static_cast<double>(item);
+    }
+
    protected:
     T item;
 };
@@ -214,7 +235,7 @@ class StandardShell<bool> : public ShellInterface
    public:
     StandardShell(bool item) : item(item) {}
 
-    inline void render(std::ostringstream& str) const override
+    inline void render(std::ostream& str) const override
     {
         str << std::boolalpha << item;
     }
@@ -229,6 +250,16 @@ class StandardShell<bool> : public ShellInterface
         return item ? 1 : 0;
     }
 
+    std::optional<long> tryInt() const override
+    {
+        return asInt();
+    }
+
+    std::optional<double> tryFloat() const override
+    {
+        return std::nullopt;
+    }
+
    protected:
     bool item;
 };
@@ -253,6 +284,16 @@ class StandardShell<std::string> : public SimpleShell<std::string>
     {
         return item.length() > 0;
     }
+
+    std::optional<long> tryInt() const override
+    {
+        return std::nullopt;
+    }
+
+    std::optional<double> tryFloat() const override
+    {
+        return std::nullopt;
+    }
 };
 
 /// STRING const*
@@ -262,7 +303,7 @@ class StandardShell<std::string const*> : public SimpleShell<std::string const*>
     using SimpleShell::SimpleShell;
 
    public:
-    void render(std::ostringstream& str) const override
+    void render(std::ostream& str) const override
     {
         str << *item;
     }
@@ -280,6 +321,16 @@ class StandardShell<std::string const*> : public SimpleShell<std::string const*>
     {
         return item->length() > 0;
     }
+
+    std::optional<long> tryInt() const override
+    {
+        return std::nullopt;
+    }
+
+    std::optional<double> tryFloat() const override
+    {
+        return std::nullopt;
+    }
 };
 
 /// SHARED_PTR<STRING>
@@ -289,7 +340,7 @@ class StandardShell<std::shared_ptr<std::string>> : public SimpleShell<std::shar
     using SimpleShell::SimpleShell;
 
    public:
-    void render(std::ostringstream& str) const override
+    void render(std::ostream& str) const override
     {
         str << *item;
     }
@@ -307,6 +358,16 @@ class StandardShell<std::shared_ptr<std::string>> : public SimpleShell<std::shar
     {
         return item->length() > 0;
     }
+
+    std::optional<long> tryInt() const override
+    {
+        return std::nullopt;
+    }
+
+    std::optional<double> tryFloat() const override
+    {
+        return std::nullopt;
+    }
 };
 
 /// VECTOR<STRING>
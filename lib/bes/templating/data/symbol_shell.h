@@ -14,7 +14,7 @@ class SymbolShell : public ShellInterface
    public:
     SymbolShell(syntax::Symbol s, Context& ctx) : symbol(s), context(ctx) {}
 
-    void render(std::ostringstream& str) const override
+    void render(std::ostream& str) const override
     {
         GetItemShell()->render(str);
     }
@@ -53,6 +53,16 @@ class SymbolShell : public ShellInterface
         return GetItemShell()->asFloat();
     }
 
+    std::optional<long> tryInt() const override
+    {
+        return GetItemShell()->tryInt();
+    }
+
+    std::optional<double> tryFloat() const override
+    {
+        return GetItemShell()->tryFloat();
+    }
+
    private:
     /**
      * Recursive function to pull child items from the context
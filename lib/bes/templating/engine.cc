@@ -64,10 +64,17 @@ void Engine::loadString(std::string const& name, std::string const& data)
 }
 
 std::string Engine::render(std::string const& name, data::Context& context)
+{
+    std::ostringstream str;
+    render(name, context, str);
+
+    return str.str();
+}
+
+void Engine::render(std::string const& name, data::Context& context, std::ostream& out)
 {
     std::shared_lock<std::shared_mutex> lock;
 
-    std::ostringstream str;
     std::shared_ptr<node::RootNode const> root;
     std::unordered_map<std::string, bool> recursion_check;
     recursion_check[name] = true;
@@ -100,12 +107,10 @@ std::string Engine::render(std::string const& name, data::Context& context)
     } while (root->extends());
 
     try {
-        root->render(str, context, ts);
+        root->render(out, context, ts);
     } catch (std::exception& e) {
         throw TemplateException(e.what());
     }
-
-    return str.str();
 }
 
 void Engine::addFilter(std::string const& name, Filter filter)
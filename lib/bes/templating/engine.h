@@ -48,6 +48,12 @@ class Engine : public RenderingInterface
      */
     std::string render(std::string const& name, data::Context& context) override;
 
+    /**
+     * Render a template into a stream. With a bes::OutputStream the output lands in its buffer as it is rendered, with
+     * no intermediate string.
+     */
+    void render(std::string const& name, data::Context& context, std::ostream& out);
+
     bes::FileFinder search_path;
 
    protected:
@@ -14,7 +14,7 @@ class BlockNode : public NamedNode
    public:
     using NamedNode::NamedNode;
 
-    void render(std::ostringstream& ss, data::Context& ctx, data::TemplateStack& ts) const override
+    void render(std::ostream& ss, data::Context& ctx, data::TemplateStack& ts) const override
     {
         ctx.increaseStack();
 
@@ -18,7 +18,7 @@ class ForNode : public ExpressionNode
    public:
     using ExpressionNode::ExpressionNode;
 
-    void render(std::ostringstream& ss, data::Context& ctx, data::TemplateStack& ts) const override
+    void render(std::ostream& ss, data::Context& ctx, data::TemplateStack& ts) const override
     {
         ctx.increaseStack();
         // Guarantees of symbol types is done during parsing
@@ -16,7 +16,7 @@ class IfNode : public ExpressionNode
    public:
     using ExpressionNode::ExpressionNode;
 
-    void render(std::ostringstream& ss, data::Context& ctx, data::TemplateStack& ts) const override
+    void render(std::ostream& ss, data::Context& ctx, data::TemplateStack& ts) const override
     {
         using CtrlType = bes::templating::syntax::Expression::Clause;
 
@@ -76,17 +76,16 @@ class IfNode : public ExpressionNode
                 // TODO:
                 throw TemplateException("Unimplemented: operator IN");
             case Expression::Operator::EQUALS:
-                try {
-                    condition_state = data::SymbolShell(expr.left, ctx) == data::SymbolShell(expr.right, ctx);
-                } catch (ValueErrorException const&) {
+            case Expression::Operator::NOT_EQUALS:
+                // Compare numerically where both sides are numbers, else fall back to comparing the rendered strings
+                if (auto equal = data::SymbolShell(expr.left, ctx).equals(data::SymbolShell(expr.right, ctx))) {
+                    condition_state = *equal;
+                } else {
                     condition_state = renderSymbol(expr.left, ctx) == renderSymbol(expr.right, ctx);
                 }
-                break;
-            case Expression::Operator::NOT_EQUALS:
-                try {
-                    condition_state = data::SymbolShell(expr.left, ctx) != data::SymbolShell(expr.right, ctx);
-                } catch (ValueErrorException const&) {
-                    condition_state = renderSymbol(expr.left, ctx) != renderSymbol(expr.right, ctx);
+
+                if (expr.op == Expression::Operator::NOT_EQUALS) {
+                    condition_state = !condition_state;
                 }
                 break;
             case Expression::Operator::LT:
@@ -14,7 +14,7 @@ class IncludeNode : public NamedNode
    public:
     using NamedNode::NamedNode;
 
-    void render(std::ostringstream& ss, bes::templating::data::Context& ctx, data::TemplateStack& ts) const override
+    void render(std::ostream& ss, bes::templating::data::Context& ctx, data::TemplateStack& ts) const override
     {
         ctx.increaseStack();
 
@@ -35,7 +35,7 @@ class StandardShell<node::loop> : public ShellInterface
    public:
     explicit StandardShell(const node::loop& item) : item(item) {}
 
-    inline void render(std::ostringstream& ss) const override
+    inline void render(std::ostream& ss) const override
     {
         throw TemplateException("Cannot render the loop context");
     }
@@ -31,7 +31,7 @@ class MacroNode : public ExpressionNode
      *
      * When we hit this, we just add the block to the TemplateStack for later referencing.
      */
-    void render(std::ostringstream& ss, data::Context& ctx, data::TemplateStack& ts) const override
+    void render(std::ostream& ss, data::Context& ctx, data::TemplateStack& ts) const override
     {
         ctx.addMacro(expr.left.value<std::string>(), dynamic_cast<Node const*>(this));
     }
@@ -39,7 +39,7 @@ class MacroNode : public ExpressionNode
     /**
      * A ValueNode has requested we render our actual content.
      */
-    void menderMacro(std::ostringstream& ss, data::Context& ctx, data::TemplateStack& ts,
+    void menderMacro(std::ostream& ss, data::Context& ctx, data::TemplateStack& ts,
                      std::vector<std::any> const& args) const
     {
         if (argCount() != args.size()) {
@@ -15,7 +15,7 @@ class Node
    public:
     explicit Node(Node const* const root = nullptr) : root(root) {}
 
-    virtual void render(std::ostringstream&, data::Context&, data::TemplateStack&) const = 0;
+    virtual void render(std::ostream&, data::Context&, data::TemplateStack&) const = 0;
 
     inline void addNode(std::shared_ptr<Node> const& node)
     {
@@ -4,7 +4,7 @@
 
 using namespace bes::templating::node;
 
-void RootNode::render(std::ostringstream& ss, data::Context& ctx, data::TemplateStack& ts) const
+void RootNode::render(std::ostream& ss, data::Context& ctx, data::TemplateStack& ts) const
 {
     for (auto& node : child_nodes) {
         node->render(ss, ctx, ts);
@@ -59,13 +59,14 @@ bool RootNode::hasBlock(std::string const& key) const
     return block_nodes.find(key) != block_nodes.end();
 }
 
-bool RootNode::renderBlock(std::string const& key, std::ostringstream& ss, bes::templating::data::Context& ctx,
+bool RootNode::renderBlock(std::string const& key, std::ostream& ss, bes::templating::data::Context& ctx,
                            data::TemplateStack& ts) const
 {
-    try {
-        block_nodes.at(key)->render(ss, ctx, ts);
-        return true;
-    } catch (std::out_of_range const&) {
+    auto it = block_nodes.find(key);
+    if (it == block_nodes.end()) {
         return false;
     }
+
+    it->second->render(ss, ctx, ts);
+    return true;
 }
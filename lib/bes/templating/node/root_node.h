@@ -17,7 +17,7 @@ class RootNode : public NamedNode
     using NamedNode::NamedNode;
 
    public:
-    void render(std::ostringstream& ss, data::Context& ctx, data::TemplateStack& ts) const override;
+    void render(std::ostream& ss, data::Context& ctx, data::TemplateStack& ts) const override;
 
     bool extends() const;
     std::string const& extendsTemplate() const;
@@ -27,7 +27,7 @@ class RootNode : public NamedNode
     void addBlock(std::string const& key, std::shared_ptr<Node> const& node);
     void allocateBlock(std::string const& key, Node* node);
     bool hasBlock(std::string const& key) const;
-    bool renderBlock(std::string const& key, std::ostringstream& ss, data::Context& ctx, data::TemplateStack& ts) const;
+    bool renderBlock(std::string const& key, std::ostream& ss, data::Context& ctx, data::TemplateStack& ts) const;
 
     // Filters
     std::unordered_map<std::string, Filter>* filters = nullptr;
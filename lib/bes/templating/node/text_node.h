@@ -24,7 +24,7 @@ class TextNode : public Node
         bes::templating::Text::trimBack(content);
     }
 
-    void render(std::ostringstream& str, data::Context& ctx, data::TemplateStack& ts) const override
+    void render(std::ostream& str, data::Context& ctx, data::TemplateStack& ts) const override
     {
         str << content;
     }
@@ -11,7 +11,7 @@ class ValueNode : public ExpressionNode
    public:
     using ExpressionNode::ExpressionNode;
 
-    void render(std::ostringstream& ss, data::Context& ctx, data::TemplateStack& ts) const override
+    void render(std::ostream& ss, data::Context& ctx, data::TemplateStack& ts) const override
     {
         if (expr.right.symbol_type == syntax::Symbol::SymbolType::FUNCTION) {
             /// Call to macro
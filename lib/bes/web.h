@@ -1,8 +1,20 @@
 #pragma once
 
+#include "web/access_log.h"
+#include "web/binary_session_codec.h"
+#include "web/caching_session_mgr.h"
+#include "web/compression.h"
 #include "web/cookie.h"
+#include "web/etag.h"
 #include "web/exception.h"
+#include "web/header_list.h"
 #include "web/http.h"
 #include "web/mapped_router.h"
+#include "web/memory_session_mgr.h"
+#include "web/param_list.h"
+#include "web/response_cache.h"
 #include "web/session_interface.h"
+#include "web/session_stats.h"
+#include "web/static_controller.h"
 #include "web/web_server.h"
+#include "web/write_behind_session_mgr.h"
@@ -1,3 +1,5 @@
 #pragma once
 
+#include "web.redis/redis_connection_pool.h"
+#include "web.redis/redis_invalidation_bus.h"
 #include "web.redis/redis_session_mgr.h"
@@ -0,0 +1,110 @@
+#include "redis_connection_pool.h"
+
+#include <bes/log.h>
+#include <bes/web.h>
+
+#include <exception>
+
+using namespace bes::web;
+
+RedisConnectionPool::Lease::Lease(RedisConnectionPool* pool, std::unique_ptr<cpp_redis::client> client)
+    : pool(pool), client(std::move(client)), exceptions(std::uncaught_exceptions())
+{}
+
+RedisConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool(other.pool), client(std::move(other.client)), exceptions(other.exceptions)
+{}
+
+RedisConnectionPool::Lease::~Lease()
+{
+    if (client != nullptr) {
+        // Unwinding mid-exchange can leave replies in the pipeline that the next user would receive
+        pool->release(std::move(client), std::uncaught_exceptions() <= exceptions);
+    }
+}
+
+RedisConnectionPool::RedisConnectionPool(Connector connector, std::size_t size,
+                                         std::chrono::milliseconds checkout_timeout)
+    : connector(std::move(connector)), capacity(size > 0 ? size : 1), checkout_timeout(checkout_timeout)
+{
+    // Connect one up front, so that a bad configuration fails at start-up rather than on the first request
+    idle.push_back(connect());
+    open = 1;
+}
+
+RedisConnectionPool::Lease RedisConnectionPool::checkout()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    bool ready = returned_cv.wait_for(lock, checkout_timeout, [this] {
+        return !idle.empty() || open < capacity;
+    });
+
+    if (!ready) {
+        throw WebException("Timed out waiting for a Redis connection");
+    }
+
+    if (!idle.empty()) {
+        auto client = std::move(idle.back());
+        idle.pop_back();
+
+        if (client->is_connected()) {
+            return Lease(this, std::move(client));
+        }
+
+        // Dropped while idle and beyond cpp_redis' own reconnects, replace it
+        BES_LOG(WARNING) << "Replacing disconnected Redis session connection";
+        client.reset();
+    } else {
+        ++open;
+    }
+
+    // Connect outside of the lock, the slot is already counted as open
+    lock.unlock();
+
+    try {
+        return Lease(this, connect());
+    } catch (...) {
+        lock.lock();
+        --open;
+        lock.unlock();
+        returned_cv.notify_one();
+        throw;
+    }
+}
+
+std::size_t RedisConnectionPool::size() const
+{
+    return capacity;
+}
+
+std::size_t RedisConnectionPool::connected() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return open;
+}
+
+std::unique_ptr<cpp_redis::client> RedisConnectionPool::connect()
+{
+    auto client = std::make_unique<cpp_redis::client>();
+    connector(*client);
+    return client;
+}
+
+void RedisConnectionPool::release(std::unique_ptr<cpp_redis::client> client, bool healthy)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (healthy) {
+            idle.push_back(std::move(client));
+        } else {
+            --open;
+        }
+    }
+
+    returned_cv.notify_one();
+
+    // Disconnect, if discarded, outside of the lock
+    client.reset();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cpp_redis/cpp_redis>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace bes::web {
+
+/**
+ * A fixed-size pool of Redis clients.
+ *
+ * A cpp_redis client is a single pipeline: commands queued by one thread are committed by whichever thread calls
+ * `sync_commit()` next, and replies are matched to callbacks in order. Sharing one between request threads serialises
+ * them on one connection and lets one thread's commit run another's callbacks. Instead, each caller checks a client
+ * out for the length of its exchange and has it to itself.
+ *
+ * Clients are connected on demand, up to the pool size. A client that has dropped its connection is reconnected when it
+ * is next checked out, and one returned while an exception is in flight is discarded, as it may still have replies
+ * pending.
+ */
+class RedisConnectionPool
+{
+   public:
+    /// Connects a new client, throwing if it can't
+    using Connector = std::function<void(cpp_redis::client&)>;
+
+    /**
+     * Exclusive use of a client until destroyed.
+     */
+    class Lease
+    {
+       public:
+        Lease(Lease&& other) noexcept;
+        Lease(Lease const&) = delete;
+        Lease& operator=(Lease const&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease();
+
+        cpp_redis::client& operator*() const
+        {
+            return *client;
+        }
+
+        cpp_redis::client* operator->() const
+        {
+            return client.get();
+        }
+
+       private:
+        friend class RedisConnectionPool;
+        Lease(RedisConnectionPool* pool, std::unique_ptr<cpp_redis::client> client);
+
+        RedisConnectionPool* pool;
+        std::unique_ptr<cpp_redis::client> client;
+        int exceptions;
+    };
+
+    RedisConnectionPool(Connector connector, std::size_t size,
+                        std::chrono::milliseconds checkout_timeout = std::chrono::milliseconds(1000));
+
+    RedisConnectionPool(RedisConnectionPool const&) = delete;
+    RedisConnectionPool& operator=(RedisConnectionPool const&) = delete;
+
+    /**
+     * Check out a client, waiting up to the checkout timeout for one to be returned if they are all in use.
+     *
+     * Throws a WebException if none became free in time, or a new client couldn't connect.
+     */
+    [[nodiscard]] Lease checkout();
+
+    /**
+     * Maximum number of clients.
+     */
+    [[nodiscard]] std::size_t size() const;
+
+    /**
+     * Number of clients connected, idle or checked out.
+     */
+    [[nodiscard]] std::size_t connected() const;
+
+   private:
+    Connector connector;
+    std::size_t capacity;
+    std::chrono::milliseconds checkout_timeout;
+
+    mutable std::mutex mutex;
+    std::condition_variable returned_cv;
+    std::vector<std::unique_ptr<cpp_redis::client>> idle;
+    std::size_t open = 0;
+
+    std::unique_ptr<cpp_redis::client> connect();
+    void release(std::unique_ptr<cpp_redis::client> client, bool healthy);
+};
+
+}  // namespace bes::web
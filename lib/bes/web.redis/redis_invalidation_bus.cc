@@ -0,0 +1,120 @@
+#include "redis_invalidation_bus.h"
+
+using namespace bes::web;
+
+namespace {
+
+// Keep trying to reconnect a dropped connection, this often
+constexpr int32_t MAX_RECONNECTS = -1;
+constexpr uint32_t RECONNECT_INTERVAL_MS = 1000;
+
+}  // namespace
+
+RedisInvalidationBus::RedisInvalidationBus(bes::net::Address svr, std::string channel, uint32_t timeout_ms)
+    : server(std::move(svr)),
+      channel(std::move(channel)),
+      node_id(SessionInterface::generateSessionKey("N")),
+      connect_timeout(timeout_ms)
+{
+    connect(publisher);
+    connect(subscriber);
+
+    subscriber.subscribe(channel, [this](std::string const&, std::string const& msg) {
+        dispatch(msg);
+    });
+    subscriber.commit();
+}
+
+RedisInvalidationBus::RedisInvalidationBus(std::vector<bes::net::Address> const& sentinels, std::string sentinel_svc,
+                                           std::string channel, uint32_t timeout_ms)
+    : sentinels(sentinels),
+      server(bes::net::Address("", 0)),
+      sentinel_svc_name(std::move(sentinel_svc)),
+      channel(std::move(channel)),
+      node_id(SessionInterface::generateSessionKey("N")),
+      connect_timeout(timeout_ms)
+{
+    connect(publisher);
+    connect(subscriber);
+
+    subscriber.subscribe(channel, [this](std::string const&, std::string const& msg) {
+        dispatch(msg);
+    });
+    subscriber.commit();
+}
+
+RedisInvalidationBus::~RedisInvalidationBus()
+{
+    // Stop delivering messages before the handler's owner goes away
+    subscriber.disconnect(true);
+    publisher.disconnect(true);
+}
+
+/**
+ * Connect the publisher or subscriber, via the sentinels if we have them.
+ */
+template <class T>
+void RedisInvalidationBus::connect(T& redis)
+{
+    try {
+        if (server.port() == 0) {
+            for (auto const& addr : sentinels) {
+                redis.add_sentinel(addr.hasIp6Addr() ? addr.ip6Addr() : addr.ip4Addr(), addr.port());
+            }
+
+            redis.connect(sentinel_svc_name, nullptr, connect_timeout, MAX_RECONNECTS, RECONNECT_INTERVAL_MS);
+        } else {
+            redis.connect(server.hasIp6Addr() ? server.ip6Addr() : server.ip4Addr(), server.port(), nullptr,
+                          connect_timeout, MAX_RECONNECTS, RECONNECT_INTERVAL_MS);
+        }
+    } catch (std::exception const& e) {
+        BES_LOG(ERROR) << "Unable to connect session invalidation bus: " << e.what();
+        throw WebException("Unable to connect to Redis server");
+    }
+}
+
+void RedisInvalidationBus::publish(std::string const& session_id)
+{
+    std::lock_guard<std::mutex> lock(publish_mutex);
+
+    // Fire and forget, a lost invalidation only costs staleness up to the cache TTL
+    publisher.publish(channel, node_id + " " + session_id, [](cpp_redis::reply&) {});
+    publisher.commit();
+}
+
+SessionInvalidationBus::Subscription RedisInvalidationBus::subscribe(Handler handler)
+{
+    std::lock_guard<std::mutex> lock(handlers_mutex);
+    auto subscription = ++next_subscription;
+    handlers.emplace(subscription, std::move(handler));
+    return subscription;
+}
+
+void RedisInvalidationBus::unsubscribe(Subscription subscription)
+{
+    std::lock_guard<std::mutex> lock(handlers_mutex);
+    handlers.erase(subscription);
+}
+
+/**
+ * Hand a message from another node to every handler, ignoring our own.
+ */
+void RedisInvalidationBus::dispatch(std::string const& msg)
+{
+    auto sep = msg.find(' ');
+    if (sep == std::string::npos || msg.compare(0, sep, node_id) == 0) {
+        return;
+    }
+
+    auto session_id = msg.substr(sep + 1);
+
+    std::lock_guard<std::mutex> lock(handlers_mutex);
+    for (auto const& it : handlers) {
+        it.second(session_id);
+    }
+}
+
+std::string const& RedisInvalidationBus::nodeId() const
+{
+    return node_id;
+}
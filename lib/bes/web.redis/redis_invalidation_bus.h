@@ -0,0 +1,58 @@
+#pragma once
+
+#include <bes/net.h>
+#include <bes/web.h>
+
+#include <cpp_redis/cpp_redis>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bes::web {
+
+/**
+ * Session invalidations over a Redis pub/sub channel.
+ *
+ * Each node publishes the IDs of the sessions it writes, tagged with a random node ID so that it can ignore its own
+ * messages. Publishing doesn't wait for a reply. The channel is subscribed to once, and each message handed to every
+ * handler subscribed to the bus. The subscriber reconnects (and re-subscribes) if the connection drops; invalidations
+ * sent while it is down are lost, which the session cache TTL bounds.
+ */
+class RedisInvalidationBus : public SessionInvalidationBus
+{
+   public:
+    RedisInvalidationBus(bes::net::Address svr, std::string channel, uint32_t timeout_ms = 250);
+    RedisInvalidationBus(std::vector<bes::net::Address> const& sentinels, std::string sentinel_svc,
+                         std::string channel, uint32_t timeout_ms = 250);
+    ~RedisInvalidationBus() override;
+
+    void publish(std::string const& session_id) override;
+    Subscription subscribe(Handler handler) override;
+    void unsubscribe(Subscription subscription) override;
+
+    [[nodiscard]] std::string const& nodeId() const;
+
+   protected:
+    template <class T>
+    void connect(T& redis);
+    void dispatch(std::string const& msg);
+
+    cpp_redis::client publisher;
+    cpp_redis::subscriber subscriber;
+    std::mutex publish_mutex;
+
+    // Handlers are called with this held, so unsubscribing waits for a call in progress
+    std::mutex handlers_mutex;
+    std::unordered_map<Subscription, Handler> handlers;
+    Subscription next_subscription = 0;
+
+    std::vector<bes::net::Address> sentinels;
+    bes::net::Address server;
+    std::string sentinel_svc_name;
+    std::string channel;
+    std::string node_id;
+    uint32_t connect_timeout;
+};
+
+}  // namespace bes::web
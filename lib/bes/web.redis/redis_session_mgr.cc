@@ -1,32 +1,53 @@
 #include "redis_session_mgr.h"
 
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <vector>
 
 using namespace bes::web;
 
-RedisSessionMgr::RedisSessionMgr(bes::net::Address addr, uint32_t timeout_ms)
+RedisSessionMgr::RedisSessionMgr(bes::net::Address addr, uint32_t timeout_ms, std::size_t pool_size)
     : server(std::move(addr)), connect_timeout(timeout_ms)
 {
-    connect();
+    pool = std::make_unique<RedisConnectionPool>(
+        [this](cpp_redis::client& client) {
+            connect(client);
+        },
+        pool_size);
 }
 
 RedisSessionMgr::RedisSessionMgr(std::vector<bes::net::Address> const& sentinels, std::string sentinel_svc,
-                                 uint32_t timeout_ms)
-    : server(bes::net::Address("", 0)), sentinel_svc_name(std::move(sentinel_svc)), connect_timeout(timeout_ms)
+                                 uint32_t timeout_ms, std::size_t pool_size)
+    : sentinels(sentinels),
+      server(bes::net::Address("", 0)),
+      sentinel_svc_name(std::move(sentinel_svc)),
+      connect_timeout(timeout_ms)
 {
-    for (auto const& addr : sentinels) {
-        client.add_sentinel(addr.hasIp6Addr() ? addr.ip6Addr() : addr.ip4Addr(), addr.port());
-    }
-
-    connect();
+    pool = std::make_unique<RedisConnectionPool>(
+        [this](cpp_redis::client& client) {
+            connect(client);
+        },
+        pool_size);
 }
 
 RedisSessionMgr* RedisSessionMgr::fromConfig(bes::Config const& config)
 {
     auto timeout = config.getOr<uint32_t>(250, "web", "sessions", "timeout");
+    auto refresh = config.getOr<uint64_t>(0, "web", "sessions", "refresh");
+    auto pool_size = config.getOr<std::size_t>(8, "web", "sessions", "redis", "pool_size");
     auto sentinel_name = config.getOr<std::string>("", "web", "sessions", "redis", "sentinel-name");
 
+    auto format_name = config.getOr<std::string>("hash", "web", "sessions", "redis", "format");
+    RedisSessionFormat format;
+    if (format_name == "hash") {
+        format = RedisSessionFormat::HASH;
+    } else if (format_name == "binary") {
+        format = RedisSessionFormat::BINARY;
+    } else {
+        throw WebException("Unknown Redis session format: " + format_name);
+    }
+
     if (!sentinel_name.empty()) {
         // We've been given a sentinel service name, now check to see we've got at least one sentinel server, too -
         auto node = config.get<YAML::Node>("web", "sessions", "redis", "sentinels");
@@ -52,7 +73,10 @@ RedisSessionMgr* RedisSessionMgr::fromConfig(bes::Config const& config)
             if (!sentinels.empty()) {
                 // We've now got everything we need for a sentinel-based config, build and return
                 BES_LOG(DEBUG) << "Creating Redis session manager with " << sentinels.size() << " sentinels";
-                return new RedisSessionMgr(sentinels, sentinel_name, timeout);
+                auto mgr = new RedisSessionMgr(sentinels, sentinel_name, timeout, pool_size);
+                mgr->setRefreshWindow(refresh);
+                mgr->setFormat(format);
+                return mgr;
             }
         }
     }
@@ -65,11 +89,21 @@ RedisSessionMgr* RedisSessionMgr::fromConfig(bes::Config const& config)
     }
 
     BES_LOG(DEBUG) << "Creating Redis session manager on server " << adr.ip4Addr() << ":" << adr.port();
-    return new RedisSessionMgr(adr, timeout);
+    auto mgr = new RedisSessionMgr(adr, timeout, pool_size);
+    mgr->setRefreshWindow(refresh);
+    mgr->setFormat(format);
+    return mgr;
 }
 
-void RedisSessionMgr::connect()
+/**
+ * Connect a new pool client, via the sentinels if we have them.
+ */
+void RedisSessionMgr::connect(cpp_redis::client& client)
 {
+    for (auto const& addr : sentinels) {
+        client.add_sentinel(addr.hasIp6Addr() ? addr.ip6Addr() : addr.ip4Addr(), addr.port());
+    }
+
     auto log = [this](auto&& host, auto&& port, auto&& status) {
         logConnectStatus(host, port, status);
     };
@@ -120,91 +154,147 @@ RedisSessionMgr& RedisSessionMgr::logConnectStatus(std::string const& host, std:
     return *this;
 }
 
+/**
+ * Hand out a new session without touching Redis: the key is random enough that a collision won't happen, and if one
+ * ever did, persisting the session would refuse to overwrite the existing one.
+ */
 Session RedisSessionMgr::createSession(std::string const& ns)
 {
-    bool ok = false;
-    std::string id;
-    uint16_t attempts = 0;
+    return Session(SessionInterface::generateSessionKey(ns));
+}
 
-    do {
-        id = SessionInterface::generateSessionKey(ns);
+/**
+ * Read a session with a single command in the configured format. A session still stored in the other format, part way
+ * through a migration, costs a second command to read.
+ */
+Session RedisSessionMgr::getSession(std::string const& session_id)
+{
+    std::string key("session:");
+    key += session_id;
 
-        // Commit a blank value to the DB to ensure there is no collision
-        client.setnx("session:" + id, "-", [&ok](cpp_redis::reply& reply) {
-            ok = reply.ok();
-        });
-        client.sync_commit();
+    std::optional<Session> session;
+
+    {
+        auto client = pool->checkout();
+        bool wrong_type = false;
 
-        if (++attempts == 50) {
-            throw WebException("Too many attempts creating unique session ID");
+        if (format == RedisSessionFormat::BINARY) {
+            session = readBinary(*client, key, session_id, wrong_type);
+            if (wrong_type) {
+                session = readHash(*client, key, session_id, wrong_type);
+            }
+        } else {
+            session = readHash(*client, key, session_id, wrong_type);
+            if (wrong_type) {
+                session = readBinary(*client, key, session_id, wrong_type);
+            }
         }
-    } while (!ok);
+    }
+
+    if (!session) {
+        throw SessionNotExistsException("Session with ID '" + session_id + "' does not exist");
+    }
 
-    return Session(id);
+    return std::move(*session);
 }
 
-Session RedisSessionMgr::getSession(std::string const& session_id)
+/**
+ * Read a session stored as a hash. Every session we write holds a refresh field, so an empty reply means the session
+ * doesn't exist (or has expired).
+ */
+std::optional<Session> RedisSessionMgr::readHash(cpp_redis::client& client, std::string const& key,
+                                                 std::string const& session_id, bool& wrong_type)
 {
-    bes::web::Session session(session_id);
-
-    std::string id("session:");
-    id += session_id;
-    bool valid = true;
+    std::optional<Session> session;
 
-    client.exists({id}, [&valid](cpp_redis::reply& reply) {
-        if (!reply.ok() || !reply.is_integer() || reply.as_integer() != 1) {
-            valid = false;
+    client.hgetall(key, [this, &session, &wrong_type, &session_id](cpp_redis::reply& reply) {
+        if (isWrongType(reply)) {
+            wrong_type = true;
+            return;
         }
-    });
 
-    client.hgetall(id, [&valid, &session, &session_id](cpp_redis::reply& reply) {
-        if (!reply.ok() || !reply.is_array()) {
-            valid = false;
+        if (!reply.ok() || !reply.is_array() || reply.as_array().empty()) {
             return;
         }
 
         auto const& arr = reply.as_array();
         if (arr.size() % 2 != 0) {
             BES_LOG(WARNING) << "Session value size error for session '" << session_id << "': " << arr.size();
-            valid = false;
             return;
         }
 
+        session.emplace(session_id);
+
         for (auto it = arr.begin(); it != arr.end(); ++it) {
-            std::string const& key = it->as_string();
+            std::string const& field = it->as_string();
             ++it;
             std::string const& value = it->as_string();
 
-            if (key.empty() || value.size() < 2) {
+            if (field == REFRESH_FIELD) {
+                // When the TTL was last set, so that persisting an unmodified session can skip refreshing it again
+                setExpires(*session, atoll(value.c_str()));
+                continue;
+            }
+
+            if (field.empty() || value.size() < 2) {
                 continue;
             }
 
             char v_type = value[0];
             switch (v_type) {
                 case 'B':
-                    session.setValue(key, SessionObject(value[1] == '1'));
+                    session->setValue(field, SessionObject(value[1] == '1'));
                     break;
                 case 'S':
-                    session.setValue(key, SessionObject(value.substr(1)));
+                    session->setValue(field, SessionObject(value.substr(1)));
                     break;
                 case 'I':
-                    session.setValue(key, SessionObject(atol(value.substr(1).c_str())));
+                    session->setValue(field, SessionObject(atol(value.substr(1).c_str())));
                     break;
                 case 'D':
-                    session.setValue(key, SessionObject(atof(value.substr(1).c_str())));
+                    session->setValue(field, SessionObject(atof(value.substr(1).c_str())));
                     break;
                 default:
                     break;
             }
         }
+
+        session->markClean();
     });
 
+    // Callbacks reference our locals, they have all run once the commit returns
     client.sync_commit();
+    return session;
+}
 
-    if (!valid) {
-        throw SessionNotExistsException("Session with ID '" + session_id + "' does not exist");
-    }
+/**
+ * Read a session stored as a single BinarySessionCodec value.
+ */
+std::optional<Session> RedisSessionMgr::readBinary(cpp_redis::client& client, std::string const& key,
+                                                   std::string const& session_id, bool& wrong_type)
+{
+    std::optional<Session> session;
+
+    client.get(key, [this, &session, &wrong_type, &session_id](cpp_redis::reply& reply) {
+        if (isWrongType(reply)) {
+            wrong_type = true;
+            return;
+        }
+
+        if (!reply.ok() || !reply.is_string()) {
+            return;
+        }
+
+        try {
+            session = BinarySessionCodec::decode(session_id, reply.as_string());
+            setExpires(*session, BinarySessionCodec::refreshed(reply.as_string()));
+        } catch (SessionCodecException const& e) {
+            BES_LOG(WARNING) << "Unreadable session '" << session_id << "': " << e.what();
+            session.reset();
+        }
+    });
 
+    client.sync_commit();
     return session;
 }
 
@@ -213,6 +303,24 @@ void RedisSessionMgr::setSessionTtl(uint64_t ttl)
     session_ttl = ttl;
 }
 
+void RedisSessionMgr::setRefreshWindow(uint64_t seconds)
+{
+    refresh_window = seconds;
+}
+
+void RedisSessionMgr::setFormat(RedisSessionFormat fmt)
+{
+    format = fmt;
+}
+
+/**
+ * Persist the session.
+ *
+ * A new session is written in full. A loaded session only has its changed fields written and removed fields deleted,
+ * and an unmodified one only has its TTL refreshed - unless that was done within the refresh window, in which case
+ * nothing is sent at all. If the key expired after the session was read, a modified session is written back in full
+ * and an unmodified one is left expired.
+ */
 void RedisSessionMgr::persistSession(Session const& session)
 {
     std::string id("session:");
@@ -223,24 +331,184 @@ void RedisSessionMgr::persistSession(Session const& session)
         id += session.sessionId();
     }
 
+    if (!session.isModified() && !needsRefresh(session)) {
+        return;
+    }
+
+    auto refreshed =
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+    if (session.isNew()) {
+        persistNewSession(id, session, refreshed);
+        return;
+    }
+
+    auto client = pool->checkout();
+    bool wrong_type = false;
+    bool missing = false;
+
+    // The scripts return 1 once written, 0 if the key has gone, which they leave that way, and -1 if it's still in
+    // the other format
+    auto check = [&wrong_type, &missing](cpp_redis::reply& reply) {
+        if (reply.is_integer()) {
+            wrong_type = reply.as_integer() < 0;
+            missing = reply.as_integer() == 0;
+        }
+    };
+
+    if (format == RedisSessionFormat::BINARY) {
+        if (session.isModified()) {
+            writeFull(*client, id, session, refreshed);
+        } else {
+            // Update the refreshed time in place, rather than sending the whole session again - unless the key has
+            // expired since it was read, where SETRANGE would create a key holding nothing but the timestamp
+            static std::string const script =
+                "local t = redis.call('TYPE', KEYS[1]).ok "
+                "if t == 'none' then return 0 end "
+                "if t ~= 'string' then return -1 end "
+                "redis.call('SETRANGE', KEYS[1], ARGV[2], ARGV[3]) "
+                "redis.call('EXPIRE', KEYS[1], ARGV[1]) "
+                "return 1";
+
+            client->send({"EVAL", script, "1", id, std::to_string(session_ttl),
+                          std::to_string(BinarySessionCodec::REFRESHED_OFFSET),
+                          BinarySessionCodec::encodeRefreshed(refreshed)},
+                         check);
+        }
+    } else {
+        // Delete the removed fields and write the changed ones, as long as the hash is still there; on an expired key,
+        // HMSET would create a session holding only the changed fields
+        static std::string const script =
+            "local t = redis.call('TYPE', KEYS[1]).ok "
+            "if t == 'none' then return 0 end "
+            "if t ~= 'hash' then return -1 end "
+            "local removed = tonumber(ARGV[2]) "
+            "if removed > 0 then redis.call('HDEL', KEYS[1], unpack(ARGV, 3, 2 + removed)) end "
+            "if #ARGV > 2 + removed then redis.call('HMSET', KEYS[1], unpack(ARGV, 3 + removed)) end "
+            "if tonumber(ARGV[1]) > 0 then redis.call('EXPIRE', KEYS[1], ARGV[1]) end "
+            "return 1";
+
+        auto const& removed = session.removedKeys();
+        std::vector<std::string> cmd{"EVAL", script, "1", id, std::to_string(session_ttl),
+                                     std::to_string(removed.size())};
+        cmd.insert(cmd.end(), removed.begin(), removed.end());
+
+        for (auto const& key : session.changedKeys()) {
+            cmd.push_back(key);
+            cmd.push_back(encodeValue(key, session.getValue(key)));
+        }
+
+        if (session_ttl) {
+            cmd.push_back(REFRESH_FIELD);
+            cmd.push_back(std::to_string(refreshed));
+        }
+
+        client->send(cmd, check);
+    }
+
+    client->sync_commit();
+
+    if (wrong_type || (missing && session.isModified())) {
+        // Still in the other format, convert it; or gone since it was read, so write it back whole rather than leave
+        // the changes unsaved
+        writeFull(*client, id, session, refreshed);
+        client->sync_commit();
+    }
+}
+
+bool RedisSessionMgr::touchSession(std::string const& id)
+{
+    if (!session_ttl || touchedRecently(id)) {
+        return true;
+    }
+
+    bool exists = false;
+
+    auto client = pool->checkout();
+    client->expire("session:" + id, session_ttl, [&exists](cpp_redis::reply& reply) {
+        // 0 if there's no such key
+        exists = reply.is_integer() && reply.as_integer() == 1;
+    });
+    client->sync_commit();
+
+    return exists;
+}
+
+/**
+ * Write a new session in full, refusing to overwrite a session that already holds its ID: in one script for a hash, or
+ * a SET NX for the binary format.
+ */
+void RedisSessionMgr::persistNewSession(std::string const& id, Session const& session, std::int64_t refreshed)
+{
+    static std::string const script =
+        "if redis.call('EXISTS', KEYS[1]) == 1 then return 0 end "
+        "redis.call('HMSET', KEYS[1], unpack(ARGV, 2)) "
+        "if tonumber(ARGV[1]) > 0 then redis.call('EXPIRE', KEYS[1], ARGV[1]) end "
+        "return 1";
+
+    std::vector<std::string> cmd;
+
+    if (format == RedisSessionFormat::BINARY) {
+        cmd = {"SET", id, BinarySessionCodec::encode(session, refreshed), "NX"};
+        if (session_ttl) {
+            cmd.emplace_back("EX");
+            cmd.push_back(std::to_string(session_ttl));
+        }
+    } else {
+        cmd = {"EVAL", script, "1", id, std::to_string(session_ttl), REFRESH_FIELD, std::to_string(refreshed)};
+        cmd.reserve(cmd.size() + session.getMap().size() * 2);
+        for (auto const& it : session.getMap()) {
+            cmd.push_back(it.first);
+            cmd.push_back(encodeValue(it.first, it.second));
+        }
+    }
+
+    bool created = false;
+    std::string error;
+
+    {
+        auto client = pool->checkout();
+        client->send(cmd, [&created, &error](cpp_redis::reply& reply) {
+            if (reply.is_error()) {
+                error = reply.error();
+            } else {
+                // The script returns 1, SET NX returns OK - or null if the key exists
+                created = reply.is_integer() ? reply.as_integer() == 1 : !reply.is_null();
+            }
+        });
+        client->sync_commit();
+    }
+
+    if (!error.empty()) {
+        throw WebException("Unable to persist new session '" + session.sessionId() + "': " + error);
+    }
+
+    if (!created) {
+        throw SessionCollisionException("Session ID '" + session.sessionId() + "' is already in use");
+    }
+}
+
+/**
+ * Queue a rewrite of an existing session in full, replacing whatever the key held.
+ */
+void RedisSessionMgr::writeFull(cpp_redis::client& client, std::string const& id, Session const& session,
+                                std::int64_t refreshed)
+{
+    if (format == RedisSessionFormat::BINARY) {
+        std::vector<std::string> cmd{"SET", id, BinarySessionCodec::encode(session, refreshed)};
+        if (session_ttl) {
+            cmd.emplace_back("EX");
+            cmd.push_back(std::to_string(session_ttl));
+        }
+
+        client.send(cmd, [](cpp_redis::reply&) {});
+        return;
+    }
+
     std::vector<std::pair<std::string, std::string>> hash;
+    hash.emplace_back(REFRESH_FIELD, std::to_string(refreshed));
     for (auto const& it : session.getMap()) {
-        switch (it.second.data_type) {
-            case SessionObject::ObjectType::DOUBLE:
-                hash.emplace_back(it.first, "D" + std::to_string(std::any_cast<double>(it.second.data)));
-                break;
-            case SessionObject::ObjectType::STRING:
-                hash.emplace_back(it.first, "S" + std::any_cast<std::string>(it.second.data));
-                break;
-            case SessionObject::ObjectType::INT64:
-                hash.emplace_back(it.first, "I" + std::to_string(std::any_cast<int64_t>(it.second.data)));
-                break;
-            case SessionObject::ObjectType::BOOL:
-                hash.emplace_back(it.first, "B" + std::to_string(std::any_cast<bool>(it.second.data)));
-                break;
-            default:
-                throw WebException("Unknown session object type: " + it.first);
-        }
+        hash.emplace_back(it.first, encodeValue(it.first, it.second));
     }
 
     client.del({id});
@@ -249,6 +517,92 @@ void RedisSessionMgr::persistSession(Session const& session)
     if (session_ttl) {
         client.expire(id, session_ttl);
     }
+}
+
+void RedisSessionMgr::setExpires(Session& session, std::int64_t refreshed) const
+{
+    if (session_ttl && refreshed > 0) {
+        session.setExpires(std::chrono::system_clock::time_point(std::chrono::seconds(refreshed)) +
+                           std::chrono::seconds(session_ttl));
+    }
+}
 
-    client.sync_commit();
+bool RedisSessionMgr::isWrongType(cpp_redis::reply const& reply)
+{
+    return reply.is_error() && reply.error().compare(0, 9, "WRONGTYPE") == 0;
+}
+
+/**
+ * Whether this process touched the session within the refresh window, recording the touch if not. IDs are kept in two
+ * sets, each covering half a window: the older is dropped as a new one starts, so memory is bounded by the IDs seen in
+ * the last window, at the cost of touching some IDs again after only half a window.
+ */
+bool RedisSessionMgr::touchedRecently(std::string const& id)
+{
+    if (!refresh_window) {
+        return false;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto half_window = std::chrono::milliseconds(refresh_window * 500);
+
+    std::lock_guard<std::mutex> lock(touch_mutex);
+
+    if (now - touched_since >= half_window) {
+        // Nothing in the older set is recent enough to skip once two half windows have passed
+        if (now - touched_since >= half_window * 2) {
+            touched_before.clear();
+        } else {
+            touched_before.swap(touched);
+        }
+
+        touched.clear();
+        touched_since = now;
+    }
+
+    if (touched.count(id) || touched_before.count(id)) {
+        return true;
+    }
+
+    touched.insert(id);
+    return false;
+}
+
+/**
+ * An unmodified session needs its TTL refreshed unless it was refreshed within the refresh window.
+ */
+bool RedisSessionMgr::needsRefresh(Session const& session) const
+{
+    if (!session_ttl) {
+        return false;
+    }
+
+    auto const& expires = session.expires();
+    if (!refresh_window || !expires) {
+        return true;
+    }
+
+    auto remaining = std::chrono::duration_cast<std::chrono::seconds>(*expires - std::chrono::system_clock::now());
+    return remaining.count() + static_cast<int64_t>(refresh_window) <= static_cast<int64_t>(session_ttl);
+}
+
+std::string RedisSessionMgr::encodeValue(std::string const& key, SessionObject const& value)
+{
+    switch (value.data_type) {
+        case SessionObject::ObjectType::DOUBLE:
+            return "D" + std::to_string(std::any_cast<double>(value.data));
+        case SessionObject::ObjectType::STRING:
+            return "S" + std::any_cast<std::string>(value.data);
+        case SessionObject::ObjectType::INT64:
+            return "I" + std::to_string(std::any_cast<int64_t>(value.data));
+        case SessionObject::ObjectType::BOOL:
+            return "B" + std::to_string(std::any_cast<bool>(value.data));
+        default:
+            throw WebException("Unknown session object type: " + key);
+    }
+}
+
+RedisConnectionPool const& RedisSessionMgr::connectionPool() const
+{
+    return *pool;
 }
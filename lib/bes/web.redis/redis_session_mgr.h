@@ -5,34 +5,101 @@
 #include <bes/web.h>
 #include <yaml-cpp/yaml.h>
 
+#include <chrono>
 #include <cpp_redis/cpp_redis>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
 #include <vector>
 
+#include "redis_connection_pool.h"
+
 namespace bes::web {
 
+/**
+ * How sessions are laid out in Redis.
+ */
+enum class RedisSessionFormat
+{
+    /// A hash with a field per value, each a type-prefixed string; changes are written field by field
+    HASH,
+
+    /// A single BinarySessionCodec value under a plain key, rewritten whole when the session changes
+    BINARY,
+};
+
 class RedisSessionMgr : public SessionInterface
 {
    public:
-    explicit RedisSessionMgr(bes::net::Address svr, uint32_t timeout_ms = 250);
+    explicit RedisSessionMgr(bes::net::Address svr, uint32_t timeout_ms = 250, std::size_t pool_size = 8);
     RedisSessionMgr(std::vector<bes::net::Address> const& sentinels, std::string sentinel_svc,
-                    uint32_t timeout_ms = 250);
+                    uint32_t timeout_ms = 250, std::size_t pool_size = 8);
     static RedisSessionMgr* fromConfig(bes::Config const& config);
 
     void setSessionTtl(uint64_t ttl) override;
 
+    /**
+     * Skip refreshing the TTL of an unmodified session if it was last refreshed less than this many seconds ago. Zero
+     * (the default) refreshes it on every request.
+     */
+    void setRefreshWindow(uint64_t seconds);
+
+    /**
+     * Format to write sessions in. Either format can be read, so a session stored in the other is still found and is
+     * converted when next written.
+     */
+    void setFormat(RedisSessionFormat fmt);
+
     [[nodiscard]] Session createSession(std::string const& ns) override;
     [[nodiscard]] Session getSession(std::string const& id) override;
     void persistSession(Session const& session) override;
 
+    /**
+     * Refresh the session's TTL with a single EXPIRE, in either format. With a refresh window, an ID this process has
+     * already touched within the window is skipped without going to Redis, and reported as existing.
+     */
+    bool touchSession(std::string const& id) override;
+
+    /**
+     * Connections to the server, each request thread checks one out for the length of a call.
+     */
+    [[nodiscard]] RedisConnectionPool const& connectionPool() const;
+
    protected:
-    void connect();
+    void connect(cpp_redis::client& client);
     RedisSessionMgr& logConnectStatus(std::string const& host, std::size_t port, cpp_redis::connect_state status);
+    bool needsRefresh(Session const& session) const;
+    bool touchedRecently(std::string const& id);
+    std::optional<Session> readHash(cpp_redis::client& client, std::string const& key, std::string const& session_id,
+                                    bool& wrong_type);
+    std::optional<Session> readBinary(cpp_redis::client& client, std::string const& key,
+                                      std::string const& session_id, bool& wrong_type);
+    void persistNewSession(std::string const& id, Session const& session, std::int64_t refreshed);
+    void writeFull(cpp_redis::client& client, std::string const& id, Session const& session, std::int64_t refreshed);
+    void setExpires(Session& session, std::int64_t refreshed) const;
+    static bool isWrongType(cpp_redis::reply const& reply);
+    static std::string encodeValue(std::string const& key, SessionObject const& value);
 
-    cpp_redis::client client;
+    /// Hash field holding when the session's TTL was last set; empty, so it can't clash with a session value
+    static constexpr char const* REFRESH_FIELD = "";
+
+    std::unique_ptr<RedisConnectionPool> pool;
+    std::vector<bes::net::Address> sentinels;
     bes::net::Address server;
     std::string sentinel_svc_name;
     uint32_t connect_timeout;
     uint64_t session_ttl = 0;
+    uint64_t refresh_window = 0;
+    RedisSessionFormat format = RedisSessionFormat::HASH;
+
+    // IDs touched by this process in the last two half refresh windows, so the sets only hold IDs seen within a window
+    std::mutex touch_mutex;
+    std::unordered_set<std::string> touched;
+    std::unordered_set<std::string> touched_before;
+    std::chrono::steady_clock::time_point touched_since;
 };
 
 }  // namespace bes::web
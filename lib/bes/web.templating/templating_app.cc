@@ -135,7 +135,39 @@ void TemplateApp::run()
 
     // Start the FastCGI server
     svc = std::make_unique<bes::web::WebServer>();
-    svc->addRouter(kernel().getContainer().get<bes::web::MappedRouter>("router"));
+    auto router = kernel().getContainer().get<bes::web::MappedRouter>("router");
+    svc->addRouter(router);
+
+    auto cache_mb = kernel().getConfig().getOr<std::size_t>(0, "web", "response_cache", "size_mb");
+    if (cache_mb > 0) {
+        auto shards = kernel().getConfig().getOr<std::size_t>(16, "web", "response_cache", "shards");
+        BES_LOG(INFO) << "Response cache enabled: " << cache_mb << " MB in " << shards << " shards";
+        router->setResponseCache(std::make_shared<ResponseCache>(cache_mb * 1024 * 1024, shards));
+    }
+
+    auto access_log_path = kernel().getConfig().getOr<std::string>("", "web", "access_log", "path");
+    if (!access_log_path.empty()) {
+        AccessLogSampling sampling;
+        sampling.success_rate = kernel().getConfig().getOr<unsigned>(1, "web", "access_log", "sample_success");
+        sampling.client_error_rate = kernel().getConfig().getOr<unsigned>(1, "web", "access_log", "sample_4xx");
+        sampling.slow_threshold =
+            std::chrono::milliseconds(kernel().getConfig().getOr<unsigned>(0, "web", "access_log", "slow_ms"));
+
+        BES_LOG(INFO) << "Writing access log to " << access_log_path;
+        svc->setAccessLog(std::make_shared<AccessLog>(access_log_path, sampling));
+    }
+
+    svc->setAutoETag(kernel().getConfig().getOr<bool>(false, "web", "etag"));
+
+    if (kernel().getConfig().getOr<bool>(false, "web", "compression", "enabled")) {
+        auto compression = std::make_shared<CompressionConfig>();
+        compression->level = kernel().getConfig().getOr<int>(compression->level, "web", "compression", "level");
+        compression->min_size =
+            kernel().getConfig().getOr<std::size_t>(compression->min_size, "web", "compression", "min_size");
+
+        BES_LOG(INFO) << "Response compression enabled at level " << compression->level;
+        svc->setCompression(compression);
+    }
 
     // Allow the app to add a session manager or other configuration
     configureServer(*(svc.get()));
@@ -17,8 +17,7 @@ HttpResponse TemplatingController::response(std::string const& templ,
 HttpResponse TemplatingController::response(std::string const& templ, bes::templating::data::ContextBuilder const& ctx,
                                             HttpResponse&& resp) const
 {
-    resp.header(bes::web::Http::Header::CONTENT_LENGTH,
-                std::to_string(resp.write(renderer->render(templ, ctx.getContext()))));
+    render(templ, ctx, resp);
 
     return HttpResponse{std::move(resp)};
 }
@@ -40,12 +39,22 @@ HttpResponse TemplatingController::response(std::string const& templ, bes::templ
 {
     HttpResponse resp;
     resp.status(status, content_type);
-    resp.header(bes::web::Http::Header::CONTENT_LENGTH,
-                std::to_string(resp.write(renderer->render(templ, ctx.getContext()))));
+    render(templ, ctx, resp);
 
     return resp;
 }
 
+/**
+ * Render straight into the response body, so the output isn't copied out of an intermediate string.
+ */
+void TemplatingController::render(std::string const& templ, bes::templating::data::ContextBuilder const& ctx,
+                                  HttpResponse& resp) const
+{
+    bes::OutputStream out(resp.body());
+    renderer->render(templ, ctx.getContext(), out);
+    resp.header(bes::web::Http::Header::CONTENT_LENGTH, std::to_string(resp.body().size()));
+}
+
 HttpResponse TemplatingController::jsonResponse(json const& j) const
 {
     return jsonResponse(j, bes::web::Http::Status::OK);
@@ -38,6 +38,9 @@ class TemplatingController
     [[nodiscard]] HttpResponse jsonResponse(json const& j, bes::web::Http::Status status) const;
 
     std::shared_ptr<bes::templating::Engine> renderer;
+
+   private:
+    void render(std::string const& templ, bes::templating::data::ContextBuilder const& ctx, HttpResponse& resp) const;
 };
 
 }  // namespace bes::web
@@ -0,0 +1,455 @@
+#include "access_log.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+
+using namespace bes::web;
+
+std::atomic<std::uint64_t> AccessLog::generations{0};
+
+namespace {
+
+/**
+ * Copy into a fixed, null-terminated field, truncating without splitting a UTF-8 sequence.
+ */
+template <std::size_t N>
+void copyField(char (&field)[N], std::string_view v)
+{
+    auto len = std::min(v.size(), N - 1);
+    if (len < v.size()) {
+        while (len > 0 && (static_cast<unsigned char>(v[len]) & 0xC0) == 0x80) {
+            --len;
+        }
+    }
+
+    std::memcpy(field, v.data(), len);
+    field[len] = '\0';
+}
+
+void appendEscaped(std::string& out, char const* str)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    for (auto p = str; *p; ++p) {
+        auto c = static_cast<unsigned char>(*p);
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            default:
+                if (c < 0x20) {
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+}
+
+void appendNumber(std::string& out, std::uint64_t value)
+{
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
+
+/**
+ * ISO 8601 UTC timestamp with microseconds, the date part is only rebuilt when the second changes.
+ */
+void appendTimestamp(std::string& out, std::int64_t ns)
+{
+    thread_local std::time_t cached_sec = -1;
+    thread_local char cached[24];
+
+    auto sec = static_cast<std::time_t>(ns / 1000000000);
+    auto usec = static_cast<long>((ns % 1000000000) / 1000);
+
+    if (sec != cached_sec) {
+        std::tm tm{};
+        gmtime_r(&sec, &tm);
+        std::strftime(cached, sizeof(cached), "%Y-%m-%dT%H:%M:%S", &tm);
+        cached_sec = sec;
+    }
+
+    char frac[] = ".000000Z";
+    for (int i = 6; i > 0; --i) {
+        frac[i] = static_cast<char>('0' + usec % 10);
+        usec /= 10;
+    }
+
+    out += cached;
+    out += frac;
+}
+
+}  // namespace
+
+void AccessRecord::setMethod(std::string_view v)
+{
+    copyField(method, v);
+}
+
+void AccessRecord::setRoute(std::string_view v)
+{
+    copyField(route, v);
+}
+
+void AccessRecord::setUri(std::string_view v)
+{
+    copyField(uri, v);
+}
+
+/**
+ * Single-producer, single-consumer ring of records, owned by one responder thread and drained by the writer.
+ */
+class AccessLog::ThreadBuffer
+{
+   public:
+    explicit ThreadBuffer(std::size_t capacity)
+        : mask([capacity] {
+              std::size_t size = 64;
+              while (size < capacity) {
+                  size <<= 1;
+              }
+              return size - 1;
+          }()),
+          slots(new AccessRecord[mask + 1])
+    {
+    }
+
+    bool push(AccessRecord const& rec)
+    {
+        auto pos = head.load(std::memory_order_relaxed);
+        if (pos - tail.load(std::memory_order_acquire) > mask) {
+            ++dropped;
+            return false;
+        }
+
+        slots[pos & mask] = rec;
+        head.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class F>
+    void drain(F&& fn)
+    {
+        auto pos = tail.load(std::memory_order_relaxed);
+        auto const end = head.load(std::memory_order_acquire);
+
+        for (; pos < end; ++pos) {
+            fn(slots[pos & mask]);
+        }
+
+        tail.store(pos, std::memory_order_release);
+    }
+
+    std::atomic<bool> retired{false};
+    std::atomic<std::uint64_t> dropped{0};
+
+   private:
+    std::size_t const mask;
+    std::unique_ptr<AccessRecord[]> slots;
+
+    alignas(64) std::atomic<std::uint64_t> head{0};
+    alignas(64) std::atomic<std::uint64_t> tail{0};
+};
+
+AccessLog::AccessLog(std::string path, AccessLogSampling sampling, std::size_t thread_buffer_records)
+    : path(std::move(path)), sampling(sampling), thread_buffer_records(thread_buffer_records)
+{
+    openFile();
+    if (fd < 0) {
+        throw std::runtime_error("Unable to open access log " + this->path + ": " + std::strerror(errno));
+    }
+
+    // Threads re-register their buffer with every new access log
+    generation = ++generations;
+
+    writer = std::thread([this] {
+        writerLoop();
+    });
+}
+
+AccessLog::~AccessLog()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    wake_cv.notify_one();
+
+    if (writer.joinable()) {
+        writer.join();
+    }
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+unsigned AccessLog::sample(int status, std::chrono::microseconds duration) const
+{
+    if (status >= 500) {
+        return 1;
+    }
+
+    if (sampling.slow_threshold.count() > 0 && duration >= sampling.slow_threshold) {
+        return 1;
+    }
+
+    // Counting per thread keeps the decision free of shared writes; across threads it's still 1 in N
+    thread_local unsigned success_count = 0;
+    thread_local unsigned client_error_count = 0;
+
+    unsigned rate;
+    unsigned* count;
+
+    if (status >= 400) {
+        rate = sampling.client_error_rate;
+        count = &client_error_count;
+    } else {
+        rate = sampling.success_rate;
+        count = &success_count;
+    }
+
+    if (rate == 0) {
+        return 0;
+    }
+
+    if (++*count >= rate) {
+        *count = 0;
+        return rate;
+    }
+
+    return 0;
+}
+
+void AccessLog::record(AccessRecord const& rec)
+{
+    threadBuffer().push(rec);
+}
+
+void AccessLog::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    if (stop) {
+        return;
+    }
+
+    // A pass may already be under way and have missed our records, so wait for the one after it
+    auto target = passes + 2;
+
+    ++flush_waiters;
+    wake_cv.notify_one();
+    pass_cv.wait(lock, [this, target] {
+        return passes >= target || stop;
+    });
+    --flush_waiters;
+}
+
+void AccessLog::reopen()
+{
+    reopen_requested.store(true);
+    wake_cv.notify_one();
+}
+
+std::uint64_t AccessLog::dropped() const
+{
+    return dropped_total.load();
+}
+
+void AccessLog::format(std::string& out, AccessRecord const& rec)
+{
+    out += "{\"ts\":\"";
+    appendTimestamp(out, rec.timestamp);
+    out += "\",\"method\":\"";
+    appendEscaped(out, rec.method);
+    out += "\",\"route\":\"";
+    appendEscaped(out, rec.route);
+    out += "\",\"uri\":\"";
+    appendEscaped(out, rec.uri);
+    out += "\",\"status\":";
+    appendNumber(out, rec.status);
+    out += ",\"bytes\":";
+    appendNumber(out, rec.bytes);
+    out += ",\"parse_us\":";
+    appendNumber(out, rec.parse_us);
+    out += ",\"handle_us\":";
+    appendNumber(out, rec.handle_us);
+    out += ",\"render_us\":";
+    appendNumber(out, rec.render_us);
+    out += ",\"total_us\":";
+    appendNumber(out, rec.total_us);
+    out += ",\"sample\":";
+    appendNumber(out, rec.sample_rate);
+    out += "}\n";
+}
+
+AccessLog::ThreadBuffer& AccessLog::threadBuffer()
+{
+    struct Handle
+    {
+        std::shared_ptr<ThreadBuffer> buffer;
+        std::uint64_t generation = 0;
+
+        ~Handle()
+        {
+            if (buffer) {
+                buffer->retired.store(true);
+            }
+        }
+    };
+
+    thread_local Handle handle;
+
+    if (handle.generation != generation) {
+        if (handle.buffer) {
+            handle.buffer->retired.store(true);
+        }
+
+        handle.buffer = std::make_shared<ThreadBuffer>(thread_buffer_records);
+        handle.generation = generation;
+
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.push_back(handle.buffer);
+    }
+
+    return *handle.buffer;
+}
+
+void AccessLog::openFile()
+{
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+}
+
+/**
+ * Check if the path no longer refers to the file we have open.
+ */
+bool AccessLog::fileMoved() const
+{
+    struct stat open_st = {};
+    struct stat path_st = {};
+
+    if (fd < 0 || ::fstat(fd, &open_st) != 0) {
+        return true;
+    }
+
+    if (::stat(path.c_str(), &path_st) != 0) {
+        return true;
+    }
+
+    return open_st.st_ino != path_st.st_ino || open_st.st_dev != path_st.st_dev;
+}
+
+void AccessLog::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        bool stopping = stop;
+
+        lock.unlock();
+        writePass();
+        lock.lock();
+
+        ++passes;
+        pass_cv.notify_all();
+
+        if (stopping) {
+            break;
+        }
+
+        wake_cv.wait_for(lock, poll_interval, [this] {
+            return stop || flush_waiters > 0 || reopen_requested.load();
+        });
+    }
+}
+
+void AccessLog::writePass()
+{
+    if (reopen_requested.exchange(false) || fileMoved()) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+
+        openFile();
+        if (fd < 0) {
+            std::cerr << "Unable to reopen access log " << path << ": " << std::strerror(errno) << std::endl;
+        }
+    }
+
+    std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        snapshot = buffers;
+    }
+
+    std::vector<ThreadBuffer*> released;
+
+    for (auto const& buffer : snapshot) {
+        // Check before draining; once retired, the owning thread can't add anything further
+        bool retired = buffer->retired.load();
+
+        buffer->drain([this](AccessRecord const& rec) {
+            format(out, rec);
+        });
+
+        dropped_total += buffer->dropped.exchange(0);
+
+        if (retired) {
+            released.push_back(buffer.get());
+        }
+    }
+
+    if (!released.empty()) {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                     [&released](auto const& b) {
+                                         return std::find(released.begin(), released.end(), b.get()) !=
+                                                released.end();
+                                     }),
+                      buffers.end());
+    }
+
+    writeOut();
+}
+
+void AccessLog::writeOut()
+{
+    if (fd < 0) {
+        out.clear();
+        return;
+    }
+
+    std::size_t written = 0;
+
+    while (written < out.size()) {
+        auto r = ::write(fd, out.data() + written, out.size() - written);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            std::cerr << "Access log write to " << path << " failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        written += static_cast<std::size_t>(r);
+    }
+
+    out.clear();
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "http.h"
+
+namespace bes::web {
+
+/**
+ * A single access log entry. Fixed size so that it can be copied into a thread buffer without allocating; the route and
+ * URI are truncated to fit.
+ */
+struct AccessRecord
+{
+    /// Wall-clock time the request was received, nanoseconds since the epoch
+    std::int64_t timestamp = 0;
+
+    /// Response size in bytes, headers included
+    std::uint64_t bytes = 0;
+
+    /// Phase timings in microseconds: building the request, yielding a response from the routers, rendering it
+    std::uint32_t parse_us = 0;
+    std::uint32_t handle_us = 0;
+    std::uint32_t render_us = 0;
+    std::uint32_t total_us = 0;
+
+    std::uint16_t status = 0;
+
+    /// The 1-in-N rate this record was sampled at, so that the pipeline can re-weight counts
+    std::uint16_t sample_rate = 1;
+
+    char method[8] = {};
+    char route[48] = {};
+    char uri[176] = {};
+
+    void setMethod(std::string_view v);
+    void setRoute(std::string_view v);
+    void setUri(std::string_view v);
+};
+
+/**
+ * Sampling rules for an AccessLog. Server errors and slow requests are always logged.
+ */
+struct AccessLogSampling
+{
+    /// Log 1 in N 1xx, 2xx and 3xx responses, zero to log none
+    unsigned success_rate = 1;
+
+    /// Log 1 in N 4xx responses, zero to log none
+    unsigned client_error_rate = 1;
+
+    /// Requests taking at least this long are always logged, zero to disable
+    std::chrono::microseconds slow_threshold{0};
+};
+
+/**
+ * Dedicated request log, kept apart from the diagnostic log sink.
+ *
+ * Each responder thread copies a fixed AccessRecord into a lock-free ring of its own; a writer thread drains every ring
+ * and appends the records to the file as newline-delimited JSON, one object per line. If a ring is full the record is
+ * dropped and counted, the request thread never waits on the file.
+ *
+ * The writer notices when the file has been moved or deleted (eg, by logrotate) and reopens the path.
+ */
+class AccessLog
+{
+   public:
+    explicit AccessLog(std::string path, AccessLogSampling sampling = {}, std::size_t thread_buffer_records = 4096);
+    ~AccessLog();
+
+    AccessLog(AccessLog const&) = delete;
+    AccessLog& operator=(AccessLog const&) = delete;
+
+    /**
+     * Decide if a request with the given status and duration should be logged. Returns the sample rate to record, or
+     * zero to skip the request.
+     */
+    [[nodiscard]] unsigned sample(int status, std::chrono::microseconds duration) const;
+
+    /**
+     * Push a record to the calling thread's buffer. Never blocks.
+     */
+    void record(AccessRecord const& rec);
+
+    /**
+     * Block until all records pushed before this call are written.
+     */
+    void flush();
+
+    /**
+     * Close and reopen the file, performed by the writer thread.
+     */
+    void reopen();
+
+    /**
+     * Number of records discarded because a thread buffer was full.
+     */
+    [[nodiscard]] std::uint64_t dropped() const;
+
+    /**
+     * Append the NDJSON representation of a record to `out`, including the trailing newline.
+     */
+    static void format(std::string& out, AccessRecord const& rec);
+
+    /// Interval at which the writer drains thread buffers
+    static constexpr std::chrono::milliseconds poll_interval{100};
+
+   private:
+    class ThreadBuffer;
+
+    std::string path;
+    AccessLogSampling sampling;
+    std::size_t thread_buffer_records;
+    std::uint64_t generation;
+
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+    // Writer thread state
+    int fd = -1;
+    std::string out;
+    std::atomic<std::uint64_t> dropped_total{0};
+    std::atomic<bool> reopen_requested{false};
+
+    std::mutex mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable pass_cv;
+    std::uint64_t passes = 0;
+    int flush_waiters = 0;
+    bool stop = false;
+
+    std::thread writer;
+
+    static std::atomic<std::uint64_t> generations;
+
+    ThreadBuffer& threadBuffer();
+    void openFile();
+    bool fileMoved() const;
+    void writerLoop();
+    void writePass();
+    void writeOut();
+};
+
+}  // namespace bes::web
@@ -0,0 +1,236 @@
+#include "binary_session_codec.h"
+
+#include <cstring>
+
+using namespace bes::web;
+
+namespace {
+
+constexpr std::size_t HEADER_SIZE = BinarySessionCodec::REFRESHED_OFFSET + BinarySessionCodec::REFRESHED_SIZE;
+
+enum class ValueType : std::uint8_t
+{
+    BOOL_FALSE = 0,
+    BOOL_TRUE = 1,
+    INT64 = 2,
+    DOUBLE = 3,
+    STRING = 4,
+};
+
+void putVarint(std::string& out, std::uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+void putFixed(std::string& out, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>(v >> (i * 8)));
+    }
+}
+
+std::size_t varintSize(std::uint64_t v)
+{
+    std::size_t size = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+/**
+ * Bounds-checked reads from an encoded session.
+ */
+class Reader
+{
+   public:
+    explicit Reader(std::string_view data) : data(data) {}
+
+    std::uint8_t byte()
+    {
+        need(1);
+        return static_cast<std::uint8_t>(data[pos++]);
+    }
+
+    std::uint64_t fixed()
+    {
+        need(8);
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) {
+            v |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(data[pos++])) << (i * 8);
+        }
+        return v;
+    }
+
+    std::uint64_t varint()
+    {
+        std::uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            auto b = byte();
+            v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return v;
+            }
+        }
+
+        throw SessionCodecException("Malformed length in encoded session");
+    }
+
+    std::string_view bytes(std::uint64_t len)
+    {
+        need(len);
+        auto s = data.substr(pos, len);
+        pos += len;
+        return s;
+    }
+
+   private:
+    std::string_view data;
+    std::size_t pos = 0;
+
+    void need(std::uint64_t len) const
+    {
+        if (len > data.size() - pos) {
+            throw SessionCodecException("Encoded session is truncated");
+        }
+    }
+};
+
+}  // namespace
+
+std::string BinarySessionCodec::encode(Session const& session, std::int64_t refreshed)
+{
+    auto const& map = session.getMap();
+
+    // Size it up front, so the blob is built in a single allocation
+    std::size_t size = HEADER_SIZE + varintSize(map.size());
+    for (auto const& it : map) {
+        size += varintSize(it.first.size()) + it.first.size() + 1;
+        switch (it.second.data_type) {
+            case SessionObject::ObjectType::STRING: {
+                auto const& str = std::any_cast<std::string const&>(it.second.data);
+                size += varintSize(str.size()) + str.size();
+                break;
+            }
+            case SessionObject::ObjectType::INT64:
+            case SessionObject::ObjectType::DOUBLE:
+                size += 8;
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::string out;
+    out.reserve(size);
+    out.push_back(static_cast<char>(MAGIC));
+    out.push_back(static_cast<char>(VERSION));
+    putFixed(out, static_cast<std::uint64_t>(refreshed));
+    putVarint(out, map.size());
+
+    for (auto const& it : map) {
+        putVarint(out, it.first.size());
+        out.append(it.first);
+
+        switch (it.second.data_type) {
+            case SessionObject::ObjectType::BOOL:
+                out.push_back(static_cast<char>(std::any_cast<bool>(it.second.data) ? ValueType::BOOL_TRUE
+                                                                                     : ValueType::BOOL_FALSE));
+                break;
+            case SessionObject::ObjectType::INT64:
+                out.push_back(static_cast<char>(ValueType::INT64));
+                putFixed(out, static_cast<std::uint64_t>(std::any_cast<int64_t>(it.second.data)));
+                break;
+            case SessionObject::ObjectType::DOUBLE: {
+                auto d = std::any_cast<double>(it.second.data);
+                std::uint64_t bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                out.push_back(static_cast<char>(ValueType::DOUBLE));
+                putFixed(out, bits);
+                break;
+            }
+            case SessionObject::ObjectType::STRING: {
+                auto const& str = std::any_cast<std::string const&>(it.second.data);
+                out.push_back(static_cast<char>(ValueType::STRING));
+                putVarint(out, str.size());
+                out.append(str);
+                break;
+            }
+            default:
+                throw WebException("Unknown session object type: " + it.first);
+        }
+    }
+
+    return out;
+}
+
+std::string BinarySessionCodec::encodeRefreshed(std::int64_t refreshed)
+{
+    std::string out;
+    out.reserve(REFRESHED_SIZE);
+    putFixed(out, static_cast<std::uint64_t>(refreshed));
+    return out;
+}
+
+bool BinarySessionCodec::isEncoded(std::string_view data)
+{
+    return data.size() >= HEADER_SIZE && static_cast<std::uint8_t>(data[0]) == MAGIC &&
+           static_cast<std::uint8_t>(data[1]) == VERSION;
+}
+
+Session BinarySessionCodec::decode(std::string const& id, std::string_view data)
+{
+    if (!isEncoded(data)) {
+        throw SessionCodecException("Session '" + id + "' is not in a known encoding");
+    }
+
+    Reader reader(data.substr(HEADER_SIZE));
+    Session session(id);
+
+    auto count = reader.varint();
+    for (std::uint64_t i = 0; i < count; ++i) {
+        std::string key(reader.bytes(reader.varint()));
+
+        switch (static_cast<ValueType>(reader.byte())) {
+            case ValueType::BOOL_FALSE:
+                session.setValue(key, false);
+                break;
+            case ValueType::BOOL_TRUE:
+                session.setValue(key, true);
+                break;
+            case ValueType::INT64:
+                session.setValue(key, static_cast<int64_t>(reader.fixed()));
+                break;
+            case ValueType::DOUBLE: {
+                auto bits = reader.fixed();
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                session.setValue(key, d);
+                break;
+            }
+            case ValueType::STRING:
+                session.setValue(key, std::string(reader.bytes(reader.varint())));
+                break;
+            default:
+                throw SessionCodecException("Unknown value type in session '" + id + "'");
+        }
+    }
+
+    session.markClean();
+    return session;
+}
+
+std::int64_t BinarySessionCodec::refreshed(std::string_view data)
+{
+    if (!isEncoded(data)) {
+        return 0;
+    }
+
+    Reader reader(data.substr(REFRESHED_OFFSET));
+    return static_cast<std::int64_t>(reader.fixed());
+}
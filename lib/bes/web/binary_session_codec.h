@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "exception.h"
+#include "session.h"
+
+namespace bes::web {
+
+class SessionCodecException : public WebException
+{
+    using WebException::WebException;
+};
+
+/**
+ * Packs a whole session into a single binary value, for a store that keeps it as one blob: a plain Redis key, or a
+ * snapshot file.
+ *
+ * Layout, integers little-endian:
+ *
+ *      magic (1) | version (1) | refreshed (8) | field count (varint)
+ *      per field: key length (varint) | key | type (1) | value
+ *
+ * where a value is a single byte for a bool, 8 bytes for an int or double, and a varint length followed by the bytes
+ * for a string. `refreshed` is when the session's TTL was last set, in seconds since the epoch; it sits at a fixed
+ * offset so that it can be updated with SETRANGE without rewriting the session.
+ *
+ * The leading magic and version tell a packed session apart from anything else, and let a future layout be read
+ * alongside this one.
+ */
+class BinarySessionCodec
+{
+   public:
+    static constexpr std::uint8_t MAGIC = 0xbe;
+    static constexpr std::uint8_t VERSION = 1;
+
+    /// Offset and size of the refreshed timestamp
+    static constexpr std::size_t REFRESHED_OFFSET = 2;
+    static constexpr std::size_t REFRESHED_SIZE = 8;
+
+    [[nodiscard]] static std::string encode(Session const& session, std::int64_t refreshed);
+
+    /**
+     * The refreshed timestamp on its own, to write at REFRESHED_OFFSET.
+     */
+    [[nodiscard]] static std::string encodeRefreshed(std::int64_t refreshed);
+
+    /**
+     * True if `data` starts with a header this codec can read.
+     */
+    [[nodiscard]] static bool isEncoded(std::string_view data);
+
+    /**
+     * Unpack a session, which is returned clean. Throws a SessionCodecException if the data is truncated or of an
+     * unknown version.
+     */
+    [[nodiscard]] static Session decode(std::string const& id, std::string_view data);
+
+    [[nodiscard]] static std::int64_t refreshed(std::string_view data);
+};
+
+}  // namespace bes::web
@@ -0,0 +1,275 @@
+#include "caching_session_mgr.h"
+
+#include <stdexcept>
+
+using namespace bes::web;
+
+namespace {
+
+// Fixed cost of an entry beyond its ID and the session: list node, index node and the session's own map
+constexpr std::size_t ENTRY_OVERHEAD = 192;
+
+}  // namespace
+
+CachingSessionMgr::CachingSessionMgr(std::shared_ptr<SessionInterface> target, SessionCacheConfig config,
+                                     std::shared_ptr<SessionInvalidationBus> bus)
+    : target(std::move(target)), config(config), bus(std::move(bus))
+{
+    if (this->target == nullptr) {
+        throw std::invalid_argument("CachingSessionMgr requires a target session manager");
+    }
+
+    auto shard_count = config.shards > 0 ? config.shards : 1;
+    shards.reserve(shard_count);
+    for (std::size_t i = 0; i < shard_count; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+
+    shard_budget = config.byte_budget / shard_count;
+
+    if (this->bus != nullptr) {
+        subscription = this->bus->subscribe([this](std::string const& id) {
+            invalidate(id);
+        });
+    }
+}
+
+CachingSessionMgr::~CachingSessionMgr()
+{
+    if (bus != nullptr) {
+        bus->unsubscribe(subscription);
+    }
+}
+
+Session CachingSessionMgr::createSession(std::string const& ns)
+{
+    auto session = target->createSession(ns);
+    invalidate(session.sessionId());
+    return session;
+}
+
+Session CachingSessionMgr::getSession(std::string const& id)
+{
+    auto& shard = shardFor(id);
+    std::uint64_t generation;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        generation = shard.generation;
+
+        auto it = shard.index.find(id);
+        if (it != shard.index.end()) {
+            if (it->second->expires > clock::now()) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+
+                if (!it->second->session) {
+                    negative_hits.fetch_add(1, std::memory_order_relaxed);
+                    throw SessionNotExistsException("Session with ID '" + id + "' does not exist");
+                }
+
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return *it->second->session;
+            }
+
+            remove(shard, it->second);
+        }
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+
+    try {
+        auto session = target->getSession(id);
+        store(id, session, config.ttl, generation);
+        return session;
+    } catch (SessionNotExistsException const&) {
+        store(id, std::nullopt, config.negative_ttl, generation);
+        throw;
+    }
+}
+
+void CachingSessionMgr::persistSession(Session const& session)
+{
+    target->persistSession(session);
+
+    // Only a TTL refresh, nothing for the cache or other nodes to learn
+    if (!session.isModified()) {
+        return;
+    }
+
+    if (session.isNew()) {
+        // Written in full, what we just wrote is what the store now holds
+        Session stored(session);
+        stored.markClean();
+        store(session.sessionId(), std::move(stored), config.ttl);
+    } else {
+        apply(session);
+    }
+
+    if (bus != nullptr) {
+        bus->publish(session.sessionId());
+    }
+}
+
+bool CachingSessionMgr::touchSession(std::string const& id)
+{
+    auto& shard = shardFor(id);
+    std::uint64_t generation;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        generation = shard.generation;
+
+        auto it = shard.index.find(id);
+        if (it != shard.index.end() && !it->second->session && it->second->expires > clock::now()) {
+            negative_hits.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    if (target->touchSession(id)) {
+        return true;
+    }
+
+    store(id, std::nullopt, config.negative_ttl, generation);
+    return false;
+}
+
+void CachingSessionMgr::setSessionTtl(uint64_t ttl)
+{
+    target->setSessionTtl(ttl);
+}
+
+void CachingSessionMgr::flush()
+{
+    target->flush();
+}
+
+void CachingSessionMgr::invalidate(std::string const& id)
+{
+    auto& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    ++shard.generation;
+
+    auto it = shard.index.find(id);
+    if (it != shard.index.end()) {
+        remove(shard, it->second);
+        invalidations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void CachingSessionMgr::clear()
+{
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->lru.clear();
+        shard->bytes = 0;
+    }
+}
+
+SessionCacheStats CachingSessionMgr::stats() const
+{
+    SessionCacheStats s;
+    s.hits = hits.load(std::memory_order_relaxed);
+    s.misses = misses.load(std::memory_order_relaxed);
+    s.negative_hits = negative_hits.load(std::memory_order_relaxed);
+    s.invalidations = invalidations.load(std::memory_order_relaxed);
+    s.evictions = evictions.load(std::memory_order_relaxed);
+
+    for (auto const& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        s.entries += shard->index.size();
+        s.bytes += shard->bytes;
+    }
+
+    return s;
+}
+
+CachingSessionMgr::Shard& CachingSessionMgr::shardFor(std::string const& id)
+{
+    return *shards[std::hash<std::string>()(id) % shards.size()];
+}
+
+/**
+ * Cache a session, or that it doesn't exist. A read from the target passes the shard generation from before it was
+ * made, and is dropped if the shard has seen an invalidation since.
+ */
+void CachingSessionMgr::store(std::string const& id, std::optional<Session> session, std::chrono::milliseconds ttl,
+                              std::optional<std::uint64_t> generation)
+{
+    auto size = entrySize(id, session);
+    if (size > shard_budget || ttl.count() <= 0) {
+        return;
+    }
+
+    auto& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (generation && *generation != shard.generation) {
+        return;
+    }
+
+    auto it = shard.index.find(id);
+    if (it != shard.index.end()) {
+        remove(shard, it->second);
+    }
+
+    shard.lru.push_front(Entry{id, std::move(session), clock::now() + ttl, size});
+    shard.index.emplace(id, shard.lru.begin());
+    shard.bytes += size;
+
+    while (shard.bytes > shard_budget) {
+        remove(shard, std::prev(shard.lru.end()));
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * The store only received the session's changes, so apply them to the cached copy rather than caching the writer's,
+ * which misses anything written since it was read. Without a cached copy there's nothing to apply them to, the next
+ * read fetches the result.
+ */
+void CachingSessionMgr::apply(Session const& session)
+{
+    auto& shard = shardFor(session.sessionId());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // A read made before this write mustn't be cached over it
+    ++shard.generation;
+
+    auto it = shard.index.find(session.sessionId());
+    if (it == shard.index.end()) {
+        return;
+    }
+
+    auto& entry = *it->second;
+    if (!entry.session) {
+        remove(shard, it->second);
+        return;
+    }
+
+    entry.session->merge(session);
+    entry.session->markClean();
+
+    shard.bytes -= entry.size;
+    entry.size = entrySize(entry.id, entry.session);
+    shard.bytes += entry.size;
+
+    while (shard.bytes > shard_budget && !shard.lru.empty()) {
+        remove(shard, std::prev(shard.lru.end()));
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void CachingSessionMgr::remove(Shard& shard, std::list<Entry>::iterator it)
+{
+    shard.bytes -= it->size;
+    shard.index.erase(it->id);
+    shard.lru.erase(it);
+}
+
+std::size_t CachingSessionMgr::entrySize(std::string const& id, std::optional<Session> const& session)
+{
+    return id.size() * 2 + ENTRY_OVERHEAD + (session ? session->memorySize() : 0);
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "session_interface.h"
+
+namespace bes::web {
+
+/**
+ * Carries session invalidations between the nodes of a deployment, so that a session written on one node is dropped
+ * from the session caches of the others.
+ */
+class SessionInvalidationBus
+{
+   public:
+    using Handler = std::function<void(std::string const& session_id)>;
+    using Subscription = std::uint64_t;
+
+    virtual ~SessionInvalidationBus() = default;
+
+    /**
+     * Tell the other nodes that a session has changed.
+     */
+    virtual void publish(std::string const& session_id) = 0;
+
+    /**
+     * Call the handler for every session another node reports as changed, until it is unsubscribed or the bus is
+     * destroyed. The handler may be called from any thread.
+     */
+    virtual Subscription subscribe(Handler handler) = 0;
+
+    /**
+     * Stop calling a subscribed handler. Once this returns the handler isn't running and won't be called again, so its
+     * owner may go away; it mustn't be called from the handler itself.
+     */
+    virtual void unsubscribe(Subscription subscription) = 0;
+};
+
+struct SessionCacheConfig
+{
+    /// Memory for cached sessions, split evenly between the shards
+    std::size_t byte_budget = 16 * 1024 * 1024;
+
+    /// How long a cached session is trusted; the longest another node's write can go unseen without an invalidation bus
+    std::chrono::milliseconds ttl{2000};
+
+    /// How long a session ID is remembered as missing, zero to disable the negative cache
+    std::chrono::milliseconds negative_ttl{1000};
+
+    std::size_t shards = 16;
+};
+
+struct SessionCacheStats
+{
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t negative_hits = 0;
+    std::uint64_t invalidations = 0;
+    std::uint64_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+};
+
+/**
+ * An in-process cache of sessions in front of another session manager.
+ *
+ * Reads are served from the cache for up to the configured TTL, and the changes to a session persisted through this
+ * manager are applied to its cached copy. IDs the target reports as missing (expired or forged) are remembered for the
+ * negative TTL, so they don't reach the store at all. Like the ResponseCache, entries are split across shards, each
+ * with its own lock, LRU list and share of the byte budget:
+ *
+ *      server.emplaceSessionInterface<CachingSessionMgr>(redis_mgr, SessionCacheConfig{}, bus);
+ *
+ * With more than one node, a session written on one node is stale in the others' caches until the TTL runs out. Give
+ * each node an invalidation bus to drop it straight away instead, the TTL then only bounds lost invalidations.
+ */
+class CachingSessionMgr : public SessionInterface
+{
+   public:
+    using clock = std::chrono::steady_clock;
+
+    explicit CachingSessionMgr(std::shared_ptr<SessionInterface> target, SessionCacheConfig config = {},
+                               std::shared_ptr<SessionInvalidationBus> bus = nullptr);
+    ~CachingSessionMgr() override;
+
+    CachingSessionMgr(CachingSessionMgr const&) = delete;
+    CachingSessionMgr& operator=(CachingSessionMgr const&) = delete;
+
+    [[nodiscard]] Session createSession(std::string const& ns) override;
+    [[nodiscard]] Session getSession(std::string const& id) override;
+    void persistSession(Session const& session) override;
+
+    /**
+     * Refresh the session's TTL in the target, unless the cache already knows the session doesn't exist.
+     */
+    bool touchSession(std::string const& id) override;
+
+    void setSessionTtl(uint64_t ttl) override;
+    void flush() override;
+
+    /**
+     * Drop a session from the cache, including a negative entry for it.
+     */
+    void invalidate(std::string const& id);
+
+    void clear();
+
+    [[nodiscard]] SessionCacheStats stats() const;
+
+   private:
+    struct Entry
+    {
+        std::string id;
+
+        // Empty for a session known not to exist
+        std::optional<Session> session;
+        clock::time_point expires;
+        std::size_t size;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        std::size_t bytes = 0;
+
+        // Bumped by every invalidation, so a read that raced with one isn't cached
+        std::uint64_t generation = 0;
+    };
+
+    std::shared_ptr<SessionInterface> target;
+    SessionCacheConfig config;
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::size_t shard_budget;
+
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> negative_hits{0};
+    std::atomic<std::uint64_t> invalidations{0};
+    std::atomic<std::uint64_t> evictions{0};
+
+    // Shared with other managers, so it may outlive us; we unsubscribe before anything is destroyed
+    std::shared_ptr<SessionInvalidationBus> bus;
+    SessionInvalidationBus::Subscription subscription = 0;
+
+    Shard& shardFor(std::string const& id);
+    void store(std::string const& id, std::optional<Session> session, std::chrono::milliseconds ttl,
+               std::optional<std::uint64_t> generation = std::nullopt);
+    void apply(Session const& session);
+    static void remove(Shard& shard, std::list<Entry>::iterator it);
+    static std::size_t entrySize(std::string const& id, std::optional<Session> const& session);
+};
+
+}  // namespace bes::web
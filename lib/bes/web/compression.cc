@@ -0,0 +1,265 @@
+#include "compression.h"
+
+#include <zlib.h>
+
+#include "exception.h"
+
+using namespace bes::web;
+
+namespace {
+
+std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+        s.remove_suffix(1);
+    }
+
+    return s;
+}
+
+bool iequals(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        char c = a[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != b[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool startsWith(std::string_view s, std::string_view prefix)
+{
+    return s.size() >= prefix.size() && iequals(s.substr(0, prefix.size()), prefix);
+}
+
+/**
+ * Parse the q-value of a coding's parameters (eg, " q=0.5"), in thousandths. A malformed value counts as 1.
+ */
+int qValue(std::string_view params)
+{
+    while (!params.empty()) {
+        auto semi = params.find(';');
+        auto param = trim(params.substr(0, semi));
+
+        if (param.size() >= 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+            param.remove_prefix(2);
+            if (param.empty() || (param[0] != '0' && param[0] != '1')) {
+                return 1000;
+            }
+
+            int q = (param[0] - '0') * 1000;
+            if (param.size() > 2 && param[1] == '.') {
+                int scale = 100;
+                for (std::size_t i = 2; i < param.size() && i < 5 && param[i] >= '0' && param[i] <= '9'; ++i) {
+                    q += (param[i] - '0') * scale;
+                    scale /= 10;
+                }
+            }
+
+            return q > 1000 ? 1000 : q;
+        }
+
+        if (semi == std::string_view::npos) {
+            break;
+        }
+        params.remove_prefix(semi + 1);
+    }
+
+    return 1000;
+}
+
+/**
+ * A deflate stream for one encoding, kept per thread and reset between bodies.
+ */
+class Deflater
+{
+   public:
+    Deflater() = default;
+    Deflater(Deflater const&) = delete;
+    Deflater& operator=(Deflater const&) = delete;
+
+    ~Deflater()
+    {
+        if (initialised) {
+            deflateEnd(&stream);
+        }
+    }
+
+    z_stream& get(int window_bits, int level)
+    {
+        if (initialised && level == stream_level) {
+            if (deflateReset(&stream) != Z_OK) {
+                throw WebException("Unable to reset zlib stream");
+            }
+            return stream;
+        }
+
+        if (initialised) {
+            deflateEnd(&stream);
+            initialised = false;
+        }
+
+        stream = z_stream{};
+        if (deflateInit2(&stream, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw WebException("Unable to initialise zlib stream at level " + std::to_string(level));
+        }
+
+        initialised = true;
+        stream_level = level;
+
+        return stream;
+    }
+
+   private:
+    z_stream stream{};
+    bool initialised = false;
+    int stream_level = 0;
+};
+
+}  // namespace
+
+ContentEncoding bes::web::negotiateEncoding(std::string_view accept_encoding)
+{
+    int gzip = -1;
+    int deflate = -1;
+    int any = -1;
+
+    while (!accept_encoding.empty()) {
+        auto comma = accept_encoding.find(',');
+        auto entry = accept_encoding.substr(0, comma);
+
+        auto semi = entry.find(';');
+        auto coding = trim(entry.substr(0, semi));
+        int q = semi == std::string_view::npos ? 1000 : qValue(entry.substr(semi + 1));
+
+        if (iequals(coding, "gzip") || iequals(coding, "x-gzip")) {
+            gzip = q;
+        } else if (iequals(coding, "deflate")) {
+            deflate = q;
+        } else if (coding == "*") {
+            any = q;
+        }
+
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        accept_encoding.remove_prefix(comma + 1);
+    }
+
+    // Codings that aren't listed take the q-value of a wildcard, if there is one
+    if (gzip < 0) {
+        gzip = any;
+    }
+
+    if (deflate < 0) {
+        deflate = any;
+    }
+
+    if (gzip > 0 && gzip >= deflate) {
+        return ContentEncoding::GZIP;
+    } else if (deflate > 0) {
+        return ContentEncoding::DEFLATE;
+    } else {
+        return ContentEncoding::IDENTITY;
+    }
+}
+
+char const* bes::web::encodingName(ContentEncoding encoding)
+{
+    switch (encoding) {
+        case ContentEncoding::GZIP:
+            return "gzip";
+        case ContentEncoding::DEFLATE:
+            return "deflate";
+        default:
+            return nullptr;
+    }
+}
+
+bool bes::web::compressibleType(std::string_view content_type)
+{
+    content_type = trim(content_type.substr(0, content_type.find(';')));
+
+    if (startsWith(content_type, "text/")) {
+        return true;
+    }
+
+    auto slash = content_type.find('/');
+    if (slash == std::string_view::npos) {
+        return false;
+    }
+
+    auto subtype = content_type.substr(slash + 1);
+
+    // Structured syntax suffixes, eg: application/ld+json, application/atom+xml
+    auto plus = subtype.rfind('+');
+    if (plus != std::string_view::npos) {
+        subtype.remove_prefix(plus + 1);
+    }
+
+    return iequals(subtype, "json") || iequals(subtype, "javascript") || iequals(subtype, "xml") ||
+           iequals(subtype, "svg") || iequals(subtype, "xhtml") || iequals(subtype, "x-javascript");
+}
+
+std::string bes::web::compress(std::string_view data, ContentEncoding encoding, int level)
+{
+    if (encoding == ContentEncoding::IDENTITY) {
+        return std::string(data);
+    }
+
+    if (level < 1 || level > 9) {
+        throw WebException("Invalid compression level: " + std::to_string(level));
+    }
+
+    thread_local Deflater gzip_deflater;
+    thread_local Deflater zlib_deflater;
+
+    // 15 window bits is zlib framing, +16 asks for a gzip header and trailer instead
+    z_stream& stream = encoding == ContentEncoding::GZIP ? gzip_deflater.get(15 + 16, level)
+                                                         : zlib_deflater.get(15, level);
+
+    std::string out;
+    out.resize(deflateBound(&stream, static_cast<uLong>(data.size())));
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    // deflateBound() leaves room for the whole body, so a single call finishes the stream
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        throw WebException("zlib failed to compress response body");
+    }
+
+    out.resize(stream.total_out);
+
+    return out;
+}
+
+std::string bes::web::encodedETag(std::string_view etag, ContentEncoding encoding)
+{
+    auto const* name = encodingName(encoding);
+    if (name == nullptr || etag.size() < 2 || etag.back() != '"') {
+        return std::string(etag);
+    }
+
+    std::string tag(etag.substr(0, etag.size() - 1));
+    tag += '-';
+    tag += name;
+    tag += '"';
+
+    return tag;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace bes::web {
+
+/**
+ * Content-codings we can apply to a response body.
+ */
+enum class ContentEncoding : char
+{
+    IDENTITY,
+    GZIP,
+    DEFLATE,
+};
+
+struct CompressionConfig
+{
+    /// zlib compression level, 1 (fastest) to 9 (smallest)
+    int level = 6;
+
+    /// Bodies smaller than this are sent as they are; compression doesn't pay for itself on tiny payloads
+    std::size_t min_size = 1024;
+};
+
+/**
+ * Pick a content-coding from an Accept-Encoding header value, honouring q-values. gzip is preferred over deflate when
+ * both are equally acceptable; IDENTITY is returned when neither is acceptable.
+ */
+ContentEncoding negotiateEncoding(std::string_view accept_encoding);
+
+/**
+ * The Content-Encoding token for an encoding, or nullptr for IDENTITY.
+ */
+char const* encodingName(ContentEncoding encoding);
+
+/**
+ * Check if a Content-Type is worth compressing: text, JSON, JavaScript, XML and SVG. Images, archives and other
+ * binary formats are already compressed.
+ */
+bool compressibleType(std::string_view content_type);
+
+/**
+ * Compress a body with zlib. GZIP produces a gzip member, DEFLATE a zlib stream (which is what HTTP calls "deflate").
+ *
+ * Each thread keeps its own zlib state, which is reset rather than reallocated between calls.
+ */
+std::string compress(std::string_view data, ContentEncoding encoding, int level);
+
+/**
+ * The entity tag of an encoded representation: a representation with a different Content-Encoding is a different
+ * entity, so it needs a different tag. "9f86d081884c7d65" becomes "9f86d081884c7d65-gzip".
+ */
+std::string encodedETag(std::string_view etag, ContentEncoding encoding);
+
+}  // namespace bes::web
@@ -0,0 +1,119 @@
+#include "etag.h"
+
+#include <cstring>
+
+using namespace bes::web;
+
+namespace {
+
+std::string_view stripWeak(std::string_view tag)
+{
+    if (tag.size() > 2 && tag[0] == 'W' && tag[1] == '/') {
+        tag.remove_prefix(2);
+    }
+
+    return tag;
+}
+
+std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) {
+        s.remove_prefix(1);
+    }
+
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) {
+        s.remove_suffix(1);
+    }
+
+    return s;
+}
+
+}  // namespace
+
+std::uint64_t bes::web::contentHash(std::string_view data, std::uint64_t seed)
+{
+    constexpr std::uint64_t m = 0xc6a4a7935bd1e995ULL;
+    constexpr int r = 47;
+
+    std::uint64_t h = seed ^ (data.size() * m);
+    char const* p = data.data();
+    char const* const end = p + (data.size() & ~std::size_t(7));
+
+    for (; p != end; p += 8) {
+        std::uint64_t k;
+        std::memcpy(&k, p, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    auto const* tail = reinterpret_cast<unsigned char const*>(p);
+    switch (data.size() & 7) {
+        case 7:
+            h ^= std::uint64_t(tail[6]) << 48;
+            [[fallthrough]];
+        case 6:
+            h ^= std::uint64_t(tail[5]) << 40;
+            [[fallthrough]];
+        case 5:
+            h ^= std::uint64_t(tail[4]) << 32;
+            [[fallthrough]];
+        case 4:
+            h ^= std::uint64_t(tail[3]) << 24;
+            [[fallthrough]];
+        case 3:
+            h ^= std::uint64_t(tail[2]) << 16;
+            [[fallthrough]];
+        case 2:
+            h ^= std::uint64_t(tail[1]) << 8;
+            [[fallthrough]];
+        case 1:
+            h ^= std::uint64_t(tail[0]);
+            h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+
+    return h;
+}
+
+std::string bes::web::strongETag(std::string_view content)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    auto h = contentHash(content);
+    std::string tag(18, '"');
+    for (int i = 16; i > 0; --i) {
+        tag[i] = hex[h & 0xf];
+        h >>= 4;
+    }
+
+    return tag;
+}
+
+bool bes::web::etagMatches(std::string_view if_none_match, std::string_view etag)
+{
+    etag = stripWeak(etag);
+
+    while (!if_none_match.empty()) {
+        auto comma = if_none_match.find(',');
+        auto candidate = trim(if_none_match.substr(0, comma));
+
+        if (candidate == "*" || stripWeak(candidate) == etag) {
+            return true;
+        }
+
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        if_none_match.remove_prefix(comma + 1);
+    }
+
+    return false;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace bes::web {
+
+/**
+ * Fast non-cryptographic 64-bit hash (MurmurHash64A), used to tag response bodies. Not suitable where an adversary
+ * could benefit from a collision.
+ */
+std::uint64_t contentHash(std::string_view data, std::uint64_t seed = 0);
+
+/**
+ * A strong entity tag for the given content, quoted and ready for the ETag header: "9f86d081884c7d65"
+ */
+std::string strongETag(std::string_view content);
+
+/**
+ * Check an If-None-Match header value against an entity tag. Uses the weak comparison required for If-None-Match, so
+ * a W/ prefix on either side is ignored; `*` matches anything.
+ */
+bool etagMatches(std::string_view if_none_match, std::string_view etag);
+
+}  // namespace bes::web
@@ -34,6 +34,14 @@ class SessionNotExistsException : public WebException
     using WebException::WebException;
 };
 
+/**
+ * A new session's ID belongs to an existing session.
+ */
+class SessionCollisionException : public WebException
+{
+    using WebException::WebException;
+};
+
 class SessionIndexError : public WebException
 {
     using WebException::WebException;
@@ -0,0 +1,188 @@
+#include "header_list.h"
+
+#include <array>
+#include <cctype>
+#include <ctime>
+#include <stdexcept>
+
+#include "http.h"
+
+using namespace bes::web;
+
+namespace {
+
+// Indexed by HeaderName
+constexpr std::array<std::string_view, 10> INTERNED_NAMES = {
+    "",
+    Http::Header::STATUS,
+    Http::Header::CONTENT_TYPE,
+    Http::Header::CONTENT_LENGTH,
+    Http::Header::CACHE_CONTROL,
+    Http::Header::SET_COOKIE,
+    Http::Header::ETAG,
+    Http::Header::LOCATION,
+    Http::Header::CONTENT_ENCODING,
+    Http::Header::VARY,
+};
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}  // namespace
+
+HeaderList::Entry::Entry(std::string_view name, std::string value) : value(std::move(value)), header_id(intern(name))
+{
+    if (header_id == HeaderName::OTHER) {
+        other_name = name;
+    }
+}
+
+std::string_view HeaderList::Entry::name() const
+{
+    return header_id == HeaderName::OTHER ? std::string_view(other_name) : nameOf(header_id);
+}
+
+HeaderName HeaderList::Entry::id() const
+{
+    return header_id;
+}
+
+void HeaderList::Entry::serialise(std::string& out) const
+{
+    auto n = name();
+    out.append(n.data(), n.size());
+    out.append(": ", 2);
+    out.append(value);
+    out.push_back('\n');
+}
+
+void HeaderList::set(std::string_view name, std::string value)
+{
+    auto i = indexOf(name);
+    if (i < entries.size()) {
+        entries[i].value = std::move(value);
+    } else {
+        entries.emplace_back(name, std::move(value));
+    }
+}
+
+std::string const* HeaderList::get(std::string_view name) const
+{
+    auto i = indexOf(name);
+    return i < entries.size() ? &entries[i].value : nullptr;
+}
+
+std::string const* HeaderList::get(HeaderName id) const
+{
+    for (auto const& entry : entries) {
+        if (entry.id() == id) {
+            return &entry.value;
+        }
+    }
+
+    return nullptr;
+}
+
+std::string const& HeaderList::at(std::string_view name) const
+{
+    if (auto const* value = get(name)) {
+        return *value;
+    }
+
+    throw std::out_of_range("No header named " + std::string(name));
+}
+
+void HeaderList::serialise(std::string& out) const
+{
+    for (auto const& entry : entries) {
+        entry.serialise(out);
+    }
+}
+
+std::vector<HeaderList::Entry>::const_iterator HeaderList::begin() const
+{
+    return entries.begin();
+}
+
+std::vector<HeaderList::Entry>::const_iterator HeaderList::end() const
+{
+    return entries.end();
+}
+
+std::size_t HeaderList::size() const
+{
+    return entries.size();
+}
+
+bool HeaderList::empty() const
+{
+    return entries.empty();
+}
+
+HeaderName HeaderList::intern(std::string_view name)
+{
+    for (std::size_t i = 1; i < INTERNED_NAMES.size(); ++i) {
+        if (equalsIgnoreCase(name, INTERNED_NAMES[i])) {
+            return static_cast<HeaderName>(i);
+        }
+    }
+
+    return HeaderName::OTHER;
+}
+
+std::string_view HeaderList::nameOf(HeaderName id)
+{
+    return INTERNED_NAMES[static_cast<std::size_t>(id)];
+}
+
+/**
+ * Position of the named header, or size() if it isn't set.
+ */
+std::size_t HeaderList::indexOf(std::string_view name) const
+{
+    auto id = intern(name);
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        auto const& entry = entries[i];
+        if (id != HeaderName::OTHER ? entry.id() == id
+                                    : entry.id() == HeaderName::OTHER && equalsIgnoreCase(entry.name(), name)) {
+            return i;
+        }
+    }
+
+    return entries.size();
+}
+
+PresetHeaders::PresetHeaders(HeaderList headers) : headers(std::move(headers))
+{
+    this->headers.serialise(block);
+}
+
+std::string_view bes::web::httpDate(std::chrono::system_clock::time_point when)
+{
+    thread_local std::time_t cached_time = -1;
+    thread_local char cached_date[32];
+    thread_local std::size_t cached_len = 0;
+
+    auto t = std::chrono::system_clock::to_time_t(when);
+    if (t != cached_time) {
+        std::tm tm{};
+        gmtime_r(&t, &tm);
+        cached_len = std::strftime(cached_date, sizeof(cached_date), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        cached_time = t;
+    }
+
+    return {cached_date, cached_len};
+}
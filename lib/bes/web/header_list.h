@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bes::web {
+
+/**
+ * Response headers common enough to be held as a tag, rather than as a copy of their name.
+ */
+enum class HeaderName : std::uint8_t
+{
+    OTHER,
+    STATUS,
+    CONTENT_TYPE,
+    CONTENT_LENGTH,
+    CACHE_CONTROL,
+    SET_COOKIE,
+    ETAG,
+    LOCATION,
+    CONTENT_ENCODING,
+    VARY,
+};
+
+/**
+ * Response headers, in the order they were first set.
+ *
+ * A response carries a handful of headers, so they're kept in a flat vector and found by a linear scan, which beats
+ * hashing the name at these sizes. Names are compared case-insensitively, and the common ones are interned to a
+ * HeaderName so they cost no allocation and compare as a single byte.
+ */
+class HeaderList
+{
+   public:
+    class Entry
+    {
+       public:
+        Entry(std::string_view name, std::string value);
+
+        [[nodiscard]] std::string_view name() const;
+        [[nodiscard]] HeaderName id() const;
+
+        /**
+         * Append "Name: value\n" to `out`.
+         */
+        void serialise(std::string& out) const;
+
+        std::string value;
+
+       private:
+        HeaderName header_id;
+        std::string other_name;
+    };
+
+    /**
+     * Set a header, replacing any value it already has.
+     */
+    void set(std::string_view name, std::string value);
+
+    /**
+     * Get a header's value, or nullptr if it isn't set.
+     */
+    [[nodiscard]] std::string const* get(std::string_view name) const;
+    [[nodiscard]] std::string const* get(HeaderName id) const;
+
+    /**
+     * Get a header's value, throwing std::out_of_range if it isn't set.
+     */
+    [[nodiscard]] std::string const& at(std::string_view name) const;
+
+    /**
+     * Append every header to `out`, one "Name: value\n" line each.
+     */
+    void serialise(std::string& out) const;
+
+    [[nodiscard]] std::vector<Entry>::const_iterator begin() const;
+    [[nodiscard]] std::vector<Entry>::const_iterator end() const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] bool empty() const;
+
+    /**
+     * The interned tag for a header name, or HeaderName::OTHER.
+     */
+    static HeaderName intern(std::string_view name);
+
+    /**
+     * The canonical spelling of an interned header name.
+     */
+    static std::string_view nameOf(HeaderName id);
+
+   private:
+    std::vector<Entry> entries;
+
+    std::size_t indexOf(std::string_view name) const;
+};
+
+/**
+ * Headers a route always sends, serialised once when the route is registered.
+ */
+struct PresetHeaders
+{
+    explicit PresetHeaders(HeaderList headers);
+
+    HeaderList headers;
+
+    /// The headers as they're written to the response
+    std::string block;
+};
+
+/**
+ * An HTTP date (IMF-fixdate, "Sun, 06 Nov 1994 08:49:37 GMT") for a point in time.
+ *
+ * Each thread keeps the last date it formatted, so the many cookies and headers stamped within the same second share a
+ * single formatting. The view is valid until the thread next calls this.
+ */
+std::string_view httpDate(std::chrono::system_clock::time_point when);
+
+}  // namespace bes::web
@@ -69,6 +69,15 @@ struct Http
         constexpr const static auto CONTENT_LENGTH = "Content-Length";
         constexpr const static auto CONTENT_DISPOSITION = "Content-Disposition";
         constexpr const static auto LOCATION = "Location";
+        constexpr const static auto ETAG = "ETag";
+        constexpr const static auto CONTENT_ENCODING = "Content-Encoding";
+        constexpr const static auto VARY = "Vary";
+        constexpr const static auto CACHE_CONTROL = "Cache-Control";
+        constexpr const static auto SET_COOKIE = "Set-Cookie";
+        constexpr const static auto LAST_MODIFIED = "Last-Modified";
+        constexpr const static auto EXPIRES = "Expires";
+        constexpr const static auto CONTENT_LOCATION = "Content-Location";
+        constexpr const static auto X_ACCEL_REDIRECT = "X-Accel-Redirect";
     };
 
     struct Parameter
@@ -78,6 +87,9 @@ struct Http
         constexpr const static auto REQUEST_URI = "REQUEST_URI";
         constexpr const static auto QUERY_STRING = "QUERY_STRING";
         constexpr const static auto REMOTE_ADDR = "REMOTE_ADDR";
+        constexpr const static auto IF_NONE_MATCH = "HTTP_IF_NONE_MATCH";
+        constexpr const static auto ACCEPT_ENCODING = "HTTP_ACCEPT_ENCODING";
+        constexpr const static auto COOKIE = "HTTP_COOKIE";
     };
 
     struct ContentType
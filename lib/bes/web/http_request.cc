@@ -2,21 +2,53 @@
 
 using namespace bes::web;
 
-HttpRequest::HttpRequest(bes::fastcgi::Request const& base, std::string const& session_prefix) : base_request(base)
+HttpRequest::HttpRequest(bes::fastcgi::Request const& base, std::string const& session_prefix)
+    : base_request(base), session_prefix(session_prefix)
 {
     http_method = Http::methodFromString(base_request.getParam(Http::Parameter::REQUEST_METHOD));
-    parseQueryString();
-    parseCookies();
-    bootstrapSession(session_prefix);
 }
 
 HttpRequest::~HttpRequest()
 {
-    // Persist the session
+    if (session_disabled || !session_loaded) {
+        // Never read, there's nothing to persist
+        auto session_id = sessionCookie();
+        if (!session_id) {
+            return;
+        }
+
+        if (auto counters = sessionCounters()) {
+            counters->skip();
+        }
+
+        if (session_disabled) {
+            return;
+        }
+
+        // But the session is still in use, so its TTL starts again
+        try {
+            sessionManager()->touchSession(std::string(*session_id));
+        } catch (std::exception const& e) {
+            BES_LOG(ERROR) << "Unable to refresh session '" << *session_id << "': " << e.what();
+        }
+
+        return;
+    }
+
+    // Persist the session; we're in a destructor, so a store that can't take it (down, or out of connections) costs
+    // this request's changes rather than the process
     if (hasSession()) {
-        auto session_mgr = base_request.container.get<bes::web::SessionInterface>(SVC_SESSION_MGR);
+        auto session_mgr = sessionManager();
         if (session_mgr != nullptr) {
-            session_mgr->persistSession(session);
+            try {
+                session_mgr->persistSession(session);
+            } catch (SessionCollisionException const& e) {
+                // The cookie has already been rendered, too late to hand out another ID; with 128 random bits this
+                // means the key generator is broken
+                BES_LOG(ERROR) << "New session dropped, its ID is already in use: " << e.what();
+            } catch (std::exception const& e) {
+                BES_LOG(ERROR) << "Unable to persist session '" << session.sessionId() << "': " << e.what();
+            }
         }
     }
 }
@@ -31,196 +63,213 @@ std::string const& HttpRequest::queryString() const
     return base_request.getParam(Http::Parameter::QUERY_STRING);
 }
 
-Http::Method const& HttpRequest::method() const
+bool HttpRequest::ifNoneMatch(std::string_view etag) const
 {
-    return http_method;
-}
+    if (http_method != Http::Method::GET && http_method != Http::Method::HEAD) {
+        return false;
+    }
 
-/**
- * Parse the query string, breaking it down into key/value pairs and decoding URI encoding.
- */
-void HttpRequest::parseQueryString()
-{
-    std::string const& qs = queryString();
+    if (!base_request.hasParam(Http::Parameter::IF_NONE_MATCH)) {
+        return false;
+    }
 
-    uint8_t mode = 0;
-    unsigned char c;
-    std::stringstream key;
-    std::stringstream value;
+    return etagMatches(base_request.getParam(Http::Parameter::IF_NONE_MATCH), etag);
+}
 
-    for (size_t i = 0; i <= qs.length(); ++i) {
-        if (i == qs.length()) {
-            c = '&';
-        } else {
-            c = qs[i];
-        }
+ContentEncoding HttpRequest::acceptedEncoding() const
+{
+    if (!base_request.hasParam(Http::Parameter::ACCEPT_ENCODING)) {
+        return ContentEncoding::IDENTITY;
+    }
 
-        if (c == '=' && mode == 0) {
-            /// Switch to value mode
-            ++mode = 1;
-        } else if (c == '&') {
-            /// Next item
-            if (key.rdbuf()->in_avail()) {
-                query_params[key.str()] = value.str();
-            }
-            key.str(std::string());
-            value.str(std::string());
-            mode = 0;
-        } else {
-            /// Parse normal character
-            // Check for special encoding first -
-            if (c == '+') {
-                // + is URI for space
-                c = ' ';
-            } else if (c == '%' && (qs.length() - i > 2)) {
-                // Convert % notation to a regular char, we must have at least 2 bytes remaining for this to be valid
-                try {
-                    c = (hexToChar(qs[i + 1]) * 16) + hexToChar(qs[i + 2]);
-                    i += 2;
-                } catch (std::out_of_range const& e) {
-                    // Malformed URI, ignore the sequence
-                }
-            }
+    return negotiateEncoding(base_request.getParam(Http::Parameter::ACCEPT_ENCODING));
+}
 
-            // Add char to key/value
-            if (mode == 0) {
-                key << c;
-            } else {
-                value << c;
-            }
-        }
-    }
+Http::Method const& HttpRequest::method() const
+{
+    return http_method;
 }
 
-void HttpRequest::parseCookies()
+ParamList const& HttpRequest::queryParams() const
 {
-    if (!base_request.hasParam("HTTP_COOKIE")) {
-        return;
+    if (!query_params) {
+        query_params.emplace().parseQuery(queryString());
     }
 
-    uint8_t mode = 0;
-    std::stringstream key;
-    std::stringstream value;
-
-    for (char const& c : base_request.getParam("HTTP_COOKIE")) {
-        if (c == ';') {
-            /// Next cookie
-            if (key.rdbuf()->in_avail() && value.rdbuf()->in_avail()) {
-                cookies.insert_or_assign(key.str(), value.str());
-            }
-
-            key.str(std::string());
-            value.str(std::string());
-            mode = 0;
-            continue;
-
-        } else if (mode == 0 && c == '=') {
-            /// Move to value
-            ++mode;
-            continue;
-        } else if (std::isspace(c)) {
-            // Whitespace is not a legal cookie character, we'll use this opportunity to trim whitespace around the
-            // header parameters.
-            continue;
-        }
+    return *query_params;
+}
 
-        if (mode == 0) {
-            key << c;
-        } else {
-            value << c;
+ParamList const& HttpRequest::cookieParams() const
+{
+    if (!cookies) {
+        cookies.emplace();
+        if (base_request.hasParam(Http::Parameter::COOKIE)) {
+            cookies->parseCookies(base_request.getParam(Http::Parameter::COOKIE));
         }
     }
 
-    if (key.rdbuf()->in_avail() && value.rdbuf()->in_avail()) {
-        cookies.insert_or_assign(key.str(), value.str());
-    }
+    return *cookies;
 }
 
-/**
- * Converts an ASCII value of a hex character into the number it represents (eg 'D' == 13).
- */
-char HttpRequest::hexToChar(char c)
+bool HttpRequest::hasQueryParam(std::string_view key) const
 {
-    if (c >= 'a' && c <= 'z') {
-        // Convert lowercase notation
-        c -= 32;  // 32 is the ASCII difference from A to a
-    } else if ((c < '0' || c > '9') && (c < 'A' || c > 'Z')) {
-        // Not a hex character
-        throw std::out_of_range(std::string("Char ") + c + " is not an hex character");
-    }
+    return queryParams().find(key).has_value();
+}
 
-    if (c > '9') {
-        // 7 is the ASCII difference from 9 to A
-        c -= '7';
-    } else {
-        c -= '0';
+std::string_view HttpRequest::queryParam(std::string_view key) const
+{
+    if (auto value = queryParams().find(key)) {
+        return *value;
     }
 
-    return c;
+    throw std::out_of_range("Query param does not exist: " + std::string(key));
 }
 
-bool HttpRequest::hasQueryParam(std::string const& key) const
+std::optional<std::string_view> HttpRequest::findQueryParam(std::string_view key) const
 {
-    return query_params.find(key) != query_params.end();
+    return queryParams().find(key);
 }
 
-std::string const& HttpRequest::queryParam(std::string const& key) const
+bool HttpRequest::hasCookie(std::string_view key) const
 {
-    return query_params.at(key);
+    return cookieParams().find(key).has_value();
 }
 
-bool HttpRequest::hasCookie(std::string const& key) const
+std::string_view HttpRequest::getCookie(std::string_view key) const
 {
-    return cookies.find(key) != cookies.end();
+    if (auto value = cookieParams().find(key)) {
+        return *value;
+    }
+
+    throw std::out_of_range("Cookie does not exist: " + std::string(key));
+}
+
+std::optional<std::string_view> HttpRequest::findCookie(std::string_view key) const
+{
+    return cookieParams().find(key);
 }
 
-std::string const& HttpRequest::getCookie(std::string const& key) const
+bool HttpRequest::sessionLoaded() const
 {
-    return cookies.at(key);
+    return session_loaded && !session_disabled;
 }
 
 bool HttpRequest::hasSession() const
 {
-    return !session.sessionId().empty();
+    if (session_disabled) {
+        return false;
+    }
+
+    if (session_loaded) {
+        return !session.sessionId().empty();
+    }
+
+    return sessionCookie().has_value();
+}
+
+std::string_view HttpRequest::sessionId() const
+{
+    if (session_disabled) {
+        return {};
+    }
+
+    if (session_loaded) {
+        return session.sessionId();
+    }
+
+    return sessionCookie().value_or(std::string_view());
 }
 
 Session& HttpRequest::getSession() const
 {
+    if (session_disabled) {
+        return session;
+    }
+
+    loadSession();
+
     if (!hasSession()) {
         // Create a new session
-        auto session_mgr = base_request.container.get<bes::web::SessionInterface>(SVC_SESSION_MGR);
+        auto session_mgr = sessionManager();
         if (session_mgr == nullptr) {
             BES_LOG(WARNING) << "Session requested but no session manager available";
             return session;
         }
 
         session = session_mgr->createSession(*(base_request.container.get<std::string>(SESSION_PREFIX_KEY)));
+        if (auto counters = sessionCounters()) {
+            counters->create();
+        }
     }
 
     return session;
 }
 
+void HttpRequest::disableSession() const
+{
+    session_disabled = true;
+}
+
+std::shared_ptr<SessionInterface> HttpRequest::sessionManager() const
+{
+    return base_request.container.get<bes::web::SessionInterface>(SVC_SESSION_MGR);
+}
+
+/**
+ * The session ID sent by the client, if we have a session manager to look it up with.
+ */
+std::optional<std::string_view> HttpRequest::sessionCookie() const
+{
+    if (sessionManager() == nullptr) {
+        return std::nullopt;
+    }
+
+    return findCookie(*(base_request.container.get<std::string>(SESSION_COOKIE_KEY)));
+}
+
 /**
- * Create a session object if a session cookie exists.
- *
- * This function must be called after the cookies has been initialised, as it depends on them.
+ * Session usage counters, if the request container was loaded with them.
  */
-void HttpRequest::bootstrapSession(std::string const& prefix)
+SessionCounters* HttpRequest::sessionCounters() const
 {
-    auto session_mgr = base_request.container.get<bes::web::SessionInterface>(SVC_SESSION_MGR);
-    if (session_mgr == nullptr) {
+    if (!base_request.container.exists(SVC_SESSION_STATS)) {
+        return nullptr;
+    }
+
+    return base_request.container.get<SessionCounters>(SVC_SESSION_STATS).get();
+}
+
+/**
+ * Fetch the session named by the session cookie, if there is one. Only the first call does anything.
+ */
+void HttpRequest::loadSession() const
+{
+    if (session_loaded) {
         return;
     }
 
-    auto session_cookie = base_request.container.get<std::string>(SESSION_COOKIE_KEY);
+    session_loaded = true;
 
-    if (hasCookie(*session_cookie)) {
-        // Session cookie exists, query manager for it
-        try {
-            session = session_mgr->getSession(getCookie(*session_cookie));
-        } catch (SessionNotExistsException const&) {
-            // Session has likely expired, create a new one
-            session = session_mgr->createSession(prefix);
+    auto session_id = sessionCookie();
+    if (!session_id) {
+        return;
+    }
+
+    auto session_mgr = sessionManager();
+    auto counters = sessionCounters();
+
+    // Session cookie exists, query manager for it
+    try {
+        session = session_mgr->getSession(std::string(*session_id));
+        if (counters != nullptr) {
+            counters->load();
+        }
+    } catch (SessionNotExistsException const&) {
+        // Session has likely expired, create a new one
+        session = session_mgr->createSession(session_prefix);
+        if (counters != nullptr) {
+            counters->expire();
+            counters->create();
         }
     }
 }
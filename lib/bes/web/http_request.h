@@ -2,14 +2,18 @@
 
 #include <bes/fastcgi.h>
 
-#include <cctype>
-#include <unordered_map>
+#include <optional>
+#include <string_view>
 
+#include "compression.h"
 #include "cookie.h"
+#include "etag.h"
 #include "exception.h"
 #include "http.h"
 #include "model.h"
+#include "param_list.h"
 #include "session_interface.h"
+#include "session_stats.h"
 
 namespace bes::web {
 
@@ -36,23 +40,38 @@ class HttpRequest
 
     /**
      * Check if we have a query-string parameter (aka "GET" param)
+     *
+     * The query-string is parsed on first access to a query param, values are views into the FastCGI params and are
+     * valid for the lifetime of the request.
      */
-    [[nodiscard]] bool hasQueryParam(std::string const& key) const;
+    [[nodiscard]] bool hasQueryParam(std::string_view key) const;
 
     /**
      * Get the value of a query-string parameter, throwing a std::out_of_range exception if it doesn't exist.
      */
-    [[nodiscard]] std::string const& queryParam(std::string const& key) const;
+    [[nodiscard]] std::string_view queryParam(std::string_view key) const;
+
+    /**
+     * Get the value of a query-string parameter, or nullopt if it doesn't exist.
+     */
+    [[nodiscard]] std::optional<std::string_view> findQueryParam(std::string_view key) const;
 
     /**
      * Check for a cookie :)
+     *
+     * Like the query-string, the Cookie header is parsed on first access.
      */
-    [[nodiscard]] bool hasCookie(std::string const& key) const;
+    [[nodiscard]] bool hasCookie(std::string_view key) const;
 
     /**
      * Get the value of a cookie, throwing a std::out_of_range exception if it doesn't exist.
      */
-    [[nodiscard]] std::string const& getCookie(std::string const& key) const;
+    [[nodiscard]] std::string_view getCookie(std::string_view key) const;
+
+    /**
+     * Get the value of a cookie, or nullopt if it doesn't exist.
+     */
+    [[nodiscard]] std::optional<std::string_view> findCookie(std::string_view key) const;
 
     /**
      * Check for a FastCGI parameter
@@ -64,28 +83,64 @@ class HttpRequest
      */
     [[nodiscard]] std::string const& getParam(std::string const& key) const;
 
+    /**
+     * Check if the client already holds the entity with this tag, per its If-None-Match header. Only GET and HEAD
+     * requests can be answered with a 304, this is always false for other methods.
+     */
+    [[nodiscard]] bool ifNoneMatch(std::string_view etag) const;
+
+    /**
+     * The content-coding the client prefers for the response body, per its Accept-Encoding header.
+     */
+    [[nodiscard]] ContentEncoding acceptedEncoding() const;
+
     /**
      * Check if we have an existing session.
+     *
+     * This doesn't load the session, a session cookie is taken on faith until the session is read.
      */
     [[nodiscard]] bool hasSession() const;
 
+    /**
+     * ID of the existing session, or an empty string if there isn't one. Like hasSession(), this doesn't load it.
+     */
+    [[nodiscard]] std::string_view sessionId() const;
+
+    /**
+     * Whether the session has been read (or created) by this request, so that its ID is known to be good.
+     */
+    [[nodiscard]] bool sessionLoaded() const;
+
     /**
      * Get the session, create one if it didn't exist.
+     *
+     * The session is fetched from the session manager on first call, requests that never call this never fetch it.
      */
     Session& getSession() const;
 
+    /**
+     * Mark the request as not using sessions, for routes declared session-free: the session is never loaded, persisted
+     * or sent back, and getSession() yields a blank session that is discarded with the request.
+     */
+    void disableSession() const;
+
    protected:
     bes::fastcgi::Request const& base_request;
     Http::Method http_method;
-    std::unordered_map<std::string, std::string> query_params;
-    std::unordered_map<std::string, std::string> cookies;
+    mutable std::optional<ParamList> query_params;
+    mutable std::optional<ParamList> cookies;
     mutable Session session;
+    std::string session_prefix;
+    mutable bool session_loaded = false;
+    mutable bool session_disabled = false;
 
    private:
-    void parseQueryString();
-    void parseCookies();
-    void bootstrapSession(std::string const& prefix = "S");
-    static char hexToChar(char c);
+    ParamList const& queryParams() const;
+    ParamList const& cookieParams() const;
+    std::shared_ptr<SessionInterface> sessionManager() const;
+    std::optional<std::string_view> sessionCookie() const;
+    SessionCounters* sessionCounters() const;
+    void loadSession() const;
 };
 
 }  // namespace bes::web
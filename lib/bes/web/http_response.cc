@@ -15,21 +15,41 @@ void HttpResponse::status(Http::Status status_code, std::string const& content_t
 
 void HttpResponse::header(std::string const& key, std::string const& value)
 {
-    http_headers.insert_or_assign(key, value);
+    http_headers.set(key, value);
 }
 
-std::unordered_map<std::string, std::string> const& HttpResponse::headers() const
+HeaderList const& HttpResponse::headers() const
 {
     return http_headers;
 }
 
-size_t HttpResponse::write(std::string const& data)
+void HttpResponse::presetHeaders(std::shared_ptr<PresetHeaders const> preset)
 {
-    resp_content << data;
+    preset_headers = std::move(preset);
+}
+
+std::shared_ptr<PresetHeaders const> const& HttpResponse::presetHeaders() const
+{
+    return preset_headers;
+}
+
+size_t HttpResponse::write(std::string_view data)
+{
+    resp_content.append(data);
 
     return data.length();
 }
 
+bes::OutputBuffer& HttpResponse::body()
+{
+    return resp_content;
+}
+
+bes::OutputBuffer const& HttpResponse::body() const
+{
+    return resp_content;
+}
+
 std::string HttpResponse::content() const
 {
     return resp_content.str();
@@ -37,14 +57,60 @@ std::string HttpResponse::content() const
 
 void HttpResponse::setCookie(Cookie cookie)
 {
-    http_cookies.insert_or_assign(cookie.getName(), std::move(cookie));
+    for (auto& existing : http_cookies) {
+        if (existing.getName() == cookie.getName()) {
+            existing = std::move(cookie);
+            return;
+        }
+    }
+
+    http_cookies.push_back(std::move(cookie));
 }
 
-std::unordered_map<std::string, Cookie> const& HttpResponse::cookies() const
+std::vector<Cookie> const& HttpResponse::cookies() const
 {
     return http_cookies;
 }
 
+void HttpResponse::routeName(std::string name)
+{
+    route_name = std::move(name);
+}
+
+std::string const& HttpResponse::routeName() const
+{
+    return route_name;
+}
+
+void HttpResponse::cached(std::shared_ptr<CachedResponse const> entry)
+{
+    cached_entry = std::move(entry);
+}
+
+std::shared_ptr<CachedResponse const> const& HttpResponse::cached() const
+{
+    return cached_entry;
+}
+
+void HttpResponse::cacheStore(ResponseCacheStore store)
+{
+    cache_store = std::move(store);
+}
+
+std::optional<ResponseCacheStore> const& HttpResponse::cacheStore() const
+{
+    return cache_store;
+}
+
+HttpResponse HttpResponse::notModified(std::string const& etag)
+{
+    HttpResponse resp;
+    resp.status(Http::Status::NOT_MODIFIED);
+    resp.header(Http::Header::ETAG, etag);
+
+    return resp;
+}
+
 HttpResponse HttpResponse::ok(std::string const& content_type)
 {
     HttpResponse ok;
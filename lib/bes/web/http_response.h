@@ -1,10 +1,16 @@
 #pragma once
 
-#include <sstream>
-#include <unordered_map>
+#include <bes/core.h>
+
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 #include "cookie.h"
+#include "header_list.h"
 #include "http.h"
+#include "response_cache.h"
 
 namespace bes::web {
 
@@ -17,6 +23,11 @@ class HttpResponse
 
     static HttpResponse ok(std::string const& content_type = Http::ContentType::HTML);
 
+    /**
+     * An empty 304 response for a client that already holds the entity tagged `etag`.
+     */
+    static HttpResponse notModified(std::string const& etag);
+
     /**
      * Set an HTTP header.
      */
@@ -25,7 +36,13 @@ class HttpResponse
     /**
      * Get all headers.
      */
-    std::unordered_map<std::string, std::string> const& headers() const;
+    HeaderList const& headers() const;
+
+    /**
+     * Headers the route always sends, set by the router. Headers set on the response take precedence over these.
+     */
+    void presetHeaders(std::shared_ptr<PresetHeaders const> preset);
+    std::shared_ptr<PresetHeaders const> const& presetHeaders() const;
 
     /**
      * Sets the HTTP status code, and optionally the content-type.
@@ -39,24 +56,54 @@ class HttpResponse
     void setCookie(Cookie cookie);
 
     /**
-     * Get a map of all cookies
+     * Get all cookies, setting a cookie again replaces it.
      */
-    std::unordered_map<std::string, Cookie> const& cookies() const;
+    std::vector<Cookie> const& cookies() const;
 
     /**
      * Write content to the internal content buffer. Returns the length of content written.
      */
-    size_t write(std::string const& data);
+    size_t write(std::string_view data);
+
+    /**
+     * The content buffer, to render into directly through a bes::OutputStream. The responder moves it onto the
+     * FastCGI output rather than copying it.
+     */
+    bes::OutputBuffer& body();
+    bes::OutputBuffer const& body() const;
 
     /**
-     * Get the content.
+     * Get a copy of the content as a single string.
      */
     std::string content() const;
 
+    /**
+     * Name of the route that yielded this response, set by the router and used for the access log.
+     */
+    void routeName(std::string name);
+    std::string const& routeName() const;
+
+    /**
+     * A response served from the ResponseCache; the stored bytes are written in place of the headers and content.
+     */
+    void cached(std::shared_ptr<CachedResponse const> entry);
+    std::shared_ptr<CachedResponse const> const& cached() const;
+
+    /**
+     * Store this response in a ResponseCache once it has been rendered. Only 200 responses that don't set cookies are
+     * stored.
+     */
+    void cacheStore(ResponseCacheStore store);
+    std::optional<ResponseCacheStore> const& cacheStore() const;
+
    protected:
-    std::unordered_map<std::string, std::string> http_headers;
-    std::unordered_map<std::string, Cookie> http_cookies;
-    std::stringstream resp_content;
+    HeaderList http_headers;
+    std::shared_ptr<PresetHeaders const> preset_headers;
+    std::vector<Cookie> http_cookies;
+    bes::OutputBuffer resp_content;
+    std::string route_name;
+    std::shared_ptr<CachedResponse const> cached_entry;
+    std::optional<ResponseCacheStore> cache_store;
 };
 
 }  // namespace bes::web
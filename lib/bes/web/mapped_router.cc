@@ -1,7 +1,10 @@
 #include "mapped_router.h"
 
+#include <algorithm>
 #include <utility>
 
+#include "compression.h"
+
 using namespace bes::web;
 
 void MappedRouter::registerController(std::string const& name, Controller c)
@@ -13,6 +16,11 @@ void MappedRouter::registerController(std::string const& name, Controller c)
     controllers[name] = std::move(c);
 }
 
+void MappedRouter::registerVersion(std::string const& route_name, VersionProvider provider)
+{
+    versions[route_name] = std::move(provider);
+}
+
 void MappedRouter::loadRoutesFromString(std::string const& src)
 {
     YAML::Node root = YAML::Load(src);
@@ -29,6 +37,7 @@ void MappedRouter::addRoute(Route route)
 {
     BES_LOG(DEBUG) << "Registered route: " << route.name;
     routes[route.name] = std::move(route);
+    buildTree();
 }
 
 std::unordered_map<std::string, PrecachedRoute> const& MappedRouter::routeMap()
@@ -60,6 +69,9 @@ void MappedRouter::parseRoutes(YAML::Node& root)
             bes::web::Route route(name, uri);
             route.includes_query = getNodeValue(node.second, "includes_query", false);
             route.controller = getNodeValue(node.second, "controller", route.name);
+            parseCachePolicy(node.second["cache"], route.cache);
+            route.session = getNodeValue(node.second, "session", true);
+            parseResponseHeaders(node.second["headers"], route.response_headers);
 
             BES_LOG(DEBUG) << "Registered route: " << route.name;
 
@@ -69,6 +81,90 @@ void MappedRouter::parseRoutes(YAML::Node& root)
             BES_LOG(ERROR) << "Error parsing route '" << name << "': " << e.what();
         }
     }
+
+    buildTree();
+}
+
+/**
+ * A route's cache policy is either a TTL in seconds, or a map:
+ *
+ *   cache:
+ *     ttl: 300
+ *     query: [page, sort]
+ *     cookies: [currency]
+ *     headers: [Accept-Language]
+ */
+void MappedRouter::parseCachePolicy(YAML::Node const& node, RouteCache& cache)
+{
+    if (!node.IsDefined() || node.IsNull()) {
+        return;
+    }
+
+    if (node.IsScalar()) {
+        cache.ttl = std::chrono::seconds(node.as<long>());
+        return;
+    }
+
+    cache.ttl = std::chrono::seconds(getNodeValue<long>(node, "ttl", 0));
+    cache.query = getNodeValue(node, "query", std::vector<std::string>());
+    cache.cookies = getNodeValue(node, "cookies", std::vector<std::string>());
+
+    for (auto const& header : getNodeValue(node, "headers", std::vector<std::string>())) {
+        cache.headers.push_back(RouteCache::headerParam(header));
+    }
+}
+
+/**
+ * Headers to send with every response from a route, as a map:
+ *
+ *   headers:
+ *     Cache-Control: public, max-age=300
+ *     X-Frame-Options: DENY
+ */
+void MappedRouter::parseResponseHeaders(YAML::Node const& node, HeaderList& headers)
+{
+    if (!node.IsDefined() || !node.IsMap()) {
+        return;
+    }
+
+    for (auto const& it : node) {
+        headers.set(it.first.as<std::string>(), it.second.as<std::string>());
+    }
+}
+
+void MappedRouter::setResponseCache(std::shared_ptr<ResponseCache> cache)
+{
+    response_cache = std::move(cache);
+}
+
+std::shared_ptr<ResponseCache> const& MappedRouter::responseCache() const
+{
+    return response_cache;
+}
+
+/**
+ * Routes are inserted in name order, so that precedence between otherwise equal routes doesn't depend on the order
+ * they were loaded in.
+ */
+void MappedRouter::buildTree()
+{
+    std::vector<PrecachedRoute const*> sorted;
+    sorted.reserve(routes.size());
+    has_query_routes = false;
+
+    for (auto const& it : routes) {
+        sorted.push_back(&it.second);
+        has_query_routes = has_query_routes || it.second.includes_query;
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [](auto const* a, auto const* b) {
+        return a->name < b->name;
+    });
+
+    route_tree.clear();
+    for (auto const* route : sorted) {
+        route_tree.insert(*route);
+    }
 }
 
 std::string MappedRouter::getUri(std::string const& route_name) const
@@ -121,27 +217,105 @@ std::string MappedRouter::getUri(std::string const& route_name, ActionArgs const
 
 HttpResponse MappedRouter::yieldResponse(HttpRequest const& request) const
 {
-    try {
-        auto [route, args] = findRoute(request.uri(), request.queryString());
+    auto resp = tryYieldResponse(request);
+    if (!resp) {
+        throw CannotYieldException();
+    }
+
+    return std::move(*resp);
+}
+
+std::optional<HttpResponse> MappedRouter::tryYieldResponse(HttpRequest const& request) const
+{
+    ActionArgs args;
+    auto const* route = matchRoute(request.uri(), request.queryString(), args);
+    if (route == nullptr) {
+        return std::nullopt;
+    }
+
+    if (!route->session) {
+        request.disableSession();
+    }
+
+    // A known version can answer revalidation without running the controller
+    std::string etag;
+    auto version = versions.find(route->name);
+    if (version != versions.end()) {
+        if (auto v = version->second(request, args)) {
+            etag = strongETag(*v);
+
+            // The client may hold any encoding of it, which the responder would have tagged with a suffix
+            for (auto encoding : {ContentEncoding::IDENTITY, ContentEncoding::GZIP, ContentEncoding::DEFLATE}) {
+                auto tag = encodedETag(etag, encoding);
+                if (!request.ifNoneMatch(tag)) {
+                    continue;
+                }
+
+                auto resp = HttpResponse::notModified(tag);
+                resp.routeName(route->name);
+                resp.presetHeaders(route->preset_headers);
+                if (encoding != ContentEncoding::IDENTITY) {
+                    resp.header(Http::Header::VARY, "Accept-Encoding");
+                }
 
-        auto const& ctrl = controllers.find(route.controller);
-        if (ctrl == controllers.end()) {
-            throw InternalServerErrorHttpException("Route '" + route.name + "' requested missing controller '" +
-                                                   route.controller + "'");
+                return resp;
+            }
+        }
+    }
+
+    // Serve from the response cache where the route allows it
+    std::string cache_key;
+    if (response_cache != nullptr && route->cache.ttl.count() > 0 && request.method() == Http::Method::GET) {
+        cache_key = ResponseCache::key(*route, args, request);
+        if (auto entry = response_cache->get(cache_key)) {
+            HttpResponse resp;
+            resp.status(Http::Status::OK);
+            resp.cached(std::move(entry));
+            resp.routeName(route->name);
+
+            // Already in the cached headers, these are for a 304
+            resp.presetHeaders(route->preset_headers);
+            return resp;
         }
+    }
 
-        return ctrl->second(request, args);
+    auto const& ctrl = controllers.find(route->controller);
+    if (ctrl == controllers.end()) {
+        throw InternalServerErrorHttpException("Route '" + route->name + "' requested missing controller '" +
+                                               route->controller + "'");
+    }
+
+    auto resp = ctrl->second(request, args);
+    resp.routeName(route->name);
+    resp.presetHeaders(route->preset_headers);
+
+    if (!etag.empty()) {
+        resp.header(Http::Header::ETAG, etag);
+    }
+
+    if (!cache_key.empty()) {
+        resp.cacheStore(ResponseCacheStore{response_cache, std::move(cache_key), route->cache.ttl});
+    }
 
-    } catch (NoMatchException const&) {
+    return resp;
+}
+
+HttpResponse MappedRouter::yieldErrorResponse(HttpRequest const& request, Http::Status status_code,
+                                              std::string const& debug_msg) const
+{
+    auto resp = tryYieldErrorResponse(request, status_code, debug_msg);
+    if (!resp) {
         throw CannotYieldException();
     }
+
+    return std::move(*resp);
 }
 
 /**
  * Error router.
  *
- * Assumes a controller named "error_xxx" or "error", where "xxx" is the HTTP status code (such as 404). Will throw a
- * CannotYieldException if neither controllers exist.
+ * Assumes a controller named "error_xxx" or "error", where "xxx" is the HTTP status code (such as 404). Yields nothing
+ * if neither controllers exist.
  *
  * Injects the following into the ActionArgs:
  *  - error_code: 404
@@ -150,8 +324,8 @@ HttpResponse MappedRouter::yieldResponse(HttpRequest const& request) const
  *
  * Will set the correct HTTP status code to match the error, regardless of what the controller tries to return.
  */
-HttpResponse MappedRouter::yieldErrorResponse(HttpRequest const& request, Http::Status status_code,
-                                              std::string const& debug_msg) const
+std::optional<HttpResponse> MappedRouter::tryYieldErrorResponse(HttpRequest const& request, Http::Status status_code,
+                                                                std::string const& debug_msg) const
 {
     bes::web::ActionArgs args;
 
@@ -182,7 +356,7 @@ HttpResponse MappedRouter::yieldErrorResponse(HttpRequest const& request, Http::
         // Then look for a generalised error template
         it = controllers.find("error");
         if (it == controllers.end()) {
-            throw CannotYieldException();
+            return std::nullopt;
         }
     }
 
@@ -190,54 +364,37 @@ HttpResponse MappedRouter::yieldErrorResponse(HttpRequest const& request, Http::
 
     // Force the correct status code on the response
     resp.status(status_code);
+    resp.routeName(it->first);
     return resp;
 }
 
 std::tuple<Route const&, ActionArgs> MappedRouter::findRoute(std::string const& uri, std::string const& query) const
 {
-    std::string qs = uri;
-    qs += std::string("?") += query;
-    for (auto const& it : routes) {
-        try {
-            if (it.second.includes_query && query.length()) {
-                return {it.second, routeMatch(it.second, qs)};
-            } else {
-                return {it.second, routeMatch(it.second, uri)};
-            }
-        } catch (NoMatchException const&) {
-        }
+    ActionArgs args;
+    auto const* route = matchRoute(uri, query, args);
+    if (route == nullptr) {
+        throw NoMatchException("No route for URI '" + uri + "'");
     }
 
-    throw NoMatchException("No route for URI '" + uri + "'");
+    return {*route, std::move(args)};
 }
 
-ActionArgs MappedRouter::routeMatch(PrecachedRoute const& route, std::string const& uri)
+PrecachedRoute const* MappedRouter::matchRoute(std::string const& uri, std::string const& query,
+                                                ActionArgs& args) const
 {
-    ActionArgs args;
-
-    size_t start_len = route.prefix.length();
-    if (start_len && uri.substr(0, start_len) != route.prefix) {
-        throw NoMatchException();
+    if (query.empty() || !has_query_routes) {
+        return route_tree.match(uri, query.empty() ? RouteTree::Accept::ALL : RouteTree::Accept::PATH_ONLY, args);
     }
 
-    if (route.arg_map.empty()) {
-        // Has no regex, start_len should match the length of the URI
-        if (start_len == uri.length()) {
-            return args;
-        } else {
-            throw NoMatchException();
-        }
-    }
-
-    std::smatch match;
-    std::string uri_re_part = uri.substr(start_len);
+    thread_local std::string subject;
+    subject.assign(uri);
+    subject += '?';
+    subject += query;
 
-    if (std::regex_match(uri_re_part, match, route.regex) && match.size() == route.arg_map.size() + 1) {
-        for (size_t i = 0; i < route.arg_map.size(); ++i) {
-            args[route.arg_map[i]] = match[i + 1].str();
-        }
-        return args;
-    } else {
-        throw NoMatchException();
+    if (auto const* route = route_tree.match(subject, RouteTree::Accept::QUERY_ONLY, args)) {
+        return route;
     }
+
+    args.clear();
+    return route_tree.match(uri, RouteTree::Accept::PATH_ONLY, args);
 }
@@ -3,13 +3,16 @@
 #include <yaml-cpp/yaml.h>
 
 #include <functional>
+#include <optional>
 #include <regex>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "response_cache.h"
 #include "route.h"
+#include "route_tree.h"
 #include "router.h"
 
 namespace bes::web {
@@ -21,6 +24,10 @@ class MappedRouter : public Router
     HttpResponse yieldErrorResponse(HttpRequest const& request, Http::Status status_code,
                                     std::string const& debug_msg) const override;
 
+    std::optional<HttpResponse> tryYieldResponse(HttpRequest const& request) const override;
+    std::optional<HttpResponse> tryYieldErrorResponse(HttpRequest const& request, Http::Status status_code,
+                                                      std::string const& debug_msg) const override;
+
     void loadRoutesFromString(std::string const& src);
     void loadRoutesFromFile(std::string const& fn);
 
@@ -51,11 +58,34 @@ class MappedRouter : public Router
     /**
      * Match a route to the given URI.
      *
-     * Throws a NoMatchException if no route matches the URI.
+     * Throws a NoMatchException if no route matches the URI; use matchRoute() where a miss is expected.
      */
     std::tuple<Route const&, ActionArgs> findRoute(std::string const& uri,
                                                    std::string const& query = std::string()) const;
 
+    /**
+     * Match a route to the given URI, populating `args` with the route arguments. Returns nullptr if no route matches.
+     *
+     * Routes that include the query-string are tried against `uri?query` first, then the remaining routes against the
+     * URI alone.
+     */
+    PrecachedRoute const* matchRoute(std::string const& uri, std::string const& query, ActionArgs& args) const;
+
+    /**
+     * Register a version provider for a route, so that revalidation doesn't need the controller.
+     *
+     * The route's ETag is derived from the version. If the client already holds it, a 304 is returned without calling
+     * the controller; otherwise the controller's response is sent with that ETag, and the body isn't hashed. The
+     * version must change whenever the rendered output would, eg, a build number combined with a record's revision.
+     */
+    void registerVersion(std::string const& route_name, VersionProvider provider);
+
+    /**
+     * Serve routes that have a `cache` policy from this cache. Set before the server starts; nullptr disables caching.
+     */
+    void setResponseCache(std::shared_ptr<ResponseCache> cache);
+    [[nodiscard]] std::shared_ptr<ResponseCache> const& responseCache() const;
+
     size_t inline size() const
     {
         return routes.size();
@@ -63,12 +93,19 @@ class MappedRouter : public Router
 
    protected:
     std::unordered_map<std::string, Controller> controllers;
+    std::unordered_map<std::string, VersionProvider> versions;
     std::unordered_map<std::string, PrecachedRoute> routes;
+    RouteTree route_tree;
+    bool has_query_routes = false;
+    std::shared_ptr<ResponseCache> response_cache;
 
    private:
     void parseRoutes(YAML::Node& root);
+    static void parseCachePolicy(YAML::Node const& node, RouteCache& cache);
+    static void parseResponseHeaders(YAML::Node const& node, HeaderList& headers);
 
-    static ActionArgs routeMatch(PrecachedRoute const& route, std::string const& uri);
+    /// Recompile the route tree after the route map has changed
+    void buildTree();
 
     template <class T>
     static T getNodeValue(YAML::Node const& node, std::string const& key, T default_value);
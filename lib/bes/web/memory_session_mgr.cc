@@ -0,0 +1,394 @@
+#include "memory_session_mgr.h"
+
+#include <bes/log.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "binary_session_codec.h"
+
+using namespace bes::web;
+
+namespace {
+
+// Fixed cost of an entry beyond the session: list node, index node and its key, and the session's own containers
+constexpr std::size_t ENTRY_OVERHEAD = 256;
+
+// Snapshot header: magic and format version
+constexpr char SNAPSHOT_MAGIC[] = {'B', 'S', 'S', 'N'};
+constexpr char SNAPSHOT_VERSION = 1;
+
+void putFixed(std::string& out, std::uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>(v >> (i * 8)));
+    }
+}
+
+bool getFixed(std::string const& in, std::size_t& pos, std::uint64_t& v, int bytes)
+{
+    if (in.size() - pos < static_cast<std::size_t>(bytes)) {
+        return false;
+    }
+
+    v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        v |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(in[pos++])) << (i * 8);
+    }
+
+    return true;
+}
+
+}  // namespace
+
+MemorySessionMgr::MemorySessionMgr(MemorySessionConfig config) : config(std::move(config))
+{
+    auto shard_count = this->config.shards > 0 ? this->config.shards : 1;
+    shards.reserve(shard_count);
+    for (std::size_t i = 0; i < shard_count; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+
+    shard_budget = this->config.byte_budget / shard_count;
+
+    if (!this->config.snapshot_path.empty()) {
+        restore();
+    }
+
+    sweeper = std::thread([this] {
+        std::unique_lock<std::mutex> lock(sweeper_mutex);
+        while (!sweeper_cv.wait_for(lock, this->config.sweep_interval, [this] {
+            return stop;
+        })) {
+            lock.unlock();
+            sweep();
+            lock.lock();
+        }
+    });
+}
+
+MemorySessionMgr::~MemorySessionMgr()
+{
+    {
+        std::lock_guard<std::mutex> lock(sweeper_mutex);
+        stop = true;
+    }
+
+    sweeper_cv.notify_one();
+    sweeper.join();
+}
+
+/**
+ * Hand out a new session. Nothing is stored until it is persisted, when a collision with a live session is refused.
+ */
+Session MemorySessionMgr::createSession(std::string const& ns)
+{
+    return Session(SessionInterface::generateSessionKey(ns));
+}
+
+Session MemorySessionMgr::getSession(std::string const& id)
+{
+    auto& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(id);
+    if (it != shard.index.end()) {
+        if (!isExpired(*it->second, clock::now())) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            return it->second->session;
+        }
+
+        // The sweeper hasn't got to it yet
+        remove(shard, it->second);
+        expired.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    throw SessionNotExistsException("Session with ID '" + id + "' does not exist");
+}
+
+/**
+ * Store a new session, or apply a loaded session's changes to the stored copy. Either way its TTL starts again.
+ */
+void MemorySessionMgr::persistSession(Session const& session)
+{
+    if (session.sessionId().empty()) {
+        throw WebException("Attempting to persist a null session");
+    }
+
+    auto ttl = session_ttl.load(std::memory_order_relaxed);
+    auto now = clock::now();
+    std::optional<clock::time_point> expires;
+    if (ttl) {
+        expires = now + std::chrono::seconds(ttl);
+    }
+
+    auto& shard = shardFor(session.sessionId());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(session.sessionId());
+    bool live = it != shard.index.end() && !isExpired(*it->second, now);
+
+    if (session.isNew() && live) {
+        throw SessionCollisionException("Session ID '" + session.sessionId() + "' is already in use");
+    }
+
+    if (!live) {
+        // New, or expired or evicted while the request held it - store it as it stands
+        if (it != shard.index.end()) {
+            remove(shard, it->second);
+        }
+
+        Session stored(session);
+        stored.markClean();
+        store(shard, std::move(stored), expires);
+        return;
+    }
+
+    auto& entry = *it->second;
+    entry.session.merge(session);
+    entry.session.markClean();
+    entry.expires = expires;
+
+    shard.bytes -= entry.size;
+    entry.size = entrySize(entry.session);
+    shard.bytes += entry.size;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+
+    while (shard.bytes > shard_budget && shard.lru.size() > 1) {
+        remove(shard, std::prev(shard.lru.end()));
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool MemorySessionMgr::touchSession(std::string const& id)
+{
+    auto ttl = session_ttl.load(std::memory_order_relaxed);
+    auto now = clock::now();
+
+    auto& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(id);
+    if (it == shard.index.end() || isExpired(*it->second, now)) {
+        return false;
+    }
+
+    if (ttl) {
+        it->second->expires = now + std::chrono::seconds(ttl);
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    return true;
+}
+
+void MemorySessionMgr::setSessionTtl(uint64_t ttl)
+{
+    session_ttl.store(ttl, std::memory_order_relaxed);
+}
+
+void MemorySessionMgr::flush()
+{
+    if (!config.snapshot_path.empty()) {
+        snapshot();
+    }
+}
+
+/**
+ * Snapshot layout, integers little-endian:
+ *
+ *      magic (4) | version (1)
+ *      per session: ID length (4) | ID | expiry in seconds since the epoch, 0 for none (8) | length (4) | session
+ *
+ * where each session is packed by the BinarySessionCodec.
+ */
+void MemorySessionMgr::snapshot() const
+{
+    std::string data(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    data.push_back(SNAPSHOT_VERSION);
+
+    auto now = clock::now();
+    std::size_t count = 0;
+
+    for (auto const& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+
+        for (auto const& entry : shard->lru) {
+            if (isExpired(entry, now)) {
+                continue;
+            }
+
+            auto const& id = entry.session.sessionId();
+            auto blob = BinarySessionCodec::encode(entry.session, 0);
+            auto expires = entry.expires ? std::chrono::duration_cast<std::chrono::seconds>(
+                                               entry.expires->time_since_epoch())
+                                               .count()
+                                         : 0;
+
+            putFixed(data, id.size(), 4);
+            data.append(id);
+            putFixed(data, static_cast<std::uint64_t>(expires), 8);
+            putFixed(data, blob.size(), 4);
+            data.append(blob);
+            ++count;
+        }
+    }
+
+    // Write alongside and rename over, so a crash mid-write can't leave a truncated snapshot
+    auto tmp_path = config.snapshot_path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            throw WebException("Unable to write session snapshot to " + tmp_path);
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), config.snapshot_path.c_str()) != 0) {
+        throw WebException("Unable to replace session snapshot " + config.snapshot_path);
+    }
+
+    BES_LOG(INFO) << "Saved " << count << " sessions to " << config.snapshot_path;
+}
+
+std::size_t MemorySessionMgr::sweep()
+{
+    std::size_t dropped = 0;
+
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        auto now = clock::now();
+
+        for (auto it = shard->lru.begin(); it != shard->lru.end();) {
+            if (isExpired(*it, now)) {
+                remove(*shard, it++);
+                ++dropped;
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    expired.fetch_add(dropped, std::memory_order_relaxed);
+    return dropped;
+}
+
+MemorySessionStats MemorySessionMgr::stats() const
+{
+    MemorySessionStats s;
+    s.expired = expired.load(std::memory_order_relaxed);
+    s.evictions = evictions.load(std::memory_order_relaxed);
+
+    for (auto const& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        s.entries += shard->index.size();
+        s.bytes += shard->bytes;
+    }
+
+    return s;
+}
+
+MemorySessionMgr::Shard& MemorySessionMgr::shardFor(std::string const& id) const
+{
+    return *shards[std::hash<std::string>()(id) % shards.size()];
+}
+
+/**
+ * Add a session the shard doesn't hold, evicting the least recently used beyond the shard's budget. The new session is
+ * kept even if it is over budget on its own.
+ */
+void MemorySessionMgr::store(Shard& shard, Session session, std::optional<clock::time_point> expires)
+{
+    auto size = entrySize(session);
+    auto id = session.sessionId();
+
+    shard.lru.push_front(Entry{std::move(session), expires, size});
+    shard.index.emplace(std::move(id), shard.lru.begin());
+    shard.bytes += size;
+
+    while (shard.bytes > shard_budget && shard.lru.size() > 1) {
+        remove(shard, std::prev(shard.lru.end()));
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MemorySessionMgr::remove(Shard& shard, std::list<Entry>::iterator it)
+{
+    shard.bytes -= it->size;
+    shard.index.erase(it->session.sessionId());
+    shard.lru.erase(it);
+}
+
+bool MemorySessionMgr::isExpired(Entry const& entry, clock::time_point now)
+{
+    return entry.expires && *entry.expires <= now;
+}
+
+std::size_t MemorySessionMgr::entrySize(Session const& session)
+{
+    return ENTRY_OVERHEAD + session.sessionId().size() + session.memorySize();
+}
+
+/**
+ * Load the snapshot, if there is one, skipping sessions that have expired since it was written. A damaged snapshot is
+ * loaded as far as it can be read.
+ */
+void MemorySessionMgr::restore()
+{
+    std::ifstream in(config.snapshot_path, std::ios::binary);
+    if (!in) {
+        return;
+    }
+
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    if (data.size() < sizeof(SNAPSHOT_MAGIC) + 1 ||
+        data.compare(0, sizeof(SNAPSHOT_MAGIC), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        data[sizeof(SNAPSHOT_MAGIC)] != SNAPSHOT_VERSION) {
+        BES_LOG(WARNING) << "Ignoring unrecognised session snapshot " << config.snapshot_path;
+        return;
+    }
+
+    auto now = clock::now();
+    std::size_t pos = sizeof(SNAPSHOT_MAGIC) + 1;
+    std::size_t count = 0;
+
+    while (pos < data.size()) {
+        std::uint64_t id_len, expires, blob_len;
+
+        if (!getFixed(data, pos, id_len, 4) || data.size() - pos < id_len) {
+            break;
+        }
+        auto id = data.substr(pos, id_len);
+        pos += id_len;
+
+        if (!getFixed(data, pos, expires, 8) || !getFixed(data, pos, blob_len, 4) || data.size() - pos < blob_len) {
+            break;
+        }
+        std::string_view blob(data.data() + pos, blob_len);
+        pos += blob_len;
+
+        std::optional<clock::time_point> expiry;
+        if (expires) {
+            expiry = clock::time_point(std::chrono::seconds(static_cast<std::int64_t>(expires)));
+            if (*expiry <= now) {
+                continue;
+            }
+        }
+
+        try {
+            auto& shard = shardFor(id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            store(shard, BinarySessionCodec::decode(id, blob), expiry);
+            ++count;
+        } catch (SessionCodecException const& e) {
+            BES_LOG(WARNING) << "Skipping session '" << id << "' in snapshot: " << e.what();
+        }
+    }
+
+    if (pos < data.size()) {
+        BES_LOG(WARNING) << "Session snapshot " << config.snapshot_path << " is truncated";
+    }
+
+    BES_LOG(INFO) << "Restored " << count << " sessions from " << config.snapshot_path;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "session_interface.h"
+
+namespace bes::web {
+
+struct MemorySessionConfig
+{
+    /// Memory for stored sessions, split evenly between the shards; the least recently used are evicted beyond it
+    std::size_t byte_budget = 64 * 1024 * 1024;
+
+    std::size_t shards = 16;
+
+    /// How often the sweeper drops expired sessions
+    std::chrono::milliseconds sweep_interval{1000};
+
+    /// File to save sessions to on shutdown and restore them from on start, empty to keep them in memory only
+    std::string snapshot_path;
+};
+
+struct MemorySessionStats
+{
+    std::uint64_t expired = 0;
+    std::uint64_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+};
+
+/**
+ * A session manager that keeps sessions in process memory.
+ *
+ * For a single node there's no need to pay a network round trip per request for sessions, nor to run Redis at all:
+ *
+ *      MemorySessionConfig config;
+ *      config.snapshot_path = "/var/lib/app/sessions";
+ *      server.emplaceSessionInterface<MemorySessionMgr>(config);
+ *
+ * Sessions are split across shards by ID, each with its own lock, so request threads rarely wait on each other. A
+ * background thread drops sessions once their TTL has passed, and when a shard outgrows its share of the byte budget
+ * its least recently used sessions are evicted. Persisting a loaded session applies only its changes, so two requests
+ * writing different values of the same session don't undo each other.
+ *
+ * With a snapshot path, sessions are written to disk when the web server shuts down and read back when the manager is
+ * next constructed, so a restart doesn't sign everyone out.
+ */
+class MemorySessionMgr : public SessionInterface
+{
+   public:
+    explicit MemorySessionMgr(MemorySessionConfig config = {});
+    ~MemorySessionMgr() override;
+
+    MemorySessionMgr(MemorySessionMgr const&) = delete;
+    MemorySessionMgr& operator=(MemorySessionMgr const&) = delete;
+
+    [[nodiscard]] Session createSession(std::string const& ns) override;
+    [[nodiscard]] Session getSession(std::string const& id) override;
+    void persistSession(Session const& session) override;
+    bool touchSession(std::string const& id) override;
+    void setSessionTtl(uint64_t ttl) override;
+
+    /**
+     * Write the snapshot, if there is a snapshot path.
+     */
+    void flush() override;
+
+    /**
+     * Save every live session to the snapshot path, replacing the file in one step. Throws a WebException if it can't
+     * be written.
+     */
+    void snapshot() const;
+
+    /**
+     * Drop expired sessions now, rather than waiting for the sweeper. Returns the number dropped.
+     */
+    std::size_t sweep();
+
+    [[nodiscard]] MemorySessionStats stats() const;
+
+   private:
+    using clock = std::chrono::system_clock;
+
+    struct Entry
+    {
+        Session session;
+        std::optional<clock::time_point> expires;
+        std::size_t size;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        std::size_t bytes = 0;
+    };
+
+    MemorySessionConfig config;
+    std::atomic<uint64_t> session_ttl{0};
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::size_t shard_budget;
+
+    std::atomic<std::uint64_t> expired{0};
+    std::atomic<std::uint64_t> evictions{0};
+
+    std::mutex sweeper_mutex;
+    std::condition_variable sweeper_cv;
+    bool stop = false;
+    std::thread sweeper;
+
+    Shard& shardFor(std::string const& id) const;
+    void store(Shard& shard, Session session, std::optional<clock::time_point> expires);
+    static void remove(Shard& shard, std::list<Entry>::iterator it);
+    static bool isExpired(Entry const& entry, clock::time_point now);
+    static std::size_t entrySize(Session const& session);
+    void restore();
+};
+
+}  // namespace bes::web
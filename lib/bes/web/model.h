@@ -7,6 +7,10 @@ auto constexpr SVC_SESSION_MGR = "session_mgr";
 auto constexpr SVC_ROUTER = "routers";
 auto constexpr SESSION_TTL_KEY = "session_ttl";
 auto constexpr SESSION_SECURE_KEY = "session_secure";
+auto constexpr SVC_ACCESS_LOG = "access_log";
+auto constexpr AUTO_ETAG_KEY = "auto_etag";
+auto constexpr SVC_COMPRESSION = "compression";
+auto constexpr SVC_SESSION_STATS = "session_stats";
 
 auto constexpr SESSION_COOKIE_KEY = "session_cookie_name";
 auto constexpr SESSION_PREFIX_KEY = "session_prefix";
@@ -0,0 +1,208 @@
+#include "param_list.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace bes::web;
+
+namespace {
+
+/**
+ * The value of a hex digit (eg 'D' == 13), or -1 if it isn't one.
+ */
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else {
+        return -1;
+    }
+}
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && isSpace(s.front())) {
+        s.remove_prefix(1);
+    }
+
+    while (!s.empty() && isSpace(s.back())) {
+        s.remove_suffix(1);
+    }
+
+    return s;
+}
+
+}  // namespace
+
+std::size_t bes::web::findAnyOf(std::string_view s, std::size_t pos, char a, char b, char c, char d)
+{
+    char const* const data = s.data();
+    std::size_t const size = s.size();
+
+#if defined(__SSE2__)
+    __m128i const va = _mm_set1_epi8(a);
+    __m128i const vb = _mm_set1_epi8(b);
+    __m128i const vc = _mm_set1_epi8(c);
+    __m128i const vd = _mm_set1_epi8(d);
+
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i const chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + pos));
+        __m128i const hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(chunk, vc), _mm_cmpeq_epi8(chunk, vd)));
+
+        auto const mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (mask != 0) {
+            return pos + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+    }
+#endif
+
+    // Scalar fallback, and the tail of a vectorised scan
+    for (; pos < size; ++pos) {
+        char const ch = data[pos];
+        if (ch == a || ch == b || ch == c || ch == d) {
+            return pos;
+        }
+    }
+
+    return std::string_view::npos;
+}
+
+void bes::web::percentDecode(std::string_view in, std::string& out, bool plus_as_space)
+{
+    out.clear();
+    out.reserve(in.size());
+
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        char c = in[i];
+
+        if (c == '+' && plus_as_space) {
+            c = ' ';
+        } else if (c == '%' && in.size() - i > 2) {
+            // Convert % notation to a regular char, malformed sequences are kept as they are
+            int high = hexValue(in[i + 1]);
+            int low = hexValue(in[i + 2]);
+
+            if (high >= 0 && low >= 0) {
+                c = static_cast<char>(high * 16 + low);
+                i += 2;
+            }
+        }
+
+        out += c;
+    }
+}
+
+std::string_view ParamList::decode(std::string_view raw)
+{
+    percentDecode(raw, decoded.emplace_front());
+    return decoded.front();
+}
+
+/**
+ * A single pass finds every delimiter and escape; a pair is only decoded if an escape was seen in it.
+ */
+void ParamList::parseQuery(std::string_view query)
+{
+    std::size_t pair_start = 0;
+    std::size_t eq = std::string_view::npos;
+    bool key_escaped = false;
+    bool value_escaped = false;
+    std::size_t pos = 0;
+
+    // A single allocation for most requests
+    entries.reserve(8);
+
+    for (;;) {
+        std::size_t const next = findAnyOf(query, pos, '&', '=', '%', '+');
+
+        if (next == std::string_view::npos || query[next] == '&') {
+            std::size_t const pair_end = next == std::string_view::npos ? query.size() : next;
+            std::size_t const key_end = eq == std::string_view::npos ? pair_end : eq;
+
+            auto key = query.substr(pair_start, key_end - pair_start);
+            auto value = eq == std::string_view::npos ? std::string_view() : query.substr(eq + 1, pair_end - eq - 1);
+
+            if (key_escaped) {
+                key = decode(key);
+            }
+
+            if (value_escaped) {
+                value = decode(value);
+            }
+
+            if (!key.empty()) {
+                entries.emplace_back(key, value);
+            }
+
+            if (next == std::string_view::npos) {
+                break;
+            }
+
+            pair_start = next + 1;
+            eq = std::string_view::npos;
+            key_escaped = false;
+            value_escaped = false;
+        } else if (query[next] == '=') {
+            // Only the first '=' separates the key, any others are part of the value
+            if (eq == std::string_view::npos) {
+                eq = next;
+            }
+        } else if (eq == std::string_view::npos) {
+            key_escaped = true;
+        } else {
+            value_escaped = true;
+        }
+
+        pos = next + 1;
+    }
+}
+
+void ParamList::parseCookies(std::string_view header)
+{
+    std::size_t pos = 0;
+    entries.reserve(8);
+
+    while (pos < header.size()) {
+        std::size_t end = findAnyOf(header, pos, ';', ';', ';', ';');
+        if (end == std::string_view::npos) {
+            end = header.size();
+        }
+
+        auto cookie = header.substr(pos, end - pos);
+        auto eq = cookie.find('=');
+
+        if (eq != std::string_view::npos) {
+            auto key = trim(cookie.substr(0, eq));
+            auto value = trim(cookie.substr(eq + 1));
+
+            if (!key.empty() && !value.empty()) {
+                entries.emplace_back(key, value);
+            }
+        }
+
+        pos = end + 1;
+    }
+}
+
+std::optional<std::string_view> ParamList::find(std::string_view key) const
+{
+    // Few enough entries that a linear scan beats hashing; searching backwards lets a repeated key override
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        if (it->first == key) {
+            return it->second;
+        }
+    }
+
+    return std::nullopt;
+}
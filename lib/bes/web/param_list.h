@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <forward_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace bes::web {
+
+/**
+ * Key/value pairs parsed from a query-string or Cookie header.
+ *
+ * Keys and values are views into the source string, which must outlive the list. Only a key or value that contains a
+ * percent-escape (or a `+`, in a query-string) is decoded, into storage owned by the list; everything else is never
+ * copied.
+ */
+class ParamList
+{
+   public:
+    using Entry = std::pair<std::string_view, std::string_view>;
+
+    ParamList() = default;
+
+    // Entries may point into the decoded storage, a copy would point into the original
+    ParamList(ParamList const&) = delete;
+    ParamList& operator=(ParamList const&) = delete;
+
+    /**
+     * Parse `a=1&b=2` pairs, decoding percent-escapes and `+` as a space. Pairs with an empty key are skipped; a key
+     * with no `=` has an empty value.
+     */
+    void parseQuery(std::string_view query);
+
+    /**
+     * Parse a Cookie header, `a=1; b=2`. Whitespace around names and values is trimmed, and cookies without both a
+     * name and a value are skipped. Values are not decoded.
+     */
+    void parseCookies(std::string_view header);
+
+    /**
+     * Get the value for a key; where a key is repeated the last value wins.
+     */
+    [[nodiscard]] std::optional<std::string_view> find(std::string_view key) const;
+
+    [[nodiscard]] std::size_t size() const
+    {
+        return entries.size();
+    }
+
+    [[nodiscard]] std::vector<Entry>::const_iterator begin() const
+    {
+        return entries.begin();
+    }
+
+    [[nodiscard]] std::vector<Entry>::const_iterator end() const
+    {
+        return entries.end();
+    }
+
+   private:
+    std::vector<Entry> entries;
+
+    // List nodes never move, so views into them stay valid as it grows; an empty list doesn't allocate
+    std::forward_list<std::string> decoded;
+
+    std::string_view decode(std::string_view raw);
+};
+
+/**
+ * Position of the first of `a`, `b`, `c` or `d` in `s` at or after `pos`, or npos. Repeat a character to search for
+ * fewer. Scans 16 bytes at a time where SSE2 is available.
+ */
+std::size_t findAnyOf(std::string_view s, std::size_t pos, char a, char b, char c, char d);
+
+/**
+ * Decode percent-escapes (and `+` as a space, if `plus_as_space`) into `out`. A malformed escape is kept as it is.
+ */
+void percentDecode(std::string_view in, std::string& out, bool plus_as_space = true);
+
+}  // namespace bes::web
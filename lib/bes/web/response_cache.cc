@@ -0,0 +1,196 @@
+#include "response_cache.h"
+
+using namespace bes::web;
+
+namespace {
+
+// Fixed cost of an entry beyond its key and payload: list node, index node and the shared response
+constexpr std::size_t ENTRY_OVERHEAD = 160;
+
+// Separators that can't appear in a route name, and are unlikely in a value
+constexpr char FIELD_SEP = '\x1f';
+constexpr char GROUP_SEP = '\x1e';
+constexpr char ABSENT = '\x1d';
+
+}  // namespace
+
+ResponseCache::ResponseCache(std::size_t byte_budget, std::size_t shard_count)
+{
+    if (shard_count == 0) {
+        shard_count = 1;
+    }
+
+    shards.reserve(shard_count);
+    for (std::size_t i = 0; i < shard_count; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+
+    shard_budget = byte_budget / shard_count;
+}
+
+ResponseCache::Shard& ResponseCache::shardFor(std::string const& key)
+{
+    return *shards[std::hash<std::string>()(key) % shards.size()];
+}
+
+void ResponseCache::remove(Shard& shard, std::list<Entry>::iterator it)
+{
+    shard.bytes -= it->size;
+    shard.index.erase(it->key);
+    shard.lru.erase(it);
+}
+
+std::shared_ptr<CachedResponse const> ResponseCache::get(std::string const& key, clock::time_point now)
+{
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    if (it->second->expires <= now) {
+        remove(shard, it->second);
+        expirations.fetch_add(1, std::memory_order_relaxed);
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    // Move to the front of the LRU list
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    hits.fetch_add(1, std::memory_order_relaxed);
+
+    return it->second->response;
+}
+
+void ResponseCache::put(std::string const& key, CachedResponse response, std::chrono::seconds ttl,
+                        clock::time_point now)
+{
+    std::size_t size = key.size() + response.headers.size() + response.body.size() + response.gzip_body.size() +
+                       ENTRY_OVERHEAD;
+    if (size > shard_budget || ttl.count() <= 0) {
+        return;
+    }
+
+    auto ptr = std::make_shared<CachedResponse const>(std::move(response));
+
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        remove(shard, it->second);
+    }
+
+    shard.lru.push_front(Entry{key, std::move(ptr), now + ttl, size});
+    shard.index.emplace(key, shard.lru.begin());
+    shard.bytes += size;
+    inserts.fetch_add(1, std::memory_order_relaxed);
+
+    while (shard.bytes > shard_budget) {
+        remove(shard, std::prev(shard.lru.end()));
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void ResponseCache::erase(std::string const& key)
+{
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        remove(shard, it->second);
+    }
+}
+
+void ResponseCache::eraseRoute(std::string const& route_name)
+{
+    std::string prefix = route_name + FIELD_SEP;
+
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+
+        for (auto it = shard->lru.begin(); it != shard->lru.end();) {
+            auto next = std::next(it);
+            if (it->key.compare(0, prefix.size(), prefix) == 0) {
+                remove(*shard, it);
+            }
+            it = next;
+        }
+    }
+}
+
+void ResponseCache::clear()
+{
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->index.clear();
+        shard->lru.clear();
+        shard->bytes = 0;
+    }
+}
+
+ResponseCacheStats ResponseCache::stats() const
+{
+    ResponseCacheStats s;
+    s.hits = hits.load(std::memory_order_relaxed);
+    s.misses = misses.load(std::memory_order_relaxed);
+    s.inserts = inserts.load(std::memory_order_relaxed);
+    s.evictions = evictions.load(std::memory_order_relaxed);
+    s.expirations = expirations.load(std::memory_order_relaxed);
+
+    for (auto const& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        s.entries += shard->index.size();
+        s.bytes += shard->bytes;
+    }
+
+    return s;
+}
+
+/**
+ * Fields are separated by control characters, and a missing value is recorded distinctly from an empty one, so that
+ * `?a=` and no `a` at all don't share an entry.
+ */
+std::string ResponseCache::key(PrecachedRoute const& route, ActionArgs const& args, HttpRequest const& request)
+{
+    std::string key = route.name;
+    key += FIELD_SEP;
+
+    for (auto const& name : route.arg_map) {
+        auto it = args.find(name);
+        if (it != args.end()) {
+            key += it->second;
+        }
+        key += FIELD_SEP;
+    }
+
+    auto append = [&key](std::optional<std::string_view> value) {
+        if (value) {
+            key += *value;
+        } else {
+            key += ABSENT;
+        }
+        key += FIELD_SEP;
+    };
+
+    key += GROUP_SEP;
+    for (auto const& name : route.cache.query) {
+        append(request.findQueryParam(name));
+    }
+
+    key += GROUP_SEP;
+    for (auto const& name : route.cache.cookies) {
+        append(request.findCookie(name));
+    }
+
+    key += GROUP_SEP;
+    for (auto const& param : route.cache.headers) {
+        append(request.hasParam(param) ? std::optional<std::string_view>(request.getParam(param)) : std::nullopt);
+    }
+
+    return key;
+}
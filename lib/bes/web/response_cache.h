@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "http.h"
+#include "http_request.h"
+#include "route.h"
+
+namespace bes::web {
+
+/**
+ * A rendered response, as it is written to the FastCGI output.
+ */
+struct CachedResponse
+{
+    /// Header lines, each terminated with a newline, without the ETag, Content-Length or the blank line that ends the
+    /// headers
+    std::string headers;
+    std::string body;
+
+    /// Entity tag of the body, if it has one; written per request as it depends on the encoding sent
+    std::string etag;
+
+    /// The body gzipped once when it was stored, if it is worth compressing
+    std::string gzip_body;
+
+    /// Content-Length the controller set for the unencoded body, empty if it set none; an encoded body is sent with
+    /// its own length instead
+    std::string content_length;
+};
+
+struct ResponseCacheStats
+{
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t inserts = 0;
+    std::uint64_t evictions = 0;
+    std::uint64_t expirations = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+};
+
+/**
+ * In-process cache of rendered responses, for routes with a `cache` policy in the route schema.
+ *
+ * Keys are split across a fixed number of shards, each with its own lock, LRU list and an equal share of the byte
+ * budget. Entries expire after the TTL they were stored with; when a shard is over budget the least recently used
+ * entries are evicted. Entries are shared, so a response being written from the cache is never invalidated under it.
+ */
+class ResponseCache
+{
+   public:
+    using clock = std::chrono::steady_clock;
+
+    explicit ResponseCache(std::size_t byte_budget, std::size_t shard_count = 16);
+
+    ResponseCache(ResponseCache const&) = delete;
+    ResponseCache& operator=(ResponseCache const&) = delete;
+
+    /**
+     * Get a live entry, or nullptr.
+     */
+    [[nodiscard]] std::shared_ptr<CachedResponse const> get(std::string const& key, clock::time_point now = clock::now());
+
+    /**
+     * Store an entry, replacing any existing one. Entries larger than a shard's budget are not stored.
+     */
+    void put(std::string const& key, CachedResponse response, std::chrono::seconds ttl,
+             clock::time_point now = clock::now());
+
+    void erase(std::string const& key);
+
+    /**
+     * Remove every entry for a route, eg, when the content behind it changes.
+     */
+    void eraseRoute(std::string const& route_name);
+
+    void clear();
+
+    [[nodiscard]] ResponseCacheStats stats() const;
+
+    /**
+     * Build the cache key for a request to a route: the route name, the route arguments and whatever the route's cache
+     * policy varies on.
+     */
+    [[nodiscard]] static std::string key(PrecachedRoute const& route, ActionArgs const& args,
+                                         HttpRequest const& request);
+
+   private:
+    struct Entry
+    {
+        std::string key;
+        std::shared_ptr<CachedResponse const> response;
+        clock::time_point expires;
+        std::size_t size;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::list<Entry> lru;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        std::size_t bytes = 0;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::size_t shard_budget;
+
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> inserts{0};
+    std::atomic<std::uint64_t> evictions{0};
+    std::atomic<std::uint64_t> expirations{0};
+
+    Shard& shardFor(std::string const& key);
+    static void remove(Shard& shard, std::list<Entry>::iterator it);
+};
+
+/**
+ * Where a cacheable response should be stored once it has been rendered.
+ */
+struct ResponseCacheStore
+{
+    std::shared_ptr<ResponseCache> cache;
+    std::string key;
+    std::chrono::seconds ttl;
+};
+
+}  // namespace bes::web
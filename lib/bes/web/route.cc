@@ -1,7 +1,27 @@
 #include "route.h"
 
+#include <cctype>
+
+#include "route_tree.h"
+
 using namespace bes::web;
 
+std::string RouteCache::headerParam(std::string const& header)
+{
+    std::string param = "HTTP_";
+    param.reserve(param.size() + header.size());
+
+    for (char c : header) {
+        if (c == '-') {
+            param += '_';
+        } else {
+            param += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+    }
+
+    return param;
+}
+
 Route::Route(std::string const& name) : name(name), controller(name) {}
 
 Route::Route(std::string const& name, std::string const& uri) : name(name), controller(name)
@@ -125,7 +145,7 @@ void PrecachedRoute::precache()
                 break;
             case RouteType::REGEX:
                 arg_map.push_back(part.name);
-                buf << '(' << part.value << ')';
+                buf << '(' << paramRegex(part.value) << ')';
                 break;
             default:
                 throw std::runtime_error("Unimplemented route type for route: " + name);
@@ -138,6 +158,8 @@ void PrecachedRoute::precache()
     if (route_re_str.length() > 2) {
         regex = route_re_str;
     }
+
+    preset_headers = response_headers.empty() ? nullptr : std::make_shared<PresetHeaders const>(response_headers);
 }
 
 PrecachedRoute::PrecachedRoute(Route&& r) : Route(std::move(r))
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <chrono>
+#include <memory>
 #include <regex>
 #include <string>
 #include <vector>
 
 #include "exception.h"
+#include "header_list.h"
 
 namespace bes::web {
 
@@ -21,6 +24,30 @@ struct RouteSection
     RouteType section_type;
 };
 
+/**
+ * Response caching for a route, see ResponseCache. A zero TTL disables caching.
+ *
+ * The route name and arguments are always part of the cache key; anything else that changes the output must be listed.
+ */
+struct RouteCache
+{
+    std::chrono::seconds ttl{0};
+
+    /// Query-string params that change the response
+    std::vector<std::string> query;
+
+    /// Cookies that change the response
+    std::vector<std::string> cookies;
+
+    /// Request headers that change the response, as FastCGI params (eg, HTTP_ACCEPT_LANGUAGE)
+    std::vector<std::string> headers;
+
+    /**
+     * Convert a header name to the FastCGI param that carries it, "Accept-Language" becomes "HTTP_ACCEPT_LANGUAGE".
+     */
+    static std::string headerParam(std::string const& header);
+};
+
 struct Route
 {
     Route() = default;
@@ -38,6 +65,13 @@ struct Route
     std::string controller;
     std::vector<RouteSection> parts;
     bool includes_query = false;
+    RouteCache cache;
+
+    /// False for routes that never read the session, which is then neither loaded nor sent back
+    bool session = true;
+
+    /// Headers sent with every response from this route, eg Cache-Control
+    HeaderList response_headers;
 
    private:
     static void trim(std::string& s);
@@ -60,6 +94,9 @@ struct PrecachedRoute : public Route
     std::regex regex;
     std::vector<std::string> arg_map;
 
+    /// The response headers, serialised; null if the route has none
+    std::shared_ptr<PresetHeaders const> preset_headers;
+
    private:
     void precache();
 };
@@ -0,0 +1,322 @@
+#include "route_tree.h"
+
+#include <algorithm>
+
+using namespace bes::web;
+
+namespace {
+
+bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool isHex(char c)
+{
+    return isDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+bool isSlug(char c)
+{
+    return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '_';
+}
+
+bool isUuid(std::string_view s)
+{
+    if (s.size() != 36) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        if (i == 8 || i == 13 || i == 18 || i == 23) {
+            if (s[i] != '-') {
+                return false;
+            }
+        } else if (!isHex(s[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+struct Capture
+{
+    std::string const* name;
+    std::size_t begin;
+    std::size_t end;
+};
+
+}  // namespace
+
+ParamType bes::web::paramType(std::string const& pattern)
+{
+    if (pattern == "int" || pattern == "[0-9]+" || pattern == "\\d+") {
+        return ParamType::INT;
+    } else if (pattern == "uuid") {
+        return ParamType::UUID;
+    } else if (pattern == "slug") {
+        return ParamType::SLUG;
+    } else if (pattern == ".+?" || pattern == ".+") {
+        return ParamType::ANY;
+    } else {
+        return ParamType::REGEX;
+    }
+}
+
+std::string bes::web::paramRegex(std::string const& pattern)
+{
+    if (pattern == "int") {
+        return "[0-9]+";
+    } else if (pattern == "uuid") {
+        return "[0-9A-Fa-f]{8}-[0-9A-Fa-f]{4}-[0-9A-Fa-f]{4}-[0-9A-Fa-f]{4}-[0-9A-Fa-f]{12}";
+    } else if (pattern == "slug") {
+        return "[A-Za-z0-9_-]+";
+    } else {
+        return pattern;
+    }
+}
+
+struct RouteTree::Node
+{
+    struct Param
+    {
+        ParamType type;
+        std::string pattern;
+        std::string name;
+        std::regex regex;
+        std::unique_ptr<Node> child;
+    };
+
+    // Label of the literal edge leading to this node
+    std::string label;
+
+    // Literal edges, no two start with the same character
+    std::vector<std::unique_ptr<Node>> literals;
+
+    // Argument edges, in precedence order
+    std::vector<Param> params;
+
+    // Routes ending at this node, in name order
+    std::vector<PrecachedRoute const*> routes;
+
+    Node* insertLiteral(std::string_view s);
+    Node* insertParam(RouteSection const& section);
+
+    bool match(std::string_view subject, std::size_t pos, Accept accept, std::vector<Capture>& captures,
+               PrecachedRoute const*& result) const;
+};
+
+/**
+ * Walk or extend the literal edges for `s`, splitting an edge where `s` diverges from it.
+ */
+RouteTree::Node* RouteTree::Node::insertLiteral(std::string_view s)
+{
+    Node* node = this;
+
+    while (!s.empty()) {
+        auto it = std::find_if(node->literals.begin(), node->literals.end(), [&s](auto const& child) {
+            return child->label[0] == s[0];
+        });
+
+        if (it == node->literals.end()) {
+            auto child = std::make_unique<Node>();
+            child->label = std::string(s);
+            node->literals.push_back(std::move(child));
+            return node->literals.back().get();
+        }
+
+        auto& child = *it;
+        std::size_t common = 1;
+        while (common < child->label.size() && common < s.size() && child->label[common] == s[common]) {
+            ++common;
+        }
+
+        if (common < child->label.size()) {
+            auto mid = std::make_unique<Node>();
+            mid->label = child->label.substr(0, common);
+            child->label.erase(0, common);
+            mid->literals.push_back(std::move(child));
+            child = std::move(mid);
+        }
+
+        node = child.get();
+        s.remove_prefix(common);
+    }
+
+    return node;
+}
+
+RouteTree::Node* RouteTree::Node::insertParam(RouteSection const& section)
+{
+    auto type = paramType(section.value);
+
+    for (auto& param : params) {
+        if (param.type == type && param.pattern == section.value && param.name == section.name) {
+            return param.child.get();
+        }
+    }
+
+    Param param;
+    param.type = type;
+    param.pattern = section.value;
+    param.name = section.name;
+    param.child = std::make_unique<Node>();
+
+    if (type == ParamType::REGEX) {
+        param.regex = std::regex(section.value);
+    }
+
+    // Keep precedence order; equal types stay in insertion (ie, route name) order
+    auto pos = std::upper_bound(params.begin(), params.end(), type, [](ParamType t, Param const& p) {
+        return t < p.type;
+    });
+
+    return params.insert(pos, std::move(param))->child.get();
+}
+
+bool RouteTree::Node::match(std::string_view subject, std::size_t pos, Accept accept, std::vector<Capture>& captures,
+                            PrecachedRoute const*& result) const
+{
+    if (pos == subject.size()) {
+        for (auto const* route : routes) {
+            if (accept == Accept::ALL || route->includes_query == (accept == Accept::QUERY_ONLY)) {
+                result = route;
+                return true;
+            }
+        }
+
+        // Every argument consumes at least one character, nothing further can match
+        return false;
+    }
+
+    char const next = subject[pos];
+
+    for (auto const& child : literals) {
+        if (child->label[0] != next) {
+            continue;
+        }
+
+        if (subject.compare(pos, child->label.size(), child->label) == 0 &&
+            child->match(subject, pos + child->label.size(), accept, captures, result)) {
+            return true;
+        }
+
+        break;
+    }
+
+    std::size_t const remaining = subject.size() - pos;
+
+    for (auto const& param : params) {
+        auto attempt = [&](std::size_t len) {
+            captures.push_back({&param.name, pos, pos + len});
+            if (param.child->match(subject, pos + len, accept, captures, result)) {
+                return true;
+            }
+            captures.pop_back();
+            return false;
+        };
+
+        switch (param.type) {
+            case ParamType::INT:
+            case ParamType::SLUG: {
+                auto test = param.type == ParamType::INT ? isDigit : isSlug;
+                std::size_t run = 0;
+                while (run < remaining && test(subject[pos + run])) {
+                    ++run;
+                }
+
+                // Greedy, as with the equivalent regex
+                for (std::size_t len = run; len > 0; --len) {
+                    if (attempt(len)) {
+                        return true;
+                    }
+                }
+                break;
+            }
+            case ParamType::UUID:
+                if (remaining >= 36 && isUuid(subject.substr(pos, 36)) && attempt(36)) {
+                    return true;
+                }
+                break;
+            case ParamType::REGEX:
+                for (std::size_t len = remaining; len > 0; --len) {
+                    if (std::regex_match(subject.begin() + pos, subject.begin() + pos + len, param.regex) &&
+                        attempt(len)) {
+                        return true;
+                    }
+                }
+                break;
+            case ParamType::ANY:
+                if (param.pattern == ".+") {
+                    for (std::size_t len = remaining; len > 0; --len) {
+                        if (attempt(len)) {
+                            return true;
+                        }
+                    }
+                } else {
+                    for (std::size_t len = 1; len <= remaining; ++len) {
+                        if (attempt(len)) {
+                            return true;
+                        }
+                    }
+                }
+                break;
+        }
+    }
+
+    return false;
+}
+
+RouteTree::RouteTree() : root(std::make_unique<Node>()) {}
+
+RouteTree::~RouteTree() = default;
+
+RouteTree::RouteTree(RouteTree&&) noexcept = default;
+
+RouteTree& RouteTree::operator=(RouteTree&&) noexcept = default;
+
+void RouteTree::insert(PrecachedRoute const& route)
+{
+    Node* node = root.get();
+
+    for (auto const& part : route.parts) {
+        switch (part.section_type) {
+            case RouteType::LITERAL:
+                node = node->insertLiteral(part.value);
+                break;
+            case RouteType::REGEX:
+                node = node->insertParam(part);
+                break;
+            default:
+                throw std::runtime_error("Unimplemented route type for route: " + route.name);
+        }
+    }
+
+    auto pos = std::upper_bound(node->routes.begin(), node->routes.end(), &route, [](auto const* a, auto const* b) {
+        return a->name < b->name;
+    });
+    node->routes.insert(pos, &route);
+}
+
+void RouteTree::clear()
+{
+    root = std::make_unique<Node>();
+}
+
+PrecachedRoute const* RouteTree::match(std::string_view subject, Accept accept, ActionArgs& args) const
+{
+    thread_local std::vector<Capture> captures;
+    captures.clear();
+
+    PrecachedRoute const* result = nullptr;
+    if (!root->match(subject, 0, accept, captures, result)) {
+        return nullptr;
+    }
+
+    for (auto const& capture : captures) {
+        args[*capture.name] = std::string(subject.substr(capture.begin, capture.end - capture.begin));
+    }
+
+    return result;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "http.h"
+#include "route.h"
+
+namespace bes::web {
+
+/**
+ * Kind of matcher used for a route argument, in order of precedence when several could match at the same point.
+ */
+enum class ParamType : char
+{
+    INT,    // { id: int } - one or more digits
+    UUID,   // { id: uuid } - 8-4-4-4-12 hex digits
+    SLUG,   // { name: slug } - one or more of [A-Za-z0-9_-]
+    REGEX,  // { name: <regex> } - anything else, matched with std::regex
+    ANY,    // { name } - one or more of any character, shortest first (or longest first for `.+`)
+};
+
+/**
+ * Classify an argument pattern, returning REGEX for anything without a dedicated matcher.
+ */
+ParamType paramType(std::string const& pattern);
+
+/**
+ * The std::regex equivalent of an argument pattern, for matchers that are given by name.
+ */
+std::string paramRegex(std::string const& pattern);
+
+/**
+ * Radix tree of compiled routes.
+ *
+ * Literal route sections are stored as compressed edges, so that common prefixes are compared once regardless of the
+ * number of routes sharing them. Argument sections become matcher edges; most are simple character scans, std::regex
+ * is only used for patterns that aren't recognised.
+ *
+ * At each node a literal edge is tried before any argument, then arguments in ParamType order. Routes are inserted in
+ * name order, so ties between identical matchers (or identical routes) always resolve the same way.
+ */
+class RouteTree
+{
+   public:
+    RouteTree();
+    ~RouteTree();
+
+    RouteTree(RouteTree&&) noexcept;
+    RouteTree& operator=(RouteTree&&) noexcept;
+
+    /**
+     * Add a route, the route must outlive the tree (or the next clear()).
+     */
+    void insert(PrecachedRoute const& route);
+    void clear();
+
+    /**
+     * Which routes may accept a match, depending on whether the subject includes the query-string.
+     */
+    enum class Accept : char
+    {
+        ALL,
+        QUERY_ONLY,
+        PATH_ONLY,
+    };
+
+    /**
+     * Match the subject against every route; returns nullptr on a miss, else the route with `args` populated.
+     */
+    PrecachedRoute const* match(std::string_view subject, Accept accept, ActionArgs& args) const;
+
+   private:
+    struct Node;
+    std::unique_ptr<Node> root;
+};
+
+}  // namespace bes::web
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <optional>
+
 #include "exception.h"
 #include "http.h"
 #include "http_request.h"
@@ -9,12 +11,47 @@ namespace bes::web {
 
 using Controller = std::function<HttpResponse(HttpRequest const&, ActionArgs const&)>;
 
+/**
+ * Supplies the version of a route's content without rendering it, or nullopt if it isn't known.
+ */
+using VersionProvider = std::function<std::optional<std::string>(HttpRequest const&, ActionArgs const&)>;
+
 class Router
 {
    public:
     [[nodiscard]] virtual HttpResponse yieldResponse(HttpRequest const& request) const = 0;
     [[nodiscard]] virtual HttpResponse yieldErrorResponse(HttpRequest const& request, Http::Status status_code,
                                                           std::string const& debug_msg) const = 0;
+
+    /**
+     * Yield a response, or nullopt if this router doesn't handle the request and the next router should be tried.
+     *
+     * This is what the WebResponder calls. The default wraps yieldResponse() and catches a CannotYieldException;
+     * routers that are likely to pass on a request (eg, any router that isn't last) should override it so that a miss
+     * doesn't cost an exception.
+     */
+    [[nodiscard]] virtual std::optional<HttpResponse> tryYieldResponse(HttpRequest const& request) const
+    {
+        try {
+            return yieldResponse(request);
+        } catch (CannotYieldException const&) {
+            return std::nullopt;
+        }
+    }
+
+    /**
+     * As tryYieldResponse(), for yieldErrorResponse().
+     */
+    [[nodiscard]] virtual std::optional<HttpResponse> tryYieldErrorResponse(HttpRequest const& request,
+                                                                            Http::Status status_code,
+                                                                            std::string const& debug_msg) const
+    {
+        try {
+            return yieldErrorResponse(request, status_code, debug_msg);
+        } catch (CannotYieldException const&) {
+            return std::nullopt;
+        }
+    }
 };
 
 }  // namespace bes::web
@@ -21,6 +21,8 @@ std::string const& Session::sessionId() const
 void Session::setValue(std::string const& key, SessionObject data)
 {
     map.insert_or_assign(key, std::move(data));
+    removed.erase(key);
+    changed.insert(key);
 }
 
 void Session::setValue(std::string const& key, std::string data)
@@ -48,6 +50,16 @@ void Session::setValue(std::string const& key, bool data)
     setValue(key, SessionObject(data));
 }
 
+void Session::removeValue(std::string const& key)
+{
+    if (map.erase(key) == 0) {
+        return;
+    }
+
+    changed.erase(key);
+    removed.insert(key);
+}
+
 SessionObject const& Session::getValue(std::string const& key) const
 {
     try {
@@ -112,3 +124,79 @@ bool Session::hasItem(std::string const& key) const
 {
     return map.find(key) != map.end();
 }
+
+bool Session::isNew() const
+{
+    return is_new;
+}
+
+bool Session::isModified() const
+{
+    return is_new || !changed.empty() || !removed.empty();
+}
+
+std::unordered_set<std::string> const& Session::changedKeys() const
+{
+    return changed;
+}
+
+std::unordered_set<std::string> const& Session::removedKeys() const
+{
+    return removed;
+}
+
+void Session::markClean()
+{
+    is_new = false;
+    changed.clear();
+    removed.clear();
+}
+
+void Session::merge(Session const& later)
+{
+    if (later.is_new) {
+        *this = later;
+        return;
+    }
+
+    for (auto const& key : later.changed) {
+        setValue(key, later.map.at(key));
+    }
+
+    // The key may only exist in the store, so it's removed even if we don't hold it
+    for (auto const& key : later.removed) {
+        map.erase(key);
+        changed.erase(key);
+        removed.insert(key);
+    }
+
+    if (later.expiry) {
+        expiry = later.expiry;
+    }
+}
+
+std::optional<std::chrono::system_clock::time_point> const& Session::expires() const
+{
+    return expiry;
+}
+
+void Session::setExpires(std::chrono::system_clock::time_point when)
+{
+    expiry = when;
+}
+
+std::size_t Session::memorySize() const
+{
+    // Per value: the map node and the std::any holding it
+    constexpr std::size_t value_overhead = 64;
+
+    std::size_t size = session_id.size();
+    for (auto const& it : map) {
+        size += it.first.size() + value_overhead;
+        if (it.second.data_type == SessionObject::ObjectType::STRING) {
+            size += std::any_cast<std::string const&>(it.second.data).size();
+        }
+    }
+
+    return size;
+}
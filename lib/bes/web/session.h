@@ -1,8 +1,11 @@
 #pragma once
 
 #include <any>
+#include <chrono>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "exception.h"
 
@@ -28,6 +31,12 @@ struct SessionObject
     ObjectType data_type;
 };
 
+/**
+ * A user session.
+ *
+ * Changes are tracked so that a session manager can write back only what a request modified: a new session has never
+ * been persisted and must be written in full, a session read from a store is clean until a value is set or removed.
+ */
 class Session
 {
    public:
@@ -43,6 +52,11 @@ class Session
     void setValue(std::string const& key, double data);
     void setValue(std::string const& key, bool data);
 
+    /**
+     * Remove a value, if it exists.
+     */
+    void removeValue(std::string const& key);
+
     [[nodiscard]] SessionObject const& getValue(std::string const& key) const;
     [[nodiscard]] std::unordered_map<std::string, SessionObject> const& getMap() const;
 
@@ -55,9 +69,58 @@ class Session
     [[nodiscard]] bool empty() const;
     [[nodiscard]] bool hasItem(std::string const& key) const;
 
+    /**
+     * True until the session has been read from, or written to, a store.
+     */
+    [[nodiscard]] bool isNew() const;
+
+    /**
+     * True if the session is new, or a value has been set or removed since it was loaded.
+     */
+    [[nodiscard]] bool isModified() const;
+
+    /**
+     * Keys set since the session was loaded.
+     */
+    [[nodiscard]] std::unordered_set<std::string> const& changedKeys() const;
+
+    /**
+     * Keys removed since the session was loaded, and not set again.
+     */
+    [[nodiscard]] std::unordered_set<std::string> const& removedKeys() const;
+
+    /**
+     * The session now matches the store: it is no longer new and has no changes. Called by a session manager once it
+     * has loaded or persisted the session.
+     */
+    void markClean();
+
+    /**
+     * Apply the changes made to a later copy of this session, as if both had been persisted in turn. A new session
+     * replaces this one outright.
+     */
+    void merge(Session const& later);
+
+    /**
+     * When the store will expire the session, if known. Set by a session manager that can tell, so that it can skip
+     * refreshing the TTL of a session that was refreshed recently.
+     */
+    [[nodiscard]] std::optional<std::chrono::system_clock::time_point> const& expires() const;
+    void setExpires(std::chrono::system_clock::time_point when);
+
+    /**
+     * Rough bytes of memory held by the session's ID and values, for managers that keep sessions within a budget.
+     */
+    [[nodiscard]] std::size_t memorySize() const;
+
    protected:
     std::string session_id;
     std::unordered_map<std::string, SessionObject> map;
+
+    bool is_new = true;
+    std::unordered_set<std::string> changed;
+    std::unordered_set<std::string> removed;
+    std::optional<std::chrono::system_clock::time_point> expiry;
 };
 
 }  // namespace bes::web
@@ -0,0 +1,108 @@
+#include "session_interface.h"
+
+#include <pthread.h>
+#include <sys/random.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include "exception.h"
+
+using namespace bes::web;
+
+namespace {
+
+// Bumped in a forked child, whose copy of a thread's buffer holds the same bytes as its parent's
+std::atomic<std::uint64_t> fork_generation{0};
+
+/**
+ * Random bytes from the kernel CSPRNG, drawn a block at a time into a buffer per thread. A key costs a syscall only
+ * once every few dozen keys, and threads never contend for it.
+ */
+class EntropyBuffer
+{
+   public:
+    void read(std::uint8_t* out, std::size_t len)
+    {
+        auto current = fork_generation.load(std::memory_order_relaxed);
+        if (pos + len > sizeof(buffer) || generation != current) {
+            refill();
+            generation = current;
+        }
+
+        std::memcpy(out, buffer + pos, len);
+
+        // Bytes handed out shouldn't linger in memory
+        std::memset(buffer + pos, 0, len);
+        pos += len;
+    }
+
+   private:
+    std::uint8_t buffer[512];
+    std::size_t pos = sizeof(buffer);
+    std::uint64_t generation = 0;
+
+    void refill()
+    {
+        std::size_t filled = 0;
+        while (filled < sizeof(buffer)) {
+            auto r = getrandom(buffer + filled, sizeof(buffer) - filled, 0);
+            if (r < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                throw WebException("Unable to read random bytes for a session key: " + std::string(strerror(errno)));
+            }
+
+            filled += static_cast<std::size_t>(r);
+        }
+
+        pos = 0;
+    }
+};
+
+EntropyBuffer& entropy()
+{
+    static bool registered = [] {
+        pthread_atfork(nullptr, nullptr, [] {
+            fork_generation.fetch_add(1, std::memory_order_relaxed);
+        });
+        return true;
+    }();
+
+    (void)registered;
+
+    thread_local EntropyBuffer buffer;
+    return buffer;
+}
+
+}  // namespace
+
+bool SessionInterface::touchSession(std::string const&)
+{
+    return true;
+}
+
+std::string SessionInterface::generateSessionKey(std::string const& ns)
+{
+    std::string key(ns.size() + SESSION_KEY_LENGTH, '\0');
+    std::memcpy(key.data(), ns.data(), ns.size());
+    writeSessionKey(key.data() + ns.size());
+    return key;
+}
+
+void SessionInterface::writeSessionKey(char* out)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+
+    std::uint8_t bytes[SESSION_KEY_BYTES];
+    entropy().read(bytes, sizeof(bytes));
+
+    for (auto b : bytes) {
+        *out++ = hex[b >> 4];
+        *out++ = hex[b & 0x0f];
+    }
+}
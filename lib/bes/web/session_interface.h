@@ -1,6 +1,7 @@
 #pragma once
 
-#include <random>
+#include <cstddef>
+#include <string>
 
 #include "session.h"
 
@@ -9,6 +10,8 @@ namespace bes::web {
 class SessionInterface
 {
    public:
+    virtual ~SessionInterface() = default;
+
     /**
      * Generate a unique session ID and create a blank session.
      */
@@ -28,34 +31,47 @@ class SessionInterface
      */
     virtual void persistSession(Session const& session) = 0;
 
+    /**
+     * Reset a session's TTL without reading it, for a request that carried the session's cookie but never read the
+     * session. Returns false if the session is known not to exist.
+     *
+     * The default does nothing, so such a session expires a TTL after it was last read; managers with a TTL should
+     * override it with something cheaper than a read.
+     */
+    virtual bool touchSession(std::string const& id);
+
     /**
      * Define the TTL used when persisting sessions.
      */
     virtual void setSessionTtl(uint64_t ttl) = 0;
 
+    /**
+     * Block until any persisted sessions that are still pending have been written. Called when the web server shuts
+     * down; managers that write synchronously have nothing to do.
+     */
+    virtual void flush() {}
+
+    /// Random bytes in a generated session key
+    static constexpr std::size_t SESSION_KEY_BYTES = 16;
+
+    /// Characters in a generated session key, not including its namespace
+    static constexpr std::size_t SESSION_KEY_LENGTH = SESSION_KEY_BYTES * 2;
+
     /**
      * Generate a session key.
      *
-     * This should result in a big, random value that has a low chance of collisions, but you should always check for a
-     * collision and re-run if you get a conflict.
+     * The key is 128 bits from the kernel's CSPRNG, hex-encoded. That makes collisions vanishingly unlikely and the key
+     * impossible to guess, so managers don't need to check for a collision before handing out a new session - though
+     * they should refuse to overwrite an existing session when it is first persisted.
      *
      * `ns` is a prefix to be used as a namespace, or cool looks - your choice.
      */
-    inline static std::string generateSessionKey(std::string const& ns = "S")
-    {
-        std::stringstream out;
-        std::mt19937 rng(std::random_device{}());
-        std::uniform_int_distribution<std::mt19937::result_type> dist64(1e17, 1e18);
-
-        // Namespace as a prefix
-        out << ns;
+    static std::string generateSessionKey(std::string const& ns = "S");
 
-        // We'll create a giant, random number - this should reduce collisions to a bare minimum but more importantly,
-        // make this all but impossible to guess by brute-force
-        out << std::hex << dist64(rng) << dist64(rng);
-
-        return out.str();
-    }
+    /**
+     * Write SESSION_KEY_LENGTH random hex characters to `out`, without allocating.
+     */
+    static void writeSessionKey(char* out);
 };
 
 }  // namespace bes::web
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace bes::web {
+
+struct SessionStats
+{
+    /// Sessions fetched from the session manager
+    std::uint64_t loads = 0;
+
+    /// Requests carrying a session cookie that never needed the session, and so never fetched it
+    std::uint64_t skipped = 0;
+
+    /// Session cookies naming a session that no longer exists
+    std::uint64_t expired = 0;
+
+    /// New sessions created
+    std::uint64_t created = 0;
+};
+
+/**
+ * Counts how sessions are used across requests, shared by every request through the request container.
+ */
+class SessionCounters
+{
+   public:
+    void load()
+    {
+        loads.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void skip()
+    {
+        skipped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void expire()
+    {
+        expired.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void create()
+    {
+        created.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] SessionStats stats() const
+    {
+        SessionStats s;
+        s.loads = loads.load(std::memory_order_relaxed);
+        s.skipped = skipped.load(std::memory_order_relaxed);
+        s.expired = expired.load(std::memory_order_relaxed);
+        s.created = created.load(std::memory_order_relaxed);
+        return s;
+    }
+
+   private:
+    std::atomic<std::uint64_t> loads{0};
+    std::atomic<std::uint64_t> skipped{0};
+    std::atomic<std::uint64_t> expired{0};
+    std::atomic<std::uint64_t> created{0};
+};
+
+}  // namespace bes::web
@@ -0,0 +1,314 @@
+#include "static_controller.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <mutex>
+#include <utility>
+
+#include "compression.h"
+#include "etag.h"
+#include "exception.h"
+
+using namespace bes::web;
+
+namespace {
+
+struct Extension
+{
+    char const* ext;
+    char const* type;
+};
+
+constexpr Extension CONTENT_TYPES[] = {
+    {"css", "text/css"},
+    {"gif", "image/gif"},
+    {"htm", "text/html"},
+    {"html", "text/html"},
+    {"ico", "image/x-icon"},
+    {"jpeg", "image/jpeg"},
+    {"jpg", "image/jpeg"},
+    {"js", "application/javascript"},
+    {"json", "application/json"},
+    {"map", "application/json"},
+    {"mjs", "application/javascript"},
+    {"pdf", "application/pdf"},
+    {"png", "image/png"},
+    {"svg", "image/svg+xml"},
+    {"ttf", "font/ttf"},
+    {"txt", "text/plain"},
+    {"wasm", "application/wasm"},
+    {"webp", "image/webp"},
+    {"woff", "font/woff"},
+    {"woff2", "font/woff2"},
+    {"xml", "application/xml"},
+};
+
+bool statFile(std::string const& path, std::size_t& size, std::chrono::system_clock::time_point& modified)
+{
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+
+    size = static_cast<std::size_t>(st.st_size);
+    modified = std::chrono::system_clock::from_time_t(st.st_mtime);
+    return true;
+}
+
+}  // namespace
+
+StaticController::StaticController(bes::FileFinder finder, StaticConfig config)
+    : finder(std::move(finder)), config(std::move(config))
+{}
+
+HttpResponse StaticController::serve(HttpRequest const& request, ActionArgs const& args)
+{
+    auto arg = args.find(config.path_arg);
+    if (arg == args.end() || !safePath(arg->second)) {
+        throw NotFoundHttpException();
+    }
+
+    auto const& rel = arg->second;
+
+    std::shared_ptr<Asset const> asset;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = assets.find(rel);
+        if (it != assets.end()) {
+            asset = it->second;
+        }
+    }
+
+    if (asset != nullptr && !config.watch) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return respond(asset, request);
+    }
+
+    std::string path;
+    try {
+        path = finder.findInPath(rel);
+    } catch (bes::FileNotFoundException const&) {
+        throw NotFoundHttpException();
+    }
+
+    std::size_t size;
+    std::chrono::system_clock::time_point modified;
+    if (!statFile(path, size, modified)) {
+        throw NotFoundHttpException();
+    }
+
+    if (asset != nullptr && asset->size == size && asset->modified == modified) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return respond(asset, request);
+    }
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+
+    // Too large to hold, let the web server send it
+    if (size > config.max_cached_size && !config.accel_prefix.empty()) {
+        redirects.fetch_add(1, std::memory_order_relaxed);
+
+        auto resp = HttpResponse::ok(std::string(contentType(rel)));
+        resp.header(Http::Header::X_ACCEL_REDIRECT, config.accel_prefix + rel);
+        return resp;
+    }
+
+    asset = load(path, size, modified);
+
+    if (size <= config.max_cached_size) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto cost = asset->size + asset->gzip.size();
+        auto it = assets.find(rel);
+
+        if (it != assets.end()) {
+            bytes -= it->second->size + it->second->gzip.size();
+            assets.erase(it);
+        }
+
+        if (bytes + cost <= config.byte_budget) {
+            assets.emplace(rel, asset);
+            bytes += cost;
+        }
+    }
+
+    return respond(asset, request);
+}
+
+void StaticController::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    assets.clear();
+    bytes = 0;
+}
+
+StaticStats StaticController::stats() const
+{
+    StaticStats s;
+    s.hits = hits.load(std::memory_order_relaxed);
+    s.misses = misses.load(std::memory_order_relaxed);
+    s.redirects = redirects.load(std::memory_order_relaxed);
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    s.files = assets.size();
+    s.bytes = bytes;
+
+    return s;
+}
+
+std::string_view StaticController::contentType(std::string_view path)
+{
+    auto dot = path.rfind('.');
+    if (dot == std::string_view::npos || path.find('/', dot) != std::string_view::npos) {
+        return Http::ContentType::BINARY;
+    }
+
+    std::string ext(path.substr(dot + 1));
+    for (auto& c : ext) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    for (auto const& it : CONTENT_TYPES) {
+        if (ext == it.ext) {
+            return it.type;
+        }
+    }
+
+    return Http::ContentType::BINARY;
+}
+
+/**
+ * Send the gzipped copy to clients that accept it. Both the ETag and the 304 are worked out here, so a revalidation
+ * doesn't build a body only for the responder to throw it away.
+ */
+HttpResponse StaticController::respond(std::shared_ptr<Asset const> const& asset, HttpRequest const& request) const
+{
+    bool const gzip = !asset->gzip.empty() && request.acceptedEncoding() == ContentEncoding::GZIP;
+    auto etag = gzip ? encodedETag(asset->etag, ContentEncoding::GZIP) : asset->etag;
+
+    HttpResponse resp;
+    if (request.ifNoneMatch(etag)) {
+        resp = HttpResponse::notModified(etag);
+    } else {
+        resp = HttpResponse::ok(asset->content_type);
+        resp.header(Http::Header::ETAG, etag);
+        resp.header(Http::Header::LAST_MODIFIED, asset->last_modified);
+
+        // Either way the body refers to the asset's own bytes, which it keeps alive until they're sent
+        if (gzip) {
+            resp.header(Http::Header::CONTENT_ENCODING, encodingName(ContentEncoding::GZIP));
+            resp.header(Http::Header::CONTENT_LENGTH, std::to_string(asset->gzip.size()));
+            resp.body().append(std::shared_ptr<char const>(asset, asset->gzip.data()), asset->gzip.size());
+        } else {
+            resp.header(Http::Header::CONTENT_LENGTH, std::to_string(asset->size));
+            resp.body().append(asset->data, asset->size);
+        }
+    }
+
+    if (!asset->gzip.empty()) {
+        resp.header(Http::Header::VARY, "Accept-Encoding");
+    }
+
+    if (!config.cache_control.empty()) {
+        resp.header(Http::Header::CACHE_CONTROL, config.cache_control);
+    }
+
+    return resp;
+}
+
+std::shared_ptr<StaticController::Asset const> StaticController::load(
+    std::string const& path, std::size_t size, std::chrono::system_clock::time_point modified) const
+{
+    auto asset = std::make_shared<Asset>();
+    asset->size = size;
+    asset->modified = modified;
+    asset->content_type = contentType(path);
+    asset->last_modified = httpDate(modified);
+
+    // Read rather than mapped: a mapping costs whole pages the byte budget doesn't see, and a file truncated while
+    // mapped faults the process when the missing pages are touched
+    if (size > 0) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw NotFoundHttpException();
+        }
+
+        std::shared_ptr<char> data(new char[size], std::default_delete<char[]>());
+        std::size_t got = 0;
+
+        while (got < size) {
+            auto r = ::read(fd, data.get() + got, size - got);
+            if (r < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (r < 0) {
+                ::close(fd);
+                throw InternalServerErrorHttpException("Unable to read " + path);
+            }
+
+            // Truncated since we looked at it, hold what is there
+            if (r == 0) {
+                break;
+            }
+
+            got += static_cast<std::size_t>(r);
+        }
+
+        ::close(fd);
+
+        asset->data = std::move(data);
+        asset->size = size = got;
+    }
+
+    std::string_view content(asset->data.get(), size);
+
+    // A file too large to hold is read per request, tag it by its size and date rather than hashing it all
+    if (size > config.max_cached_size) {
+        asset->etag = strongETag(std::to_string(size) + "-" + asset->last_modified);
+        return asset;
+    }
+
+    asset->etag = strongETag(content);
+
+    if (size >= config.gzip_min_size && compressibleType(asset->content_type)) {
+        asset->gzip = compress(content, ContentEncoding::GZIP, 9);
+
+        // Not worth the Vary header if it barely shrinks
+        if (asset->gzip.size() >= size) {
+            asset->gzip.clear();
+        }
+    }
+
+    return asset;
+}
+
+/**
+ * A relative path that stays inside the search path.
+ */
+bool StaticController::safePath(std::string const& path)
+{
+    if (path.empty() || path.front() == '/' || path.find('\0') != std::string::npos ||
+        path.find('\\') != std::string::npos) {
+        return false;
+    }
+
+    std::size_t start = 0;
+    while (start <= path.size()) {
+        auto end = path.find('/', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+
+        if (path.compare(start, end - start, "..") == 0) {
+            return false;
+        }
+
+        start = end + 1;
+    }
+
+    return true;
+}
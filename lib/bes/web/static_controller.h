@@ -0,0 +1,128 @@
+#pragma once
+
+#include <bes/core.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "http.h"
+#include "http_request.h"
+#include "http_response.h"
+
+namespace bes::web {
+
+struct StaticConfig
+{
+    /// Files up to this size are held in memory; larger ones are handed back to the web server
+    std::size_t max_cached_size = 256 * 1024;
+
+    /// Memory for held files; once it is spent, further files are read on each request
+    std::size_t byte_budget = 64 * 1024 * 1024;
+
+    /// Internal location that the web server serves large files from with X-Accel-Redirect, eg "/_assets/". Empty to
+    /// send large files through FastCGI instead.
+    std::string accel_prefix;
+
+    /// Cache-Control sent with every file, empty for none
+    std::string cache_control = "public, max-age=3600";
+
+    /// Route argument holding the path of the file, relative to the search path
+    std::string path_arg = "path";
+
+    /// Compressible files at least this large are held gzipped as well
+    std::size_t gzip_min_size = 256;
+
+    /// Check each file for changes on every request, for development
+    bool watch = false;
+};
+
+struct StaticStats
+{
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t redirects = 0;
+    std::size_t files = 0;
+    std::size_t bytes = 0;
+};
+
+/**
+ * A controller that serves static files from a search path.
+ *
+ *      assets:
+ *        uri: /assets/{ path: .+ }
+ *
+ *      StaticConfig config;
+ *      config.accel_prefix = "/_assets/";
+ *      auto assets = std::make_shared<StaticController>(bes::FileFinder({"/srv/app/public"}), config);
+ *      router.registerController("assets", &StaticController::serve, assets);
+ *
+ * A file up to `max_cached_size` is read into memory the first time it is requested, with its ETag, Last-Modified
+ * date and a gzipped copy worked out then, so later requests cost a map lookup; the body is sent from the held copy
+ * without being copied again. Larger files are answered with an X-Accel-Redirect to `accel_prefix`, so nginx sends
+ * them and their bytes never pass through FastCGI:
+ *
+ *      location /_assets/ {
+ *          internal;
+ *          alias /srv/app/public/;
+ *      }
+ *
+ * Files are assumed not to change while the application runs, unless `watch` is set. Paths that try to leave the
+ * search path, and files that don't exist, are a 404.
+ */
+class StaticController
+{
+   public:
+    explicit StaticController(bes::FileFinder finder, StaticConfig config = {});
+
+    StaticController(StaticController const&) = delete;
+    StaticController& operator=(StaticController const&) = delete;
+
+    HttpResponse serve(HttpRequest const& request, ActionArgs const& args);
+
+    /**
+     * Drop every held file, so they're read again on their next request.
+     */
+    void clear();
+
+    [[nodiscard]] StaticStats stats() const;
+
+    /**
+     * The Content-Type for a file name, by its extension.
+     */
+    static std::string_view contentType(std::string_view path);
+
+   private:
+    struct Asset
+    {
+        std::shared_ptr<char const> data;
+        std::size_t size = 0;
+        std::string gzip;
+        std::string content_type;
+        std::string etag;
+        std::string last_modified;
+        std::chrono::system_clock::time_point modified;
+    };
+
+    bes::FileFinder finder;
+    StaticConfig config;
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Asset const>> assets;
+    std::size_t bytes = 0;
+
+    std::atomic<std::uint64_t> hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> redirects{0};
+
+    HttpResponse respond(std::shared_ptr<Asset const> const& asset, HttpRequest const& request) const;
+    std::shared_ptr<Asset const> load(std::string const& path, std::size_t size,
+                                      std::chrono::system_clock::time_point modified) const;
+    static bool safePath(std::string const& path);
+};
+
+}  // namespace bes::web
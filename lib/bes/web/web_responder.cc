@@ -1,20 +1,43 @@
 #include "web_responder.h"
 
+#include <algorithm>
+#include <cstdlib>
+
 using namespace bes::web;
 
+namespace {
+
+/**
+ * The Content-Length to send: the controller's while the body is sent as it was, the body's own once the responder has
+ * encoded it. None if the controller didn't set one.
+ */
+std::string encodedLength(std::string const& content_length, ContentEncoding encoding, std::size_t encoded_size)
+{
+    if (content_length.empty() || encoding == ContentEncoding::IDENTITY) {
+        return content_length;
+    }
+
+    return std::to_string(encoded_size);
+}
+
+}  // namespace
+
 /**
  * Wrap the FastCGI entry-point so that we can control error templates.
  */
 int WebResponder::run()
 {
     // For stats only
-    auto t_start = std::chrono::high_resolution_clock::now();
+    auto t_start = std::chrono::steady_clock::now();
+    auto t_parsed = t_start;
     std::string method = "-";
     std::string uri = "-";
+    std::string route_name;
     std::string ret_status = "-";
 
     try {
         HttpRequest http_req(request);
+        t_parsed = std::chrono::steady_clock::now();
         method = request.getParam(Http::Parameter::REQUEST_METHOD);
         uri = request.getParam(Http::Parameter::REQUEST_URI);
 
@@ -23,30 +46,32 @@ int WebResponder::run()
             /// Normal response handling
             bool responded = false;
             for (auto const& router : *(request.container.get<std::vector<std::shared_ptr<Router>>>(SVC_ROUTER))) {
-                try {
-                    // Get an HttpResponse from the router, if applicable
-                    auto resp = router->yieldResponse(http_req);
-
-                    // Validate it has a response code
-                    try {
-                        ret_status = resp.headers().at(Http::Header::STATUS);
-                    } catch (...) {
-                        ret_status = "200";
-                        resp.status(Http::Status::OK);
-                    }
-
-                    // Render, break from the loop
-                    renderResponse(resp, http_req);
-                    responded = true;
-                    break;
-                } catch (CannotYieldException const&) {
-                    // Router couldn't yield a response, continue looking
+                // Get an HttpResponse from the router, if applicable, else continue looking
+                auto resp = router->tryYieldResponse(http_req);
+                if (!resp) {
+                    continue;
+                }
+
+                // Validate it has a response code
+                if (auto const* status = resp->headers().get(HeaderName::STATUS)) {
+                    ret_status = *status;
+                } else {
+                    ret_status = "200";
+                    resp->status(Http::Status::OK);
                 }
+
+                // Render, break from the loop
+                route_name = resp->routeName();
+                renderResponse(*resp, http_req);
+                responded = true;
+                break;
             }
 
-            // No routers could yield a response, raise a 404 (this is acceptable behavior)
+            // No routers could yield a response, render a 404 (this is acceptable behavior, and common enough under
+            // bot traffic that it shouldn't go through the exception handlers)
             if (!responded) {
-                throw NotFoundHttpException();
+                ret_status = std::to_string(static_cast<int>(Http::Status::NOT_FOUND));
+                renderError(http_req, Http::Status::NOT_FOUND, "Page Not Found");
             }
 
         } catch (RedirectHttpException const& e) {
@@ -84,23 +109,63 @@ int WebResponder::run()
         renderEmergencyErrorResponse(e.what());
     }
 
-    auto t_end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_start).count();
+    if (not_modified) {
+        ret_status = std::to_string(static_cast<int>(Http::Status::NOT_MODIFIED));
+    }
+
+    auto t_end = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(t_end - t_start);
 
-    BES_LOG(INFO) << "[HTTP] " << method << " " << uri << " -> " << ret_status << " in " << duration << " μs";
+    auto access_log = request.container.get<AccessLog>(SVC_ACCESS_LOG);
+    if (access_log == nullptr) {
+        BES_LOG(INFO) << "[HTTP] " << method << " " << uri << " -> " << ret_status << " in " << duration.count()
+                      << " μs";
+        return 0;
+    }
+
+    int status = std::atoi(ret_status.c_str());
+    auto rate = access_log->sample(status, duration);
+    if (rate == 0) {
+        return 0;
+    }
+
+    // Requests that failed before rendering never set the render start, treat the whole request as handling
+    if (t_render < t_parsed) {
+        t_render = t_end;
+    }
+
+    auto us = [](auto d) {
+        return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+    };
+
+    AccessRecord rec;
+    rec.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        (std::chrono::system_clock::now() - duration).time_since_epoch())
+                        .count();
+    rec.bytes = out_buffer.size();
+    rec.parse_us = us(t_parsed - t_start);
+    rec.handle_us = us(t_render - t_parsed);
+    rec.render_us = us(t_end - t_render);
+    rec.total_us = us(duration);
+    rec.status = static_cast<std::uint16_t>(status);
+    rec.sample_rate = static_cast<std::uint16_t>(std::min(rate, 65535u));
+    rec.setMethod(method);
+    rec.setRoute(route_name);
+    rec.setUri(uri);
+
+    access_log->record(rec);
 
     return 0;
 }
 
 void WebResponder::renderError(HttpRequest const& req, Http::Status code, std::string const& debug_msg)
 {
-    for (auto const& router : *(request.container.get<std::vector<std::shared_ptr<Router>>>("routers"))) {
-        try {
-            // Render error response, if this router yields one
-            renderResponse(router->yieldErrorResponse(req, code, debug_msg), req);
-        } catch (CannotYieldException const&) {
-            // Router does not handle this error type, continue looking
-            // At least one router should be a catch-all error handler
+    for (auto const& router : *(request.container.get<std::vector<std::shared_ptr<Router>>>(SVC_ROUTER))) {
+        // Render error response, if this router yields one, otherwise continue looking
+        // At least one router should be a catch-all error handler
+        if (auto resp = router->tryYieldErrorResponse(req, code, debug_msg)) {
+            renderResponse(*resp, req);
+            return;
         }
     }
 
@@ -109,70 +174,306 @@ void WebResponder::renderError(HttpRequest const& req, Http::Status code, std::s
     renderEmergencyErrorResponse("No routers contain a handler for this error: " + debug_msg);
 }
 
-void WebResponder::renderResponse(HttpResponse const& resp, HttpRequest const& req)
+/**
+ * Write a response to the FastCGI output. The body is moved across rather than copied, unless it must be hashed,
+ * compressed or cached, when a flat copy is taken for that.
+ */
+void WebResponder::renderResponse(HttpResponse& resp, HttpRequest const& req)
 {
-    // Render headers
-    for (auto const& header : resp.headers()) {
-        out << header.first << ": " << header.second << "\n";
+    t_render = std::chrono::steady_clock::now();
+
+    // Served from the response cache, only the session cookie and encoding are specific to this request
+    if (auto const& entry = resp.cached()) {
+        auto const* config = compression();
+        bool const compressible = !entry->gzip_body.empty();
+        auto encoding = compressible ? req.acceptedEncoding() : ContentEncoding::IDENTITY;
+        if (encoding == ContentEncoding::DEFLATE && config == nullptr) {
+            encoding = ContentEncoding::IDENTITY;
+        }
+
+        auto etag = encodedETag(entry->etag, encoding);
+        if (!etag.empty() && req.ifNoneMatch(etag)) {
+            renderNotModified(etag, compressible, resp, req);
+            return;
+        }
+
+        std::string deflated;
+        std::string_view body = entry->body;
+        switch (encoding) {
+            case ContentEncoding::GZIP:
+                body = entry->gzip_body;
+                break;
+            case ContentEncoding::DEFLATE:
+                // Rare enough that only the gzip variant is kept
+                deflated = compress(entry->body, encoding, config->level);
+                body = deflated;
+                break;
+            default:
+                break;
+        }
+
+        out_buffer.append(entry->headers);
+        renderEncoding(encoding, etag, encodedLength(entry->content_length, encoding, body.size()));
+        renderSessionCookie(req);
+        out << "\n";
+        out_buffer.append(body);
+
+        return;
+    }
+
+    auto& body = resp.body();
+
+    auto const& resp_headers = resp.headers();
+    auto const* status = resp_headers.get(HeaderName::STATUS);
+    bool const ok = status != nullptr && *status == "200";
+
+    auto const* etag_header = resp_headers.get(HeaderName::ETAG);
+    bool const tag_body = etag_header == nullptr && ok && autoETag();
+
+    // Compress if the client accepts it, unless the controller has already encoded the body itself
+    auto const* config = compression();
+    bool compressible = false;
+    if (config != nullptr && ok && body.size() >= config->min_size &&
+        resp_headers.get(HeaderName::CONTENT_ENCODING) == nullptr) {
+        auto const* type = resp_headers.get(HeaderName::CONTENT_TYPE);
+        compressible = type != nullptr && compressibleType(*type);
+    }
+
+    auto const encoding = compressible ? req.acceptedEncoding() : ContentEncoding::IDENTITY;
+
+    // Only gather the body into one string if something needs to read it whole; a response built from the session is
+    // personal to whoever sent the request, so it's never stored
+    auto const& store = resp.cacheStore();
+    bool const storing = store && ok && resp.cookies().empty() && !req.sessionLoaded();
+    std::string content;
+    if (tag_body || encoding != ContentEncoding::IDENTITY || storing) {
+        content = body.str();
+    }
+
+    // Tag the body if the controller (or a version provider) hasn't already
+    std::string etag;
+    if (etag_header != nullptr) {
+        etag = *etag_header;
+    } else if (tag_body) {
+        etag = strongETag(content);
+    }
+
+    auto const encoded_etag = encodedETag(etag, encoding);
+
+    // Render headers; the ETag, Content-Encoding and Content-Length vary by request, they're written separately
+    std::string headers;
+    headers.reserve(256);
+    std::string content_length;
+    for (auto const& header : resp_headers) {
+        if (header.id() == HeaderName::CONTENT_LENGTH) {
+            content_length = header.value;
+        } else if (header.id() != HeaderName::ETAG) {
+            header.serialise(headers);
+        }
     }
-    // Cookies
-    for (auto const& it : resp.cookies()) {
-        renderCookie(it.second);
+
+    renderPresetHeaders(resp, headers);
+
+    if (compressible) {
+        headers += Http::Header::VARY;
+        headers += ": Accept-Encoding\n";
     }
 
-    // Check for a session, add a session cookie if we have a session
-    if (req.hasSession()) {
-        Cookie session_cookie(*(request.container.get<std::string>(SESSION_COOKIE_KEY)), req.getSession().sessionId());
-        session_cookie.setHttpOnly(true);
-        if (*(request.container.get<bool>(SESSION_SECURE_KEY))) {
-            session_cookie.setSecure(true);
+    std::string encoded;
+    if (ok && !encoded_etag.empty() && req.ifNoneMatch(encoded_etag)) {
+        renderNotModified(encoded_etag, compressible, resp, req);
+    } else {
+        if (encoding != ContentEncoding::IDENTITY) {
+            encoded = compress(content, encoding, config->level);
         }
 
-        renderCookie(session_cookie);
+        out_buffer.append(headers);
+        renderEncoding(encoding, encoded_etag, encodedLength(content_length, encoding, encoded.size()));
+
+        // Cookies
+        for (auto const& cookie : resp.cookies()) {
+            renderCookie(cookie);
+        }
+
+        renderSessionCookie(req);
+
+        // End of headers
+        out << "\n";
+
+        // Render content
+        if (encoding == ContentEncoding::IDENTITY) {
+            out_buffer.append(std::move(body));
+        } else {
+            out << encoded;
+        }
     }
 
-    // End of headers
+    // Store for the next request, unless the response was personal to this one
+    if (storing) {
+        std::string gzip_body;
+        if (compressible) {
+            gzip_body = (encoding == ContentEncoding::GZIP && !encoded.empty())
+                            ? std::move(encoded)
+                            : compress(content, ContentEncoding::GZIP, config->level);
+        }
+
+        store->cache->put(store->key,
+                          CachedResponse{std::move(headers), std::move(content), std::move(etag), std::move(gzip_body),
+                                         std::move(content_length)},
+                          store->ttl);
+    }
+}
+
+/**
+ * Headers that depend on the encoding chosen for this request.
+ */
+void WebResponder::renderEncoding(ContentEncoding encoding, std::string const& etag, std::string_view content_length)
+{
+    if (auto const* name = encodingName(encoding)) {
+        out << Http::Header::CONTENT_ENCODING << ": " << name << "\n";
+    }
+
+    if (!content_length.empty()) {
+        out << Http::Header::CONTENT_LENGTH << ": " << content_length << "\n";
+    }
+
+    if (!etag.empty()) {
+        out << Http::Header::ETAG << ": " << etag << "\n";
+    }
+}
+
+/**
+ * The route's own headers go in as one block, unless the controller has set one of them itself.
+ */
+void WebResponder::renderPresetHeaders(HttpResponse const& resp, std::string& headers)
+{
+    auto const& preset = resp.presetHeaders();
+    if (!preset) {
+        return;
+    }
+
+    auto const& resp_headers = resp.headers();
+    bool overridden = false;
+    for (auto const& header : preset->headers) {
+        overridden = overridden || resp_headers.get(header.name()) != nullptr;
+    }
+
+    if (!overridden) {
+        headers += preset->block;
+        return;
+    }
+
+    for (auto const& header : preset->headers) {
+        if (resp_headers.get(header.name()) == nullptr) {
+            header.serialise(headers);
+        }
+    }
+}
+
+/**
+ * The client already holds this entity: send its tag, any cookies and the headers a 200 would have carried that
+ * describe the entity's caching (RFC 9110 15.4.5), but no body.
+ */
+void WebResponder::renderNotModified(std::string const& etag, bool vary_encoding, HttpResponse const& resp,
+                                     HttpRequest const& req)
+{
+    not_modified = true;
+
+    std::string headers;
+    headers += Http::Header::STATUS;
+    headers += ": ";
+    headers += std::to_string(static_cast<int>(Http::Status::NOT_MODIFIED));
+    headers += '\n';
+
+    for (auto const* name : {Http::Header::CACHE_CONTROL, Http::Header::EXPIRES, Http::Header::CONTENT_LOCATION}) {
+        if (auto const* value = resp.headers().get(name)) {
+            headers += name;
+            headers += ": ";
+            headers += *value;
+            headers += '\n';
+        }
+    }
+
+    renderPresetHeaders(resp, headers);
+
+    if (vary_encoding) {
+        headers += Http::Header::VARY;
+        headers += ": Accept-Encoding\n";
+    }
+
+    out_buffer.append(headers);
+    out << Http::Header::ETAG << ": " << etag << "\n";
+
+    for (auto const& cookie : resp.cookies()) {
+        renderCookie(cookie);
+    }
+
+    renderSessionCookie(req);
     out << "\n";
+}
+
+void WebResponder::renderSessionCookie(HttpRequest const& req)
+{
+    // Only a session that was read or created is sent back: the client already holds the cookie for one that wasn't,
+    // and an expired or forged ID shouldn't be echoed to it
+    if (!req.sessionLoaded() || !req.hasSession()) {
+        return;
+    }
 
-    // Render content
-    out << resp.content();
+    Cookie session_cookie(*(request.container.get<std::string>(SESSION_COOKIE_KEY)), std::string(req.sessionId()));
+    session_cookie.setHttpOnly(true);
+    if (*(request.container.get<bool>(SESSION_SECURE_KEY))) {
+        session_cookie.setSecure(true);
+    }
+
+    renderCookie(session_cookie);
 }
 
+/**
+ * Built up in a buffer kept by the thread and appended in one piece.
+ */
 void WebResponder::renderCookie(Cookie const& cookie)
 {
-    out << "Set-Cookie: " << cookie.getName() << "=" << cookie.getValue();
+    thread_local std::string line;
+    line.assign("Set-Cookie: ");
+    line += cookie.getName();
+    line += '=';
+    line += cookie.getValue();
 
     if (!cookie.getDomain().empty()) {
-        out << "; Domain=" << cookie.getDomain();
+        line += "; Domain=";
+        line += cookie.getDomain();
     }
 
     if (!cookie.getPath().empty()) {
-        out << "; Path=" << cookie.getPath();
+        line += "; Path=";
+        line += cookie.getPath();
     }
 
     if (cookie.getMaxAge()) {
-        out << "; Max-Age=" << std::to_string(cookie.getMaxAge());
+        line += "; Max-Age=";
+        line += std::to_string(cookie.getMaxAge());
     } else if (cookie.getExpires() > std::chrono::system_clock::now()) {
-        std::time_t exp_time_t = std::chrono::system_clock::to_time_t(cookie.getExpires());
-        std::tm exp_tm = *std::localtime(&exp_time_t);
-        char buf[40];  // Should be ~ 30 chars
-        strftime(buf, 40, "%a, %d-%b-%Y %T GMT", &exp_tm);
-        out << "; Expires=" << buf;
+        line += "; Expires=";
+        line += httpDate(cookie.getExpires());
     }
 
     if (cookie.isSecure()) {
-        out << "; Secure";
+        line += "; Secure";
     }
 
     if (cookie.isHttpOnly()) {
-        out << "; HttpOnly";
+        line += "; HttpOnly";
     }
 
-    out << "\n";
+    line += '\n';
+    out_buffer.append(line);
 }
 
 void WebResponder::renderEmergencyErrorResponse(std::string const& debug_msg)
 {
+    t_render = std::chrono::steady_clock::now();
+
     out << Http::Header::STATUS << ": " << static_cast<int>(Http::Status::INTERNAL_SERVER_ERROR) << "\n";
     out << Http::Header::CONTENT_TYPE << ": " << Http::ContentType::HTML << "\n\n";
 
@@ -185,6 +486,26 @@ void WebResponder::renderEmergencyErrorResponse(std::string const& debug_msg)
     out << "</body></html>";
 }
 
+/**
+ * Checks if the request container was loaded with the option to tag response bodies with an ETag
+ */
+bool WebResponder::autoETag()
+{
+    return request.container.exists(AUTO_ETAG_KEY) && *(request.container.get<bool>(AUTO_ETAG_KEY));
+}
+
+/**
+ * The compression settings the request container was loaded with, or nullptr if responses aren't compressed
+ */
+CompressionConfig const* WebResponder::compression()
+{
+    if (!request.container.exists(SVC_COMPRESSION)) {
+        return nullptr;
+    }
+
+    return request.container.get<CompressionConfig>(SVC_COMPRESSION).get();
+}
+
 /**
  * Checks if the request container was loaded with an option allowing us to render debug errors
  */
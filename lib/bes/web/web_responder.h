@@ -4,7 +4,10 @@
 #include <bes/log.h>
 
 #include <chrono>
+#include <vector>
 
+#include "access_log.h"
+#include "compression.h"
 #include "exception.h"
 #include "http.h"
 #include "http_request.h"
@@ -22,11 +25,24 @@ class WebResponder : public bes::fastcgi::Response
     int run() override;
 
    protected:
-    void renderResponse(HttpResponse const& resp, HttpRequest const& req);
+    void renderResponse(HttpResponse& resp, HttpRequest const& req);
     void renderCookie(Cookie const& cookie);
+    void renderSessionCookie(HttpRequest const& req);
+    void renderEncoding(ContentEncoding encoding, std::string const& etag, std::string_view content_length);
+    void renderPresetHeaders(HttpResponse const& resp, std::string& headers);
+    void renderNotModified(std::string const& etag, bool vary_encoding, HttpResponse const& resp,
+                           HttpRequest const& req);
     void renderError(HttpRequest const& req, Http::Status code, std::string const& debug_msg);
     void renderEmergencyErrorResponse(std::string const& debug_msg);
     bool debugMode();
+    bool autoETag();
+    CompressionConfig const* compression();
+
+    /// Time rendering started, for the access log
+    std::chrono::steady_clock::time_point t_render{};
+
+    /// A 304 was sent in place of the response
+    bool not_modified = false;
 };
 
 }  // namespace bes::web
@@ -5,6 +5,7 @@ using namespace bes::web;
 WebServer::WebServer()
 {
     routers = std::make_shared<std::vector<std::shared_ptr<Router>>>();
+    session_counters = std::make_shared<SessionCounters>();
 }
 
 void WebServer::run(bes::net::Address const& listen_addr, bool allow_dbg_rendering)
@@ -14,7 +15,11 @@ void WebServer::run(bes::net::Address const& listen_addr, bool allow_dbg_renderi
     svc = std::make_unique<bes::fastcgi::Service>();
     svc->container.add(SVC_ROUTER, routers);
     svc->container.add(SVC_SESSION_MGR, session_mgr);
+    svc->container.add(SVC_ACCESS_LOG, access_log);
+    svc->container.add(SVC_COMPRESSION, compression);
+    svc->container.add(SVC_SESSION_STATS, session_counters);
     svc->container.emplace<bool>(DEBUG_KEY, allow_dbg_rendering);
+    svc->container.emplace<bool>(AUTO_ETAG_KEY, auto_etag);
     svc->container.emplace<uint64_t>(SESSION_TTL_KEY, session_ttl);
     svc->container.emplace<bool>(SESSION_SECURE_KEY, session_secure);
     svc->container.emplace<std::string>(SESSION_PREFIX_KEY, SESSION_DEFAULT_PREFIX);
@@ -29,6 +34,15 @@ void WebServer::shutdown()
         svc->shutdown();
         svc.reset(nullptr);
     }
+
+    // Sessions persisted by the last requests may still be queued
+    if (session_mgr != nullptr) {
+        session_mgr->flush();
+    }
+
+    if (access_log != nullptr) {
+        access_log->flush();
+    }
 }
 
 void WebServer::allocateRouter(Router* router)
@@ -41,6 +55,25 @@ void WebServer::addRouter(std::shared_ptr<Router> const& router)
     routers->push_back(router);
 }
 
+void WebServer::setAccessLog(std::shared_ptr<AccessLog> const& log)
+{
+    access_log = log;
+}
+
+void WebServer::setAutoETag(bool enabled)
+{
+    auto_etag = enabled;
+}
+
+void WebServer::setCompression(std::shared_ptr<CompressionConfig> const& config)
+{
+    if (config != nullptr && (config->level < 1 || config->level > 9)) {
+        throw WebException("Compression level must be between 1 and 9, got " + std::to_string(config->level));
+    }
+
+    compression = config;
+}
+
 void WebServer::allocateSessionInterface(SessionInterface* si)
 {
     session_mgr = std::shared_ptr<SessionInterface>(si);
@@ -100,3 +133,8 @@ void WebServer::setSessionCookieName(std::string const& name)
         svc->container.emplace<std::string>(SESSION_COOKIE_KEY, name);
     }
 }
+
+SessionStats WebServer::sessionStats() const
+{
+    return session_counters->stats();
+}
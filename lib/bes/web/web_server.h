@@ -4,9 +4,12 @@
 
 #include <memory>
 
+#include "access_log.h"
+#include "compression.h"
 #include "model.h"
 #include "router.h"
 #include "session_interface.h"
+#include "session_stats.h"
 #include "web_responder.h"
 
 namespace bes::web {
@@ -34,12 +37,38 @@ class WebServer
     void setSessionPrefix(std::string const &prefix);
     void setSessionCookieName(std::string const &name);
 
+    /**
+     * Log requests to a dedicated access log rather than the log sink. Must be set before calling run().
+     */
+    void setAccessLog(std::shared_ptr<AccessLog> const &log);
+
+    /**
+     * Tag 200 responses with an ETag hashed from the body, and answer a matching If-None-Match with a 304. Must be set
+     * before calling run().
+     */
+    void setAutoETag(bool enabled);
+
+    /**
+     * Compress responses for clients that accept gzip or deflate; nullptr (the default) disables compression. Must be
+     * set before calling run().
+     */
+    void setCompression(std::shared_ptr<CompressionConfig> const &config);
+
+    /**
+     * How requests have used their sessions since the server was created, including how many never fetched theirs.
+     */
+    [[nodiscard]] SessionStats sessionStats() const;
+
    protected:
     std::unique_ptr<bes::fastcgi::Service> svc;
     std::shared_ptr<std::vector<std::shared_ptr<Router>>> routers;
     std::shared_ptr<SessionInterface> session_mgr;
+    std::shared_ptr<AccessLog> access_log;
+    std::shared_ptr<CompressionConfig> compression;
+    std::shared_ptr<SessionCounters> session_counters;
     uint64_t session_ttl = 0;
     bool session_secure = false;
+    bool auto_etag = false;
 };
 
 template <class T, class... Args>
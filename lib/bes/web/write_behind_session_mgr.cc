@@ -0,0 +1,208 @@
+#include "write_behind_session_mgr.h"
+
+#include <bes/log.h>
+
+#include <stdexcept>
+
+using namespace bes::web;
+
+WriteBehindSessionMgr::WriteBehindSessionMgr(std::shared_ptr<SessionInterface> target, std::size_t max_pending)
+    : target(std::move(target)), max_pending(max_pending)
+{
+    if (this->target == nullptr) {
+        throw std::invalid_argument("WriteBehindSessionMgr requires a target session manager");
+    }
+
+    writer = std::thread([this] {
+        writerLoop();
+    });
+}
+
+WriteBehindSessionMgr::~WriteBehindSessionMgr()
+{
+    shutdown();
+}
+
+Session WriteBehindSessionMgr::createSession(std::string const& ns)
+{
+    return target->createSession(ns);
+}
+
+Session WriteBehindSessionMgr::getSession(std::string const& id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // A pending write holds the whole session, newer than the store
+        std::optional<Session> pending;
+        auto it = queued.find(id);
+        if (it != queued.end()) {
+            pending = it->second;
+        } else if (in_flight && in_flight->sessionId() == id) {
+            pending = *in_flight;
+        }
+
+        if (pending) {
+            pending->markClean();
+            return std::move(*pending);
+        }
+    }
+
+    return target->getSession(id);
+}
+
+void WriteBehindSessionMgr::persistSession(Session const& session)
+{
+    if (session.sessionId().empty()) {
+        throw WebException("Attempting to persist a null session");
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        auto it = queued.find(session.sessionId());
+        if (it != queued.end()) {
+            it->second.merge(session);
+            return;
+        }
+
+        // A queued touch already holds a place in the order, the write takes it over
+        if (touched.erase(session.sessionId())) {
+            queued.emplace(session.sessionId(), session);
+            return;
+        }
+
+        if (waitForSpace(lock)) {
+            queued.emplace(session.sessionId(), session);
+            order.push_back(session.sessionId());
+            wake_cv.notify_one();
+            return;
+        }
+    }
+
+    // The writer has stopped, there's no one else to do it
+    target->persistSession(session);
+}
+
+bool WriteBehindSessionMgr::touchSession(std::string const& id)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        // A pending write refreshes the TTL anyway
+        if (queued.count(id) || touched.count(id) || (in_flight && in_flight->sessionId() == id)) {
+            return true;
+        }
+
+        if (waitForSpace(lock)) {
+            touched.insert(id);
+            order.push_back(id);
+            wake_cv.notify_one();
+            return true;
+        }
+    }
+
+    return target->touchSession(id);
+}
+
+void WriteBehindSessionMgr::setSessionTtl(uint64_t ttl)
+{
+    target->setSessionTtl(ttl);
+}
+
+void WriteBehindSessionMgr::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle_cv.wait(lock, [this] {
+            return (order.empty() && !in_flight && !touching) || writer_done;
+        });
+    }
+
+    // The target may be queueing writes of its own
+    target->flush();
+}
+
+void WriteBehindSessionMgr::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    wake_cv.notify_one();
+    space_cv.notify_all();
+
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+std::size_t WriteBehindSessionMgr::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return queued.size() + touched.size() + (in_flight || touching ? 1 : 0);
+}
+
+/**
+ * Wait for room in the queue, returning false if the writer stopped while we waited.
+ */
+bool WriteBehindSessionMgr::waitForSpace(std::unique_lock<std::mutex>& lock)
+{
+    space_cv.wait(lock, [this] {
+        return queued.size() + touched.size() < max_pending || stop;
+    });
+
+    return !stop;
+}
+
+void WriteBehindSessionMgr::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        wake_cv.wait(lock, [this] {
+            return !order.empty() || stop;
+        });
+
+        // Once stopped, keep going until the queue is drained
+        if (order.empty()) {
+            break;
+        }
+
+        auto id = std::move(order.front());
+        order.pop_front();
+
+        auto node = queued.extract(id);
+        if (node.empty()) {
+            touched.erase(id);
+            touching = true;
+        } else {
+            in_flight = std::move(node.mapped());
+        }
+
+        lock.unlock();
+        space_cv.notify_one();
+
+        try {
+            if (in_flight) {
+                target->persistSession(*in_flight);
+            } else {
+                target->touchSession(id);
+            }
+        } catch (std::exception const& e) {
+            BES_LOG(ERROR) << "Failed to persist session '" << id << "': " << e.what();
+        }
+
+        lock.lock();
+        in_flight.reset();
+        touching = false;
+
+        if (order.empty()) {
+            idle_cv.notify_all();
+        }
+    }
+
+    writer_done = true;
+    idle_cv.notify_all();
+}
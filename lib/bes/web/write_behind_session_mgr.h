@@ -0,0 +1,96 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "session_interface.h"
+
+namespace bes::web {
+
+/**
+ * Moves session writes off the request thread.
+ *
+ * Persisted sessions are queued and a dedicated writer thread hands them to the wrapped session manager, so a request
+ * no longer waits on the store before its response is sent. Use it as a decorator around another session manager:
+ *
+ *      server.emplaceSessionInterface<WriteBehindSessionMgr>(std::make_shared<RedisSessionMgr>(address));
+ *
+ * Writes for a session are applied in the order they were persisted. A session persisted again while an earlier write
+ * is still queued is merged into it, so the store sees one write with both sets of changes. Reading a session with a
+ * pending write returns the pending copy rather than the stale stored one.
+ *
+ * Destroying the manager writes everything still queued; calling flush() also waits for the target to flush.
+ */
+class WriteBehindSessionMgr : public SessionInterface
+{
+   public:
+    explicit WriteBehindSessionMgr(std::shared_ptr<SessionInterface> target, std::size_t max_pending = 10000);
+    ~WriteBehindSessionMgr() override;
+
+    WriteBehindSessionMgr(WriteBehindSessionMgr const&) = delete;
+    WriteBehindSessionMgr& operator=(WriteBehindSessionMgr const&) = delete;
+
+    [[nodiscard]] Session createSession(std::string const& ns) override;
+    [[nodiscard]] Session getSession(std::string const& id) override;
+
+    /**
+     * Queue the session to be written. If `max_pending` sessions are already queued, waits for the writer to catch up.
+     */
+    void persistSession(Session const& session) override;
+
+    /**
+     * Queue a TTL refresh for the session, unless a write for it is already pending. The session is assumed to exist;
+     * a touch of one that doesn't is dropped by the writer.
+     */
+    bool touchSession(std::string const& id) override;
+
+    void setSessionTtl(uint64_t ttl) override;
+
+    /**
+     * Block until every session queued before this call has been written.
+     */
+    void flush() override;
+
+    /**
+     * Write everything queued and stop the writer thread. Sessions persisted afterwards are written synchronously.
+     */
+    void shutdown();
+
+    /**
+     * Number of sessions waiting to be written.
+     */
+    [[nodiscard]] std::size_t pending() const;
+
+   private:
+    std::shared_ptr<SessionInterface> target;
+    std::size_t max_pending;
+
+    // Queued sessions by ID, IDs queued for only a TTL refresh, and the order they were first queued in
+    std::unordered_map<std::string, Session> queued;
+    std::unordered_set<std::string> touched;
+    std::deque<std::string> order;
+
+    // The session being written, still visible to readers until the write completes
+    std::optional<Session> in_flight;
+    bool touching = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake_cv;
+    std::condition_variable space_cv;
+    std::condition_variable idle_cv;
+    bool stop = false;
+    bool writer_done = false;
+
+    std::thread writer;
+
+    bool waitForSpace(std::unique_lock<std::mutex>& lock);
+    void writerLoop();
+};
+
+}  // namespace bes::web
@@ -0,0 +1,100 @@
+#include <bes/core.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST(BesCoreTest, OutputBufferAppend)
+{
+    bes::OutputBuffer buffer;
+    EXPECT_TRUE(buffer.empty());
+
+    buffer.append("Hello");
+    buffer.append(' ');
+    bes::OutputStream out(buffer);
+    out << "World " << 42;
+
+    EXPECT_EQ(14, buffer.size());
+    EXPECT_EQ("Hello World 42", buffer.str());
+
+    // Writes larger than a slab keep their order across slab boundaries
+    std::string large(bes::OutputBuffer::slab_size * 2 + 100, 'x');
+    large.back() = 'y';
+    buffer.append(large);
+    EXPECT_EQ(14 + large.size(), buffer.size());
+    EXPECT_EQ("Hello World 42" + large, buffer.str());
+
+    std::size_t runs = 0, total = 0;
+    buffer.forEach([&](char const*, std::size_t len) {
+        ++runs;
+        total += len;
+    });
+    EXPECT_LE(runs, 3);
+    EXPECT_EQ(buffer.size(), total);
+
+    buffer.clear();
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ("", buffer.str());
+}
+
+TEST(BesCoreTest, OutputBufferSplice)
+{
+    bes::OutputBuffer headers;
+    headers.append("Status: 200\n\n");
+
+    // Small bodies are copied into the space left in the last slab
+    bes::OutputBuffer small;
+    small.append("<p>hi</p>");
+    headers.append(std::move(small));
+    EXPECT_TRUE(small.empty());
+    EXPECT_EQ("Status: 200\n\n<p>hi</p>", headers.str());
+
+    // Large bodies are moved across slab by slab, the data itself stays where it was written
+    bes::OutputBuffer body;
+    body.append(std::string(bes::OutputBuffer::slab_size, 'a'));
+    body.append("b");
+
+    std::vector<char const*> before;
+    body.forEach([&](char const* data, std::size_t) {
+        before.push_back(data);
+    });
+
+    headers.append(std::move(body));
+    EXPECT_TRUE(body.empty());
+    EXPECT_EQ(22 + bes::OutputBuffer::slab_size + 1, headers.size());
+
+    std::vector<char const*> after;
+    headers.forEach([&](char const* data, std::size_t) {
+        after.push_back(data);
+    });
+    ASSERT_EQ(before.size() + 1, after.size());
+    EXPECT_EQ(before.front(), after[1]);
+
+    // Appending keeps going after the spliced slabs
+    headers.append("c");
+    auto flat = headers.str();
+    EXPECT_EQ("bc", flat.substr(flat.size() - 2));
+}
+
+TEST(BesCoreTest, OutputBufferShared)
+{
+    auto owned = std::make_shared<std::string>("shared bytes");
+
+    bes::OutputBuffer buffer;
+    buffer.append("head ");
+    buffer.append(std::shared_ptr<char const>(owned, owned->data()), owned->size());
+    buffer.append(" tail");
+    EXPECT_EQ("head shared bytes tail", buffer.str());
+
+    // Sent from where they lie, and kept alive until the buffer lets go
+    bool seen = false;
+    buffer.forEach([&](char const* data, std::size_t) {
+        seen = seen || data == owned->data();
+    });
+    EXPECT_TRUE(seen);
+    EXPECT_EQ(2, owned.use_count());
+
+    buffer.clear();
+    EXPECT_EQ(1, owned.use_count());
+}
@@ -0,0 +1,163 @@
+#include <bes/log.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace bes::log;
+using namespace bes::log::backend;
+
+namespace {
+
+/**
+ * Captures records for inspection, optionally stalling to simulate a slow sink.
+ */
+class CaptureBackend : public LogBackend
+{
+   public:
+    std::vector<LogRecord> records;
+    std::atomic<bool> stall{false};
+    std::atomic<bool> stalled{false};
+    std::atomic<std::size_t> batches{0};
+    std::atomic<std::size_t> flushes{0};
+
+    void process(LogRecord const& log_record) override
+    {
+        records.push_back(log_record);
+    }
+
+    void processBatch(std::vector<LogRecord> const& batch) override
+    {
+        while (stall.load()) {
+            stalled = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        ++batches;
+        records.insert(records.end(), batch.begin(), batch.end());
+    }
+
+    void flush() override
+    {
+        ++flushes;
+    }
+};
+
+LogRecord makeRecord(std::string msg)
+{
+    LogRecord r;
+    r.severity = Severity::INFO;
+    r.function = "test";
+    r.filename = __FILE__;
+    r.lineno = __LINE__;
+    r.timestamp = std::chrono::system_clock::now();
+    r.message = std::move(msg);
+    return r;
+}
+
+}  // namespace
+
+TEST(BesLogTest, RingBuffer)
+{
+    RingBuffer<int> ring(3);
+    EXPECT_EQ(4, ring.capacity());
+    EXPECT_TRUE(ring.empty());
+
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.tryPush(int(i)));
+    }
+    EXPECT_FALSE(ring.tryPush(99));
+
+    int v;
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.tryPop(v));
+        EXPECT_EQ(i, v);
+    }
+    EXPECT_FALSE(ring.tryPop(v));
+    EXPECT_TRUE(ring.empty());
+
+    EXPECT_THROW(RingBuffer<int>(1), std::invalid_argument);
+}
+
+TEST(BesLogTest, AsyncPreservesOrderAcrossProducers)
+{
+    auto capture = std::make_shared<CaptureBackend>();
+    constexpr int producers = 4;
+    constexpr int per_producer = 5000;
+
+    {
+        AsyncLogBackend async(capture, OverflowPolicy::BLOCK, 64);
+        LogBackend& backend = async;
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&backend, p] {
+                for (int i = 0; i < per_producer; ++i) {
+                    backend.process(makeRecord(std::to_string(p) + ":" + std::to_string(i)));
+                }
+            });
+        }
+
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        backend.flush();
+        EXPECT_EQ(producers * per_producer, capture->records.size());
+        EXPECT_EQ(0, async.dropped());
+    }
+
+    // Each producer's records must arrive in the order they were logged
+    std::vector<int> next(producers, 0);
+    for (auto const& r : capture->records) {
+        auto sep = r.message.find(':');
+        int p = std::stoi(r.message.substr(0, sep));
+        EXPECT_EQ(next[p]++, std::stoi(r.message.substr(sep + 1)));
+    }
+}
+
+TEST(BesLogTest, AsyncDropWithCount)
+{
+    auto capture = std::make_shared<CaptureBackend>();
+    capture->stall = true;
+
+    AsyncLogBackend async(capture, OverflowPolicy::DROP_WITH_COUNT, 8);
+    LogBackend& backend = async;
+
+    // Park the writer inside a batch so the ring can't drain
+    backend.process(makeRecord("first"));
+    while (!capture->stalled.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        backend.process(makeRecord("msg"));
+    }
+
+    EXPECT_EQ(92, async.dropped());
+
+    capture->stall = false;
+    backend.flush();
+
+    // first + 8 buffered + the overflow warning
+    ASSERT_EQ(10, capture->records.size());
+    auto const& last = capture->records.back();
+    EXPECT_EQ(Severity::WARNING, last.severity);
+    EXPECT_NE(std::string::npos, last.message.find("92 log records dropped"));
+}
+
+TEST(BesLogTest, AsyncShutdownFlushes)
+{
+    auto capture = std::make_shared<CaptureBackend>();
+
+    {
+        AsyncLogBackend async(capture, OverflowPolicy::BLOCK, 1024);
+        LogBackend& backend = async;
+        for (int i = 0; i < 500; ++i) {
+            backend.process(makeRecord("msg"));
+        }
+    }
+
+    EXPECT_EQ(500, capture->records.size());
+    EXPECT_GE(capture->flushes.load(), 1);
+}
@@ -0,0 +1,259 @@
+#include <bes/log.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+using namespace bes::log;
+
+namespace {
+
+std::vector<LogRecord> captured;
+
+class CaptureBackend : public backend::LogBackend
+{
+   public:
+    void process(LogRecord const& log_record) override
+    {
+        captured.push_back(log_record);
+    }
+};
+
+std::string tempPath(char const* name)
+{
+    auto path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+std::vector<LogRecord> readAll(std::string const& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    binary::Reader reader(in);
+
+    std::vector<LogRecord> records;
+    LogRecord record;
+    while (reader.next(record)) {
+        records.push_back(record);
+    }
+
+    return records;
+}
+
+}  // namespace
+
+TEST(BesLogTest, BinaryPayloadFormat)
+{
+    std::string s = "str";
+    std::string payload(binary::payloadSize(true, 'c', -5, 7u, 1.5, s, "lit"), '\0');
+    auto* end = binary::encodePayload(payload.data(), true, 'c', -5, 7u, 1.5, s, "lit");
+    EXPECT_EQ(payload.data() + payload.size(), end);
+
+    std::ostringstream out;
+    binary::formatPayload(out, "{} {} {} {} {} {} {} {}", payload.data(), payload.size());
+    EXPECT_EQ("true c -5 7 1.5 str lit {}", out.str());
+
+    // Cut off part way through the second argument
+    EXPECT_THROW(binary::formatPayload(out, "{} {}", payload.data(), 3), std::runtime_error);
+}
+
+TEST(BesLogTest, BinaryRoundTrip)
+{
+    auto path = tempPath("bes_binary_roundtrip.blog");
+
+    {
+        LogSink sink(Severity::INFO);
+        sink.addBackend<backend::BinaryLogBackend>(path);
+
+        BES_LOGF(INFO, "request {} took {}ms", 42, 1.25);
+        BES_LOGF(DEBUG, "filtered {}", 1);
+        BES_LOG(WARNING) << "standard " << 7;
+
+        std::thread t([] {
+            for (int i = 0; i < 100; ++i) {
+                BES_LOGF(NOTICE, "thread {} of {}", i, std::string("worker"));
+            }
+        });
+        t.join();
+
+        sink.flush();
+    }
+
+    auto records = readAll(path);
+    ASSERT_EQ(102, records.size());
+
+    EXPECT_EQ("request 42 took 1.25ms", records[0].message);
+    EXPECT_EQ(Severity::INFO, records[0].severity);
+    EXPECT_EQ(__FILE__, records[0].filename);
+    EXPECT_EQ("TestBody", records[0].function);
+
+    EXPECT_EQ("standard 7", records[1].message);
+    EXPECT_EQ(Severity::WARNING, records[1].severity);
+
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ("thread " + std::to_string(i) + " of worker", records[i + 2].message);
+    }
+
+    // Timestamps are written in order
+    for (std::size_t i = 1; i < records.size(); ++i) {
+        EXPECT_LE(records[i - 1].timestamp, records[i].timestamp);
+    }
+
+    std::ostringstream line;
+    records[0].str(line, LogFormat::SHORT);
+    EXPECT_EQ("[INFO] request 42 took 1.25ms", line.str());
+}
+
+TEST(BesLogTest, BinaryStandardRecordSites)
+{
+    auto path = tempPath("bes_binary_sites.blog");
+    int first_line = 0;
+
+    {
+        LogSink sink(Severity::INFO);
+        sink.addBackend<backend::BinaryLogBackend>(path);
+
+        // Each site's format is registered once, then found again from the thread's cache
+        for (int i = 0; i < 3; ++i) {
+            first_line = __LINE__ + 1;
+            BES_LOG(INFO) << "first " << i;
+            BES_LOG(WARNING) << "second " << i;
+        }
+
+        std::thread([] {
+            BES_LOG(ERROR) << "other thread";
+        }).join();
+
+        sink.flush();
+    }
+
+    auto records = readAll(path);
+    ASSERT_EQ(7, records.size());
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ("first " + std::to_string(i), records[i * 2].message);
+        EXPECT_EQ(Severity::INFO, records[i * 2].severity);
+        EXPECT_EQ(first_line, records[i * 2].lineno);
+
+        EXPECT_EQ("second " + std::to_string(i), records[i * 2 + 1].message);
+        EXPECT_EQ(Severity::WARNING, records[i * 2 + 1].severity);
+        EXPECT_EQ(first_line + 1, records[i * 2 + 1].lineno);
+        EXPECT_EQ(__FILE__, records[i * 2 + 1].filename);
+    }
+
+    EXPECT_EQ("other thread", records[6].message);
+}
+
+TEST(BesLogTest, BinaryDroppedRecords)
+{
+    auto path = tempPath("bes_binary_dropped.blog");
+
+    {
+        LogSink sink(Severity::INFO);
+        auto id = sink.addBackend<backend::BinaryLogBackend>(path, 1024);
+
+        // Far more than a 1KiB buffer holds between writer passes
+        std::string padding(100, 'x');
+        for (int i = 0; i < 1000; ++i) {
+            BES_LOGF(INFO, "{} {}", i, padding);
+        }
+
+        sink.flush();
+        sink.removeBackend(id);
+    }
+
+    auto records = readAll(path);
+    std::uint64_t dropped = 0;
+    std::size_t logged = 0;
+
+    for (auto const& r : records) {
+        if (r.severity == Severity::WARNING) {
+            dropped += std::stoull(r.message);
+        } else {
+            ++logged;
+        }
+    }
+
+    EXPECT_GT(dropped, 0);
+    EXPECT_EQ(1000, logged + dropped);
+}
+
+TEST(BesLogTest, BinaryBackendRemovedWhileLogging)
+{
+    auto path = tempPath("bes_binary_removed.blog");
+    LogSink sink(Severity::INFO);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&done] {
+            for (int i = 0; !done.load(); ++i) {
+                BES_LOGF(INFO, "churn {}", i);
+            }
+        });
+    }
+
+    // Each removal destroys the backend while the threads are pushing to it
+    for (int i = 0; i < 20; ++i) {
+        auto id = sink.addBackend<backend::BinaryLogBackend>(path, 4096);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        sink.removeBackend(id);
+    }
+
+    done.store(true);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_FALSE(backend::BinaryLogBackend::active());
+}
+
+TEST(BesLogTest, StructuredWithoutBinaryBackend)
+{
+    LogSink sink(Severity::INFO);
+    sink.addBackend<CaptureBackend>();
+
+    captured.clear();
+    BES_LOGF(INFO, "{} + {} = {}", 1, 2, 3u);
+    BES_LOGF(INFO, "no args");
+
+    EXPECT_FALSE(backend::BinaryLogBackend::active());
+    ASSERT_EQ(2, captured.size());
+    EXPECT_EQ("1 + 2 = 3", captured[0].message);
+    EXPECT_EQ("no args", captured[1].message);
+    EXPECT_EQ(Severity::INFO, captured[0].severity);
+}
+
+TEST(BesLogTest, StructuredWithBinaryAndTextBackends)
+{
+    auto path = tempPath("bes_binary_mixed.blog");
+
+    {
+        LogSink sink(Severity::INFO);
+        sink.addBackend<backend::BinaryLogBackend>(path);
+        sink.addBackend<CaptureBackend>();
+
+        captured.clear();
+        BES_LOGF(INFO, "{} + {} = {}", 1, 2, 3u);
+        BES_LOG(INFO) << "standard";
+        sink.flush();
+
+        // The text backend gets both statements formatted
+        ASSERT_EQ(2, captured.size());
+        EXPECT_EQ("1 + 2 = 3", captured[0].message);
+        EXPECT_EQ("standard", captured[1].message);
+    }
+
+    // The binary log holds each statement once
+    auto records = readAll(path);
+    ASSERT_EQ(2, records.size());
+    EXPECT_EQ("1 + 2 = 3", records[0].message);
+    EXPECT_EQ("standard", records[1].message);
+}
+
+TEST(BesLogTest, BinaryReaderRejectsGarbage)
+{
+    std::istringstream in("not a log");
+    EXPECT_THROW(binary::Reader reader(in), std::runtime_error);
+}
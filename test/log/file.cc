@@ -0,0 +1,133 @@
+#include <bes/log.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <thread>
+
+using namespace bes::log;
+using namespace bes::log::backend;
+
+namespace {
+
+std::string tempPath(char const* name)
+{
+    auto path = ::testing::TempDir() + name;
+    for (auto const& suffix : {"", ".1", ".2", ".3"}) {
+        std::remove((path + suffix).c_str());
+    }
+
+    return path;
+}
+
+std::vector<std::string> readLines(std::string const& path)
+{
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+
+    return lines;
+}
+
+LogRecord makeRecord(std::string msg)
+{
+    LogRecord r;
+    r.severity = Severity::INFO;
+    r.function = "test";
+    r.filename = __FILE__;
+    r.lineno = __LINE__;
+    r.timestamp = std::chrono::system_clock::now();
+    r.message = std::move(msg);
+    return r;
+}
+
+}  // namespace
+
+TEST(BesLogTest, FileBackendWrites)
+{
+    auto path = tempPath("bes_file_writes.log");
+
+    {
+        FileLogBackend file(path, LogFormat::SHORT);
+        LogBackend& backend = file;
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&backend] {
+                for (int i = 0; i < 5000; ++i) {
+                    backend.process(makeRecord("line " + std::to_string(i)));
+                }
+            });
+        }
+
+        for (auto& t : threads) {
+            t.join();
+        }
+
+        backend.flush();
+        EXPECT_EQ(20000, readLines(path).size());
+        EXPECT_EQ(0, file.dropped());
+
+        backend.process(makeRecord("last"));
+    }
+
+    // Destruction writes anything still buffered
+    auto lines = readLines(path);
+    ASSERT_EQ(20001, lines.size());
+    EXPECT_EQ("[INFO] last", lines.back());
+}
+
+TEST(BesLogTest, FileBackendRotatesBySize)
+{
+    auto path = tempPath("bes_file_rotate.log");
+
+    FileLogRotation rotation;
+    rotation.max_bytes = 1000;
+    rotation.keep = 2;
+
+    FileLogBackend file(path, LogFormat::MSG_ONLY, rotation);
+    LogBackend& backend = file;
+
+    // Each flush writes ~600 bytes, so every second flush rotates
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < 20; ++i) {
+            backend.process(makeRecord("round " + std::to_string(round) + " ...................."));
+        }
+        backend.flush();
+    }
+
+    auto live = readLines(path);
+    auto first = readLines(path + ".1");
+    auto second = readLines(path + ".2");
+
+    ASSERT_EQ(20, live.size());
+    EXPECT_EQ(0u, live[0].find("round 3"));
+    ASSERT_EQ(20, first.size());
+    EXPECT_EQ(0u, first[0].find("round 2"));
+    ASSERT_EQ(20, second.size());
+    EXPECT_EQ(0u, second[0].find("round 1"));
+    EXPECT_TRUE(readLines(path + ".3").empty());
+}
+
+TEST(BesLogTest, FileBackendReopen)
+{
+    auto path = tempPath("bes_file_reopen.log");
+
+    FileLogBackend file(path, LogFormat::MSG_ONLY);
+    LogBackend& backend = file;
+
+    backend.process(makeRecord("before"));
+    backend.flush();
+
+    // Simulate logrotate moving the file away
+    std::rename(path.c_str(), (path + ".1").c_str());
+    backend.reopen();
+
+    backend.process(makeRecord("after"));
+    backend.flush();
+
+    EXPECT_EQ(std::vector<std::string>{"before"}, readLines(path + ".1"));
+    EXPECT_EQ(std::vector<std::string>{"after"}, readLines(path));
+}
@@ -0,0 +1,127 @@
+#define BES_LOG_MODULE "test.levels"
+
+#include <bes/log.h>
+#include <gtest/gtest.h>
+
+using namespace bes::log;
+
+namespace {
+
+class CountingBackend : public backend::LogBackend
+{
+   public:
+    std::vector<std::string> messages;
+
+    void process(LogRecord const& log_record) override
+    {
+        messages.push_back(log_record.message);
+    }
+};
+
+int evaluated(int& counter)
+{
+    return ++counter;
+}
+
+}  // namespace
+
+TEST(BesLogTest, DisabledStatementNotEvaluated)
+{
+    int counter = 0;
+
+    // No sink
+    BES_LOG(FATAL) << evaluated(counter);
+    EXPECT_EQ(0, counter);
+
+    LogSink sink(Severity::INFO);
+
+    // No backends
+    BES_LOG(FATAL) << evaluated(counter);
+    EXPECT_EQ(0, counter);
+
+    sink.addBackend<CountingBackend>();
+
+    BES_LOG(DEBUG) << evaluated(counter);
+    EXPECT_EQ(0, counter);
+
+    BES_LOG(INFO) << evaluated(counter);
+    EXPECT_EQ(1, counter);
+}
+
+TEST(BesLogTest, ModuleSeverity)
+{
+    auto& threshold = LogSink::moduleThreshold("test.levels");
+    EXPECT_EQ(severity_off, threshold.load());
+
+    LogSink sink(Severity::WARNING);
+    sink.addBackend<CountingBackend>();
+    EXPECT_EQ(static_cast<int>(Severity::WARNING), threshold.load());
+
+    int counter = 0;
+    BES_LOG(INFO) << evaluated(counter);
+    EXPECT_EQ(0, counter);
+
+    // Lowering this module's threshold does not affect other modules
+    sink.setModuleSeverity("test.levels", Severity::INFO);
+    EXPECT_EQ(static_cast<int>(Severity::WARNING), LogSink::moduleThreshold("test.other").load());
+
+    BES_LOG(INFO) << evaluated(counter);
+    EXPECT_EQ(1, counter);
+
+    sink.setModuleSeverity("test.levels", Severity::ERROR);
+    BES_LOG(WARNING) << evaluated(counter);
+    EXPECT_EQ(1, counter);
+
+    sink.clearModuleSeverity("test.levels");
+    BES_LOG(WARNING) << evaluated(counter);
+    EXPECT_EQ(2, counter);
+}
+
+TEST(BesLogTest, LoggerChecksSeverity)
+{
+    LogSink sink(Severity::WARNING);
+    sink.addBackend<CountingBackend>();
+
+    EXPECT_FALSE(Logger(Severity::INFO, __func__, __FILE__, __LINE__).enabled());
+    EXPECT_TRUE(Logger(Severity::WARNING, __func__, __FILE__, __LINE__).enabled());
+
+    // A module set below the global severity must still be able to log
+    sink.setModuleSeverity("test.levels", Severity::DEBUG);
+    EXPECT_TRUE(Logger(Severity::DEBUG, __func__, __FILE__, __LINE__).enabled());
+
+    sink.clearModuleSeverity("test.levels");
+    EXPECT_FALSE(Logger(Severity::DEBUG, __func__, __FILE__, __LINE__).enabled());
+}
+
+TEST(BesLogTest, ThresholdListener)
+{
+    static int calls = 0;
+    static int seen = severity_off;
+
+    LogSink::onThresholdChange([] {
+        ++calls;
+        seen = LogSink::moduleThreshold("test.levels").load();
+    });
+
+    {
+        LogSink sink(Severity::WARNING);
+        sink.addBackend<CountingBackend>();
+        EXPECT_EQ(static_cast<int>(Severity::WARNING), seen);
+
+        auto before = calls;
+        sink.setModuleSeverity("test.levels", Severity::DEBUG);
+        EXPECT_EQ(before + 1, calls);
+        EXPECT_EQ(static_cast<int>(Severity::DEBUG), seen);
+    }
+
+    // Destroying the sink turns every module off
+    EXPECT_EQ(severity_off, seen);
+}
+
+TEST(BesLogTest, ParseSeverity)
+{
+    EXPECT_EQ(Severity::TRACE, parseSeverity("trace"));
+    EXPECT_EQ(Severity::WARNING, parseSeverity("Warning"));
+    EXPECT_EQ(Severity::FATAL, parseSeverity("FATAL"));
+    EXPECT_THROW(parseSeverity("loud"), std::invalid_argument);
+}
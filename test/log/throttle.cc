@@ -0,0 +1,152 @@
+#include <bes/log.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace bes::log;
+
+namespace {
+
+struct Collector
+{
+    std::vector<std::pair<Severity, std::string>> records;
+
+    void operator()(Severity s, std::string_view msg)
+    {
+        records.emplace_back(s, std::string(msg));
+    }
+};
+
+class CapturingBackend : public backend::LogBackend
+{
+   public:
+    explicit CapturingBackend(std::vector<std::string>& messages) : messages(messages) {}
+
+    void process(LogRecord const& log_record) override
+    {
+        messages.push_back(log_record.message);
+    }
+
+   private:
+    std::vector<std::string>& messages;
+};
+
+}  // namespace
+
+TEST(BesLogThrottleTest, Dedup)
+{
+    Throttle throttle(ThrottleConfig{});
+    Collector out;
+    auto now = Throttle::clock::now();
+
+    throttle.admit(Severity::ERROR, "node down", std::ref(out), now);
+    throttle.admit(Severity::ERROR, "node down", std::ref(out), now);
+    throttle.admit(Severity::ERROR, "node down", std::ref(out), now);
+    throttle.admit(Severity::WARNING, "node down", std::ref(out), now);
+    throttle.admit(Severity::ERROR, "node up", std::ref(out), now);
+
+    ASSERT_EQ(4, out.records.size());
+    EXPECT_EQ("node down", out.records[0].second);
+    EXPECT_EQ("Last message repeated 2 times", out.records[1].second);
+    EXPECT_EQ(Severity::ERROR, out.records[1].first);
+    EXPECT_EQ(Severity::WARNING, out.records[2].first);
+    EXPECT_EQ("node down", out.records[2].second);
+    EXPECT_EQ("node up", out.records[3].second);
+}
+
+TEST(BesLogThrottleTest, RepeatReport)
+{
+    ThrottleConfig cfg;
+    cfg.repeat_report = std::chrono::seconds(10);
+    Throttle throttle(cfg);
+    Collector out;
+    auto now = Throttle::clock::now();
+
+    throttle.admit(Severity::ERROR, "timeout", std::ref(out), now);
+    for (int i = 1; i <= 20; ++i) {
+        throttle.admit(Severity::ERROR, "timeout", std::ref(out), now + std::chrono::seconds(i));
+    }
+
+    ASSERT_EQ(3, out.records.size());
+    EXPECT_EQ("Last message repeated 10 times", out.records[1].second);
+    EXPECT_EQ("Last message repeated 10 times", out.records[2].second);
+
+    throttle.drain(std::ref(out));
+    EXPECT_EQ(3, out.records.size());
+}
+
+TEST(BesLogThrottleTest, RateLimit)
+{
+    ThrottleConfig cfg;
+    cfg.rate = 10;
+    cfg.burst = 5;
+    cfg.dedup = false;
+    Throttle throttle(cfg);
+    Collector out;
+    auto now = Throttle::clock::now();
+
+    for (int i = 0; i < 20; ++i) {
+        throttle.admit(Severity::ERROR, "msg " + std::to_string(i), std::ref(out), now);
+    }
+    EXPECT_EQ(5, out.records.size());
+
+    // Half a second refills five tokens
+    now += std::chrono::milliseconds(500);
+    throttle.admit(Severity::ERROR, "after", std::ref(out), now);
+
+    ASSERT_EQ(7, out.records.size());
+    EXPECT_EQ(Severity::WARNING, out.records[5].first);
+    EXPECT_EQ("15 messages suppressed by rate limit", out.records[5].second);
+    EXPECT_EQ("after", out.records[6].second);
+
+    // Counts still pending when the flood ends are reported on drain
+    for (int i = 0; i < 10; ++i) {
+        throttle.admit(Severity::ERROR, "late " + std::to_string(i), std::ref(out), now);
+    }
+    out.records.clear();
+    throttle.drain(std::ref(out));
+    ASSERT_EQ(1, out.records.size());
+    EXPECT_EQ("6 messages suppressed by rate limit", out.records[0].second);
+}
+
+TEST(BesLogThrottleTest, SinkSource)
+{
+    std::vector<std::string> messages;
+    LogSink sink(Severity::INFO);
+    sink.addBackend<CapturingBackend>(messages);
+
+    ThrottleConfig cfg;
+    cfg.rate = 0.001;
+    cfg.burst = 2;
+    sink.setSourceThrottle("driver", cfg);
+    EXPECT_TRUE(sink.hasSourceThrottle("driver"));
+    EXPECT_FALSE(sink.hasSourceThrottle("other"));
+
+    for (int i = 0; i < 5; ++i) {
+        BES_LOG_SOURCE(ERROR, "driver") << "connection refused";
+    }
+    for (int i = 0; i < 5; ++i) {
+        BES_LOG_SOURCE(ERROR, "driver") << "flood " << i;
+    }
+
+    // Unthrottled sources and plain statements pass straight through
+    for (int i = 0; i < 3; ++i) {
+        BES_LOG_SOURCE(ERROR, "other") << "same";
+        BES_LOG(ERROR) << "same";
+    }
+
+    ASSERT_EQ(9, messages.size());
+    EXPECT_EQ("connection refused", messages[0]);
+    EXPECT_EQ("Last message repeated 4 times", messages[1]);
+    EXPECT_EQ("flood 0", messages[2]);
+
+    sink.flush();
+    ASSERT_EQ(10, messages.size());
+    EXPECT_EQ("driver: 4 messages suppressed by rate limit", messages[9]);
+
+    sink.clearSourceThrottle("driver");
+    BES_LOG_SOURCE(ERROR, "driver") << "flood 0";
+    BES_LOG_SOURCE(ERROR, "driver") << "flood 0";
+    EXPECT_EQ(12, messages.size());
+}
@@ -60,6 +60,32 @@ class bes::templating::data::StandardShell<std::shared_ptr<Document>> : public b
     std::vector<std::string>::iterator it;
 };
 
+struct Badge
+{
+    std::string label;
+    int count = 0;
+};
+
+/**
+ * A shell written against the old interface, overriding only the std::ostringstream form of render().
+ */
+template <>
+class bes::templating::data::StandardShell<Badge> : public bes::templating::data::ShellInterface
+{
+   public:
+    explicit StandardShell(Badge item) : item(std::move(item)) {}
+
+    void render(std::ostringstream& str) const override
+    {
+        str << item.label << " (";
+        StandardShell<int>(item.count).render(str);
+        str << ")";
+    }
+
+   protected:
+    Badge item;
+};
+
 TEST(TemplatingRenderTest, BasicRender)
 {
     auto doc = std::make_shared<Document>("Sample App", "   Hello World   ");
@@ -111,3 +137,45 @@ TEST(TemplatingRenderTest, BasicRender)
         EXPECT_EQ(buffer.str(), engine.render("sample", ctx.getContext()));
     }
 }
+
+TEST(TemplatingRenderTest, Conditionals)
+{
+    bes::templating::Engine engine;
+    bes::templating::data::ContextBuilder ctx;
+
+    engine.loadString("cmp",
+                      "{% if count == 3 %}a{% endif %}"
+                      "{% if count != 3 %}b{% endif %}"
+                      "{% if ratio == 0.5 %}c{% endif %}"
+                      "{% if count == ratio %}d{% endif %}"
+                      "{% if name == \"fox\" %}e{% endif %}"
+                      "{% if name != count %}f{% endif %}"
+                      "{% if count > 2 %}g{% endif %}"
+                      "{% if count < ratio %}h{% endif %}");
+
+    ctx.set("count", 3);
+    ctx.set("ratio", 0.5);
+    ctx.set("name", std::string("fox"));
+    EXPECT_EQ("acefg", engine.render("cmp", ctx.getContext()));
+
+    // Mismatched types compare as rendered strings for equality, but have no ordering
+    ctx.set("name", std::string("3"));
+    EXPECT_EQ("acg", engine.render("cmp", ctx.getContext()));
+
+    engine.loadString("order", "{% if name < count %}x{% endif %}");
+    EXPECT_THROW(engine.render("order", ctx.getContext()), bes::templating::TemplateException);
+}
+
+TEST(TemplatingRenderTest, LegacyShellRender)
+{
+    bes::templating::Engine engine;
+    bes::templating::data::ContextBuilder ctx;
+
+    engine.loadString("badge", "<b>{{ badge }}</b>");
+    ctx.set("badge", Badge{"Inbox", 3});
+    EXPECT_EQ("<b>Inbox (3)</b>", engine.render("badge", ctx.getContext()));
+
+    // A shell overriding neither form still isn't renderable
+    std::ostringstream str;
+    EXPECT_THROW(bes::templating::data::ShellInterface().render(str), bes::templating::UnknownTypeException);
+}
@@ -1,8 +1,11 @@
 #include <bes/web.redis.h>
 #include <gtest/gtest.h>
 
+#include <thread>
 #include <vector>
 
+#include "../web/fake_request.h"
+
 TEST(SessionTest, RedisSessionTest)
 {
     bes::web::RedisSessionMgr mgr(bes::net::Address("127.0.0.1", 6379));
@@ -42,3 +45,164 @@ TEST(SessionTest, RedisSessionTest)
     EXPECT_FALSE(session3.getBool("bool-f"));
     EXPECT_TRUE(session3.getBool("bool-t"));
 }
+
+TEST(SessionTest, RedisSessionDeltaTest)
+{
+    bes::web::RedisSessionMgr mgr(bes::net::Address("127.0.0.1", 6379));
+    mgr.setSessionTtl(60);
+    mgr.setRefreshWindow(30);
+
+    auto session = mgr.createSession("S");
+    session.setValue("keep", "kept");
+    session.setValue("change", int64_t(1));
+    session.setValue("remove", true);
+    mgr.persistSession(session);
+
+    auto loaded = mgr.getSession(session.sessionId());
+    EXPECT_FALSE(loaded.isModified());
+    ASSERT_TRUE(loaded.expires().has_value());
+
+    // Only the changed and removed fields are written
+    loaded.setValue("change", int64_t(2));
+    loaded.removeValue("remove");
+    mgr.persistSession(loaded);
+
+    auto reloaded = mgr.getSession(session.sessionId());
+    ASSERT_EQ(2, reloaded.size());
+    EXPECT_EQ("kept", reloaded.getString("keep"));
+    EXPECT_EQ(2, reloaded.getInt("change"));
+    EXPECT_FALSE(reloaded.hasItem("remove"));
+
+    // Unmodified and refreshed within the window, nothing to write
+    mgr.persistSession(reloaded);
+}
+
+TEST(SessionTest, RedisSessionCreateTest)
+{
+    bes::web::RedisSessionMgr mgr(bes::net::Address("127.0.0.1", 6379));
+    mgr.setSessionTtl(60);
+
+    // Nothing is written until the session is persisted, and an empty session still exists once it is
+    auto session = mgr.createSession("S");
+    EXPECT_THROW((void)mgr.getSession(session.sessionId()), bes::web::SessionNotExistsException);
+
+    mgr.persistSession(session);
+    auto loaded = mgr.getSession(session.sessionId());
+    EXPECT_TRUE(loaded.empty());
+    EXPECT_TRUE(loaded.expires().has_value());
+
+    // A new session may never overwrite an existing one
+    bes::web::Session duplicate(session.sessionId());
+    duplicate.setValue("stolen", true);
+    EXPECT_THROW(mgr.persistSession(duplicate), bes::web::SessionCollisionException);
+    EXPECT_FALSE(mgr.getSession(session.sessionId()).hasItem("stolen"));
+}
+
+TEST(SessionTest, RedisSessionFormatTest)
+{
+    bes::web::RedisSessionMgr hash_mgr(bes::net::Address("127.0.0.1", 6379));
+    bes::web::RedisSessionMgr binary_mgr(bes::net::Address("127.0.0.1", 6379));
+    hash_mgr.setSessionTtl(60);
+    binary_mgr.setSessionTtl(60);
+    binary_mgr.setFormat(bes::web::RedisSessionFormat::BINARY);
+
+    auto session = binary_mgr.createSession("S");
+    session.setValue("str", "Hello World");
+    session.setValue("int", int64_t(1213));
+    binary_mgr.persistSession(session);
+
+    auto loaded = binary_mgr.getSession(session.sessionId());
+    EXPECT_EQ("Hello World", loaded.getString("str"));
+    EXPECT_TRUE(loaded.expires().has_value());
+
+    // Either manager reads the other's format, and writing a change converts it
+    auto from_hash = hash_mgr.getSession(session.sessionId());
+    EXPECT_EQ(1213, from_hash.getInt("int"));
+    from_hash.setValue("int", int64_t(1214));
+    hash_mgr.persistSession(from_hash);
+
+    auto converted = binary_mgr.getSession(session.sessionId());
+    EXPECT_EQ(1214, converted.getInt("int"));
+    EXPECT_EQ("Hello World", converted.getString("str"));
+
+    // A TTL refresh of the binary format only patches its header
+    auto binary = binary_mgr.createSession("S");
+    binary.setValue("bool", true);
+    binary_mgr.persistSession(binary);
+    auto unmodified = binary_mgr.getSession(binary.sessionId());
+    binary_mgr.persistSession(unmodified);
+    EXPECT_TRUE(binary_mgr.getSession(binary.sessionId()).getBool("bool"));
+}
+
+TEST(SessionTest, RedisSessionPoolTest)
+{
+    bes::web::RedisSessionMgr mgr(bes::net::Address("127.0.0.1", 6379), 250, 4);
+    mgr.setSessionTtl(60);
+    EXPECT_EQ(4, mgr.connectionPool().size());
+    EXPECT_EQ(1, mgr.connectionPool().connected());
+
+    // Each thread works on its own session, replies must not cross between them
+    std::vector<std::thread> threads;
+    std::vector<char> ok(16, 0);
+    for (std::size_t i = 0; i < ok.size(); ++i) {
+        threads.emplace_back([&mgr, &ok, i] {
+            bool good = true;
+            for (int64_t n = 0; n < 20; ++n) {
+                auto session = mgr.createSession("P");
+                session.setValue("thread", int64_t(i));
+                session.setValue("n", n);
+                mgr.persistSession(session);
+
+                auto loaded = mgr.getSession(session.sessionId());
+                good = good && loaded.getInt("thread") == int64_t(i) && loaded.getInt("n") == n;
+            }
+            ok[i] = good;
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (char thread_ok : ok) {
+        EXPECT_TRUE(thread_ok);
+    }
+
+    EXPECT_LE(mgr.connectionPool().connected(), 4);
+}
+
+TEST(SessionTest, RedisSessionPoolExhaustedTest)
+{
+    // Gives the test a lease of its own on the manager's only connection
+    struct LeasingSessionMgr : bes::web::RedisSessionMgr
+    {
+        using RedisSessionMgr::RedisSessionMgr;
+
+        bes::web::RedisConnectionPool::Lease lease()
+        {
+            return pool->checkout();
+        }
+    };
+
+    auto mgr = std::make_shared<LeasingSessionMgr>(bes::net::Address("127.0.0.1", 6379), 250, 1);
+    mgr->setSessionTtl(60);
+
+    bes::Container container;
+    container.add<bes::web::SessionInterface>(bes::web::SVC_SESSION_MGR, mgr);
+    container.emplace<std::string>(bes::web::SESSION_PREFIX_KEY, bes::web::SESSION_DEFAULT_PREFIX);
+    container.emplace<std::string>(bes::web::SESSION_COOKIE_KEY, bes::web::SESSION_DEFAULT_COOKIE);
+
+    std::string session_id;
+
+    {
+        auto held = mgr->lease();
+
+        // Persisting times out waiting for a connection as the request is destroyed, which mustn't terminate us
+        bes::web::test::FakeRequest base(container, "/");
+        bes::web::HttpRequest request(base);
+        request.getSession().setValue("user", "bob");
+        session_id = request.sessionId();
+    }
+
+    EXPECT_THROW((void)mgr->getSession(session_id), bes::web::SessionNotExistsException);
+}
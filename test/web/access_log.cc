@@ -0,0 +1,161 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::string tmpPath(std::string const& name)
+{
+    return "/tmp/bes_test_" + name + "_" + std::to_string(::getpid()) + ".log";
+}
+
+std::vector<std::string> readLines(std::string const& path)
+{
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(in, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+}  // namespace
+
+TEST(AccessLogTest, Format)
+{
+    bes::web::AccessRecord rec;
+    rec.timestamp = 1600000000123456789;
+    rec.bytes = 1024;
+    rec.parse_us = 1;
+    rec.handle_us = 20;
+    rec.render_us = 3;
+    rec.total_us = 24;
+    rec.status = 200;
+    rec.sample_rate = 10;
+    rec.setMethod("GET");
+    rec.setRoute("home");
+    rec.setUri("/search?q=\"x\"\\\n");
+
+    std::string out;
+    bes::web::AccessLog::format(out, rec);
+
+    EXPECT_EQ(
+        "{\"ts\":\"2020-09-13T12:26:40.123456Z\",\"method\":\"GET\",\"route\":\"home\","
+        "\"uri\":\"/search?q=\\\"x\\\"\\\\\\u000a\",\"status\":200,\"bytes\":1024,\"parse_us\":1,\"handle_us\":20,"
+        "\"render_us\":3,\"total_us\":24,\"sample\":10}\n",
+        out);
+}
+
+TEST(AccessLogTest, Truncation)
+{
+    bes::web::AccessRecord rec;
+    rec.setRoute(std::string(100, 'r'));
+    EXPECT_EQ(sizeof(rec.route) - 1, std::string(rec.route).size());
+
+    // A multi-byte character straddling the limit is dropped whole
+    rec.setRoute(std::string(sizeof(rec.route) - 2, 'r') + "\xc3\xa9");
+    EXPECT_EQ(sizeof(rec.route) - 2, std::string(rec.route).size());
+}
+
+TEST(AccessLogTest, Sampling)
+{
+    auto path = tmpPath("access_sampling");
+
+    bes::web::AccessLogSampling sampling;
+    sampling.success_rate = 4;
+    sampling.client_error_rate = 0;
+    sampling.slow_threshold = std::chrono::milliseconds(100);
+
+    bes::web::AccessLog log(path, sampling);
+
+    int logged = 0;
+    for (int i = 0; i < 100; ++i) {
+        auto rate = log.sample(200, std::chrono::microseconds(50));
+        if (rate) {
+            EXPECT_EQ(4, rate);
+            ++logged;
+        }
+    }
+    EXPECT_EQ(25, logged);
+
+    EXPECT_EQ(0, log.sample(404, std::chrono::microseconds(50)));
+    EXPECT_EQ(1, log.sample(500, std::chrono::microseconds(50)));
+    EXPECT_EQ(1, log.sample(503, std::chrono::microseconds(50)));
+    EXPECT_EQ(1, log.sample(404, std::chrono::milliseconds(150)));
+
+    std::remove(path.c_str());
+}
+
+TEST(AccessLogTest, Write)
+{
+    auto path = tmpPath("access_write");
+    std::remove(path.c_str());
+
+    {
+        bes::web::AccessLog log(path);
+
+        auto worker = [&log](int id) {
+            for (int i = 0; i < 100; ++i) {
+                bes::web::AccessRecord rec;
+                rec.status = 200;
+                rec.setMethod("GET");
+                rec.setRoute("t" + std::to_string(id));
+                rec.setUri("/" + std::to_string(i));
+                log.record(rec);
+            }
+        };
+
+        std::thread a(worker, 1);
+        std::thread b(worker, 2);
+        a.join();
+        b.join();
+
+        log.flush();
+        EXPECT_EQ(200, readLines(path).size());
+        EXPECT_EQ(0, log.dropped());
+
+        // Simulate logrotate moving the file away
+        auto moved = path + ".1";
+        std::rename(path.c_str(), moved.c_str());
+        log.flush();
+
+        bes::web::AccessRecord rec;
+        rec.status = 500;
+        log.record(rec);
+        log.flush();
+
+        EXPECT_EQ(200, readLines(moved).size());
+        std::remove(moved.c_str());
+    }
+
+    auto lines = readLines(path);
+    ASSERT_EQ(1, lines.size());
+    EXPECT_NE(std::string::npos, lines[0].find("\"status\":500"));
+
+    std::remove(path.c_str());
+}
+
+TEST(AccessLogTest, Overflow)
+{
+    auto path = tmpPath("access_overflow");
+
+    {
+        bes::web::AccessLog log(path, {}, 64);
+
+        bes::web::AccessRecord rec;
+        for (int i = 0; i < 1000; ++i) {
+            log.record(rec);
+        }
+
+        log.flush();
+        EXPECT_EQ(1000, readLines(path).size() + log.dropped());
+    }
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,60 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+using bes::web::BinarySessionCodec;
+
+TEST(SessionCodecTest, RoundTripTest)
+{
+    bes::web::Session session("S0123");
+    session.setValue("str", "Hello World");
+    session.setValue("empty", "");
+    session.setValue("binary", std::string("a\0b", 3));
+    session.setValue("int", int64_t(-1213));
+    session.setValue("float", 12.345);
+    session.setValue("bool-f", false);
+    session.setValue("bool-t", true);
+
+    auto blob = BinarySessionCodec::encode(session, 1700000000);
+    ASSERT_TRUE(BinarySessionCodec::isEncoded(blob));
+    EXPECT_EQ(1700000000, BinarySessionCodec::refreshed(blob));
+
+    auto decoded = BinarySessionCodec::decode("S0123", blob);
+    EXPECT_EQ("S0123", decoded.sessionId());
+    EXPECT_FALSE(decoded.isModified());
+    ASSERT_EQ(7, decoded.size());
+    EXPECT_EQ("Hello World", decoded.getString("str"));
+    EXPECT_EQ("", decoded.getString("empty"));
+    EXPECT_EQ(std::string("a\0b", 3), decoded.getString("binary"));
+    EXPECT_EQ(-1213, decoded.getInt("int"));
+    EXPECT_EQ(12.345, decoded.getDouble("float"));
+    EXPECT_FALSE(decoded.getBool("bool-f"));
+    EXPECT_TRUE(decoded.getBool("bool-t"));
+
+    // Patching the refreshed time in place, as SETRANGE does
+    blob.replace(BinarySessionCodec::REFRESHED_OFFSET, BinarySessionCodec::REFRESHED_SIZE,
+                 BinarySessionCodec::encodeRefreshed(1700000060));
+    EXPECT_EQ(1700000060, BinarySessionCodec::refreshed(blob));
+    EXPECT_EQ(7, BinarySessionCodec::decode("S0123", blob).size());
+}
+
+TEST(SessionCodecTest, MalformedTest)
+{
+    bes::web::Session session("S0123");
+    session.setValue("str", "Hello World");
+    auto blob = BinarySessionCodec::encode(session, 0);
+
+    // Truncated anywhere
+    for (std::size_t len = 0; len < blob.size(); ++len) {
+        EXPECT_THROW((void)BinarySessionCodec::decode("S0123", blob.substr(0, len)),
+                     bes::web::SessionCodecException);
+    }
+
+    // Unknown version, and a hash-format value
+    auto future = blob;
+    future[1] = static_cast<char>(BinarySessionCodec::VERSION + 1);
+    EXPECT_FALSE(BinarySessionCodec::isEncoded(future));
+    EXPECT_THROW((void)BinarySessionCodec::decode("S0123", future), bes::web::SessionCodecException);
+    EXPECT_FALSE(BinarySessionCodec::isEncoded("SHello World"));
+}
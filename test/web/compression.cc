@@ -0,0 +1,105 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <string>
+
+using namespace bes::web;
+
+namespace {
+
+/**
+ * Inflate a gzip or zlib stream, detecting which from its header.
+ */
+std::string inflateBody(std::string const& data)
+{
+    z_stream stream{};
+    EXPECT_EQ(Z_OK, inflateInit2(&stream, 15 + 32));
+
+    std::string out(64 * 1024, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+
+    EXPECT_EQ(Z_STREAM_END, inflate(&stream, Z_FINISH));
+    out.resize(stream.total_out);
+    inflateEnd(&stream);
+
+    return out;
+}
+
+std::string page()
+{
+    std::string s;
+    while (s.size() < 8 * 1024) {
+        s += "<li><a href=\"/articles/1234\">A headline for the article</a></li>\n";
+    }
+
+    return s;
+}
+
+}  // namespace
+
+TEST(CompressionTest, Negotiate)
+{
+    EXPECT_EQ(ContentEncoding::IDENTITY, negotiateEncoding(""));
+    EXPECT_EQ(ContentEncoding::IDENTITY, negotiateEncoding("br, identity"));
+    EXPECT_EQ(ContentEncoding::GZIP, negotiateEncoding("gzip, deflate, br"));
+    EXPECT_EQ(ContentEncoding::GZIP, negotiateEncoding("deflate, GZIP"));
+    EXPECT_EQ(ContentEncoding::GZIP, negotiateEncoding("x-gzip"));
+    EXPECT_EQ(ContentEncoding::DEFLATE, negotiateEncoding("deflate"));
+    EXPECT_EQ(ContentEncoding::DEFLATE, negotiateEncoding("gzip;q=0.5, deflate"));
+    EXPECT_EQ(ContentEncoding::GZIP, negotiateEncoding("gzip ; q=0.8, deflate;q=0.2"));
+    EXPECT_EQ(ContentEncoding::IDENTITY, negotiateEncoding("gzip;q=0, deflate;q=0.000"));
+    EXPECT_EQ(ContentEncoding::GZIP, negotiateEncoding("*"));
+    EXPECT_EQ(ContentEncoding::DEFLATE, negotiateEncoding("*;q=0.5, gzip;q=0"));
+    EXPECT_EQ(ContentEncoding::IDENTITY, negotiateEncoding("*;q=0"));
+}
+
+TEST(CompressionTest, CompressibleType)
+{
+    EXPECT_TRUE(compressibleType("text/html"));
+    EXPECT_TRUE(compressibleType("text/html; charset=utf-8"));
+    EXPECT_TRUE(compressibleType("application/json"));
+    EXPECT_TRUE(compressibleType("application/ld+json"));
+    EXPECT_TRUE(compressibleType("application/javascript"));
+    EXPECT_TRUE(compressibleType("image/svg+xml"));
+    EXPECT_FALSE(compressibleType("image/png"));
+    EXPECT_FALSE(compressibleType("application/octet-stream"));
+    EXPECT_FALSE(compressibleType("application/zip"));
+    EXPECT_FALSE(compressibleType(""));
+}
+
+TEST(CompressionTest, RoundTrip)
+{
+    auto const body = page();
+
+    for (auto encoding : {ContentEncoding::GZIP, ContentEncoding::DEFLATE}) {
+        for (int level : {1, 6, 9}) {
+            auto compressed = compress(body, encoding, level);
+            EXPECT_LT(compressed.size(), body.size() / 4);
+            EXPECT_EQ(body, inflateBody(compressed));
+        }
+    }
+
+    // The thread's stream is reused, a second body mustn't carry state from the first
+    EXPECT_EQ("hello", inflateBody(compress("hello", ContentEncoding::GZIP, 6)));
+
+    // gzip and zlib framing
+    auto gzip = compress(body, ContentEncoding::GZIP, 6);
+    EXPECT_EQ('\x1f', gzip[0]);
+    EXPECT_EQ('\x8b', gzip[1]);
+    EXPECT_EQ('\x78', compress(body, ContentEncoding::DEFLATE, 6)[0]);
+
+    EXPECT_EQ(body, compress(body, ContentEncoding::IDENTITY, 6));
+    EXPECT_THROW((void)compress(body, ContentEncoding::GZIP, 0), WebException);
+}
+
+TEST(CompressionTest, EncodedETag)
+{
+    EXPECT_EQ("\"0123456789abcdef-gzip\"", encodedETag("\"0123456789abcdef\"", ContentEncoding::GZIP));
+    EXPECT_EQ("W/\"v1-deflate\"", encodedETag("W/\"v1\"", ContentEncoding::DEFLATE));
+    EXPECT_EQ("\"0123456789abcdef\"", encodedETag("\"0123456789abcdef\"", ContentEncoding::IDENTITY));
+    EXPECT_EQ("", encodedETag("", ContentEncoding::GZIP));
+}
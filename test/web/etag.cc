@@ -0,0 +1,48 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace bes::web;
+
+TEST(ETagTest, ContentHash)
+{
+    EXPECT_EQ(contentHash("hello world"), contentHash("hello world"));
+    EXPECT_NE(contentHash("hello world"), contentHash("hello worle"));
+    EXPECT_NE(contentHash(""), contentHash(std::string(1, '\0')));
+    EXPECT_NE(contentHash("hello world", 1), contentHash("hello world", 2));
+
+    // Every tail length, and bytes with the high bit set
+    std::string s;
+    for (int i = 0; i < 17; ++i) {
+        auto before = contentHash(s);
+        s += static_cast<char>(0x80 + i);
+        EXPECT_NE(before, contentHash(s));
+    }
+}
+
+TEST(ETagTest, StrongETag)
+{
+    auto tag = strongETag("<html></html>");
+    ASSERT_EQ(18, tag.size());
+    EXPECT_EQ('"', tag.front());
+    EXPECT_EQ('"', tag.back());
+    EXPECT_EQ(std::string::npos, tag.substr(1, 16).find_first_not_of("0123456789abcdef"));
+    EXPECT_EQ(tag, strongETag("<html></html>"));
+    EXPECT_NE(tag, strongETag("<html> </html>"));
+}
+
+TEST(ETagTest, Matches)
+{
+    EXPECT_TRUE(etagMatches("\"abc\"", "\"abc\""));
+    EXPECT_FALSE(etagMatches("\"abc\"", "\"abd\""));
+    EXPECT_FALSE(etagMatches("", "\"abc\""));
+
+    // Lists, whitespace and weak comparison
+    EXPECT_TRUE(etagMatches("\"x\", \"abc\"", "\"abc\""));
+    EXPECT_TRUE(etagMatches("\"x\",\t\"y\" ,W/\"abc\"", "\"abc\""));
+    EXPECT_TRUE(etagMatches("\"abc\"", "W/\"abc\""));
+    EXPECT_FALSE(etagMatches("\"x\", \"y\"", "\"abc\""));
+
+    EXPECT_TRUE(etagMatches("*", "\"abc\""));
+}
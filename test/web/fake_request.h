@@ -0,0 +1,74 @@
+#pragma once
+
+#include <bes/web.h>
+
+#include <string>
+
+namespace bes::web::test {
+
+/**
+ * An unconnected socket for a FakeRequest to hold; the request is never read from it.
+ */
+struct FakeTransport
+{
+    bes::net::socket::Stream socket;
+    bes::fastcgi::Transceiver transceiver{socket};
+};
+
+/**
+ * A FastCGI GET request with its params set directly, rather than read from a socket.
+ */
+class FakeRequest : private FakeTransport, public bes::fastcgi::Request
+{
+   public:
+    FakeRequest(bes::Container const& container, std::string const& uri, std::string const& query = std::string())
+        : bes::fastcgi::Request(FakeTransport::transceiver, container)
+    {
+        params[Http::Parameter::REQUEST_METHOD] = "GET";
+        params[Http::Parameter::DOCUMENT_URI] = uri;
+        params[Http::Parameter::QUERY_STRING] = query;
+    }
+
+    void setParam(std::string const& key, std::string const& value)
+    {
+        params[key] = value;
+    }
+
+    bes::fastcgi::Transceiver& fakeTransceiver()
+    {
+        return FakeTransport::transceiver;
+    }
+};
+
+/**
+ * A WebResponder that renders a response into its output buffer and hands it back, rather than sending it.
+ */
+class FakeResponder : public WebResponder
+{
+   public:
+    explicit FakeResponder(FakeRequest& request) : WebResponder(request, request.fakeTransceiver()) {}
+
+    std::string render(HttpResponse& resp, HttpRequest const& req)
+    {
+        out_buffer.clear();
+        renderResponse(resp, req);
+        return out_buffer.str();
+    }
+};
+
+/**
+ * A container holding the services every HttpRequest looks up, with no session manager.
+ */
+inline bes::Container const& requestContainer()
+{
+    static bes::Container container;
+    static bool initialised = [] {
+        container.add<SessionInterface>(SVC_SESSION_MGR, nullptr);
+        return true;
+    }();
+
+    (void)initialised;
+    return container;
+}
+
+}  // namespace bes::web::test
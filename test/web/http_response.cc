@@ -0,0 +1,56 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+using bes::web::HeaderList;
+using bes::web::HeaderName;
+
+TEST(HttpResponseTest, HeaderListTest)
+{
+    HeaderList headers;
+    headers.set("Content-Type", "text/html");
+    headers.set("X-Frame-Options", "DENY");
+    headers.set("Status", "200");
+
+    // Names are matched regardless of case, and keep the position they were first set in
+    headers.set("content-type", "application/json");
+    headers.set("x-frame-options", "SAMEORIGIN");
+    ASSERT_EQ(3, headers.size());
+    EXPECT_EQ("application/json", headers.at("Content-Type"));
+    EXPECT_EQ("application/json", *headers.get(HeaderName::CONTENT_TYPE));
+    EXPECT_EQ("SAMEORIGIN", headers.at("X-Frame-Options"));
+    EXPECT_EQ(nullptr, headers.get("ETag"));
+    EXPECT_THROW((void)headers.at("ETag"), std::out_of_range);
+
+    // Common names are interned and written in their canonical spelling
+    EXPECT_EQ(HeaderName::CONTENT_TYPE, headers.begin()->id());
+    EXPECT_EQ(HeaderName::OTHER, HeaderList::intern("X-Frame-Options"));
+
+    std::string out;
+    headers.serialise(out);
+    EXPECT_EQ("Content-Type: application/json\nX-Frame-Options: SAMEORIGIN\nStatus: 200\n", out);
+}
+
+TEST(HttpResponseTest, CookieTest)
+{
+    auto resp = bes::web::HttpResponse::ok();
+    resp.setCookie(bes::web::Cookie("a", "1"));
+    resp.setCookie(bes::web::Cookie("b", "2"));
+    resp.setCookie(bes::web::Cookie("a", "3"));
+
+    ASSERT_EQ(2, resp.cookies().size());
+    EXPECT_EQ("a", resp.cookies()[0].getName());
+    EXPECT_EQ("3", resp.cookies()[0].getValue());
+}
+
+TEST(HttpResponseTest, HttpDateTest)
+{
+    auto when = std::chrono::system_clock::from_time_t(784111777);
+    EXPECT_EQ("Sun, 06 Nov 1994 08:49:37 GMT", bes::web::httpDate(when));
+
+    // Anywhere in the same second gives the same date
+    EXPECT_EQ("Sun, 06 Nov 1994 08:49:37 GMT", bes::web::httpDate(when + std::chrono::milliseconds(999)));
+    EXPECT_EQ("Sun, 06 Nov 1994 08:49:38 GMT", bes::web::httpDate(when + std::chrono::seconds(1)));
+}
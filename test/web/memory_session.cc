@@ -0,0 +1,145 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using bes::web::MemorySessionConfig;
+using bes::web::MemorySessionMgr;
+
+TEST(MemorySessionTest, PersistTest)
+{
+    MemorySessionMgr mgr;
+    mgr.setSessionTtl(60);
+
+    auto session = mgr.createSession("M");
+    EXPECT_EQ('M', session.sessionId()[0]);
+    EXPECT_THROW((void)mgr.getSession(session.sessionId()), bes::web::SessionNotExistsException);
+
+    session.setValue("keep", "kept");
+    session.setValue("count", int64_t(1));
+    mgr.persistSession(session);
+
+    // A new session can't take over a live one
+    EXPECT_THROW(mgr.persistSession(session), bes::web::SessionCollisionException);
+
+    // Two requests changing different values of the same session both land
+    auto first = mgr.getSession(session.sessionId());
+    auto second = mgr.getSession(session.sessionId());
+    EXPECT_FALSE(first.isModified());
+    first.setValue("count", int64_t(2));
+    second.setValue("flag", true);
+    second.removeValue("keep");
+    mgr.persistSession(first);
+    mgr.persistSession(second);
+
+    auto loaded = mgr.getSession(session.sessionId());
+    ASSERT_EQ(2, loaded.size());
+    EXPECT_EQ(2, loaded.getInt("count"));
+    EXPECT_TRUE(loaded.getBool("flag"));
+    EXPECT_EQ(1, mgr.stats().entries);
+}
+
+TEST(MemorySessionTest, ExpiryTest)
+{
+    MemorySessionConfig config;
+    config.sweep_interval = std::chrono::milliseconds(10);
+    MemorySessionMgr mgr(config);
+    mgr.setSessionTtl(1);
+
+    auto expiring = mgr.createSession("M");
+    mgr.persistSession(expiring);
+
+    mgr.setSessionTtl(0);
+    auto permanent = mgr.createSession("M");
+    mgr.persistSession(permanent);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+
+    EXPECT_THROW((void)mgr.getSession(expiring.sessionId()), bes::web::SessionNotExistsException);
+    EXPECT_NO_THROW((void)mgr.getSession(permanent.sessionId()));
+
+    auto stats = mgr.stats();
+    EXPECT_EQ(1, stats.entries);
+    EXPECT_EQ(1, stats.expired);
+
+    EXPECT_FALSE(mgr.touchSession(expiring.sessionId()));
+    EXPECT_TRUE(mgr.touchSession(permanent.sessionId()));
+}
+
+TEST(MemorySessionTest, TouchTest)
+{
+    MemorySessionMgr mgr;
+    mgr.setSessionTtl(1);
+
+    auto session = mgr.createSession("M");
+    mgr.persistSession(session);
+
+    // Touched before it runs out, the TTL starts again without the session being read
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    EXPECT_TRUE(mgr.touchSession(session.sessionId()));
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+    EXPECT_NO_THROW((void)mgr.getSession(session.sessionId()));
+}
+
+TEST(MemorySessionTest, BudgetTest)
+{
+    MemorySessionConfig config;
+    config.shards = 1;
+    config.byte_budget = 8 * 1024;
+    MemorySessionMgr mgr(config);
+
+    std::vector<std::string> ids;
+    for (int i = 0; i < 100; ++i) {
+        auto session = mgr.createSession("M");
+        session.setValue("payload", std::string(100, 'x'));
+        mgr.persistSession(session);
+        ids.push_back(session.sessionId());
+
+        // Keep the first session in use, so it is never the least recently used
+        (void)mgr.getSession(ids.front());
+    }
+
+    auto stats = mgr.stats();
+    EXPECT_LE(stats.bytes, config.byte_budget);
+    EXPECT_LT(stats.entries, 100);
+    EXPECT_EQ(100, stats.entries + stats.evictions);
+
+    EXPECT_NO_THROW((void)mgr.getSession(ids.front()));
+    EXPECT_NO_THROW((void)mgr.getSession(ids.back()));
+    EXPECT_THROW((void)mgr.getSession(ids[1]), bes::web::SessionNotExistsException);
+}
+
+TEST(MemorySessionTest, SnapshotTest)
+{
+    auto path = testing::TempDir() + "bes_memory_sessions";
+    std::remove(path.c_str());
+
+    MemorySessionConfig config;
+    config.snapshot_path = path;
+    std::string id;
+
+    {
+        MemorySessionMgr mgr(config);
+        mgr.setSessionTtl(60);
+
+        auto session = mgr.createSession("M");
+        session.setValue("str", "Hello World");
+        session.setValue("float", 12.345);
+        mgr.persistSession(session);
+        id = session.sessionId();
+
+        mgr.flush();
+    }
+
+    MemorySessionMgr restored(config);
+    auto session = restored.getSession(id);
+    EXPECT_EQ("Hello World", session.getString("str"));
+    EXPECT_EQ(12.345, session.getDouble("float"));
+    EXPECT_FALSE(session.isModified());
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,81 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace bes::web;
+
+namespace {
+
+bool pointsInto(std::string_view view, std::string const& source)
+{
+    return view.data() >= source.data() && view.data() + view.size() <= source.data() + source.size();
+}
+
+}  // namespace
+
+TEST(ParamListTest, FindAnyOf)
+{
+    // Every position across and after the first 16 byte block, to cover both the vector and scalar paths
+    for (std::size_t len = 1; len < 40; ++len) {
+        for (std::size_t at = 0; at < len; ++at) {
+            std::string s(len, 'x');
+            s[at] = '&';
+            EXPECT_EQ(at, findAnyOf(s, 0, '&', '=', '%', '+'));
+            EXPECT_EQ(at, findAnyOf(s, at, '&', '=', '%', '+'));
+            EXPECT_EQ(std::string_view::npos, findAnyOf(s, at + 1, '&', '=', '%', '+'));
+        }
+    }
+
+    EXPECT_EQ(std::string_view::npos, findAnyOf("", 0, '&', '&', '&', '&'));
+    EXPECT_EQ(3, findAnyOf("abc+def=", 0, '&', '=', '%', '+'));
+}
+
+TEST(ParamListTest, Query)
+{
+    std::string const qs = "page=2&sort=date-desc&q=hello+world%21&flag&=orphan&a=1=2&page=3&&%61b=c";
+
+    ParamList params;
+    params.parseQuery(qs);
+
+    EXPECT_EQ(7, params.size());
+    EXPECT_EQ("3", params.find("page"));
+    EXPECT_EQ("date-desc", params.find("sort"));
+    EXPECT_EQ("hello world!", params.find("q"));
+    EXPECT_EQ("", params.find("flag"));
+    EXPECT_EQ("1=2", params.find("a"));
+    EXPECT_EQ("c", params.find("ab"));
+    EXPECT_FALSE(params.find("orphan"));
+    EXPECT_FALSE(params.find(""));
+
+    // Values without escapes are views into the source, not copies
+    EXPECT_TRUE(pointsInto(*params.find("sort"), qs));
+    EXPECT_FALSE(pointsInto(*params.find("q"), qs));
+}
+
+TEST(ParamListTest, Cookies)
+{
+    std::string const header = "bsn=S0123456789abcdef; theme = dark ;empty=; =novalue;flag;last=a=b";
+
+    ParamList cookies;
+    cookies.parseCookies(header);
+
+    EXPECT_EQ(3, cookies.size());
+    EXPECT_EQ("S0123456789abcdef", cookies.find("bsn"));
+    EXPECT_EQ("dark", cookies.find("theme"));
+    EXPECT_EQ("a=b", cookies.find("last"));
+    EXPECT_FALSE(cookies.find("empty"));
+    EXPECT_FALSE(cookies.find("flag"));
+    EXPECT_TRUE(pointsInto(*cookies.find("bsn"), header));
+}
+
+TEST(ParamListTest, PercentDecode)
+{
+    std::string out;
+
+    percentDecode("a%2Fb+c%zz%4", out);
+    EXPECT_EQ("a/b c%zz%4", out);
+
+    percentDecode("a+b", out, false);
+    EXPECT_EQ("a+b", out);
+}
@@ -0,0 +1,117 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace bes::web;
+
+namespace {
+
+CachedResponse response(std::string const& body)
+{
+    return CachedResponse{"Status: 200\n", body};
+}
+
+}  // namespace
+
+TEST(ResponseCacheTest, GetPut)
+{
+    ResponseCache cache(1024 * 1024, 4);
+    auto now = ResponseCache::clock::now();
+
+    EXPECT_EQ(nullptr, cache.get("a", now));
+
+    cache.put("a", response("alpha"), std::chrono::seconds(10), now);
+    auto entry = cache.get("a", now);
+    ASSERT_NE(nullptr, entry);
+    EXPECT_EQ("Status: 200\n", entry->headers);
+    EXPECT_EQ("alpha", entry->body);
+
+    // Replacing an entry doesn't disturb a copy already handed out
+    cache.put("a", response("beta"), std::chrono::seconds(10), now);
+    EXPECT_EQ("alpha", entry->body);
+    EXPECT_EQ("beta", cache.get("a", now)->body);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(2, stats.hits);
+    EXPECT_EQ(1, stats.misses);
+    EXPECT_EQ(2, stats.inserts);
+    EXPECT_EQ(1, stats.entries);
+
+    cache.erase("a");
+    EXPECT_EQ(nullptr, cache.get("a", now));
+}
+
+TEST(ResponseCacheTest, Expiry)
+{
+    ResponseCache cache(1024 * 1024, 1);
+    auto now = ResponseCache::clock::now();
+
+    cache.put("a", response("alpha"), std::chrono::seconds(10), now);
+    EXPECT_NE(nullptr, cache.get("a", now + std::chrono::seconds(9)));
+    EXPECT_EQ(nullptr, cache.get("a", now + std::chrono::seconds(10)));
+
+    auto stats = cache.stats();
+    EXPECT_EQ(1, stats.expirations);
+    EXPECT_EQ(0, stats.entries);
+    EXPECT_EQ(0, stats.bytes);
+
+    // A zero TTL is never stored
+    cache.put("b", response("beta"), std::chrono::seconds(0), now);
+    EXPECT_EQ(nullptr, cache.get("b", now));
+}
+
+TEST(ResponseCacheTest, LruEviction)
+{
+    // Room for three entries in a single shard
+    std::string const body(200, 'x');
+    ResponseCache cache(3 * 400, 1);
+    auto now = ResponseCache::clock::now();
+
+    cache.put("a", response(body), std::chrono::seconds(10), now);
+    cache.put("b", response(body), std::chrono::seconds(10), now);
+    cache.put("c", response(body), std::chrono::seconds(10), now);
+
+    // Touch "a" so that "b" is the least recently used
+    EXPECT_NE(nullptr, cache.get("a", now));
+    cache.put("d", response(body), std::chrono::seconds(10), now);
+
+    EXPECT_NE(nullptr, cache.get("a", now));
+    EXPECT_EQ(nullptr, cache.get("b", now));
+    EXPECT_NE(nullptr, cache.get("c", now));
+    EXPECT_NE(nullptr, cache.get("d", now));
+    EXPECT_EQ(1, cache.stats().evictions);
+
+    // Larger than the budget, not stored and nothing evicted for it
+    cache.put("e", response(std::string(2000, 'x')), std::chrono::seconds(10), now);
+    EXPECT_EQ(nullptr, cache.get("e", now));
+    EXPECT_EQ(3, cache.stats().entries);
+}
+
+TEST(ResponseCacheTest, EraseRoute)
+{
+    ResponseCache cache(1024 * 1024, 8);
+    auto now = ResponseCache::clock::now();
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < 20; ++i) {
+        keys.push_back("article\x1f" + std::to_string(i) + "\x1f");
+        cache.put(keys.back(), response("a"), std::chrono::seconds(10), now);
+    }
+    cache.put("articles\x1f", response("list"), std::chrono::seconds(10), now);
+
+    cache.eraseRoute("article");
+    EXPECT_EQ(1, cache.stats().entries);
+    EXPECT_NE(nullptr, cache.get("articles\x1f", now));
+
+    cache.clear();
+    EXPECT_EQ(0, cache.stats().entries);
+    EXPECT_EQ(0, cache.stats().bytes);
+}
+
+TEST(ResponseCacheTest, HeaderParam)
+{
+    EXPECT_EQ("HTTP_ACCEPT_LANGUAGE", RouteCache::headerParam("Accept-Language"));
+    EXPECT_EQ("HTTP_X_FORWARDED_PROTO", RouteCache::headerParam("x-forwarded-proto"));
+}
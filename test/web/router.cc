@@ -1,8 +1,11 @@
 #include <bes/web.h>
 #include <gtest/gtest.h>
 
+#include <optional>
 #include <vector>
 
+#include "fake_request.h"
+
 constexpr auto routes = R"--EOF--(---
 home:
   uri: /
@@ -18,6 +21,9 @@ page:
 
 )--EOF--";
 
+using bes::web::test::FakeRequest;
+using bes::web::test::requestContainer;
+
 TEST(WebTest, RouteGenTest)
 {
     bes::web::MappedRouter router;
@@ -151,4 +157,308 @@ TEST(WebTest, RouteMatchTest)
 
     EXPECT_THROW(router.findRoute("/section/this-is-not-valid", "page=xxx"), bes::web::NoMatchException);
     EXPECT_THROW(router.findRoute("/category/abc/"), bes::web::NoMatchException);
-}
\ No newline at end of file
+}
+TEST(WebTest, RouteTypedMatchTest)
+{
+    bes::web::MappedRouter router;
+    router.addRoute(bes::web::Route("article", "/articles/{ id: int }"));
+    router.addRoute(bes::web::Route("article_slug", "/articles/{ slug: slug }"));
+    router.addRoute(bes::web::Route("article_new", "/articles/new"));
+    router.addRoute(bes::web::Route("user", "/users/{ id: uuid }/profile"));
+    router.addRoute(bes::web::Route("file", "/files/{ path }"));
+    router.addRoute(bes::web::Route("file_edit", "/files/{ path }/edit"));
+    router.addRoute(bes::web::Route("year", "/archive/{ year: [0-9]{4} }/{ month: int }"));
+
+    bes::web::ActionArgs args;
+
+    // Literals take precedence over arguments, then int over slug
+    EXPECT_EQ("article_new", router.matchRoute("/articles/new", "", args)->name);
+    EXPECT_EQ("article", router.matchRoute("/articles/123", "", args)->name);
+    EXPECT_EQ("123", args["id"]);
+    EXPECT_EQ("article_slug", router.matchRoute("/articles/hello-world", "", args)->name);
+    EXPECT_EQ("hello-world", args["slug"]);
+    EXPECT_EQ(nullptr, router.matchRoute("/articles/hello world", "", args));
+    EXPECT_EQ(nullptr, router.matchRoute("/articles/", "", args));
+
+    args.clear();
+    auto const* user = router.matchRoute("/users/0b5c4a8e-3f7d-4c1a-9e2b-7d6f5a4c3b2a/profile", "", args);
+    ASSERT_NE(nullptr, user);
+    EXPECT_EQ("user", user->name);
+    EXPECT_EQ("0b5c4a8e-3f7d-4c1a-9e2b-7d6f5a4c3b2a", args["id"]);
+    EXPECT_EQ(nullptr, router.matchRoute("/users/0b5c4a8e-3f7d-4c1a-9e2b/profile", "", args));
+
+    // Untyped arguments span any characters, backtracking to let the remainder match
+    args.clear();
+    EXPECT_EQ("file", router.matchRoute("/files/a/b/c.txt", "", args)->name);
+    EXPECT_EQ("a/b/c.txt", args["path"]);
+    args.clear();
+    EXPECT_EQ("file_edit", router.matchRoute("/files/a/b/c.txt/edit", "", args)->name);
+    EXPECT_EQ("a/b/c.txt", args["path"]);
+
+    // Regex fallback
+    args.clear();
+    EXPECT_EQ("year", router.matchRoute("/archive/2019/07", "", args)->name);
+    EXPECT_EQ("2019", args["year"]);
+    EXPECT_EQ("07", args["month"]);
+    EXPECT_EQ(nullptr, router.matchRoute("/archive/19/07", "", args));
+}
+
+TEST(WebTest, RoutePrecedenceTest)
+{
+    // Identical routes resolve by name, regardless of the order they're added
+    for (int order = 0; order < 2; ++order) {
+        bes::web::MappedRouter router;
+        if (order == 0) {
+            router.addRoute(bes::web::Route("b", "/x/{ id }"));
+            router.addRoute(bes::web::Route("a", "/x/{ id }"));
+        } else {
+            router.addRoute(bes::web::Route("a", "/x/{ id }"));
+            router.addRoute(bes::web::Route("b", "/x/{ id }"));
+        }
+
+        bes::web::ActionArgs args;
+        EXPECT_EQ("a", router.matchRoute("/x/1", "", args)->name);
+    }
+
+    // Query routes are tried with the query-string first, then path routes without it
+    bes::web::MappedRouter router;
+    router.loadRoutesFromString(routes);
+    router.addRoute(bes::web::Route("section", "/section/{ section }"));
+
+    bes::web::ActionArgs args;
+    EXPECT_EQ("page", router.matchRoute("/section/abc", "page=1", args)->name);
+    args.clear();
+    EXPECT_EQ("section", router.matchRoute("/section/abc", "other=1", args)->name);
+    EXPECT_EQ("abc", args["section"]);
+    EXPECT_EQ("home", router.matchRoute("/", "utm=1", args)->name);
+}
+
+TEST(WebTest, RouterYieldTest)
+{
+    bes::web::MappedRouter router;
+    router.loadRoutesFromString(routes);
+    router.registerController("home", [](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        bes::web::HttpResponse resp;
+        resp.write("home");
+        return resp;
+    });
+
+    {
+        FakeRequest base(requestContainer(), "/");
+        bes::web::HttpRequest request(base);
+        auto resp = router.tryYieldResponse(request);
+        ASSERT_TRUE(resp.has_value());
+        EXPECT_EQ("home", resp->routeName());
+    }
+
+    {
+        // A miss passes to the next router without an exception, but the throwing form keeps its contract
+        FakeRequest base(requestContainer(), "/missing");
+        bes::web::HttpRequest request(base);
+        EXPECT_FALSE(router.tryYieldResponse(request).has_value());
+        EXPECT_THROW((void)router.yieldResponse(request), bes::web::CannotYieldException);
+
+        EXPECT_FALSE(router.tryYieldErrorResponse(request, bes::web::Http::Status::NOT_FOUND, "").has_value());
+        router.registerController("error", [](bes::web::HttpRequest const&, bes::web::ActionArgs const& args) {
+            bes::web::HttpResponse resp;
+            resp.write(args.at("error_title"));
+            return resp;
+        });
+
+        auto resp = router.tryYieldErrorResponse(request, bes::web::Http::Status::NOT_FOUND, "");
+        ASSERT_TRUE(resp.has_value());
+        EXPECT_EQ("error", resp->routeName());
+        EXPECT_EQ("404", resp->headers().at(bes::web::Http::Header::STATUS));
+    }
+}
+
+TEST(WebTest, RouterPresetHeadersTest)
+{
+    bes::web::MappedRouter router;
+    router.loadRoutesFromString(routes);
+    router.loadRoutesFromString(R"--EOF--(---
+static:
+  uri: /static
+  headers:
+    Cache-Control: public, max-age=300
+    X-Frame-Options: DENY
+)--EOF--");
+    router.registerController("static", [](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        return bes::web::HttpResponse::ok();
+    });
+
+    FakeRequest base(requestContainer(), "/static");
+    bes::web::HttpRequest request(base);
+    auto resp = router.tryYieldResponse(request);
+    ASSERT_TRUE(resp.has_value());
+
+    // Serialised once, when the route was loaded
+    auto const& preset = resp->presetHeaders();
+    ASSERT_NE(nullptr, preset);
+    EXPECT_EQ("Cache-Control: public, max-age=300\nX-Frame-Options: DENY\n", preset->block);
+    EXPECT_EQ(preset, router.routeMap().at("static").preset_headers);
+    EXPECT_EQ(nullptr, router.routeMap().at("home").preset_headers);
+}
+
+TEST(WebTest, QueryDecodeTest)
+{
+    FakeRequest base(requestContainer(), "/", "a=%41%62+c&b=%zz%4&c=%4g%2F");
+    bes::web::HttpRequest request(base);
+
+    EXPECT_EQ("Ab c", request.queryParam("a"));
+
+    // Malformed sequences are left as they are
+    EXPECT_EQ("%zz%4", request.queryParam("b"));
+    EXPECT_EQ("%4g/", request.queryParam("c"));
+}
+
+TEST(WebTest, RouterCacheTest)
+{
+    constexpr auto cached_routes = R"--EOF--(---
+home:
+  uri: /
+  cache: 60
+
+article:
+  uri: "/articles/{ id: int }"
+  cache:
+    ttl: 30
+    query: [page]
+    cookies: [currency]
+    headers: [Accept-Language]
+
+contact:
+  uri: /contact
+)--EOF--";
+
+    bes::web::MappedRouter router;
+    router.loadRoutesFromString(cached_routes);
+
+    auto const& article = router.routeMap().at("article");
+    EXPECT_EQ(std::chrono::seconds(30), article.cache.ttl);
+    EXPECT_EQ(std::vector<std::string>{"page"}, article.cache.query);
+    EXPECT_EQ(std::vector<std::string>{"currency"}, article.cache.cookies);
+    EXPECT_EQ(std::vector<std::string>{"HTTP_ACCEPT_LANGUAGE"}, article.cache.headers);
+    EXPECT_EQ(std::chrono::seconds(60), router.routeMap().at("home").cache.ttl);
+    EXPECT_EQ(std::chrono::seconds(0), router.routeMap().at("contact").cache.ttl);
+
+    int calls = 0;
+    auto controller = [&calls](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        ++calls;
+        auto resp = bes::web::HttpResponse::ok();
+        resp.write("body");
+        return resp;
+    };
+    router.registerController("article", controller);
+    router.registerController("contact", controller);
+
+    auto yield = [&router](std::string const& uri, std::string const& query = std::string()) {
+        FakeRequest base(requestContainer(), uri, query);
+        bes::web::HttpRequest request(base);
+        return router.tryYieldResponse(request);
+    };
+
+    // Without a cache, nothing is marked for storage
+    EXPECT_FALSE(yield("/articles/1")->cacheStore().has_value());
+
+    auto cache = std::make_shared<bes::web::ResponseCache>(1024 * 1024);
+    router.setResponseCache(cache);
+    EXPECT_FALSE(yield("/contact")->cacheStore().has_value());
+
+    auto miss = yield("/articles/1", "page=2&utm_source=x");
+    ASSERT_TRUE(miss->cacheStore().has_value());
+    EXPECT_EQ(nullptr, miss->cached());
+    EXPECT_EQ(3, calls);
+
+    // The responder stores it once rendered
+    auto const& store = *miss->cacheStore();
+    EXPECT_EQ(std::chrono::seconds(30), store.ttl);
+    cache->put(store.key, bes::web::CachedResponse{"Status: 200\n", "cached"}, store.ttl);
+
+    // Unlisted query params don't split the cache, listed ones and the route arguments do
+    auto hit = yield("/articles/1", "page=2");
+    ASSERT_NE(nullptr, hit->cached());
+    EXPECT_EQ("cached", hit->cached()->body);
+    EXPECT_EQ("article", hit->routeName());
+    EXPECT_EQ(3, calls);
+
+    EXPECT_EQ(nullptr, yield("/articles/1", "page=3")->cached());
+    EXPECT_EQ(nullptr, yield("/articles/2", "page=2")->cached());
+    EXPECT_EQ(nullptr, yield("/articles/1")->cached());
+    EXPECT_EQ(6, calls);
+}
+
+TEST(WebTest, RouterVersionTest)
+{
+    bes::web::MappedRouter router;
+    router.loadRoutesFromString(routes);
+
+    int calls = 0;
+    router.registerController("home", [&calls](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        ++calls;
+        return bes::web::HttpResponse::ok();
+    });
+
+    std::optional<std::string> version = "build-1";
+    router.registerVersion("home", [&version](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        return version;
+    });
+
+    auto const etag = bes::web::strongETag("build-1");
+
+    auto yield = [&router](std::string const& if_none_match) {
+        FakeRequest base(requestContainer(), "/");
+        if (!if_none_match.empty()) {
+            base.setParam(bes::web::Http::Parameter::IF_NONE_MATCH, if_none_match);
+        }
+        bes::web::HttpRequest request(base);
+        return *router.tryYieldResponse(request);
+    };
+
+    {
+        // No validator, rendered and tagged
+        auto resp = yield("");
+        EXPECT_EQ(1, calls);
+        EXPECT_EQ("200", resp.headers().at(bes::web::Http::Header::STATUS));
+        EXPECT_EQ(etag, resp.headers().at(bes::web::Http::Header::ETAG));
+    }
+
+    {
+        // Client holds this version, the controller isn't called
+        auto resp = yield(etag);
+        EXPECT_EQ(1, calls);
+        EXPECT_EQ("304", resp.headers().at(bes::web::Http::Header::STATUS));
+        EXPECT_EQ(etag, resp.headers().at(bes::web::Http::Header::ETAG));
+        EXPECT_EQ("home", resp.routeName());
+    }
+
+    {
+        // A compressed copy of this version, tagged by the responder with its encoding
+        auto gzip_etag = bes::web::encodedETag(etag, bes::web::ContentEncoding::GZIP);
+        auto resp = yield(gzip_etag);
+        EXPECT_EQ(1, calls);
+        EXPECT_EQ("304", resp.headers().at(bes::web::Http::Header::STATUS));
+        EXPECT_EQ(gzip_etag, resp.headers().at(bes::web::Http::Header::ETAG));
+        EXPECT_EQ("Accept-Encoding", resp.headers().at(bes::web::Http::Header::VARY));
+
+        resp = yield(bes::web::encodedETag(etag, bes::web::ContentEncoding::DEFLATE));
+        EXPECT_EQ(1, calls);
+        EXPECT_EQ("304", resp.headers().at(bes::web::Http::Header::STATUS));
+    }
+
+    {
+        // Stale version
+        version = "build-2";
+        auto resp = yield(etag);
+        EXPECT_EQ(2, calls);
+        EXPECT_EQ("200", resp.headers().at(bes::web::Http::Header::STATUS));
+    }
+
+    {
+        // Unknown version, rendered without a tag
+        version = std::nullopt;
+        auto resp = yield(etag);
+        EXPECT_EQ(3, calls);
+        EXPECT_EQ(nullptr, resp.headers().get(bes::web::Http::Header::ETAG));
+    }
+}
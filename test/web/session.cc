@@ -0,0 +1,592 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "fake_request.h"
+
+using bes::web::test::FakeRequest;
+using bes::web::test::FakeResponder;
+
+namespace {
+
+/**
+ * Sessions kept in a map, counting calls to the manager.
+ */
+class FakeSessionMgr : public bes::web::SessionInterface
+{
+   public:
+    bes::web::Session createSession(std::string const& ns) override
+    {
+        ++creates;
+        return bes::web::Session(ns + std::to_string(creates));
+    }
+
+    bes::web::Session getSession(std::string const& id) override
+    {
+        ++gets;
+        auto it = store.find(id);
+        if (it == store.end()) {
+            throw bes::web::SessionNotExistsException("No session: " + id);
+        }
+
+        auto session = it->second;
+        session.markClean();
+        return session;
+    }
+
+    void persistSession(bes::web::Session const& session) override
+    {
+        ++persists;
+
+        // Like a real store, only a new session is written in full
+        auto it = store.find(session.sessionId());
+        if (it != store.end() && !session.isNew()) {
+            it->second.merge(session);
+        } else {
+            store.insert_or_assign(session.sessionId(), session);
+        }
+    }
+
+    bool touchSession(std::string const& id) override
+    {
+        ++touches;
+        return store.count(id) != 0;
+    }
+
+    void setSessionTtl(uint64_t) override {}
+
+    void flush() override
+    {
+        ++flushes;
+    }
+
+    std::map<std::string, bes::web::Session> store;
+    int creates = 0;
+    int gets = 0;
+    int persists = 0;
+    int touches = 0;
+    int flushes = 0;
+};
+
+/**
+ * An invalidation bus connecting the caches of two "nodes" in the same process.
+ */
+class FakeBus : public bes::web::SessionInvalidationBus
+{
+   public:
+    void publish(std::string const& session_id) override
+    {
+        if (peer != nullptr && peer->handler) {
+            peer->handler(session_id);
+        }
+    }
+
+    Subscription subscribe(Handler h) override
+    {
+        handler = std::move(h);
+        return 1;
+    }
+
+    void unsubscribe(Subscription) override
+    {
+        handler = nullptr;
+    }
+
+    FakeBus* peer = nullptr;
+    Handler handler;
+};
+
+struct SessionContainer
+{
+    SessionContainer()
+    {
+        container.add<bes::web::SessionInterface>(bes::web::SVC_SESSION_MGR, mgr);
+        container.add(bes::web::SVC_SESSION_STATS, counters);
+        container.emplace<std::string>(bes::web::SESSION_PREFIX_KEY, bes::web::SESSION_DEFAULT_PREFIX);
+        container.emplace<std::string>(bes::web::SESSION_COOKIE_KEY, bes::web::SESSION_DEFAULT_COOKIE);
+        container.emplace<bool>(bes::web::SESSION_SECURE_KEY, false);
+    }
+
+    std::shared_ptr<FakeSessionMgr> mgr = std::make_shared<FakeSessionMgr>();
+    std::shared_ptr<bes::web::SessionCounters> counters = std::make_shared<bes::web::SessionCounters>();
+    bes::Container container;
+};
+
+}  // namespace
+
+TEST(SessionTest, KeyGenerationTest)
+{
+    auto key = bes::web::SessionInterface::generateSessionKey("S");
+    ASSERT_EQ(1 + bes::web::SessionInterface::SESSION_KEY_LENGTH, key.size());
+    EXPECT_EQ('S', key[0]);
+    EXPECT_EQ(std::string::npos, key.find_first_not_of("0123456789abcdef", 1));
+
+    // Each thread draws from its own buffer, none may repeat another's key
+    std::vector<std::vector<std::string>> keys(4);
+    std::vector<std::thread> threads;
+    for (auto& thread_keys : keys) {
+        threads.emplace_back([&thread_keys] {
+            for (int i = 0; i < 1000; ++i) {
+                thread_keys.push_back(bes::web::SessionInterface::generateSessionKey(""));
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    std::unordered_set<std::string> unique;
+    for (auto const& thread_keys : keys) {
+        unique.insert(thread_keys.begin(), thread_keys.end());
+    }
+
+    EXPECT_EQ(4000, unique.size());
+}
+
+TEST(SessionTest, ChangeTrackingTest)
+{
+    bes::web::Session session("S123");
+    EXPECT_TRUE(session.isNew());
+    EXPECT_TRUE(session.isModified());
+
+    session.setValue("user", "bob");
+    session.setValue("visits", int64_t(3));
+    session.markClean();
+    EXPECT_FALSE(session.isNew());
+    EXPECT_FALSE(session.isModified());
+    EXPECT_TRUE(session.changedKeys().empty());
+
+    // Reading doesn't modify
+    EXPECT_EQ("bob", session.getString("user"));
+    EXPECT_FALSE(session.isModified());
+
+    session.setValue("visits", int64_t(4));
+    session.removeValue("user");
+    session.removeValue("missing");
+    EXPECT_TRUE(session.isModified());
+    EXPECT_EQ(std::unordered_set<std::string>{"visits"}, session.changedKeys());
+    EXPECT_EQ(std::unordered_set<std::string>{"user"}, session.removedKeys());
+    EXPECT_FALSE(session.hasItem("user"));
+
+    // Setting a removed key again is a change, not a removal
+    session.setValue("user", "alice");
+    EXPECT_TRUE(session.removedKeys().empty());
+    EXPECT_EQ(2, session.changedKeys().size());
+
+    session.removeValue("visits");
+    EXPECT_EQ(std::unordered_set<std::string>{"user"}, session.changedKeys());
+    EXPECT_EQ(std::unordered_set<std::string>{"visits"}, session.removedKeys());
+}
+
+TEST(SessionTest, LazyLoadTest)
+{
+    SessionContainer c;
+    bes::web::Session existing("S123");
+    existing.setValue("user", "bob");
+    c.mgr->store.emplace("S123", existing);
+
+    {
+        // The cookie is enough to know we have a session, the manager isn't asked until it is read
+        FakeRequest base(c.container, "/");
+        base.setParam(bes::web::Http::Parameter::COOKIE, "theme=dark; bsn=S123");
+        bes::web::HttpRequest request(base);
+        EXPECT_TRUE(request.hasSession());
+        EXPECT_EQ("S123", request.sessionId());
+        EXPECT_FALSE(request.sessionLoaded());
+
+        // Nor is the unverified ID sent back
+        FakeResponder responder(base);
+        auto resp = bes::web::HttpResponse::ok();
+        EXPECT_EQ(std::string::npos, responder.render(resp, request).find("Set-Cookie"));
+    }
+
+    // But its TTL is still refreshed
+    EXPECT_EQ(0, c.mgr->gets);
+    EXPECT_EQ(0, c.mgr->persists);
+    EXPECT_EQ(1, c.mgr->touches);
+    EXPECT_EQ(1, c.counters->stats().skipped);
+
+    {
+        FakeRequest base(c.container, "/");
+        base.setParam(bes::web::Http::Parameter::COOKIE, "bsn=S123");
+        bes::web::HttpRequest request(base);
+        EXPECT_EQ("bob", request.getSession().getString("user"));
+        EXPECT_EQ("bob", request.getSession().getString("user"));
+    }
+
+    EXPECT_EQ(1, c.mgr->gets);
+    EXPECT_EQ(1, c.mgr->persists);
+    EXPECT_EQ(1, c.counters->stats().loads);
+
+    {
+        // An expired session is replaced when it is read
+        FakeRequest base(c.container, "/");
+        base.setParam(bes::web::Http::Parameter::COOKIE, "bsn=S999");
+        bes::web::HttpRequest request(base);
+        EXPECT_EQ("S999", request.sessionId());
+        EXPECT_EQ("S1", request.getSession().sessionId());
+        EXPECT_EQ("S1", request.sessionId());
+
+        // Only the replacement is sent back
+        FakeResponder responder(base);
+        auto resp = bes::web::HttpResponse::ok();
+        auto out = responder.render(resp, request);
+        EXPECT_NE(std::string::npos, out.find("Set-Cookie: bsn=S1"));
+        EXPECT_EQ(std::string::npos, out.find("S999"));
+    }
+
+    EXPECT_EQ(1, c.counters->stats().expired);
+    EXPECT_EQ(1, c.counters->stats().created);
+
+    {
+        // No cookie, no session until one is asked for
+        FakeRequest base(c.container, "/");
+        bes::web::HttpRequest request(base);
+        EXPECT_FALSE(request.hasSession());
+        EXPECT_EQ("", request.sessionId());
+    }
+
+    EXPECT_EQ(2, c.mgr->gets);
+    EXPECT_EQ(1, c.mgr->touches);
+    EXPECT_EQ(1, c.counters->stats().skipped);
+}
+
+TEST(SessionTest, StoreFailureTest)
+{
+    // A store that can't be reached, as when every connection is checked out
+    struct FailingSessionMgr : FakeSessionMgr
+    {
+        void persistSession(bes::web::Session const&) override
+        {
+            throw bes::web::WebException("No connection available");
+        }
+
+        bool touchSession(std::string const&) override
+        {
+            throw bes::web::WebException("No connection available");
+        }
+    };
+
+    SessionContainer c;
+    auto mgr = std::make_shared<FailingSessionMgr>();
+    c.container.remove(bes::web::SVC_SESSION_MGR);
+    c.container.add<bes::web::SessionInterface>(bes::web::SVC_SESSION_MGR, mgr);
+
+    // Destroying the request loses the write, but not the process
+    {
+        FakeRequest base(c.container, "/");
+        bes::web::HttpRequest request(base);
+        request.getSession().setValue("user", "bob");
+    }
+
+    {
+        FakeRequest base(c.container, "/");
+        base.setParam(bes::web::Http::Parameter::COOKIE, "bsn=S123");
+        bes::web::HttpRequest request(base);
+    }
+
+    EXPECT_EQ(1, mgr->creates);
+    EXPECT_TRUE(mgr->store.empty());
+}
+
+TEST(SessionTest, StoreCollisionTest)
+{
+    // Hands out the same ID every time
+    struct FixedIdSessionMgr : bes::web::MemorySessionMgr
+    {
+        bes::web::Session createSession(std::string const&) override
+        {
+            return bes::web::Session("M1");
+        }
+    };
+
+    SessionContainer c;
+    auto mgr = std::make_shared<FixedIdSessionMgr>();
+    c.container.remove(bes::web::SVC_SESSION_MGR);
+    c.container.add<bes::web::SessionInterface>(bes::web::SVC_SESSION_MGR, mgr);
+
+    for (auto user : {"bob", "alice"}) {
+        FakeRequest base(c.container, "/");
+        bes::web::HttpRequest request(base);
+        request.getSession().setValue("user", user);
+    }
+
+    // The second request's session is dropped rather than overwriting the first
+    EXPECT_EQ("bob", mgr->getSession("M1").getString("user"));
+}
+
+TEST(SessionTest, SessionFreeRouteTest)
+{
+    constexpr auto routes = R"--EOF--(---
+home:
+  uri: /
+health:
+  uri: /health
+  session: false
+)--EOF--";
+
+    SessionContainer c;
+    c.mgr->store.emplace("S123", bes::web::Session("S123"));
+
+    bes::web::MappedRouter router;
+    router.loadRoutesFromString(routes);
+    EXPECT_TRUE(router.routeMap().at("home").session);
+    EXPECT_FALSE(router.routeMap().at("health").session);
+
+    auto controller = [](bes::web::HttpRequest const& request, bes::web::ActionArgs const&) {
+        request.getSession().setValue("seen", true);
+        return bes::web::HttpResponse::ok();
+    };
+    router.registerController("home", controller);
+    router.registerController("health", controller);
+
+    {
+        FakeRequest base(c.container, "/health");
+        base.setParam(bes::web::Http::Parameter::COOKIE, "bsn=S123");
+        bes::web::HttpRequest request(base);
+        ASSERT_TRUE(router.tryYieldResponse(request).has_value());
+        EXPECT_FALSE(request.hasSession());
+    }
+
+    EXPECT_EQ(0, c.mgr->gets);
+    EXPECT_EQ(0, c.mgr->creates);
+    EXPECT_EQ(0, c.mgr->persists);
+    EXPECT_EQ(0, c.mgr->touches);
+    EXPECT_EQ(1, c.counters->stats().skipped);
+
+    {
+        FakeRequest base(c.container, "/");
+        base.setParam(bes::web::Http::Parameter::COOKIE, "bsn=S123");
+        bes::web::HttpRequest request(base);
+        ASSERT_TRUE(router.tryYieldResponse(request).has_value());
+        EXPECT_TRUE(request.hasSession());
+    }
+
+    EXPECT_EQ(1, c.mgr->gets);
+    EXPECT_EQ(1, c.mgr->persists);
+    EXPECT_TRUE(c.mgr->store.at("S123").getBool("seen"));
+}
+
+TEST(SessionTest, WriteBehindTest)
+{
+    auto target = std::make_shared<FakeSessionMgr>();
+
+    bes::web::Session base("S123");
+    base.setValue("user", "bob");
+    base.setValue("visits", int64_t(1));
+    target->store.emplace("S123", base);
+
+    {
+        bes::web::WriteBehindSessionMgr mgr(target);
+
+        // Two requests working on the same session, persisted back to back
+        auto first = mgr.getSession("S123");
+        auto second = mgr.getSession("S123");
+        first.setValue("visits", int64_t(2));
+        second.setValue("theme", "dark");
+        second.removeValue("user");
+        mgr.persistSession(first);
+        mgr.persistSession(second);
+
+        // Reads see the pending write, not the store
+        auto pending = mgr.getSession("S123");
+        EXPECT_FALSE(pending.isModified());
+        EXPECT_EQ(2, pending.getInt("visits"));
+        EXPECT_EQ("dark", pending.getString("theme"));
+        EXPECT_FALSE(pending.hasItem("user"));
+
+        mgr.flush();
+        EXPECT_EQ(0, mgr.pending());
+        EXPECT_LE(target->persists, 2);
+        EXPECT_EQ(1, target->flushes);
+
+        auto const& stored = target->store.at("S123");
+        EXPECT_EQ(2, stored.getInt("visits"));
+        EXPECT_EQ("dark", stored.getString("theme"));
+        EXPECT_FALSE(stored.hasItem("user"));
+
+        // Queued writes are written on destruction
+        auto created = mgr.createSession("N");
+        created.setValue("new", true);
+        mgr.persistSession(created);
+    }
+
+    ASSERT_EQ(1, target->store.count("N1"));
+    EXPECT_TRUE(target->store.at("N1").getBool("new"));
+}
+
+TEST(SessionTest, WriteBehindTouchTest)
+{
+    // Holds the writer on its first write, so what queues behind it is known
+    struct GatedSessionMgr : FakeSessionMgr
+    {
+        void persistSession(bes::web::Session const& session) override
+        {
+            std::lock_guard<std::mutex> lock(gate);
+            FakeSessionMgr::persistSession(session);
+        }
+
+        std::mutex gate;
+    };
+
+    auto target = std::make_shared<GatedSessionMgr>();
+    target->store.emplace("S123", bes::web::Session("S123"));
+    bes::web::WriteBehindSessionMgr mgr(target);
+
+    {
+        std::lock_guard<std::mutex> lock(target->gate);
+        mgr.persistSession(bes::web::Session("S456"));
+
+        // A touch of a session already queued is dropped, and a write takes over a queued touch
+        EXPECT_TRUE(mgr.touchSession("S123"));
+        EXPECT_TRUE(mgr.touchSession("S123"));
+        auto session = mgr.getSession("S123");
+        session.setValue("theme", "dark");
+        mgr.persistSession(session);
+        EXPECT_TRUE(mgr.touchSession("S123"));
+        EXPECT_EQ(2, mgr.pending());
+    }
+
+    mgr.flush();
+    EXPECT_EQ(0, target->touches);
+    EXPECT_EQ(2, target->persists);
+    EXPECT_EQ("dark", target->store.at("S123").getString("theme"));
+
+    EXPECT_TRUE(mgr.touchSession("S123"));
+    mgr.flush();
+    EXPECT_EQ(1, target->touches);
+    EXPECT_EQ(0, mgr.pending());
+}
+
+TEST(SessionTest, CachingTest)
+{
+    auto target = std::make_shared<FakeSessionMgr>();
+    bes::web::Session base("S123");
+    base.setValue("user", "bob");
+    target->store.emplace("S123", base);
+
+    bes::web::SessionCacheConfig config;
+    config.ttl = std::chrono::milliseconds(200);
+    config.negative_ttl = std::chrono::milliseconds(200);
+    bes::web::CachingSessionMgr mgr(target, config);
+
+    // Repeat reads come from the cache
+    EXPECT_EQ("bob", mgr.getSession("S123").getString("user"));
+    EXPECT_FALSE(mgr.getSession("S123").isModified());
+    EXPECT_EQ(1, target->gets);
+    EXPECT_EQ(1, mgr.stats().hits);
+
+    // Writes go through and update the cached copy
+    auto session = mgr.getSession("S123");
+    session.setValue("user", "alice");
+    mgr.persistSession(session);
+    EXPECT_EQ(1, target->persists);
+    EXPECT_EQ("alice", mgr.getSession("S123").getString("user"));
+    EXPECT_EQ(1, target->gets);
+
+    // Two requests working on the same session: the cache holds both sets of changes, as the store does
+    auto first = mgr.getSession("S123");
+    auto second = mgr.getSession("S123");
+    first.setValue("theme", "dark");
+    second.setValue("lang", "en");
+    mgr.persistSession(first);
+    mgr.persistSession(second);
+    EXPECT_EQ("dark", target->store.at("S123").getString("theme"));
+    EXPECT_EQ("dark", mgr.getSession("S123").getString("theme"));
+    EXPECT_EQ("en", mgr.getSession("S123").getString("lang"));
+    EXPECT_EQ(1, target->gets);
+
+    // Unknown IDs are remembered as missing
+    EXPECT_THROW((void)mgr.getSession("forged"), bes::web::SessionNotExistsException);
+    EXPECT_THROW((void)mgr.getSession("forged"), bes::web::SessionNotExistsException);
+    EXPECT_EQ(2, target->gets);
+    EXPECT_EQ(1, mgr.stats().negative_hits);
+
+    // Until they expire, the store is asked again
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    EXPECT_THROW((void)mgr.getSession("forged"), bes::web::SessionNotExistsException);
+    EXPECT_EQ("alice", mgr.getSession("S123").getString("user"));
+    EXPECT_EQ(4, target->gets);
+
+    // Touching a missing session is remembered too
+    EXPECT_TRUE(mgr.touchSession("S123"));
+    EXPECT_FALSE(mgr.touchSession("missing"));
+    EXPECT_FALSE(mgr.touchSession("missing"));
+    EXPECT_EQ(2, target->touches);
+}
+
+TEST(SessionTest, CachingBudgetTest)
+{
+    auto target = std::make_shared<FakeSessionMgr>();
+    for (int i = 0; i < 100; ++i) {
+        bes::web::Session session("S" + std::to_string(i));
+        session.setValue("data", std::string(100, 'x'));
+        target->store.emplace(session.sessionId(), session);
+    }
+
+    bes::web::SessionCacheConfig config;
+    config.byte_budget = 4096;
+    config.shards = 1;
+    bes::web::CachingSessionMgr mgr(target, config);
+
+    for (int i = 0; i < 100; ++i) {
+        (void)mgr.getSession("S" + std::to_string(i));
+    }
+
+    auto stats = mgr.stats();
+    EXPECT_LE(stats.bytes, 4096);
+    EXPECT_GT(stats.entries, 0);
+    EXPECT_EQ(100 - stats.entries, stats.evictions);
+
+    // The most recent are kept
+    (void)mgr.getSession("S99");
+    EXPECT_EQ(100, target->gets);
+}
+
+TEST(SessionTest, CachingInvalidationTest)
+{
+    // Two nodes sharing a store, each with its own cache
+    auto target = std::make_shared<FakeSessionMgr>();
+    target->store.emplace("S123", bes::web::Session("S123"));
+
+    auto bus_a = std::make_shared<FakeBus>();
+    auto bus_b = std::make_shared<FakeBus>();
+    bus_a->peer = bus_b.get();
+    bus_b->peer = bus_a.get();
+
+    bes::web::CachingSessionMgr node_a(target, {}, bus_a);
+    auto node_b = std::make_unique<bes::web::CachingSessionMgr>(target, bes::web::SessionCacheConfig{}, bus_b);
+
+    (void)node_a.getSession("S123");
+    (void)node_b->getSession("S123");
+    EXPECT_EQ(2, target->gets);
+
+    auto session = node_a.getSession("S123");
+    session.setValue("theme", "dark");
+    node_a.persistSession(session);
+
+    // Node B drops its copy and reads the write
+    EXPECT_EQ("dark", node_b->getSession("S123").getString("theme"));
+    EXPECT_EQ(3, target->gets);
+    EXPECT_EQ(1, node_b->stats().invalidations);
+
+    // An unmodified session is only a TTL refresh, nobody is told
+    node_a.persistSession(node_a.getSession("S123"));
+    (void)node_b->getSession("S123");
+    EXPECT_EQ(3, target->gets);
+
+    // The bus outlives a manager that goes away, which stops being called
+    node_b.reset();
+    EXPECT_FALSE(bus_b->handler);
+    auto later = node_a.getSession("S123");
+    later.setValue("theme", "light");
+    node_a.persistSession(later);
+}
@@ -0,0 +1,146 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "fake_request.h"
+
+using bes::web::Http;
+using bes::web::StaticConfig;
+using bes::web::StaticController;
+using bes::web::test::FakeRequest;
+using bes::web::test::requestContainer;
+
+namespace {
+
+std::string writeFile(std::string const& name, std::string const& content)
+{
+    auto path = testing::TempDir() + name;
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+    return path;
+}
+
+bes::web::ActionArgs path(std::string const& p)
+{
+    return {{"path", p}};
+}
+
+}  // namespace
+
+TEST(StaticControllerTest, ServeTest)
+{
+    std::string css;
+    for (int i = 0; i < 100; ++i) {
+        css += ".item-" + std::to_string(i) + " { color: red; }\n";
+    }
+
+    auto css_path = writeFile("bes_static.css", css);
+    auto png_path = writeFile("bes_static.png", std::string(64, '\x89'));
+
+    StaticController assets(bes::FileFinder({testing::TempDir()}));
+
+    FakeRequest base(requestContainer(), "/assets");
+    bes::web::HttpRequest request(base);
+    auto resp = assets.serve(request, path("bes_static.css"));
+
+    EXPECT_EQ("200", resp.headers().at(Http::Header::STATUS));
+    EXPECT_EQ("text/css", resp.headers().at(Http::Header::CONTENT_TYPE));
+    EXPECT_EQ(std::to_string(css.size()), resp.headers().at(Http::Header::CONTENT_LENGTH));
+    EXPECT_EQ("Accept-Encoding", resp.headers().at(Http::Header::VARY));
+    EXPECT_NE(nullptr, resp.headers().get(Http::Header::LAST_MODIFIED));
+    EXPECT_EQ(nullptr, resp.headers().get(Http::Header::CONTENT_ENCODING));
+    EXPECT_EQ(css, resp.content());
+    auto etag = resp.headers().at(Http::Header::ETAG);
+
+    // Gzipped once, when the file was first read
+    FakeRequest gzip_base(requestContainer(), "/assets");
+    gzip_base.setParam(Http::Parameter::ACCEPT_ENCODING, "gzip");
+    bes::web::HttpRequest gzip_request(gzip_base);
+    resp = assets.serve(gzip_request, path("bes_static.css"));
+    EXPECT_EQ("gzip", resp.headers().at(Http::Header::CONTENT_ENCODING));
+    EXPECT_EQ(bes::web::encodedETag(etag, bes::web::ContentEncoding::GZIP), resp.headers().at(Http::Header::ETAG));
+    EXPECT_LT(resp.body().size(), css.size());
+
+    // Revalidation doesn't send the body
+    FakeRequest match_base(requestContainer(), "/assets");
+    match_base.setParam(Http::Parameter::IF_NONE_MATCH, etag);
+    bes::web::HttpRequest match_request(match_base);
+    resp = assets.serve(match_request, path("bes_static.css"));
+    EXPECT_EQ("304", resp.headers().at(Http::Header::STATUS));
+    EXPECT_TRUE(resp.body().empty());
+
+    // Binary types are held as they are
+    resp = assets.serve(request, path("bes_static.png"));
+    EXPECT_EQ("image/png", resp.headers().at(Http::Header::CONTENT_TYPE));
+    EXPECT_EQ(nullptr, resp.headers().get(Http::Header::VARY));
+    EXPECT_EQ(std::string(64, '\x89'), resp.content());
+
+    auto stats = assets.stats();
+    EXPECT_EQ(2, stats.misses);
+    EXPECT_EQ(2, stats.hits);
+    EXPECT_EQ(2, stats.files);
+
+    std::remove(css_path.c_str());
+    std::remove(png_path.c_str());
+}
+
+TEST(StaticControllerTest, TruncatedTest)
+{
+    std::string const js(8192, 'x');
+    auto js_path = writeFile("bes_static_truncated.js", js);
+
+    StaticConfig config;
+    config.gzip_min_size = js.size() + 1;
+    StaticController assets(bes::FileFinder({testing::TempDir()}), config);
+
+    FakeRequest base(requestContainer(), "/assets");
+    bes::web::HttpRequest request(base);
+    EXPECT_EQ(js, assets.serve(request, path("bes_static_truncated.js")).content());
+
+    // The held copy is ours, emptying the file under it changes nothing until the file is read again
+    writeFile("bes_static_truncated.js", "");
+    EXPECT_EQ(js, assets.serve(request, path("bes_static_truncated.js")).content());
+
+    // And the budget counts exactly what is held
+    EXPECT_EQ(js.size(), assets.stats().bytes);
+
+    std::remove(js_path.c_str());
+}
+
+TEST(StaticControllerTest, AccelRedirectTest)
+{
+    auto large_path = writeFile("bes_static_large.js", std::string(4096, 'x'));
+
+    StaticConfig config;
+    config.max_cached_size = 1024;
+    config.accel_prefix = "/_assets/";
+    StaticController assets(bes::FileFinder({testing::TempDir()}), config);
+
+    FakeRequest base(requestContainer(), "/assets");
+    bes::web::HttpRequest request(base);
+    auto resp = assets.serve(request, path("bes_static_large.js"));
+
+    EXPECT_EQ("/_assets/bes_static_large.js", resp.headers().at(Http::Header::X_ACCEL_REDIRECT));
+    EXPECT_EQ("application/javascript", resp.headers().at(Http::Header::CONTENT_TYPE));
+    EXPECT_TRUE(resp.body().empty());
+    EXPECT_EQ(1, assets.stats().redirects);
+    EXPECT_EQ(0, assets.stats().files);
+
+    std::remove(large_path.c_str());
+}
+
+TEST(StaticControllerTest, NotFoundTest)
+{
+    StaticController assets(bes::FileFinder({testing::TempDir()}));
+
+    FakeRequest base(requestContainer(), "/assets");
+    bes::web::HttpRequest request(base);
+
+    EXPECT_THROW(assets.serve(request, path("missing.css")), bes::web::NotFoundHttpException);
+    EXPECT_THROW(assets.serve(request, path("../etc/passwd")), bes::web::NotFoundHttpException);
+    EXPECT_THROW(assets.serve(request, path("a/../../b")), bes::web::NotFoundHttpException);
+    EXPECT_THROW(assets.serve(request, path("/etc/passwd")), bes::web::NotFoundHttpException);
+    EXPECT_THROW(assets.serve(request, {}), bes::web::NotFoundHttpException);
+}
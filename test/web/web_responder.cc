@@ -0,0 +1,202 @@
+#include <bes/web.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "fake_request.h"
+
+using bes::web::Http;
+using bes::web::test::FakeRequest;
+using bes::web::test::FakeResponder;
+using bes::web::test::requestContainer;
+
+namespace {
+
+constexpr auto routes = R"--EOF--(---
+home:
+  uri: /
+  headers:
+    X-Frame-Options: DENY
+versioned:
+  uri: /versioned
+  headers:
+    X-Frame-Options: SAMEORIGIN
+)--EOF--";
+
+bool contains(std::string const& haystack, std::string const& needle)
+{
+    return haystack.find(needle) != std::string::npos;
+}
+
+/**
+ * The Content-Length a rendered response declares, and the size of the body it actually carries.
+ */
+std::pair<std::string, std::size_t> declaredLength(std::string const& out)
+{
+    auto end = out.find("\n\n");
+    auto start = out.find("Content-Length: ");
+    if (end == std::string::npos || start == std::string::npos || start > end) {
+        return {std::string(), 0};
+    }
+
+    start += 16;
+    return {out.substr(start, out.find('\n', start) - start), out.size() - end - 2};
+}
+
+}  // namespace
+
+TEST(WebResponderTest, NotModifiedPresetHeadersTest)
+{
+    bes::web::MappedRouter router;
+    router.loadRoutesFromString(routes);
+
+    auto const etag = bes::web::strongETag("body");
+    router.registerController("home", [&etag](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        auto resp = bes::web::HttpResponse::ok();
+        resp.header(Http::Header::ETAG, etag);
+        resp.header(Http::Header::CACHE_CONTROL, "max-age=60");
+        resp.write("body");
+        return resp;
+    });
+    router.registerController("versioned", [](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        return bes::web::HttpResponse::ok();
+    });
+    router.registerVersion("versioned", [](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        return std::optional<std::string>("build-1");
+    });
+
+    {
+        // The controller's ETag matched, the 304 carries what a 200 would have said about caching
+        FakeRequest base(requestContainer(), "/");
+        base.setParam(Http::Parameter::IF_NONE_MATCH, etag);
+        bes::web::HttpRequest request(base);
+        FakeResponder responder(base);
+
+        auto resp = *router.tryYieldResponse(request);
+        auto out = responder.render(resp, request);
+        EXPECT_TRUE(contains(out, "Status: 304\n"));
+        EXPECT_TRUE(contains(out, "X-Frame-Options: DENY\n"));
+        EXPECT_TRUE(contains(out, "Cache-Control: max-age=60\n"));
+        EXPECT_TRUE(contains(out, "ETag: " + etag + "\n"));
+        EXPECT_FALSE(contains(out, "body"));
+    }
+
+    {
+        // Answered by the version provider, without the controller
+        FakeRequest base(requestContainer(), "/versioned");
+        base.setParam(Http::Parameter::IF_NONE_MATCH, bes::web::strongETag("build-1"));
+        bes::web::HttpRequest request(base);
+        FakeResponder responder(base);
+
+        auto resp = *router.tryYieldResponse(request);
+        auto out = responder.render(resp, request);
+        EXPECT_TRUE(contains(out, "Status: 304\n"));
+        EXPECT_TRUE(contains(out, "X-Frame-Options: SAMEORIGIN\n"));
+    }
+}
+
+TEST(WebResponderTest, EncodedContentLengthTest)
+{
+    constexpr auto cached_routes = R"--EOF--(---
+page:
+  uri: /page
+cached:
+  uri: /cached
+  cache: 60
+)--EOF--";
+
+    bes::Container container;
+    container.add<bes::web::SessionInterface>(bes::web::SVC_SESSION_MGR, nullptr);
+    container.add(bes::web::SVC_COMPRESSION, std::make_shared<bes::web::CompressionConfig>());
+
+    bes::web::MappedRouter router;
+    router.loadRoutesFromString(cached_routes);
+    router.setResponseCache(std::make_shared<bes::web::ResponseCache>(1024 * 1024));
+
+    std::string const text(4096, 'x');
+    auto controller = [&text](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        auto resp = bes::web::HttpResponse::ok();
+        resp.header(Http::Header::CONTENT_LENGTH, std::to_string(resp.write(text)));
+        return resp;
+    };
+    router.registerController("page", controller);
+    router.registerController("cached", controller);
+
+    auto render = [&](std::string const& uri, std::string const& accept) {
+        FakeRequest base(container, uri);
+        base.setParam(Http::Parameter::ACCEPT_ENCODING, accept);
+        bes::web::HttpRequest request(base);
+        FakeResponder responder(base);
+
+        auto resp = *router.tryYieldResponse(request);
+        return responder.render(resp, request);
+    };
+
+    // The controller's length is for the body it wrote, a compressed body is sent with its own
+    for (auto const* uri : {"/page", "/cached", "/cached"}) {
+        for (auto const* accept : {"deflate", "gzip", ""}) {
+            auto out = render(uri, accept);
+            auto length = declaredLength(out);
+            EXPECT_EQ(std::to_string(length.second), length.first) << uri << " " << accept;
+            EXPECT_EQ(*accept == '\0', length.second == text.size()) << uri << " " << accept;
+        }
+    }
+}
+
+TEST(WebResponderTest, SessionNotCachedTest)
+{
+    constexpr auto cached_routes = R"--EOF--(---
+account:
+  uri: /account
+  cache: 60
+about:
+  uri: /about
+  cache: 60
+)--EOF--";
+
+    bes::Container container;
+    container.add<bes::web::SessionInterface>(bes::web::SVC_SESSION_MGR,
+                                              std::make_shared<bes::web::MemorySessionMgr>());
+    container.emplace<std::string>(bes::web::SESSION_PREFIX_KEY, bes::web::SESSION_DEFAULT_PREFIX);
+    container.emplace<std::string>(bes::web::SESSION_COOKIE_KEY, bes::web::SESSION_DEFAULT_COOKIE);
+    container.emplace<bool>(bes::web::SESSION_SECURE_KEY, false);
+
+    auto cache = std::make_shared<bes::web::ResponseCache>(1024 * 1024);
+    bes::web::MappedRouter router;
+    router.loadRoutesFromString(cached_routes);
+    router.setResponseCache(cache);
+
+    int calls = 0;
+    router.registerController("account", [&calls](bes::web::HttpRequest const& request, bes::web::ActionArgs const&) {
+        ++calls;
+        auto resp = bes::web::HttpResponse::ok();
+        auto& session = request.getSession();
+        resp.write(session.hasItem("user") ? "Hello " + session.getString("user") : "Hello guest");
+        return resp;
+    });
+    router.registerController("about", [](bes::web::HttpRequest const&, bes::web::ActionArgs const&) {
+        auto resp = bes::web::HttpResponse::ok();
+        resp.write("About");
+        return resp;
+    });
+
+    auto render = [&](std::string const& uri) {
+        FakeRequest base(container, uri);
+        bes::web::HttpRequest request(base);
+        FakeResponder responder(base);
+
+        auto resp = *router.tryYieldResponse(request);
+        return responder.render(resp, request);
+    };
+
+    // Built from the session, so rendered for each visitor rather than stored
+    render("/account");
+    render("/account");
+    EXPECT_EQ(2, calls);
+    EXPECT_EQ(0, cache->stats().inserts);
+
+    render("/about");
+    EXPECT_EQ(1, cache->stats().inserts);
+}
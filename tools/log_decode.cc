@@ -0,0 +1,70 @@
+#include <bes/log.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+
+using bes::log::LogFormat;
+
+namespace {
+
+void usage(char const* bin)
+{
+    std::cerr << "Usage: " << bin << " [--format=msg|short|standard|full|detail] [file]\n\n"
+              << "Renders a binary log as text. Reads from stdin if no file is given.\n";
+    std::exit(2);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    static std::map<std::string, LogFormat> const formats = {
+        {"msg", LogFormat::MSG_ONLY},   {"short", LogFormat::SHORT},   {"standard", LogFormat::STANDARD},
+        {"full", LogFormat::FULL},      {"detail", LogFormat::DETAIL},
+    };
+
+    LogFormat format = LogFormat::STANDARD;
+    std::string filename;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--format=", 9) == 0) {
+            auto it = formats.find(argv[i] + 9);
+            if (it == formats.end()) {
+                usage(argv[0]);
+            }
+            format = it->second;
+        } else if (argv[i][0] == '-' || !filename.empty()) {
+            usage(argv[0]);
+        } else {
+            filename = argv[i];
+        }
+    }
+
+    std::ifstream file;
+    if (!filename.empty()) {
+        file.open(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Unable to open " << filename << std::endl;
+            return 1;
+        }
+    }
+
+    std::istream& in = filename.empty() ? std::cin : file;
+
+    try {
+        bes::log::binary::Reader reader(in);
+        bes::log::LogRecord record;
+
+        while (reader.next(record)) {
+            record.str(std::cout, format) << '\n';
+        }
+    } catch (std::runtime_error const& e) {
+        std::cout.flush();
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}